@@ -0,0 +1,72 @@
+#include "bench_common.h"
+
+#include "stopwatch.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// Batches shorter than this are dominated by the resolution of the stopwatch
+#define MIN_BATCH_NSEC 20000000ULL
+
+// Batches timed once calibrated. The median is reported
+#define NUM_BATCHES 7
+
+static bool first_result;
+
+void bench_begin(const char *suite)
+{
+    printf("{\"suite\": \"%s\", \"benchmarks\": [", suite);
+    first_result = true;
+}
+
+static unsigned long long time_batch(BenchFunction function, unsigned long long iterations)
+{
+    unsigned long long begin = sw_now_nsec();
+    for (unsigned long long i = 0; i < iterations; ++i)
+    {
+        function();
+    }
+    return sw_now_nsec() - begin;
+}
+
+static int compare_doubles(const void *a, const void *b)
+{
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+void bench_run(const char *name, BenchFunction function, unsigned int items, const char *item_name)
+{
+    // Double the batch until it is long enough, which also warms up caches
+    unsigned long long iterations = 1;
+    while (time_batch(function, iterations) < MIN_BATCH_NSEC)
+    {
+        iterations *= 2;
+    }
+
+    double ns_per_op[NUM_BATCHES];
+    for (int batch = 0; batch < NUM_BATCHES; ++batch)
+    {
+        ns_per_op[batch] = (double)time_batch(function, iterations) / (double)iterations;
+    }
+    qsort(ns_per_op, NUM_BATCHES, sizeof(double), compare_doubles);
+
+    double median = ns_per_op[NUM_BATCHES / 2];
+    printf("%s\n  {\"name\": \"%s\", \"iterations\": %llu, \"ns_per_op\": %.1f, \"min_ns_per_op\": %.1f",
+           first_result ? "" : ",", name, iterations, median, ns_per_op[0]);
+    if (items > 0)
+    {
+        printf(", \"ns_per_%s\": %.2f", item_name, median / items);
+    }
+    printf("}");
+    fflush(stdout);
+
+    first_result = false;
+}
+
+void bench_end(void)
+{
+    printf("\n]}\n");
+}
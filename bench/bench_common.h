@@ -0,0 +1,26 @@
+/* Minimal benchmark harness. An operation is run in batches long enough for the
+ * stopwatch to time precisely, and the median batch is reported. Each suite
+ * prints one JSON document to stdout so runs can be compared across releases:
+ *
+ * {"suite": "...", "benchmarks": [{"name": "...", "iterations": ..., "ns_per_op": ..., ...}]}
+ */
+
+#ifndef BENCH_COMMON_H
+#define BENCH_COMMON_H
+
+typedef void (*BenchFunction)(void);
+
+/* Start the JSON document of a suite
+ */
+void bench_begin(const char *suite);
+
+/* Time `function` and report nanoseconds per call. If the call processes
+ * `items` things, e.g. stars, nanoseconds per `item_name` are reported too
+ */
+void bench_run(const char *name, BenchFunction function, unsigned int items, const char *item_name);
+
+/* Close the JSON document
+ */
+void bench_end(void);
+
+#endif // BENCH_COMMON_H
@@ -0,0 +1,125 @@
+/* Building the star catalog at startup, and looking up cities
+ */
+
+#include "bench_common.h"
+#include "bsc5.h"
+#include "bsc5_names.h"
+#include "city.h"
+#include "city_tree.h"
+#include "city_trie.h"
+#include "core.h"
+#include "parse_BSC5.h"
+
+#include <stdlib.h>
+
+static unsigned int num_stars;
+static struct Entry *entries;
+static struct StarNameTable name_table;
+static struct Star *star_table;
+static struct CityTrie city_trie;
+static struct CityTree city_tree;
+
+static void bench_parse_entries(void)
+{
+    struct Entry *parsed;
+    unsigned int num_parsed;
+    parse_entries(bsc5, bsc5_len, &parsed, &num_parsed);
+    free(parsed);
+}
+
+static void bench_generate_star_table(void)
+{
+    struct Star *table;
+    generate_star_table(&table, entries, &name_table, num_stars);
+    free_stars(table, num_stars);
+}
+
+static void bench_star_indices_by_magnitude(void)
+{
+    unsigned int *idx_by_mag;
+    star_indices_by_magnitude(&idx_by_mag, star_table, num_stars);
+    free(idx_by_mag);
+}
+
+static void bench_get_city(void)
+{
+    // Both ends of data/cities.csv
+    free_city(get_city("Aachen"));
+    free_city(get_city("Zürich"));
+}
+
+static void bench_find_city(void)
+{
+    find_city("Aachen");
+    find_city("Zürich");
+}
+
+static void bench_generate_city_trie(void)
+{
+    struct CityTrie trie;
+    generate_city_trie(&trie, builtin_city_table());
+    free_city_trie(&trie);
+}
+
+static void bench_city_trie_complete(void)
+{
+    const struct CityRecord *first;
+    city_trie_complete(&city_trie, "san", &first);
+    city_trie_complete(&city_trie, "zür", &first);
+}
+
+static void bench_city_trie_search(void)
+{
+    // Misspellings of Aachen and Zürich, as suggested when a city is not found
+    struct CityMatch matches[5];
+    city_trie_search(&city_trie, "Achen", 2, matches, 5);
+    city_trie_search(&city_trie, "Zurich", 2, matches, 5);
+}
+
+static void bench_generate_city_tree(void)
+{
+    struct CityTree tree;
+    generate_city_tree(&tree, builtin_city_table());
+    free_city_tree(&tree);
+}
+
+static void bench_city_tree_nearest(void)
+{
+    // A city, the open ocean and a pole
+    city_tree_nearest(&city_tree, 0.8990, 0.1487, NULL);
+    city_tree_nearest(&city_tree, -0.7, -2.5, NULL);
+    city_tree_nearest(&city_tree, -1.5708, 0.0, NULL);
+}
+
+int main(void)
+{
+    if (!parse_entries(bsc5, bsc5_len, &entries, &num_stars) ||
+        !generate_name_table(bsc5_names, bsc5_names_len, &name_table) ||
+        !generate_star_table(&star_table, entries, &name_table, num_stars) ||
+        !generate_city_trie(&city_trie, builtin_city_table()) ||
+        !generate_city_tree(&city_tree, builtin_city_table()))
+    {
+        return EXIT_FAILURE;
+    }
+
+    bench_begin("catalog");
+    bench_run("parse_entries", bench_parse_entries, num_stars, "star");
+    bench_run("generate_star_table", bench_generate_star_table, num_stars, "star");
+    bench_run("star_indices_by_magnitude", bench_star_indices_by_magnitude, num_stars, "star");
+    bench_run("get_city", bench_get_city, 2, "lookup");
+    bench_run("find_city", bench_find_city, 2, "lookup");
+    bench_run("generate_city_trie", bench_generate_city_trie, builtin_city_table()->num_records, "city");
+    bench_run("city_trie_complete", bench_city_trie_complete, 2, "lookup");
+    bench_run("city_trie_search", bench_city_trie_search, 2, "lookup");
+    bench_run("generate_city_tree", bench_generate_city_tree, builtin_city_table()->num_records, "city");
+    bench_run("city_tree_nearest", bench_city_tree_nearest, 3, "lookup");
+    bench_end();
+
+    free_city_tree(&city_tree);
+    free_city_trie(&city_trie);
+    free_stars(star_table, num_stars);
+    free_star_names(&name_table);
+    free(entries);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,72 @@
+/* Positions of stars, planets and the moon for one frame
+ */
+
+#include "bench_common.h"
+#include "bsc5.h"
+#include "bsc5_names.h"
+#include "core.h"
+#include "core_position.h"
+#include "data/keplerian_elements.h"
+#include "macros.h"
+#include "parse_BSC5.h"
+
+#include <stdlib.h>
+
+// 2000-01-01 12:00 UTC, from Boston
+#define BENCH_JULIAN_DATE 2451545.0
+#define BENCH_LATITUDE (42.36 * TO_RAD)
+#define BENCH_LONGITUDE (-71.06 * TO_RAD)
+
+static unsigned int num_stars;
+static struct Star *star_table;
+static struct Planet *planet_table;
+static struct Moon moon_object;
+
+// Advanced on every call so results are not reused
+static double julian_date = BENCH_JULIAN_DATE;
+
+static void bench_update_star_positions(void)
+{
+    julian_date += 1.0E-5;
+    update_star_positions(star_table, (int)num_stars, julian_date, BENCH_LATITUDE, BENCH_LONGITUDE);
+}
+
+static void bench_update_planet_positions(void)
+{
+    julian_date += 1.0E-5;
+    update_planet_positions(planet_table, julian_date, BENCH_LATITUDE, BENCH_LONGITUDE);
+}
+
+static void bench_update_moon_position(void)
+{
+    julian_date += 1.0E-5;
+    update_moon_position(&moon_object, julian_date, BENCH_LATITUDE, BENCH_LONGITUDE);
+}
+
+int main(void)
+{
+    struct Entry *entries;
+    struct StarNameTable name_table;
+    if (!parse_entries(bsc5, bsc5_len, &entries, &num_stars) ||
+        !generate_name_table(bsc5_names, bsc5_names_len, &name_table) ||
+        !generate_star_table(&star_table, entries, &name_table, num_stars) ||
+        !generate_planet_table(&planet_table, planet_elements, planet_rates, planet_extras) ||
+        !generate_moon_object(&moon_object, &moon_elements, &moon_rates))
+    {
+        return EXIT_FAILURE;
+    }
+
+    bench_begin("ephemeris");
+    bench_run("update_star_positions", bench_update_star_positions, num_stars, "star");
+    bench_run("update_planet_positions", bench_update_planet_positions, NUM_PLANETS, "planet");
+    bench_run("update_moon_position", bench_update_moon_position, 0, NULL);
+    bench_end();
+
+    free_stars(star_table, num_stars);
+    free_planets(planet_table, NUM_PLANETS);
+    free_moon_object(moon_object);
+    free_star_names(&name_table);
+    free(entries);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,85 @@
+/* Drawing stars and constellations into an off-screen canvas, as the thread
+ * producing frames does. Nothing is copied to a terminal
+ */
+
+#include "bench_common.h"
+#include "bsc5.h"
+#include "bsc5_constellations.h"
+#include "bsc5_names.h"
+#include "canvas.h"
+#include "core.h"
+#include "core_position.h"
+#include "core_render.h"
+#include "macros.h"
+#include "parse_BSC5.h"
+#include "view.h"
+
+#include <stdlib.h>
+
+// A typical full screen sky: square, with cells twice as tall as wide
+#define BENCH_ROWS 100
+#define BENCH_COLS 200
+
+static struct Conf config = {
+    .latitude = 42.36 * TO_RAD,
+    .longitude = -71.06 * TO_RAD,
+    .threshold = 5.0f,
+    .label_thresh = 0.25f,
+    .projection = PROJECTION_STEREOGRAPHIC,
+};
+
+static struct Canvas canvas;
+static unsigned int num_stars;
+static struct Star *star_table;
+static unsigned int *idx_by_mag;
+static struct ConstellTable constell_table;
+static struct View view;
+
+static void bench_render_stars_stereo(void)
+{
+    canvas_erase(&canvas);
+    render_stars_stereo(&canvas, &config, star_table, (int)num_stars, idx_by_mag);
+}
+
+static void bench_render_constells(void)
+{
+    canvas_erase(&canvas);
+    render_constells(&canvas, &config, &view, &constell_table, star_table);
+}
+
+int main(void)
+{
+    struct Entry *entries;
+    struct StarNameTable name_table;
+    if (!parse_entries(bsc5, bsc5_len, &entries, &num_stars) ||
+        !generate_name_table(bsc5_names, bsc5_names_len, &name_table) ||
+        !generate_constell_table(bsc5_constellations, bsc5_constellations_len, num_stars, &constell_table) ||
+        !generate_star_table(&star_table, entries, &name_table, num_stars) ||
+        !star_indices_by_magnitude(&idx_by_mag, star_table, num_stars))
+    {
+        return EXIT_FAILURE;
+    }
+    drop_faint_labels(star_table, num_stars, config.label_thresh);
+    update_star_positions(star_table, (int)num_stars, 2451545.0, config.latitude, config.longitude);
+    view_init(&view);
+
+    if (!generate_canvas(&canvas, BENCH_ROWS, BENCH_COLS))
+    {
+        return EXIT_FAILURE;
+    }
+
+    bench_begin("render");
+    bench_run("render_stars_stereo", bench_render_stars_stereo, num_stars, "star");
+    bench_run("render_constells", bench_render_constells, constell_table.num_constells, "constellation");
+    bench_end();
+
+    free_canvas(&canvas);
+
+    free_constells(&constell_table);
+    free_stars(star_table, num_stars);
+    free_star_names(&name_table);
+    free(idx_by_mag);
+    free(entries);
+
+    return EXIT_SUCCESS;
+}
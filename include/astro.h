@@ -11,6 +11,9 @@
 #include <stdbool.h>
 #include <time.h>
 
+// Sidereal days per solar day, i.e. turns of the sky per day
+#define SIDEREAL_RATE 1.00273790935
+
 // For our purposes, the Sun is treated the same as a planet
 enum Planets
 {
@@ -54,6 +57,14 @@ enum ZodiacSign
     PISCES,
 };
 
+// Daily path of a fixed object across the sky of a given observer
+enum DiurnalMotion
+{
+    RISES_AND_SETS = 0,
+    CIRCUMPOLAR, // Never sets
+    NEVER_RISES
+};
+
 // Keplerian/orbital elements
 
 struct KepElems
@@ -131,6 +142,19 @@ void calc_planet_geo_ICRF(double xe, double ye, double ze, const struct KepElems
 void calc_moon_geo_ICRF(const struct KepElems *moon_elements, const struct KepRates *moon_rates, double julian_date, double *xg,
                         double *yg, double *zg);
 
+/* Classify the daily path of a fixed object at a given declination for an
+ * observer at a given latitude (radians). The declination is only trusted to
+ * within `margin` radians: an object is classified as circumpolar or never
+ * rising only if that holds anywhere within the margin
+ */
+enum DiurnalMotion classify_diurnal_motion(double declination, double latitude, double margin);
+
+/* Calculate the semi-diurnal arc of a fixed object, i.e. the hour angle
+ * (radians) at which it sets below `altitude`; it rises at the negated hour
+ * angle. The arc is only written if the object rises and sets
+ */
+enum DiurnalMotion calc_semi_diurnal_arc(double declination, double latitude, double altitude, double *semi_arc);
+
 // Miscellaneous
 
 /* Note: this is NOT the obliquity of the elliptic. Instead, it is the angle
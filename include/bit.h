@@ -25,4 +25,14 @@ double bytes_to_double64_LE(const uint8_t *buffer);
 
 bool bytes_to_bool32_LE(const uint8_t *buffer);
 
+// Bit scanning
+
+/* Index of the lowest set bit of a nonzero word
+ */
+unsigned int lowest_set_bit64(uint64_t word);
+
+/* Index of the highest set bit of a nonzero word
+ */
+unsigned int highest_set_bit64(uint64_t word);
+
 #endif // BIT_UTILS_H
@@ -0,0 +1,74 @@
+/* Off-screen grid of terminal cells that frames are drawn into. A canvas is
+ * plain memory rather than a curses window, so frames can be drawn on any
+ * thread: only the thread owning the terminal copies a finished canvas to a
+ * window, with win_draw_canvas.
+ *
+ * Cells hold one Unicode code point each. Text is clipped at the right edge
+ * instead of wrapping, and anything drawn outside the canvas is dropped.
+ */
+
+#ifndef CANVAS_H
+#define CANVAS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+struct Cell
+{
+    uint32_t ch;         // Unicode code point, or 0 if nothing is drawn
+    uint16_t color_pair; // 0 indicates no color pair
+};
+
+struct Canvas
+{
+    int height;
+    int width;
+    struct Cell *cells; // Row by row
+    int color_pair;     // Color pair of the cells drawn next
+};
+
+/* Allocate a blank canvas of `height` rows and `width` columns. This function
+ * allocates memory which should be freed by the caller via free_canvas.
+ * Returns false upon memory allocation error
+ */
+bool generate_canvas(struct Canvas *canvas, int height, int width);
+
+/* Change the size of a canvas, leaving it blank. Returns false upon memory
+ * allocation error, in which case the canvas is left empty
+ */
+bool resize_canvas(struct Canvas *canvas, int height, int width);
+
+void free_canvas(struct Canvas *canvas);
+
+/* Blank every cell
+ */
+void canvas_erase(struct Canvas *canvas);
+
+/* Set the color pair of the cells drawn next, 0 for none
+ */
+void canvas_set_color(struct Canvas *canvas, int color_pair);
+
+/* Draw an ASCII character at row `y` and column `x`
+ */
+void canvas_put_char(struct Canvas *canvas, int y, int x, char ch);
+
+/* Draw a UTF-8 string starting at row `y` and column `x`, one cell per code
+ * point. Tabs advance to the next multiple of eight columns
+ */
+void canvas_put_str(struct Canvas *canvas, int y, int x, const char *str);
+
+/* Draw formatted text like canvas_put_str
+ */
+void canvas_printf(struct Canvas *canvas, int y, int x, const char *format, ...);
+
+/* Decode the UTF-8 code point at `*str` and advance past it. Invalid bytes
+ * decode to U+FFFD one at a time
+ */
+uint32_t utf8_decode(const char **str);
+
+/* Encode a code point as UTF-8 into `out`, which must hold at least 5 bytes,
+ * and NUL-terminate it. Returns the number of bytes before the NUL
+ */
+int utf8_encode(uint32_t code_point, char *out);
+
+#endif // CANVAS_H
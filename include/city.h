@@ -1,6 +1,13 @@
 #ifndef CITY_H
 #define CITY_H
 
+#include <stdbool.h>
+#include <stddef.h>
+
+// Longest normalized city name (bytes), including the terminator. Longer names
+// are never found, and are skipped when loading cities from a file
+#define CITY_KEY_MAX 256
+
 typedef struct
 {
     const char *city_name;
@@ -8,6 +15,55 @@ typedef struct
     float longitude;
 } CityData;
 
+// A city of the index generated from data/cities.csv at build time, or loaded
+// from a file
+struct CityRecord
+{
+    const char *key; // Name without surrounding spaces and in ASCII lowercase, which the index is sorted by
+    const char *name;
+    const char *country_code;
+    float latitude;
+    float longitude;
+    unsigned long population;
+};
+
+// Cities sorted by key, then by decreasing population
+struct CityTable
+{
+    const struct CityRecord *records;
+    unsigned int num_records;
+    void *data; // Records and their strings when loaded from a file, or NULL
+};
+
+/* The cities built into the program. Never needs freeing
+ */
+const struct CityTable *builtin_city_table(void);
+
+/* Load cities from a file, either a CSV in the format of data/cities.csv or a
+ * GeoNames dump (e.g. cities500.txt or allCountries.txt). This function
+ * allocates memory which should be freed by the caller via free_city_table.
+ * Returns false if the file could not be read or holds no city
+ */
+bool generate_city_table(struct CityTable *table, const char *path);
+
+void free_city_table(struct CityTable *table);
+
+/* Write the normalized form of a city name to `key`: surrounding spaces are
+ * trimmed and ASCII letters lowercased, whatever the locale. Returns false if
+ * the key does not fit, in which case no city has that name
+ */
+bool normalize_city_key(const char *name, char *key, size_t key_size);
+
+/* Find a city by name, ignoring surrounding spaces and the case of ASCII
+ * letters. Among cities of the same name, the most populous is found. Returns
+ * NULL if not found. Never allocates
+ */
+const struct CityRecord *city_table_find(const struct CityTable *table, const char *name);
+
+/* Find a built-in city by name, as city_table_find
+ */
+const struct CityRecord *find_city(const char *name);
+
 /* Attempt to get the coordinates of a city by name. Returns NULL if not found.
  */
 CityData *get_city(const char *name);
@@ -0,0 +1,27 @@
+/* Looking up cities from the command line: by name, by prefix, or with
+ * suggestions for a name that was not found.
+ */
+
+#ifndef CITY_LOOKUP_H
+#define CITY_LOOKUP_H
+
+#include "city.h"
+
+#include <stdbool.h>
+
+/* Load the cities in `city_file`, or the built-in ones if it is NULL. Cities
+ * from a file should be freed by the caller via free_city_table, which leaves
+ * the built-in table alone. Returns false if the file could not be loaded
+ */
+bool load_city_table(const char *city_file, struct CityTable *cities);
+
+/* Print the cities named closest to a name that was not found, if any are close
+ */
+void print_city_suggestions(const struct CityTable *cities, const char *name);
+
+/* Print every city whose name starts with `prefix`, or suggestions if none
+ * does. Returns false if no city was listed
+ */
+bool list_cities(const char *city_file, const char *prefix);
+
+#endif // CITY_LOOKUP_H
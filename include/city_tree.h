@@ -0,0 +1,46 @@
+/* k-d tree over the cities of a city table, for finding the city nearest to a
+ * place on Earth. Cities are points on the unit sphere split along x, y or z,
+ * so there is no seam at the antimeridian and no singularity at the poles. The
+ * tree is implicit: each node is the median of its range of the array, with
+ * the nodes before it on one side and the nodes after it on the other.
+ * Searches never allocate.
+ */
+
+#ifndef CITY_TREE_H
+#define CITY_TREE_H
+
+#include "city.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+struct CityTreeNode
+{
+    float position[3]; // Unit vector from the center of the Earth towards the city
+    uint32_t record;   // Index of the city in the table
+    uint32_t axis;     // Coordinate the node splits its range on
+};
+
+struct CityTree
+{
+    const struct CityTable *table;
+    struct CityTreeNode *nodes; // One per city
+    unsigned int num_nodes;
+};
+
+/* Build a tree over the cities of `table`, which must outlive it. This function
+ * allocates memory which should be freed by the caller via free_city_tree.
+ * Returns false upon memory allocation error
+ */
+bool generate_city_tree(struct CityTree *tree, const struct CityTable *table);
+
+void free_city_tree(struct CityTree *tree);
+
+/* Find the city nearest to a place, given in radians. If `distance` is not
+ * NULL, it is set to the angle between them as seen from the center of the
+ * Earth (radians). Returns NULL if there are no cities
+ */
+const struct CityRecord *city_tree_nearest(const struct CityTree *tree, double latitude, double longitude,
+                                           double *distance);
+
+#endif // CITY_TREE_H
@@ -0,0 +1,65 @@
+/* Compact trie over the names of a city table, for completing prefixes and for
+ * finding names within a few typos. Edges hold whole runs of bytes, so there
+ * are at most about twice as many nodes as cities. Nodes store no text: since
+ * cities are sorted by name, the cities under a node are contiguous in the
+ * table and a node's label is read from the first of them. Searches never
+ * allocate.
+ */
+
+#ifndef CITY_TRIE_H
+#define CITY_TRIE_H
+
+#include "city.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Longest normalized query (bytes) searched for with typos
+#define CITY_FUZZY_MAX 64
+
+struct CityTrieNode
+{
+    uint32_t first_child;  // Children are contiguous, in byte order
+    uint32_t first_record; // Cities under the node
+    uint32_t num_records;
+    uint32_t num_terminal; // Cities named exactly the prefix ending at the node, first of its cities
+    uint16_t depth;        // Length of the prefix ending at the node
+    uint16_t num_children;
+};
+
+struct CityTrie
+{
+    const struct CityTable *table;
+    struct CityTrieNode *nodes; // The root first
+    unsigned int num_nodes;
+};
+
+struct CityMatch
+{
+    const struct CityRecord *city;
+    unsigned int distance; // Bytes inserted, deleted or replaced to turn the query into the city's key
+};
+
+/* Build a trie over the cities of `table`, which must outlive it. This function
+ * allocates memory which should be freed by the caller via free_city_trie.
+ * Returns false upon memory allocation error
+ */
+bool generate_city_trie(struct CityTrie *trie, const struct CityTable *table);
+
+void free_city_trie(struct CityTrie *trie);
+
+/* Find the cities whose name starts with `prefix`, ignoring surrounding spaces
+ * and the case of ASCII letters. They are contiguous in the table, in order of
+ * name, starting at `first`. Returns how many there are
+ */
+unsigned int city_trie_complete(const struct CityTrie *trie, const char *prefix, const struct CityRecord **first);
+
+/* Find up to `max_matches` cities named within `max_distance` edits of `query`,
+ * normalized as names are, closest first and then most populous first. Among
+ * cities of the same name, only the most populous is matched. Queries longer
+ * than CITY_FUZZY_MAX match nothing. Returns the number of matches
+ */
+unsigned int city_trie_search(const struct CityTrie *trie, const char *query, unsigned int max_distance,
+                              struct CityMatch *matches, unsigned int max_matches);
+
+#endif // CITY_TRIE_H
@@ -43,6 +43,18 @@
 #ifndef COORD_H
 #define COORD_H
 
+#include <stdbool.h>
+
+// Azimuthal projections of the sky above the horizon onto the screen disk. All
+// are centered on the zenith and map the horizon to the edge of the disk
+enum Projection
+{
+    PROJECTION_STEREOGRAPHIC = 0, // Conformal, the default
+    PROJECTION_ORTHOGRAPHIC,      // The sky as seen from far away, compressed near the horizon
+    PROJECTION_LAMBERT,           // Lambert azimuthal equal-area
+    PROJECTION_EQUIDISTANT,       // Radius proportional to zenith distance
+};
+
 // CONVERSIONS
 
 /* Converts equatorial coordinates (global) to horizontal coordinates (local)
@@ -54,6 +66,26 @@
 void equatorial_to_horizontal(double right_ascension, double declination, double gmst, double latitude, double longitude,
                               double *azimuth, double *altitude);
 
+/* Converts equatorial coordinates (global) to a unit vector in the horizontal
+ * frame (local), like horizontal_to_unit(equatorial_to_horizontal(...)) but
+ * without going through the angles
+ */
+void equatorial_to_horizontal_unit(double right_ascension, double declination, double gmst, double latitude,
+                                   double longitude, double *east, double *north, double *up);
+
+/* Converts horizontal coordinates back to equatorial coordinates, the inverse
+ * of equatorial_to_horizontal. Right ascension is in [0, 2π)
+ */
+void horizontal_to_equatorial(double azimuth, double altitude, double gmst, double latitude, double longitude,
+                              double *right_ascension, double *declination);
+
+/* Rates of change of azimuth and altitude per radian of hour angle for a fixed
+ * object, i.e. the derivatives of equatorial_to_horizontal as the sky turns.
+ * The azimuth rate is singular at the zenith, where it is reported as zero
+ */
+void horizontal_rates(double hour_angle, double declination, double latitude, double *azimuth_rate,
+                      double *altitude_rate);
+
 /* Converts rectangular equatorial coordinates to spherical rectangular
  * coordinates
  */
@@ -63,6 +95,16 @@ void equatorial_rectangular_to_spherical(double xeq, double yeq, double zeq, dou
  */
 void horizontal_to_spherical(double azimuth, double altitude, double *theta_sphere, double *phi_sphere);
 
+/* Converts horizontal coordinates to a unit vector in the horizontal frame,
+ * with components towards the East, the North and the zenith
+ */
+void horizontal_to_unit(double azimuth, double altitude, double *east, double *north, double *up);
+
+/* Converts a unit vector in the horizontal frame back to horizontal
+ * coordinates, the inverse of horizontal_to_unit. Azimuth is in [0, 2π)
+ */
+void unit_to_horizontal(double east, double north, double up, double *azimuth, double *altitude);
+
 // MAP PROJECTIONS
 
 /* Generalized stereographic projection centered on a generic focus point
@@ -104,6 +146,27 @@ void project_stereographic_south(double radius_sphere, double theta_sphere, doub
 void project_stereographic_north(double radius_sphere, double theta_sphere, double phi_sphere, double *r_polar,
                                  double *theta_polar);
 
+/* Look up a projection by its name as given on the command line, e.g.
+ * "stereographic". Returns false if the name is unknown
+ */
+bool projection_from_name(const char *name, enum Projection *projection);
+
+/* Projects horizontal unit vectors straight to screen space, with North at the
+ * top and East on the left as in project_stereographic_north followed by
+ * polar_to_win. Uses only one square root and one division per vector and no
+ * branches, so the loop vectorizes. Vectors below the horizon have their
+ * altitude clamped to zero, which lands them inside the disk, so they must be
+ * skipped by the caller
+ */
+void project_unit_vectors(enum Projection projection, const double *east, const double *north, const double *up,
+                          unsigned int count, int win_height, int win_width, int *rows, int *cols);
+
+/* Projects a single horizontal unit vector to screen space. Returns false if it
+ * lies below the horizon
+ */
+bool project_unit_vector(enum Projection projection, double east, double north, double up, int win_height,
+                         int win_width, int *row, int *col);
+
 // SCREEN SPACE MAPPING
 
 /* Maps point a point (r, θ) on the unit circle to screen space
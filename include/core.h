@@ -5,6 +5,7 @@
 #define CORE_H
 
 #include "astro.h"
+#include "coord.h"
 #include "parse_BSC5.h"
 
 #include <stdbool.h>
@@ -23,19 +24,37 @@ struct Conf
     float speed;
     double julian_date;
     double aspect_ratio;
+    int sky_cache_mib; // 0 disables the projection cache
+    enum Projection projection;
+    const char *tiles_path;       // Deep catalog streamed into the zoomed view, or NULL
+    const char *write_tiles_path; // Export the built-in catalog here and exit, or NULL
+    int tile_cache_mib;
+    int spin_usec;            // Busy-wait this long before each frame deadline instead of sleeping
+    const char *profile_path; // Per-stage frame profile written here at exit, or NULL
+    const char *trace_path;   // Timeline of every stage streamed here, or NULL
+    const char *city_name;    // Observe from this city instead of the latitude and longitude, or NULL
+    const char *city_file;    // Cities looked up instead of the built-in ones, or NULL
+    const char *list_cities;  // Print the cities starting with this prefix and exit, or NULL
+    int bench_frames;         // Frames drawn off screen as fast as possible, or 0 to run interactively
     bool quit_on_any;
     bool unicode;
     bool color;
     bool grid;
     bool constell;
     bool metadata;
+    bool coordinates_given; // The observer was placed with --latitude or --longitude
+    bool pipeline;          // Compute the next frame while the current one is drawn
+    bool perf_counters;     // Count hardware events in each stage of a benchmark
 };
 
 // All information pertinent to rendering a celestial body
 struct ObjectBase
 {
-    double azimuth; // Coordinates used for rendering
-    double altitude;
+    // Unit vector towards the object in the horizontal frame, used for
+    // rendering. Objects below the horizon have up < 0
+    double east;
+    double north;
+    double up;
     int color_pair; // 0 indicates no color pair
     char symbol_ASCII;
     const char *symbol_unicode;
@@ -70,42 +89,73 @@ struct Moon
     float magnitude;
 };
 
-struct Constell
+// Constellation stick figures in compressed sparse row (CSR) layout. The
+// segments of figure `i` are [offsets[i], offsets[i + 1]), and segment `j`
+// joins the stars at star table indices endpoints[2 * j] and
+// endpoints[2 * j + 1]. Both arrays share one allocation
+struct ConstellTable
 {
-    unsigned int num_segments;
-    int *star_numbers;
+    unsigned int num_constells;
+    unsigned int *offsets;   // num_constells + 1 entries
+    unsigned int *endpoints; // 2 * offsets[num_constells] entries
 };
 
+// Entry in the sparse catalog number -> name index
 struct StarName
 {
-    char *name;
+    int catalog_number;
+    unsigned int offset; // Offset of the name within the string pool
+};
+
+// Star names stored in a single contiguous string pool. The index and the pool
+// share one allocation, so the whole table is released with a single free()
+struct StarNameTable
+{
+    struct StarName *index; // Sorted by increasing catalog number
+    char *pool;             // NUL-terminated names, referenced by offset
+    unsigned int num_names;
 };
 
 // Data structure generation
 
+/* Set the ASCII and unicode symbols of a star according to its magnitude
+ */
+void set_star_symbol(struct ObjectBase *base, float magnitude);
+
 /* Fill array of star structures using entries from BSC5 and table of star
- * names. Stars with catalog number `n` are mapped to index `n-1`. This function
- * allocates memory which must be freed by the caller. Returns false upon memory
- * allocation error
+ * names. Stars with catalog number `n` are mapped to index `n-1`. Star labels
+ * point into the string pool of `name_table`, which must outlive the star
+ * table. This function allocates memory which must be freed by the caller.
+ * Returns false upon memory allocation error
  */
-bool generate_star_table(struct Star **star_table, struct Entry *entries, const struct StarName *name_table,
+bool generate_star_table(struct Star **star_table, struct Entry *entries, const struct StarNameTable *name_table,
                          unsigned int num_stars);
 
-/* Parse data from bsc5_names.txt and return an array of names. Stars with
- * catalog number `n` are mapped to index `n-1`. This function allocates memory
- * which should be freed by the caller. Returns false upon memory allocation
- * error.
+/* Remove the labels of stars fainter than `label_thresh`, which is fixed for the
+ * session, so renderers draw every label a star has
  */
-bool generate_name_table(const uint8_t *data, size_t data_len, struct StarName **name_table_out, int num_stars);
+void drop_faint_labels(struct Star *star_table, unsigned int num_stars, float label_thresh);
 
-/* Parse data from bsc5_constellations.txt and return an array of constell
- * structs. This function allocates memory which should  be freed by the
- * caller. Returns false upon memory allocation error.
- *
- * NOTE: bsc5.constellations.txt MUST end in a new line to grab all the data.
+/* Parse data from bsc5_names.txt into a string pool and a sparse index sorted
+ * by catalog number. Only stars that have a name occupy space in the table.
+ * This function allocates memory which should be freed by the caller via
+ * free_star_names. Returns false upon memory allocation error.
  */
-bool generate_constell_table(const uint8_t *data, size_t data_len, struct Constell **constell_table_out,
-                             unsigned int *num_constell_out);
+bool generate_name_table(const uint8_t *data, size_t data_len, struct StarNameTable *name_table_out);
+
+/* Look up the name of a star by catalog number. Returns NULL if the star has no
+ * name
+ */
+const char *star_name_lookup(const struct StarNameTable *name_table, int catalog_number);
+
+/* Parse data from bsc5_constellations.txt into a CSR constellation table.
+ * Catalog numbers are resolved to star table indices and validated against
+ * `num_stars` at load time. This function allocates memory which should be
+ * freed by the caller via free_constells. Returns false upon memory allocation
+ * error or malformed data.
+ */
+bool generate_constell_table(const uint8_t *data, size_t data_len, unsigned int num_stars,
+                             struct ConstellTable *constell_table_out);
 
 /* Generate an array of planet structs. This function allocates memory which
  * should  be freed by the caller. Returns false upon memory allocation error
@@ -120,21 +170,20 @@ bool generate_moon_object(struct Moon *moon_data, const struct KepElems *moon_el
 // Memory freeing
 
 void free_stars(struct Star *star_table, unsigned int size);
-void free_star_names(struct StarName *name_table, unsigned int size);
-void free_constells(struct Constell *constell_table, unsigned int size);
+void free_star_names(struct StarNameTable *name_table);
+void free_constells(struct ConstellTable *constell_table);
 void free_planets(struct Planet *planets, unsigned int size);
 void free_moon_object(struct Moon moon_data);
 
 // Miscellaneous
 
-/* Comparator for star structs
- */
-int star_magnitude_comparator(const void *v1, const void *v2);
-
-/* Modify an array of star numbers sorted by increasing magnitude. Used in
- * rendering functions so brighter stars are always rendered on top
+/* Fill an array of star table indices sorted by decreasing magnitude (dimmest
+ * first) using a radix sort over quantized magnitudes. Used in rendering
+ * functions so brighter stars are always rendered on top. This function
+ * allocates memory which must be freed by the caller. Returns false upon memory
+ * allocation error
  */
-bool star_numbers_by_magnitude(int **num_by_mag, const struct Star *star_table, unsigned int num_stars);
+bool star_indices_by_magnitude(unsigned int **idx_by_mag, const struct Star *star_table, unsigned int num_stars);
 
 /* Map a double `input` which lies in range [min_float, max_float]
  * to an integer which lies in range [min_int, max_int].
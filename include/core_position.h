@@ -5,21 +5,108 @@
 #define CORE_POSITION_H
 
 #include "core.h"
+#include "sky_index.h"
+#include "tile_catalog.h"
+#include "visibility.h"
+
+// Horizontal unit vector of a star when it was last computed exactly. Its
+// motion since follows from the rotation of the sky about the celestial pole
+struct StarMotion
+{
+    double julian_date;
+    double east;
+    double north;
+    double up;
+};
+
+// State for amortized star updates: each frame recomputes every `period`-th
+// star of the visible set and extrapolates the rest along the turning sky.
+// Motions are indexed by magnitude rank like the visible set
+struct StarExtrapolation
+{
+    unsigned int num_stars;
+    struct StarMotion *motions;
+    unsigned int period;
+    unsigned long frame;
+    double julian_date; // Time of the previous update
+    double latitude;
+    double longitude;
+};
 
 /* Update apparent star positions for a given observation time and location by
- * setting the azimuth and altitude of each star struct in an array of star
+ * setting the horizontal unit vector of each star struct in an array of star
  * structs
  */
 void update_star_positions(struct Star *star_table, int num_stars, double julian_date, double latitude, double longitude);
 
+/* Update apparent star positions like update_star_positions, but only for
+ * stars in cells of `index` that may be above the horizon. Stars in cells that
+ * drop below the horizon are moved to the nadir once so they are not rendered,
+ * and are not touched again until their cell rises. Pinned stars are always
+ * updated
+ */
+void update_star_positions_indexed(struct Star *star_table, struct SkyIndex *index, double julian_date, double latitude,
+                                   double longitude);
+
+/* Update apparent star positions like update_star_positions, but only for
+ * stars in cells of `index` that may lie within `radius` radians of the given
+ * equatorial coordinates and above the horizon, e.g. the field of a zoomed
+ * view. The updated cells are left in index->selected_cells. Pinned stars are
+ * always updated
+ */
+void update_star_positions_in_cap(struct Star *star_table, struct SkyIndex *index, double julian_date, double latitude,
+                                  double longitude, double right_ascension, double declination, double radius);
+
+/* Update apparent star positions like update_star_positions, but only for the
+ * visible set of `scheduler` after advancing it to the given time and
+ * location. Stars that set are moved to the nadir once so they are not rendered
+ */
+void update_star_positions_scheduled(struct Star *star_table, struct VisibilityScheduler *scheduler, double julian_date,
+                                     double latitude, double longitude);
+
+/* Update apparent positions of only the pinned stars of `scheduler`, e.g. when
+ * the rest of the sky is drawn from a projection cache
+ */
+void update_pinned_star_positions(struct Star *star_table, const struct VisibilityScheduler *scheduler,
+                                  double julian_date, double latitude, double longitude);
+
+/* Allocate amortized update state for a catalog. This function allocates
+ * memory which must be freed by the caller via free_star_extrapolation.
+ * Returns false upon memory allocation error
+ */
+bool generate_star_extrapolation(struct StarExtrapolation *extrapolation, unsigned int num_stars);
+
+/* Pick how many frames apart each star is recomputed so that linear
+ * extrapolation stays within half a cell on a projection `radius_cells` cells
+ * across from its center, given the simulated time per frame (days)
+ */
+unsigned int amortized_update_period(double frame_step, double radius_cells);
+
+/* Update apparent positions of the tile stars captured for this frame by
+ * tile_catalog_request
+ */
+void update_tile_star_positions(struct TileCatalog *catalog, double julian_date, double latitude, double longitude);
+
+/* Update apparent star positions like update_star_positions_scheduled, but
+ * recompute only a round-robin share of the visible set each frame and
+ * extrapolate the rest, keeping the error within half a cell for a projection
+ * `radius_cells` cells across. Stars not recomputed recently are always
+ * recomputed
+ */
+void update_star_positions_amortized(struct Star *star_table, struct VisibilityScheduler *scheduler,
+                                     struct StarExtrapolation *extrapolation, double julian_date, double latitude,
+                                     double longitude, double radius_cells);
+
+void free_star_extrapolation(struct StarExtrapolation *extrapolation);
+
 /* Update apparent Sun & planet positions for a given observation time and
- * location by setting the azimuth and altitude of each planet struct in an
+ * location by setting the horizontal unit vector of each planet struct in an
  * array of planet structs
  */
 void update_planet_positions(struct Planet *planet_table, double julian_date, double latitude, double longitude);
 
 /* Update apparent Moon positions for a given observation time and
- * location by setting the azimuth and altitude of a moon struct
+ * location by setting the horizontal unit vector of a moon struct
  */
 void update_moon_position(struct Moon *moon_object, double julian_date, double latitude, double longitude);
 
@@ -4,34 +4,72 @@
 #ifndef CORE_RENDER_H
 #define CORE_RENDER_H
 
+#include "canvas.h"
 #include "core.h"
-
-#include <curses.h>
+#include "projection_cache.h"
+#include "sky_index.h"
+#include "tile_catalog.h"
+#include "view.h"
+#include "visibility.h"
 
 /* Render stars to the screen using a stereographic projection
  */
-void render_stars_stereo(WINDOW *win, const struct Conf *config, struct Star *star_table, int num_stars, const int *num_by_mag);
+void render_stars_stereo(struct Canvas *canvas, const struct Conf *config, struct Star *star_table, int num_stars,
+                         const unsigned int *idx_by_mag);
+
+/* Render only the visible set of `scheduler` like render_stars_stereo, still in
+ * magnitude order. If `cache` and `slot` are not NULL, the cells stars are
+ * drawn at are recorded into the slot
+ */
+void render_visible_stars_stereo(struct Canvas *canvas, const struct Conf *config, struct Star *star_table,
+                                 const struct VisibilityScheduler *scheduler, struct ProjectionCache *cache,
+                                 struct CacheSlot *slot);
 
-/* Render the Sun and planets to the screen using a stereographic projection
+/* Render the stars of the cells selected in `index` that fall within a zoomed
+ * view, in magnitude order. See update_star_positions_in_cap
  */
-void render_planets_stereo(WINDOW *win, const struct Conf *config, const struct Planet *planet_table);
+void render_stars_in_view(struct Canvas *canvas, const struct Conf *config, const struct View *view,
+                          struct Star *star_table, const struct SkyIndex *index);
 
-/* Render the Moon to the screen using a stereographic projection
+/* Render the resident tile stars captured for this frame that fall within a
+ * zoomed view, in magnitude order. See update_tile_star_positions
  */
-void render_moon_stereo(WINDOW *win, const struct Conf *config, struct Moon moon_object);
+void render_tile_stars_in_view(struct Canvas *canvas, const struct Conf *config, const struct View *view,
+                               const struct TileCatalog *catalog);
 
-/* Render constellations
+/* Render the stars recorded in a filled cache slot without projecting them
  */
-void render_constells(WINDOW *win, const struct Conf *config, struct Constell **constell_table, int num_const,
-                      const struct Star *star_table);
+void render_cached_stars(struct Canvas *canvas, const struct Conf *config, const struct Star *star_table,
+                         const struct ProjectionCache *cache, const struct CacheSlot *slot);
+
+/* Render the Sun and planets to the screen using a stereographic projection,
+ * or in the zoomed view if `view` is zoomed
+ */
+void render_planets_stereo(struct Canvas *canvas, const struct Conf *config, const struct View *view,
+                           const struct Planet *planet_table);
+
+/* Render the Moon to the screen using a stereographic projection, or in the
+ * zoomed view if `view` is zoomed
+ */
+void render_moon_stereo(struct Canvas *canvas, const struct Conf *config, const struct View *view,
+                        struct Moon moon_object);
+
+/* Render constellations on the whole sky or in the zoomed view
+ */
+void render_constells(struct Canvas *canvas, const struct Conf *config, const struct View *view,
+                      const struct ConstellTable *constell_table, const struct Star *star_table);
 
 /* Render an azimuthal grid on a stereographic projection
  */
-void render_azimuthal_grid(WINDOW *win, const struct Conf *config);
+void render_azimuthal_grid(struct Canvas *canvas, const struct Conf *config);
 
 /* Render cardinal direction indicators for the Northern, Eastern, Southern, and
  * Western horizons
  */
-void render_cardinal_directions(WINDOW *win, const struct Conf *config);
+void render_cardinal_directions(struct Canvas *canvas, const struct Conf *config);
+
+/* Render the center, field and projection of a zoomed view on the bottom row
+ */
+void render_view_status(struct Canvas *canvas, const struct Conf *config, const struct View *view);
 
 #endif // CORE_RENDER_H
@@ -0,0 +1,51 @@
+/* Event-driven waiting between frames on Linux. poll() watches the terminal
+ * input, a timerfd armed with the deadline of the next frame and a signalfd
+ * receiving SIGWINCH, SIGINT and SIGTERM. The process sleeps until one of them
+ * is ready, so keys and resizes are handled as they arrive rather than once per
+ * frame. Elsewhere the loop is unavailable and callers keep polling.
+ */
+
+#ifndef EVENT_LOOP_H
+#define EVENT_LOOP_H
+
+#include "stopwatch.h"
+
+#include <stdbool.h>
+
+enum LoopEvent
+{
+    LOOP_EVENT_TICK,   // The deadline passed
+    LOOP_EVENT_INPUT,  // Input is ready to read
+    LOOP_EVENT_RESIZE, // The terminal was resized
+    LOOP_EVENT_QUIT,   // Interrupted, terminated or the input was closed
+};
+
+struct EventLoop
+{
+    int input_fd;
+    int timer_fd;
+    int signal_fd;
+};
+
+/* Route SIGWINCH, SIGINT and SIGTERM to the loop and watch `input_fd`. Must be
+ * called before any thread is started, since threads inherit the blocked
+ * signals. Returns false if the platform has no event loop, in which case
+ * nothing changed
+ */
+bool event_loop_init(struct EventLoop *loop, int input_fd);
+
+/* Tick once at `deadline`, a timestamp set by sw_gettime. Deadlines in the past
+ * tick right away
+ */
+bool event_loop_arm(struct EventLoop *loop, struct SwTimestamp deadline);
+
+/* Sleep until the next event. Signals are reported before input, and input
+ * before ticks
+ */
+enum LoopEvent event_loop_wait(struct EventLoop *loop);
+
+/* Close the loop and restore the default handling of its signals
+ */
+void event_loop_destroy(struct EventLoop *loop);
+
+#endif // EVENT_LOOP_H
@@ -0,0 +1,56 @@
+/* Frame pacing against a fixed schedule of absolute deadlines, with statistics
+ * on how well the schedule is kept.
+ *
+ * Frame k is due at start + k * period. Sleeping until the next deadline,
+ * rather than for the period minus the time the frame took, keeps oversleeping
+ * and scheduler jitter from adding up over frames. A frame that finishes after
+ * the next deadline is counted as missed, and the schedule skips ahead to the
+ * current slot instead of catching up with a burst of frames.
+ */
+
+#ifndef FRAME_PACER_H
+#define FRAME_PACER_H
+
+#include "histogram.h"
+#include "stopwatch.h"
+
+#include <stdbool.h>
+
+struct FrameStats
+{
+    struct Histogram times;        // Times between frames (microseconds)
+    unsigned long long num_missed; // Frames that finished after the next deadline
+};
+
+struct FramePacer
+{
+    unsigned long long period; // Time between deadlines (microseconds)
+    unsigned long long spin;   // Time before each deadline spent spinning rather than sleeping (microseconds)
+    struct SwTimestamp start;  // Deadline of frame 0
+    struct SwTimestamp wake;   // When the current frame started
+    unsigned long long frame;  // Slot of the schedule the current frame started in
+    struct FrameStats stats;
+};
+
+/* Start the schedule now, in slot 0
+ */
+void frame_pacer_init(struct FramePacer *pacer, unsigned long long period, unsigned long long spin);
+
+/* Wait for the deadline of the next frame, once the current one is done, and
+ * move to its slot. Returns the number of slots skipped because the current
+ * frame was late
+ */
+unsigned long long frame_pacer_wait(struct FramePacer *pacer);
+
+/* The two halves of frame_pacer_wait, for callers sleeping some other way:
+ * move to the slot of the next frame and set `wake` to its deadline minus the
+ * spin time, returning the number of slots skipped
+ */
+unsigned long long frame_pacer_next(struct FramePacer *pacer, struct SwTimestamp *wake);
+
+/* Spin until the deadline of the current slot once woken up, then start the
+ * frame
+ */
+void frame_pacer_begin(struct FramePacer *pacer);
+
+#endif // FRAME_PACER_H
@@ -0,0 +1,67 @@
+/* Ring of frame slots handed from a single producer, which computes and draws
+ * frames off screen, to a single consumer, which flushes them to the terminal.
+ * The producer fills the next free slot while the consumer presents the oldest
+ * filled one, so a slow terminal and frame computation overlap instead of
+ * adding up. The ring only tracks slot indices: what a slot holds is up to the
+ * caller.
+ */
+
+#ifndef FRAME_RING_H
+#define FRAME_RING_H
+
+#include "thread.h"
+
+#include <stdbool.h>
+
+#define FRAME_RING_MAX_SLOTS 4
+
+struct FrameRing
+{
+    unsigned int num_slots;
+    unsigned int read;   // Oldest filled slot
+    unsigned int filled; // Filled slots, including one being read
+    bool writing;        // The producer holds slot (read + filled) % num_slots
+    bool reading;        // The consumer holds slot `read`
+    bool paused;
+    bool closed;
+    struct Mutex lock; // Only held to move indices, never while drawing
+    struct Condition changed;
+};
+
+/* Initialize an empty ring of `num_slots` slots, at most FRAME_RING_MAX_SLOTS
+ */
+void frame_ring_init(struct FrameRing *ring, unsigned int num_slots);
+
+/* Wait for a free slot and store its index in `slot`. Returns false once the
+ * ring is closed
+ */
+bool frame_ring_begin_write(struct FrameRing *ring, unsigned int *slot);
+
+/* Hand the slot being written to the consumer
+ */
+void frame_ring_end_write(struct FrameRing *ring);
+
+/* Wait for the oldest filled slot and store its index in `slot`. Returns false
+ * once the ring is closed
+ */
+bool frame_ring_begin_read(struct FrameRing *ring, unsigned int *slot);
+
+/* Return the slot being read to the producer
+ */
+void frame_ring_end_read(struct FrameRing *ring);
+
+/* Stop the producer between frames, e.g. to resize what the slots hold, and
+ * discard the filled slots. Must be called by the consumer while it is not
+ * reading
+ */
+void frame_ring_pause(struct FrameRing *ring);
+
+void frame_ring_resume(struct FrameRing *ring);
+
+/* Wake and turn away both sides for good
+ */
+void frame_ring_close(struct FrameRing *ring);
+
+void frame_ring_destroy(struct FrameRing *ring);
+
+#endif // FRAME_RING_H
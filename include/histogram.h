@@ -0,0 +1,34 @@
+/* Fixed-size histograms of durations in log-linear buckets: 2^HISTOGRAM_SUB_BITS
+ * buckets for each power of two, so percentiles are within 1% of the true value
+ * at any scale without allocating while recording.
+ */
+
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#define HISTOGRAM_SUB_BITS 7
+#define HISTOGRAM_MAX_BIT 39 // Longer durations are counted as 2^40 - 1
+#define HISTOGRAM_BUCKETS ((HISTOGRAM_MAX_BIT - HISTOGRAM_SUB_BITS + 2) << HISTOGRAM_SUB_BITS)
+
+struct Histogram
+{
+    unsigned int counts[HISTOGRAM_BUCKETS];
+    unsigned long long count;
+    unsigned long long sum;
+    unsigned long long max;
+};
+
+void histogram_reset(struct Histogram *histogram);
+
+void histogram_record(struct Histogram *histogram, unsigned long long value);
+
+/* Value that the given fraction of recorded values are within, e.g. 0.99 for
+ * the 99th percentile. Returns 0 if nothing was recorded
+ */
+unsigned long long histogram_percentile(const struct Histogram *histogram, double fraction);
+
+/* Mean of the recorded values, or 0 if nothing was recorded
+ */
+double histogram_mean(const struct Histogram *histogram);
+
+#endif // HISTOGRAM_H
@@ -7,6 +7,7 @@
 #define tzname _tzname
 #define strncasecmp _strnicmp
 #define strdup _strdup
+#define fileno _fileno
 #define tzset _tzset
 #define tzname _tzname
 #define strncasecmp _strnicmp
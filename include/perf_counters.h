@@ -0,0 +1,52 @@
+/* Hardware performance counters of the calling thread, read with
+ * perf_event_open on Linux. All counters are opened as one group so that a
+ * single read returns them together, and counters the CPU, kernel or
+ * perf_event_paranoid setting refuse are left out. Elsewhere no counter is
+ * ever available.
+ */
+
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include <stdbool.h>
+
+enum PerfCounter
+{
+    COUNTER_CYCLES,
+    COUNTER_INSTRUCTIONS,
+    COUNTER_L1D_MISSES, // Level 1 data cache read misses
+    COUNTER_LLC_MISSES, // Last level cache read misses
+    COUNTER_BRANCH_MISSES,
+    NUM_PERF_COUNTERS,
+};
+
+struct PerfCounters
+{
+    int fds[NUM_PERF_COUNTERS]; // -1 for counters that could not be opened
+    int group_fd;               // First counter opened, which reads the whole group
+    unsigned int num_open;
+};
+
+// Running totals of the counters since they were opened
+struct PerfSample
+{
+    unsigned long long values[NUM_PERF_COUNTERS];
+    unsigned int valid; // Bit set of the counters read
+};
+
+/* Open every available counter for the calling thread, user space only.
+ * Returns false if none could be opened
+ */
+bool perf_counters_open(struct PerfCounters *counters);
+
+/* Read all counters at once. Counters the kernel had to multiplex with other
+ * events are scaled up to the time they were enabled. Returns false if nothing
+ * could be read
+ */
+bool perf_counters_read(const struct PerfCounters *counters, struct PerfSample *sample);
+
+void perf_counters_close(struct PerfCounters *counters);
+
+const char *perf_counter_name(enum PerfCounter counter);
+
+#endif // PERF_COUNTERS_H
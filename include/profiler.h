@@ -0,0 +1,106 @@
+/* Per-stage frame profiler. Each stage of producing and presenting a frame is
+ * timed with the stopwatch and counted in a histogram, so stutters can be
+ * blamed on a stage from its 99th percentile rather than its mean. Hardware
+ * events are optionally added up per stage from the counters of the thread
+ * running it, and each lap traced as a span on the timeline of that thread.
+ */
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include "histogram.h"
+#include "perf_counters.h"
+#include "stopwatch.h"
+#include "thread.h"
+#include "trace.h"
+
+#include <stdbool.h>
+
+enum ProfileStage
+{
+    STAGE_CLEAR,
+    STAGE_UPDATE_STARS,
+    STAGE_UPDATE_PLANETS,
+    STAGE_UPDATE_MOON,
+    STAGE_RENDER_STARS,
+    STAGE_RENDER_CONSTELLS,
+    STAGE_RENDER_PLANETS,
+    STAGE_RENDER_MOON,
+    STAGE_RENDER_GRID, // Grid, cardinal directions or zoomed view status
+    STAGE_RENDER_METADATA,
+    STAGE_FRAME_WAIT, // Waiting for the compute thread to finish a frame
+    STAGE_FLUSH,      // Writing the frame to the terminal
+    STAGE_SLEEP,      // Waiting for the next deadline, including handling keys
+    NUM_PROFILE_STAGES,
+};
+
+// Hardware events counted in a stage
+struct StageCounts
+{
+    unsigned long long laps; // Laps that were counted
+    unsigned long long events[NUM_PERF_COUNTERS];
+    unsigned int valid; // Bit set of the counters read in every lap
+};
+
+struct Profiler
+{
+    struct Histogram *stages; // Time spent in each stage (microseconds)
+    struct StageCounts counts[NUM_PROFILE_STAGES];
+    struct Mutex lock; // Stages are timed by both the compute and main threads
+};
+
+// What is recorded for the stages of a thread, besides their time
+struct ProfileThread
+{
+    struct PerfCounters *counters; // Counters of the thread, or NULL
+    struct TraceBuffer *trace;     // Trace buffer of the thread, or NULL
+};
+
+// Where the next stage of a thread starts
+struct ProfileMark
+{
+    struct SwTimestamp time;
+    struct ProfileThread thread;
+    struct PerfSample sample;
+};
+
+struct StageSummary
+{
+    unsigned long long count;
+    unsigned long long p50;
+    unsigned long long p99;
+    unsigned long long max;
+    double mean;
+};
+
+bool generate_profiler(struct Profiler *profiler);
+
+void free_profiler(struct Profiler *profiler);
+
+const char *profile_stage_name(enum ProfileStage stage);
+
+/* Start timing stages at the current time. Stages are always timed, but
+ * hardware events are only counted and spans only traced if `thread` is not
+ * NULL and has counters or a trace buffer
+ */
+void profiler_mark(struct ProfileMark *mark, const struct ProfileThread *thread);
+
+/* Count the time and events since `mark` towards a stage and trace it, then
+ * move `mark` to now, which is where the next stage starts
+ */
+void profiler_lap(struct Profiler *profiler, enum ProfileStage stage, struct ProfileMark *mark);
+
+/* Percentiles of every stage (microseconds)
+ */
+void profiler_summarize(struct Profiler *profiler, struct StageSummary summary[NUM_PROFILE_STAGES]);
+
+/* Hardware events of every stage
+ */
+void profiler_counts(struct Profiler *profiler, struct StageCounts counts[NUM_PROFILE_STAGES]);
+
+/* Write the summary of every stage as CSV. Returns false if the file could not
+ * be written
+ */
+bool profiler_write_csv(struct Profiler *profiler, const char *path);
+
+#endif // PROFILER_H
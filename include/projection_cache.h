@@ -0,0 +1,80 @@
+/* Cache of projected star positions for a fixed observer. Where stars land on
+ * screen depends almost only on local sidereal time, so the sidereal day is
+ * divided into slots short enough that no star moves more than half a cell
+ * within one. The stars drawn in a slot are recorded the first time it comes
+ * around, and every later frame in that slot, on any later sidereal day, only
+ * looks them up.
+ */
+
+#ifndef PROJECTION_CACHE_H
+#define PROJECTION_CACHE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// A star drawn at a screen cell
+struct CachedStar
+{
+    uint32_t star; // Index into the star table
+    uint16_t row;
+    uint16_t col;
+};
+
+// The stars of a slot are stars[offset] up to stars[offset + count], in the
+// order they were drawn
+struct CacheSlot
+{
+    unsigned int offset;
+    unsigned int count;
+    bool filled;
+    bool uncacheable; // Did not fit in the budget, so it is not recorded again until the cache is cleared
+};
+
+struct ProjectionCache
+{
+    size_t budget; // Largest number of bytes used for cached stars
+    struct CachedStar *stars;
+    unsigned int num_stars;
+    unsigned int capacity;
+
+    unsigned int num_slots;
+    struct CacheSlot *slots;
+
+    // The cache is cleared whenever any of these change
+    int height;
+    int width;
+    double latitude;
+    double longitude;
+    float threshold;
+    double created_julian_date;
+};
+
+/* Initialize an empty cache that never grows beyond `budget` bytes of cached
+ * stars. Memory is allocated as slots are filled and must be freed by the
+ * caller via free_projection_cache. Returns false upon memory allocation error
+ */
+bool generate_projection_cache(struct ProjectionCache *cache, size_t budget);
+
+/* Return the slot for the given moment, clearing the cache first if the window
+ * size, observer or magnitude threshold differ from what it was filled with.
+ * Returns NULL upon memory allocation error
+ */
+struct CacheSlot *projection_cache_slot(struct ProjectionCache *cache, int height, int width, double latitude,
+                                        double longitude, float threshold, double julian_date);
+
+/* Append a star to the slot being filled. Returns false once the budget is
+ * exhausted, in which case the slot should be abandoned, or if the slot is
+ * uncacheable
+ */
+bool projection_cache_append(struct ProjectionCache *cache, struct CacheSlot *slot, unsigned int star, int row,
+                             int col);
+
+/* Mark a slot as filled with the stars appended to it, or discard them and mark
+ * it uncacheable so later frames in the slot do not record it again
+ */
+void projection_cache_finish(struct ProjectionCache *cache, struct CacheSlot *slot, bool keep);
+
+void free_projection_cache(struct ProjectionCache *cache);
+
+#endif // PROJECTION_CACHE_H
@@ -0,0 +1,34 @@
+/* Reports on how frames were paced and where their time went: printed at
+ * exit, or drawn over the sky while running.
+ */
+
+#ifndef REPORT_H
+#define REPORT_H
+
+#include "canvas.h"
+#include "frame_pacer.h"
+#include "profiler.h"
+#include "timer.h"
+
+/* Print how well frames kept to the schedule of `fps` frames per second
+ */
+void print_frame_stats(const struct FrameStats *stats, int fps);
+
+/* Print the frame rate of a --bench run of `num_frames` frames over `usec`
+ * microseconds, the startup time, and the time spent in each stage
+ */
+void print_bench_report(struct Profiler *profiler, const struct SwTimer *startup, unsigned long long num_frames,
+                        unsigned long long usec);
+
+/* Print the hardware counters of each stage per frame, and per star of a
+ * catalog of `num_stars` stars
+ */
+void print_bench_counters(struct Profiler *profiler, unsigned int num_stars);
+
+/* Draw the time spent in each stage at the top right of the canvas, against
+ * the time between frames `dt` (microseconds)
+ */
+void render_profile(struct Canvas *canvas, const struct StageSummary summary[NUM_PROFILE_STAGES],
+                    unsigned long long dt);
+
+#endif // REPORT_H
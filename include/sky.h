@@ -0,0 +1,121 @@
+/* State of the sky being shown, shared by the thread computing frames and the
+ * main thread presenting them, and the tasks loading it at startup.
+ */
+
+#ifndef SKY_H
+#define SKY_H
+
+#include "canvas.h"
+#include "city.h"
+#include "core.h"
+#include "core_position.h"
+#include "frame_ring.h"
+#include "parse_BSC5.h"
+#include "profiler.h"
+#include "projection_cache.h"
+#include "sky_index.h"
+#include "thread.h"
+#include "tile_catalog.h"
+#include "view.h"
+#include "visibility.h"
+
+#include <curses.h>
+#include <stdbool.h>
+
+// Frames in flight when computing and presenting are pipelined: one being
+// presented while the next is computed
+#define PIPELINE_SLOTS 2
+
+// Key presses waiting for the compute thread
+#define MAX_PENDING_KEYS 16
+
+// How well frames keep to the pacing schedule, as shown in the metadata window
+struct PacingSummary
+{
+    unsigned long long p50_usec;
+    unsigned long long p99_usec;
+    unsigned long long max_usec;
+    unsigned long long num_missed;
+    unsigned long long num_frames;
+};
+
+// Everything the compute stage needs to produce a frame
+struct Sky
+{
+    const struct Conf *config;
+    unsigned long dt; // Time between frames (microseconds)
+    bool use_scheduler;
+    bool use_cache;
+    bool use_tiles;
+
+    unsigned int num_stars;
+    struct Star *star_table;
+    unsigned int *idx_by_mag;
+    struct ConstellTable constell_table; // Only parsed once figures are first drawn
+    bool constells_loaded;
+    bool show_constells; // Draw constellation figures, toggled at runtime
+    struct Planet *planet_table;
+    struct Moon moon_object;
+    struct SkyIndex sky_index;
+    struct VisibilityScheduler scheduler;
+    struct StarExtrapolation extrapolation;
+    struct ProjectionCache projection_cache;
+    struct TileCatalog tile_catalog;
+    struct View view;
+
+    // City nearest to an observer given by coordinates, shown in the metadata
+    // window, and the table it belongs to
+    struct CityTable cities;
+    const struct CityRecord *nearest_city; // Or NULL
+    double nearest_city_distance;          // Radians
+
+    unsigned long long frame; // Slot of the pacing schedule the frame being produced is shown in
+    struct Profiler profiler;
+    bool show_profile; // Draw the profile of each stage over the sky, toggled by the main thread
+
+    // Hardware counters and trace buffers of the threads producing and
+    // presenting frames, if any. Without the pipeline, both are the main
+    // thread's
+    struct ProfileThread producer;
+    struct ProfileThread presenter;
+
+    // Canvases drawn into for each slot of the pipeline, and the windows they
+    // are copied to when presented. Curses is not thread safe, so the windows
+    // are only ever touched by the main thread
+    unsigned int num_slots;
+    struct Canvas main_canvases[PIPELINE_SLOTS];
+    struct Canvas metadata_canvases[PIPELINE_SLOTS];
+    WINDOW *main_win;
+    WINDOW *metadata_win;
+
+    // Handoff between the compute thread and the main thread, which is the
+    // only one to call curses, read keys, resize windows or pace frames
+    struct FrameRing ring;
+    struct Mutex lock; // Guards everything below
+    int pending_keys[MAX_PENDING_KEYS];
+    unsigned int num_pending_keys;
+    unsigned long long skipped_frames; // Slots skipped since the compute thread last looked
+    struct PacingSummary pacing;
+};
+
+// Inputs and intermediate results of the tasks loading the sky at startup
+struct Startup
+{
+    struct Sky *sky;
+    struct Conf *config; // The city sets the observer location
+    struct Entry *entries;
+    struct StarNameTable name_table;
+};
+
+/* Load everything the sky is drawn from, running loaders concurrently as soon
+ * as their inputs are ready. Exporting tiles only needs the star table.
+ * Returns false if any loader failed
+ */
+bool load_sky(struct Startup *startup);
+
+/* Parse the constellation table and keep its endpoints up to date from the
+ * next frame on. Returns false upon memory allocation error or malformed data
+ */
+bool load_constellations(struct Sky *sky);
+
+#endif // SKY_H
@@ -0,0 +1,123 @@
+/* Spatial index over the star catalog. The celestial sphere is divided into
+ * declination bands, each subdivided in right ascension into cells of roughly
+ * equal area. Every cell carries a bounding cap (center and angular radius) so
+ * whole cells can be rejected against the horizon, or any other circular
+ * region, before any of their stars are transformed.
+ */
+
+#ifndef SKY_INDEX_H
+#define SKY_INDEX_H
+
+#include "core.h"
+
+#include <stdbool.h>
+
+struct SkyCell
+{
+    double ra_min; // Cell bounds (radians)
+    double ra_max;
+    double dec_min;
+    double dec_max;
+    double center_ra; // Bounding cap containing every point of the cell
+    double center_dec;
+    double radius;
+    double max_motion; // Largest proper motion of any member (radians/year)
+};
+
+// Equatorial coordinates of a member star, copied in cell order so the update
+// stage reads them sequentially instead of gathering from the star table
+struct SkyEntry
+{
+    double right_ascension;
+    double declination;
+    double ra_motion;
+    double dec_motion;
+};
+
+// Cells and their members in compressed sparse row layout: the stars of cell
+// `i` are star_indices[cell_offsets[i]] up to star_indices[cell_offsets[i + 1]]
+// and entries[] holds their coordinates at the same positions
+struct SkyIndex
+{
+    unsigned int num_bands;
+    unsigned int *band_offsets; // num_bands + 1 entries into cells
+    unsigned int num_cells;
+    struct SkyCell *cells;
+    unsigned int *cell_offsets; // num_cells + 1 entries
+    unsigned int *star_indices;
+    struct SkyEntry *entries;
+    bool *cell_visible; // Visibility of each cell during the last update
+    double max_motion;  // Largest proper motion of any star (radians/year)
+
+    // Members of each cell are partitioned so stars that never rise for the
+    // classified latitude come last: only cell_offsets[i] up to
+    // cell_active_end[i] need to be updated
+    unsigned int *cell_active_end;
+    double classified_latitude; // NAN until the first classification
+    double classified_julian_date;
+    unsigned int num_circumpolar;
+    unsigned int num_never_rises;
+
+    // Cells that may hold stars within the cap of the last sky_index_select_cap
+    unsigned int num_selected;
+    unsigned int *selected_cells;
+
+    // Stars that are always updated regardless of culling, e.g. constellation
+    // endpoints whose azimuth is needed to clip segments at the horizon
+    unsigned int num_pinned;
+    unsigned int *pinned;
+};
+
+/* Build a spatial index with `num_bands` declination bands over a star table.
+ * This function allocates memory which must be freed by the caller via
+ * free_sky_index. Returns false upon memory allocation error
+ */
+bool generate_sky_index(struct SkyIndex *index, const struct Star *star_table, unsigned int num_stars,
+                        unsigned int num_bands);
+
+/* Suggest a number of declination bands for a catalog size, aiming for a few
+ * dozen stars per cell on average
+ */
+unsigned int sky_index_default_bands(unsigned int num_stars);
+
+/* Mark stars that must be updated every frame even if their cell is culled.
+ * Duplicate indices are ignored. Replaces any previously pinned stars. Returns
+ * false upon memory allocation error
+ */
+bool sky_index_pin_stars(struct SkyIndex *index, const unsigned int *star_indices, unsigned int count);
+
+/* Classify every star as circumpolar, never rising or neither for an observer
+ * at `latitude` and reorder the members of each cell so never rising stars are
+ * skipped by updates. Never rising stars are parked at the nadir. The
+ * classification allows for proper motion within a window of years around
+ * `julian_date`
+ */
+void sky_index_classify(struct SkyIndex *index, struct Star *star_table, double latitude, double julian_date);
+
+/* Return true if the classification must be redone for the given observer
+ * latitude and date
+ */
+bool sky_index_needs_classify(const struct SkyIndex *index, double latitude, double julian_date);
+
+/* Return the index of the cell containing the given equatorial coordinates
+ */
+unsigned int sky_index_find_cell(const struct SkyIndex *index, double right_ascension, double declination);
+
+/* Return true if every point of a cell, allowing `margin` radians of slack for
+ * proper motion, lies below the horizon for the given local sidereal time and
+ * latitude
+ */
+bool sky_cell_below_horizon(const struct SkyCell *cell, double local_sidereal_time, double latitude, double margin);
+
+/* Select the cells that may hold stars within `radius` radians of the given
+ * equatorial coordinates, allowing `margin` radians of slack for proper motion.
+ * Only the declination bands overlapping the cap are searched, so the cost
+ * shrinks with the cap rather than growing with the catalog. The selection is
+ * stored in selected_cells
+ */
+void sky_index_select_cap(struct SkyIndex *index, double right_ascension, double declination, double radius,
+                          double margin);
+
+void free_sky_index(struct SkyIndex *index);
+
+#endif // SKY_INDEX_H
@@ -49,9 +49,54 @@ int sw_gettime(struct SwTimestamp *stamp);
  */
 int sw_timediff_usec(struct SwTimestamp end, struct SwTimestamp begin, unsigned long long *diff);
 
+/* Set the difference between two timestamps in nanoseconds. Returns 0 on
+ * success -1 on failure
+ */
+int sw_timediff_nsec(struct SwTimestamp end, struct SwTimestamp begin, unsigned long long *diff);
+
+/* Nanoseconds on the clock read by sw_gettime, from an arbitrary origin. Cheaper
+ * to pass around and subtract than timestamps. Returns 0 on failure
+ */
+unsigned long long sw_now_nsec(void);
+
+/* CPU time used by the calling thread, in nanoseconds. Unlike wall time, it
+ * leaves out time spent preempted, sleeping or waiting on locks. Returns 0
+ * where unsupported
+ */
+unsigned long long sw_thread_cpu_nsec(void);
+
+// Resources used by the whole process so far
+struct SwUsage
+{
+    unsigned long long user_nsec;   // CPU time in user space, over all threads
+    unsigned long long system_nsec; // CPU time in the kernel on behalf of the process
+    unsigned long long max_rss_kib; // Peak resident memory, or 0 where unsupported
+    unsigned long long minor_faults;
+    unsigned long long major_faults;         // Page faults that needed I/O
+    unsigned long long voluntary_switches;   // Blocked, e.g. sleeping or waiting on a lock
+    unsigned long long involuntary_switches; // Preempted
+};
+
+/* Read the resources used by the process. Counts the platform does not track
+ * are 0. Returns 0 on success and -1 on failure
+ */
+int sw_process_usage(struct SwUsage *usage);
+
 /* Sleep for the specified number of microseconds. Returns 0 on success and -1
  * on failure
  */
 int sw_sleep(unsigned long long microseconds);
 
+/* Move a timestamp forward by the specified number of microseconds. Returns 0
+ * on success and -1 on failure
+ */
+int sw_timeadd_usec(struct SwTimestamp *stamp, unsigned long long microseconds);
+
+/* Sleep until the time of a timestamp, returning at once if it has passed.
+ * Unlike sleeping for the time left, being preempted between reading the clock
+ * and going to sleep does not delay the wake up. Returns 0 on success and -1 on
+ * failure
+ */
+int sw_sleep_until(struct SwTimestamp deadline);
+
 #endif // STOPWATCH_H
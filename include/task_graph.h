@@ -0,0 +1,77 @@
+/* Work split into tasks that run on a small pool of threads as soon as the
+ * tasks they depend on have finished, e.g. the loaders run at startup. A task
+ * that fails stops every task depending on it, directly or not, from running,
+ * so no task ever runs on missing inputs. Independent tasks still run to
+ * completion, which keeps what they allocated in a known state for cleanup.
+ */
+
+#ifndef TASK_GRAPH_H
+#define TASK_GRAPH_H
+
+#include "thread.h"
+
+#include <stdbool.h>
+
+#define TASK_GRAPH_MAX_TASKS 32
+#define TASK_GRAPH_MAX_DEPS 4
+#define TASK_GRAPH_MAX_THREADS 4
+
+// Runs a task. Returns false upon error, which the task reports itself
+typedef bool (*TaskFunction)(void *arg);
+
+enum TaskState
+{
+    TASK_WAITING,
+    TASK_RUNNING,
+    TASK_DONE,
+    TASK_FAILED,
+    TASK_SKIPPED, // A task it depends on failed or was skipped
+};
+
+struct Task
+{
+    const char *name;
+    TaskFunction function;
+    void *arg;
+    unsigned int deps[TASK_GRAPH_MAX_DEPS];
+    unsigned int num_deps;
+    unsigned int num_pending; // Dependencies not done yet
+    enum TaskState state;
+};
+
+struct TaskGraph
+{
+    struct Task tasks[TASK_GRAPH_MAX_TASKS];
+    unsigned int num_tasks;
+    unsigned int num_finished; // Done, failed or skipped
+    bool malformed;            // A task could not be added, so none are run
+
+    struct Mutex lock; // Guards the states above while running
+    struct Condition changed;
+};
+
+/* Initialize a graph with no tasks
+ */
+void task_graph_init(struct TaskGraph *graph);
+
+/* Add a task running `function(arg)` once the tasks in `deps` are done. Tasks
+ * can only depend on tasks added before them, which keeps the graph acyclic.
+ * Returns the index of the task, to depend on it. A task over the limits above
+ * or depending on a later task is reported and not added, and the graph then
+ * fails to run
+ */
+unsigned int task_graph_add(struct TaskGraph *graph, const char *name, TaskFunction function, void *arg,
+                            const unsigned int *deps, unsigned int num_deps);
+
+/* Run every task on `num_threads` threads, counting the calling thread, and
+ * wait for them. Returns false if any task failed or was skipped, or could not
+ * be added, in which case no task runs
+ */
+bool task_graph_run(struct TaskGraph *graph, unsigned int num_threads);
+
+/* Threads worth running a graph of `num_tasks` tasks on: one per processor,
+ * up to TASK_GRAPH_MAX_THREADS
+ */
+unsigned int task_graph_default_threads(unsigned int num_tasks);
+
+#endif // TASK_GRAPH_H
@@ -4,6 +4,8 @@
 #ifndef TERM_H
 #define TERM_H
 
+#include "canvas.h"
+
 #include <curses.h>
 #ifdef _WIN32
 #include <windows.h>
@@ -13,6 +15,11 @@
  */
 void ncurses_init(bool color);
 
+/* Initialize ncurses on the null device with a `rows` by `cols` screen, to
+ * draw without a terminal. Returns false if curses could not be started
+ */
+bool ncurses_init_headless(bool color, int rows, int cols);
+
 /* Kill ncurses
  */
 void ncurses_kill(void);
@@ -46,10 +53,9 @@ void term_size(int *y, int *x);
  */
 float get_cell_aspect_ratio(void);
 
-/* Add string via mvwaddstr, but truncate text that does not fit in the window,
- * instead of having it wrap
+/* Replace the contents of a window with a canvas, clipped to the window
  */
-void mvwaddstr_truncate(WINDOW *win, int y, int x, const char *str);
+void win_draw_canvas(WINDOW *win, const struct Canvas *canvas);
 
 /* Check for window resizing on windows
  */
@@ -0,0 +1,73 @@
+/* Minimal portable threads, mutexes and condition variables: POSIX threads on
+ * UNIX and the native primitives on Windows. Only what the background workers
+ * of the program need.
+ */
+
+#ifndef THREAD_H
+#define THREAD_H
+
+#include <stdbool.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+typedef void (*ThreadFunction)(void *arg);
+
+struct Thread
+{
+#ifdef _WIN32
+    HANDLE handle;
+#else
+    pthread_t handle;
+#endif
+    ThreadFunction function;
+    void *arg;
+};
+
+struct Mutex
+{
+#ifdef _WIN32
+    SRWLOCK lock;
+#else
+    pthread_mutex_t lock;
+#endif
+};
+
+struct Condition
+{
+#ifdef _WIN32
+    CONDITION_VARIABLE cond;
+#else
+    pthread_cond_t cond;
+#endif
+};
+
+/* Run `function(arg)` on a new thread. The thread struct must stay valid until
+ * thread_join returns. Returns false if the thread could not be created
+ */
+bool thread_start(struct Thread *thread, ThreadFunction function, void *arg);
+
+/* Wait for a thread to finish
+ */
+void thread_join(struct Thread *thread);
+
+void mutex_init(struct Mutex *mutex);
+void mutex_lock(struct Mutex *mutex);
+void mutex_unlock(struct Mutex *mutex);
+void mutex_destroy(struct Mutex *mutex);
+
+void condition_init(struct Condition *condition);
+
+/* Atomically release `mutex` and wait for a signal, then reacquire `mutex`.
+ * Spurious wakeups are possible, so callers must recheck their predicate
+ */
+void condition_wait(struct Condition *condition, struct Mutex *mutex);
+
+void condition_signal(struct Condition *condition);
+void condition_broadcast(struct Condition *condition);
+void condition_destroy(struct Condition *condition);
+
+#endif // THREAD_H
@@ -0,0 +1,129 @@
+/* Streaming of deep star catalogs from an on-disk tiled file. The sky is split
+ * into the cells of a sky index with a fixed number of declination bands, and
+ * the stars of each cell (tile) are stored contiguously, brightest first, so
+ * the brightest N stars of a tile are a single read of its first N records.
+ *
+ * A loader thread reads the tiles around the zoomed view into an LRU cache
+ * bounded by a memory budget. The renderer never waits on the disk: each frame
+ * it draws whatever is resident and queues the rest, with more stars per tile
+ * the narrower the field.
+ *
+ * File layout, little-endian:
+ *
+ *     header     magic "ASTTILE1", uint32 num_bands, uint32 num_tiles,
+ *                uint64 num_stars, float64 max_motion (radians/year)
+ *     directory  num_tiles × {uint64 offset, uint32 count, float32 brightest}
+ *     stars      num_stars × {float64 ra, float64 dec (J2000, radians),
+ *                float32 ra_motion, float32 dec_motion (radians/year),
+ *                float32 magnitude, int32 catalog_number}
+ *
+ * Tile `i` is cell `i` of generate_sky_index with num_bands bands and its
+ * stars start `offset` bytes into the file.
+ */
+
+#ifndef TILE_CATALOG_H
+#define TILE_CATALOG_H
+
+#include "core.h"
+#include "sky_index.h"
+#include "thread.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+struct Tile
+{
+    uint64_t offset;         // Start of the stars of the tile in the file
+    unsigned int count;      // Stars stored in the file
+    struct Star *stars;      // Brightest num_loaded stars, brightest first
+    unsigned int num_loaded; // Zero if the tile is not resident
+    unsigned int num_wanted; // Stars wanted at the current zoom
+    bool pinned;             // Drawn this frame, so never evicted or freed
+    bool queued;
+    int lru_prev; // Resident tiles, most recently used first
+    int lru_next;
+};
+
+// Resident stars of a tile captured for the current frame
+struct TileSnapshot
+{
+    unsigned int tile;
+    struct Star *stars;
+    unsigned int count;
+};
+
+struct TileCatalog
+{
+    struct SkyIndex layout; // Tile geometry without any stars
+    double max_motion;      // Largest proper motion of any star (radians/year)
+    unsigned int num_tiles;
+    unsigned int num_stars;
+    struct Tile *tiles;
+    FILE *file; // Only read by the loader thread
+
+    // LRU cache of resident tiles bounded by `budget` bytes of stars
+    size_t budget;
+    size_t resident_bytes;
+    int lru_head;
+    int lru_tail;
+
+    // Tiles waiting to be loaded, most urgent first
+    unsigned int *queue;
+    unsigned int queue_head;
+    unsigned int queue_length;
+
+    // Buffers replaced while their tile was pinned, freed on release
+    struct Star **retired;
+    unsigned int num_retired;
+
+    // Tiles drawn this frame
+    struct TileSnapshot *frame;
+    unsigned int num_frame;
+
+    struct Mutex lock;
+    struct Condition wake; // Signals the loader that work was queued
+    struct Condition idle; // Signals that the queue was drained
+    struct Thread loader;
+    bool busy;
+    bool stop;
+    unsigned long num_loads;
+};
+
+/* Write a star table as a tiled catalog with `num_bands` declination bands.
+ * Returns false if the file cannot be written or upon memory allocation error
+ */
+bool write_tile_catalog(const char *path, const struct Star *star_table, unsigned int num_stars,
+                        unsigned int num_bands);
+
+/* Open a tiled catalog and start its loader thread with a cache of `budget`
+ * bytes. Only the directory is read up front. This function allocates memory
+ * which must be freed by the caller via free_tile_catalog. Returns false if
+ * the file is missing or malformed, or upon memory allocation error
+ */
+bool generate_tile_catalog(struct TileCatalog *catalog, const char *path, size_t budget);
+
+/* Capture the resident tiles overlapping a cap of `radius` radians around the
+ * given equatorial coordinates into `frame`, pinning them until
+ * tile_catalog_release. About `stars_per_view` of the brightest stars over the
+ * whole cap are wanted, spread evenly over its tiles. Missing stars, and those
+ * of the tiles around the cap, are queued for the loader. Only waits on the
+ * bookkeeping of the loader, never on the disk
+ */
+void tile_catalog_request(struct TileCatalog *catalog, double julian_date, double right_ascension, double declination,
+                          double radius, unsigned int stars_per_view);
+
+/* Unpin the tiles captured by tile_catalog_request once the frame is drawn
+ */
+void tile_catalog_release(struct TileCatalog *catalog);
+
+/* Wait until every queued tile has been loaded or skipped
+ */
+void tile_catalog_wait_idle(struct TileCatalog *catalog);
+
+/* Stop the loader thread and free every tile
+ */
+void free_tile_catalog(struct TileCatalog *catalog);
+
+#endif // TILE_CATALOG_H
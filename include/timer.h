@@ -0,0 +1,88 @@
+/* Named timers accumulating how long a piece of code takes, for instrumenting
+ * hot paths. Each timer keeps the count, total, minimum and maximum of its
+ * durations in nanoseconds, plus a histogram of them for percentiles. Timers
+ * are plain structs that can be defined statically, and recording never
+ * allocates or locks, so a timer must only be recorded by one thread at a
+ * time.
+ *
+ * Time a block with SW_TIMED:
+ *
+ *     static struct SwTimer parse_timer = SW_TIMER("parse entries");
+ *
+ *     SW_TIMED(&parse_timer)
+ *     {
+ *         parse_entries(...);
+ *     }
+ *
+ * Leaving the block with break, return or goto skips recording.
+ */
+
+#ifndef TIMER_H
+#define TIMER_H
+
+#include "histogram.h"
+
+#include <limits.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+struct SwTimer
+{
+    const char *name;
+    unsigned long long min; // Shortest duration (nanoseconds), ULLONG_MAX until recorded
+    struct Histogram times; // Durations (nanoseconds), with their count, total and maximum
+};
+
+// Static initializer of a timer with nothing recorded
+#define SW_TIMER(timer_name) {.name = (timer_name), .min = ULLONG_MAX}
+
+// A timed block in progress
+struct SwTimerScope
+{
+    struct SwTimer *timer;
+    unsigned long long begin; // Nanoseconds, from sw_now_nsec
+    bool open;
+};
+
+#define SW_TIMER_CONCAT_(a, b) a##b
+#define SW_TIMER_CONCAT(a, b) SW_TIMER_CONCAT_(a, b)
+
+/* Time the statement or block that follows with `timer`
+ */
+#define SW_TIMED(timer)                                                                                                \
+    for (struct SwTimerScope SW_TIMER_CONCAT(sw_scope_, __LINE__) = sw_timer_begin(timer);                             \
+         SW_TIMER_CONCAT(sw_scope_, __LINE__).open; sw_timer_end(&SW_TIMER_CONCAT(sw_scope_, __LINE__)))
+
+struct SwTimerSummary
+{
+    const char *name;
+    unsigned long long count;
+    unsigned long long total; // Nanoseconds, as are the rest
+    unsigned long long min;
+    unsigned long long max;
+    unsigned long long p50;
+    unsigned long long p99;
+    double mean;
+};
+
+/* Forget everything recorded and rename the timer
+ */
+void sw_timer_reset(struct SwTimer *timer, const char *name);
+
+void sw_timer_record(struct SwTimer *timer, unsigned long long nsec);
+
+struct SwTimerScope sw_timer_begin(struct SwTimer *timer);
+
+/* Record the time since the scope began, and close it
+ */
+void sw_timer_end(struct SwTimerScope *scope);
+
+/* Statistics of a timer. The minimum is 0 if nothing was recorded
+ */
+void sw_timer_summarize(const struct SwTimer *timer, struct SwTimerSummary *summary);
+
+/* Write a table of timers, in microseconds, skipping those never recorded
+ */
+void sw_timers_print(FILE *file, const struct SwTimer *const timers[], unsigned int num_timers);
+
+#endif // TIMER_H
@@ -0,0 +1,81 @@
+/* Timeline of a session in the Chrome trace event format, which Perfetto and
+ * chrome://tracing load. Each traced thread records spans into a ring buffer of
+ * its own, and a background thread formats them and streams them to the file,
+ * so recording a span costs a short uncontended lock and no I/O. When the
+ * writer falls behind, new spans are dropped and counted rather than blocking
+ * the thread recording them.
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include "stopwatch.h"
+#include "thread.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+
+#define TRACE_BUFFER_EVENTS 8192
+
+struct TraceEvent
+{
+    const char *name; // Static string, written as is
+    struct SwTimestamp begin;
+    struct SwTimestamp end; // Equal to begin for instants
+    bool instant;
+};
+
+struct Tracer;
+
+// Ring of events recorded by one thread
+struct TraceBuffer
+{
+    struct Tracer *tracer;
+    const char *thread_name;
+    struct TraceEvent *events;
+    unsigned int head;  // Oldest event
+    unsigned int count; // Events waiting to be written
+    unsigned long long num_dropped;
+    struct Mutex lock; // Only held to move indices and copy events
+};
+
+struct Tracer
+{
+    FILE *file;
+    struct SwTimestamp start; // Time 0 of the trace
+    unsigned int num_buffers;
+    struct TraceBuffer *buffers;
+    bool any_written;
+
+    struct Thread writer;
+    struct Mutex lock; // Guards the flags below
+    struct Condition wake;
+    bool pending; // A buffer is filling up
+    bool stop;
+};
+
+/* Create `path` and start writing to it in the background, with one buffer for
+ * each of the `num_threads` named threads. Returns false if the file could not
+ * be created or the writer could not start
+ */
+bool generate_tracer(struct Tracer *tracer, const char *path, const char *const thread_names[], unsigned int num_threads);
+
+/* Write every remaining event and close the file. Returns false if the trace
+ * could not be written completely
+ */
+bool free_tracer(struct Tracer *tracer);
+
+/* Record that `name` ran from `begin` to `end`. Must only be called by the
+ * thread the buffer belongs to
+ */
+void trace_span(struct TraceBuffer *buffer, const char *name, struct SwTimestamp begin, struct SwTimestamp end);
+
+/* Record that `name` happened at `time`
+ */
+void trace_instant(struct TraceBuffer *buffer, const char *name, struct SwTimestamp time);
+
+/* Events dropped because the writer fell behind, over all threads
+ */
+unsigned long long tracer_dropped(struct Tracer *tracer);
+
+#endif // TRACE_H
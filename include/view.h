@@ -0,0 +1,66 @@
+/* Zoomed view of part of the sky. Instead of the whole hemisphere, the window
+ * shows a field of view centered on any azimuth and altitude, projected onto
+ * the plane tangent to the sky at its center (gnomonic) or stereographically
+ * about it. Only the cells of the sky index around the field are updated and
+ * drawn, so narrow fields stay cheap however large the catalog is.
+ */
+
+#ifndef VIEW_H
+#define VIEW_H
+
+#include <stdbool.h>
+
+struct View
+{
+    bool zoomed;        // False shows the whole sky above the horizon
+    bool gnomonic;      // Gnomonic, or stereographic about the center
+    double azimuth;     // Center of the field
+    double altitude;
+    double field;       // Angle spanned by the window (radians)
+    double half_extent; // Half the width of the window on the projection plane
+
+    // Orthonormal frame of the field in horizontal unit vector components:
+    // towards the center, the right of the window and the top of the window
+    double center[3];
+    double right[3];
+    double up[3];
+};
+
+/* Initialize a view of the whole sky. Zooming in first centers the field on
+ * the zenith with North at the top, like the whole sky projection
+ */
+void view_init(struct View *view);
+
+/* Zoom in on a field of `field` radians centered on the given azimuth and
+ * altitude
+ */
+void view_look_at(struct View *view, double azimuth, double altitude, double field);
+
+/* Apply a key press: arrows or hjkl pan, + and - zoom, p switches between the
+ * gnomonic and stereographic projections and z returns to the whole sky.
+ * Returns false if the key is not bound to the view
+ */
+bool view_handle_key(struct View *view, int key);
+
+/* Angular radius of a cap around the center containing the whole window
+ */
+double view_cap_radius(const struct View *view);
+
+/* Equatorial coordinates of the center of the field for the given date and
+ * observer
+ */
+void view_center_equatorial(const struct View *view, double julian_date, double latitude, double longitude,
+                            double *right_ascension, double *declination);
+
+/* Project a horizontal unit vector onto the view plane, where the edges of the
+ * window lie at x = ±1 and y = ±1. Returns false if the point is too far from
+ * the center to be projected
+ */
+bool view_project(const struct View *view, double east, double north, double up, double *x, double *y);
+
+/* Map a point on the view plane to a window cell. Returns false if it lies
+ * outside the window
+ */
+bool view_plane_to_win(double x, double y, int win_height, int win_width, int *row, int *col);
+
+#endif // VIEW_H
@@ -0,0 +1,84 @@
+/* Rise/set scheduling of stars. Every star that rises and sets has an event at
+ * its next horizon crossing in a min-heap keyed on Julian date, so advancing
+ * the clock only touches stars whose visibility actually changed. Visible stars
+ * are kept in a bitset over magnitude ranks, so updating and rendering iterate
+ * only the visible set and still do so in magnitude order.
+ */
+
+#ifndef VISIBILITY_H
+#define VISIBILITY_H
+
+#include "core.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+struct VisibilityEvent
+{
+    double julian_date; // Next horizon crossing
+    unsigned int star;  // Index into the star table
+};
+
+struct VisibilityScheduler
+{
+    unsigned int num_stars;
+    const unsigned int *idx_by_mag; // Not owned, see star_indices_by_magnitude
+    unsigned int *rank_of;          // Inverse of idx_by_mag
+
+    // Bitsets over magnitude ranks. Pinned stars are treated as visible
+    unsigned int num_words;
+    uint64_t *visible;
+    uint64_t *pinned;
+    unsigned int num_visible;
+
+    struct VisibilityEvent *events; // Binary min-heap, at most one per star
+    unsigned int num_events;
+
+    // Observer and date the events were computed for
+    bool built;
+    double latitude;
+    double longitude;
+    double julian_date;
+    double built_julian_date;
+};
+
+/* Allocate a scheduler for a star table ordered by `idx_by_mag`, which must
+ * outlive it. Events are computed on the first advance. This function allocates
+ * memory which must be freed by the caller via free_visibility_scheduler.
+ * Returns false upon memory allocation error
+ */
+bool generate_visibility_scheduler(struct VisibilityScheduler *scheduler, const unsigned int *idx_by_mag,
+                                   unsigned int num_stars);
+
+/* Mark stars that are always part of the visible set, e.g. constellation
+ * endpoints whose azimuth is needed to clip segments at the horizon
+ */
+void visibility_scheduler_pin_stars(struct VisibilityScheduler *scheduler, const unsigned int *star_indices,
+                                    unsigned int count);
+
+/* Bring the visible set up to date for the given date and observer. Stars that
+ * set are parked at the nadir. Moving backwards in time or changing the
+ * observer recomputes every event
+ */
+void visibility_scheduler_advance(struct VisibilityScheduler *scheduler, struct Star *star_table, double julian_date,
+                                  double latitude, double longitude);
+
+/* Whether scheduling beats culling cells of the sky index for a clock that
+ * advances `frame_step` days per frame. Clocks that are fast, or that run
+ * backwards, are better served by the sky index
+ */
+bool visibility_scheduler_suits(double frame_step);
+
+/* Return the first visible or pinned magnitude rank at or after `rank`, or
+ * num_stars if there is none
+ */
+unsigned int visibility_scheduler_next(const struct VisibilityScheduler *scheduler, unsigned int rank);
+
+/* Return the first pinned magnitude rank at or after `rank`, or num_stars if
+ * there is none
+ */
+unsigned int visibility_scheduler_next_pinned(const struct VisibilityScheduler *scheduler, unsigned int rank);
+
+void free_visibility_scheduler(struct VisibilityScheduler *scheduler);
+
+#endif // VISIBILITY_H
@@ -0,0 +1,94 @@
+"""
+Generate a C header with a static, sorted index of the cities in cities.csv.
+
+Each record holds the normalized name the index is sorted by, with the name,
+country, coordinates and population parsed ahead of time, so looking up a city
+is a binary search over constant data. Cities of the same normalized name are
+ordered from most to least populous.
+"""
+
+import argparse
+import csv
+import sys
+
+# Must match normalize_city_key in src/city.c: surrounding ASCII whitespace is
+# trimmed and only ASCII letters are lowercased, whatever the locale
+ASCII_WHITESPACE = " \t\n\v\f\r"
+
+
+def normalize(name):
+    data = name.strip(ASCII_WHITESPACE).encode("utf-8")
+    return bytes(byte + 32 if 65 <= byte <= 90 else byte for byte in data)
+
+
+def c_string(data):
+    """
+    Quote UTF-8 bytes as a C string literal. Octal escapes take at most three
+    digits, so unlike hex escapes they never swallow the character after them.
+    """
+    out = []
+    for byte in data:
+        if 32 <= byte < 127 and byte not in (ord('"'), ord("\\"), ord("?")):
+            out.append(chr(byte))
+        else:
+            out.append(f"\\{byte:03o}")
+    return '"' + "".join(out) + '"'
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Generate a C header indexing cities by normalized name.")
+    parser.add_argument("--source", required=True, help="Path to cities.csv")
+    parser.add_argument("--header", required=True, help="Path to the output header file")
+    args = parser.parse_args()
+
+    try:
+        with open(args.source, "r", encoding="utf-8", newline="") as csv_file:
+            reader = csv.DictReader(csv_file)
+            cities = [
+                (
+                    normalize(row["city_name"]),
+                    -int(row["population"]),
+                    row["city_name"],
+                    row["country_code"],
+                    float(row["latitude"]),
+                    float(row["longitude"]),
+                )
+                for row in reader
+            ]
+    except (OSError, KeyError, ValueError) as error:
+        print(f"Error: could not read cities from '{args.source}': {error}")
+        sys.exit(1)
+
+    # Byte order is the order strcmp compares keys in
+    cities.sort(key=lambda city: (city[0], city[1]))
+    # Longer names could not be looked up, see CITY_KEY_MAX in include/city.h
+    for city in cities:
+        if len(city[0]) >= 256:
+            print(f"Error: city name '{city[2]}' is too long")
+            sys.exit(1)
+
+    lines = [
+        "// Generated by scripts/city_index.py from cities.csv. Do not edit",
+        "",
+        "#define CITY_RECORDS_LEN " + str(len(cities)),
+        "",
+        "// Sorted by key, then by decreasing population",
+        "static const struct CityRecord city_records[] = {",
+    ]
+    for key, negative_population, name, country_code, latitude, longitude in cities:
+        lines.append(
+            f"    {{{c_string(key)}, {c_string(name.encode('utf-8'))}, {c_string(country_code.encode('utf-8'))}, "
+            f"{latitude!r}f, {longitude!r}f, {-negative_population}}},"
+        )
+    lines.append("};")
+
+    try:
+        with open(args.header, "w", encoding="ascii", newline="\n") as header:
+            header.write("\n".join(lines) + "\n")
+    except OSError as error:
+        print(f"Error writing to output file '{args.header}': {error}")
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
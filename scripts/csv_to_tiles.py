@@ -0,0 +1,164 @@
+import argparse
+import csv
+import math
+import struct
+import sys
+import traceback
+
+"""
+Script to convert a deep star catalog in CSV format, such as a Gaia archive
+export, to the tiled catalog format streamed by `astroterm --tiles`.
+
+The CSV must have a header row. Columns are looked up by name:
+    - ra, dec: position in degrees
+    - phot_g_mean_mag (or mag): magnitude
+    - pmra, pmdec (optional): proper motion in mas/yr, with pmra including the
+      cos(dec) factor as in Gaia
+    - source_id (optional): catalog number, truncated to 32 bits
+
+Positions are propagated linearly from `--epoch` to J2000, e.g. use
+`--epoch 2016` for Gaia DR3.
+
+The layout of the file is documented in include/tile_catalog.h. Tiles must be
+the cells of the sky index built by astroterm for the same number of bands, so
+the layout below mirrors src/sky_index.c.
+
+Example:
+
+```
+python3 scripts/csv_to_tiles.py -i gaia_subset.csv -o gaia.tiles --epoch 2016
+astroterm --tiles gaia.tiles --threshold 12
+```
+"""
+
+MAGIC = b"ASTTILE1"
+HEADER_SIZE = 32
+DIRECTORY_ENTRY_SIZE = 16
+STAR_RECORD_SIZE = 32
+
+# Must match sky_index_default_bands in src/sky_index.c
+STARS_PER_CELL = 24
+MIN_BANDS = 6
+MAX_BANDS = 512
+
+MAS_TO_RAD = math.pi / (180.0 * 3600.0 * 1000.0)
+
+
+def default_bands(num_stars: int) -> int:
+    bands = math.sqrt(math.pi * num_stars / (4.0 * STARS_PER_CELL))
+    return max(MIN_BANDS, min(MAX_BANDS, math.ceil(bands)))
+
+
+def band_divisions(dec_min: float, dec_max: float, num_bands: int) -> int:
+    widest = max(math.cos(dec_min), math.cos(dec_max))
+    if dec_min < 0.0 and dec_max > 0.0:
+        widest = 1.0
+    return max(math.ceil(2.0 * num_bands * widest), 1)
+
+
+def layout(num_bands: int) -> list:
+    """First tile of each band, plus the total number of tiles"""
+    band_height = math.pi / num_bands
+    offsets = [0]
+    for band in range(num_bands):
+        dec_min = -math.pi / 2.0 + band * band_height
+        offsets.append(offsets[-1] + band_divisions(dec_min, dec_min + band_height, num_bands))
+    return offsets
+
+
+def find_tile(offsets: list, num_bands: int, ra: float, dec: float) -> int:
+    band_height = math.pi / num_bands
+    band = math.floor((dec + math.pi / 2.0) / band_height)
+    band = max(0, min(band, num_bands - 1))
+
+    first = offsets[band]
+    divisions = offsets[band + 1] - first
+
+    ra = math.fmod(ra, 2.0 * math.pi)
+    if ra < 0.0:
+        ra += 2.0 * math.pi
+    column = min(int(ra / (2.0 * math.pi) * divisions), divisions - 1)
+    return first + column
+
+
+def read_stars(csv_file: str, epoch: float) -> list:
+    stars = []
+    with open(csv_file, newline="") as file:
+        reader = csv.DictReader(file)
+        mag_column = "phot_g_mean_mag" if "phot_g_mean_mag" in reader.fieldnames else "mag"
+        for row in reader:
+            if not row["ra"] or not row["dec"] or not row[mag_column]:
+                continue
+
+            dec = math.radians(float(row["dec"]))
+            ra = math.radians(float(row["ra"]))
+            pmra = float(row.get("pmra") or 0.0) * MAS_TO_RAD
+            pmdec = float(row.get("pmdec") or 0.0) * MAS_TO_RAD
+
+            # astroterm expects the rate of change of right ascension itself
+            ra_motion = pmra / max(math.cos(dec), 1.0e-9)
+            dec_motion = pmdec
+
+            years = epoch - 2000.0
+            ra -= ra_motion * years
+            dec = max(-math.pi / 2.0, min(math.pi / 2.0, dec - dec_motion * years))
+
+            number = int(row.get("source_id") or len(stars) + 1) & 0x7FFFFFFF
+            stars.append((ra, dec, ra_motion, dec_motion, float(row[mag_column]), number))
+    return stars
+
+
+def write_tiles(stars: list, output_file: str, num_bands: int):
+    offsets = layout(num_bands)
+    num_tiles = offsets[-1]
+
+    tiles = [[] for _ in range(num_tiles)]
+    max_motion = 0.0
+    for index, star in enumerate(stars):
+        ra, dec, ra_motion, dec_motion, magnitude, _ = star
+        tiles[find_tile(offsets, num_bands, ra, dec)].append((magnitude, index))
+        max_motion = max(max_motion, abs(ra_motion) * math.cos(dec) + abs(dec_motion))
+
+    with open(output_file, "wb") as file:
+        file.write(MAGIC + struct.pack("<IIQd", num_bands, num_tiles, len(stars), max_motion))
+
+        offset = HEADER_SIZE + num_tiles * DIRECTORY_ENTRY_SIZE
+        for tile in tiles:
+            # Brightest first
+            tile.sort()
+            brightest = tile[0][0] if tile else math.inf
+            file.write(struct.pack("<QIf", offset, len(tile), brightest))
+            offset += len(tile) * STAR_RECORD_SIZE
+
+        for tile in tiles:
+            for _, index in tile:
+                ra, dec, ra_motion, dec_motion, magnitude, number = stars[index]
+                file.write(struct.pack("<ddfffi", ra, dec, ra_motion, dec_motion, magnitude, number))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Convert a CSV star catalog to a tiled catalog.")
+    parser.add_argument('-i', '--input', required=True, help="Input CSV file")
+    parser.add_argument('-o', '--output', required=True, help="Output tiled catalog")
+    parser.add_argument('--epoch', type=float, default=2000.0, help="Epoch of the positions (default: 2000)")
+    parser.add_argument('--bands', type=int, default=0, help="Number of declination bands (default: automatic)")
+    args = parser.parse_args()
+
+    try:
+
+        stars = read_stars(args.input, args.epoch)
+        assert stars, "No stars found in the input file"
+
+        num_bands = args.bands if args.bands > 0 else default_bands(len(stars))
+        write_tiles(stars, args.output, num_bands)
+
+    except AssertionError as e:
+        print(f"Assertion failed: {e}", file=sys.stderr)
+        sys.exit(1)
+    except Exception as e:
+        print(f"An unexpected error occurred: {e}", file=sys.stderr)
+        traceback.print_exc(file=sys.stderr)
+        sys.exit(1)
+
+if __name__ == "__main__":
+    main()
@@ -44,7 +44,7 @@ def process_cities(input_txt, output_csv, population_threshold=15000):
                     # Skip rows with invalid population data
                     continue
 
-        # Sort cities by city_name (the sort key must match the normalization in city.c)
+        # Sort cities by city_name, to keep diffs readable (city_index.py sorts the index at build time)
         cities.sort(key=lambda x: x[0].strip().lower())
 
         # Write sorted data to the output CSV
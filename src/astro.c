@@ -320,6 +320,46 @@ void calc_moon_geo_ICRF(const struct KepElems *moon_elements, const struct KepRa
     return;
 }
 
+enum DiurnalMotion classify_diurnal_motion(double declination, double latitude, double margin)
+{
+    // Upper culmination is at altitude π/2 - |φ - δ| and lower culmination at
+    // |φ + δ| - π/2
+    if (fabs(latitude - declination) > M_PI / 2 + margin)
+    {
+        return NEVER_RISES;
+    }
+    if (fabs(latitude + declination) > M_PI / 2 + margin)
+    {
+        return CIRCUMPOLAR;
+    }
+    return RISES_AND_SETS;
+}
+
+enum DiurnalMotion calc_semi_diurnal_arc(double declination, double latitude, double altitude, double *semi_arc)
+{
+    double denominator = cos(latitude) * cos(declination);
+    double numerator = sin(altitude) - sin(latitude) * sin(declination);
+
+    // At the poles (of the sky or the observer) altitude is constant
+    if (fabs(denominator) < 1.0E-12)
+    {
+        return numerator < 0.0 ? CIRCUMPOLAR : NEVER_RISES;
+    }
+
+    double cos_arc = numerator / denominator;
+    if (cos_arc <= -1.0)
+    {
+        return CIRCUMPOLAR;
+    }
+    if (cos_arc >= 1.0)
+    {
+        return NEVER_RISES;
+    }
+
+    *semi_arc = acos(cos_arc);
+    return RISES_AND_SETS;
+}
+
 double calc_moon_age(double julian_date)
 {
     // A crude calculation for the phase of the moon
@@ -108,3 +108,34 @@ bool bytes_to_bool32_LE(const uint8_t *buffer)
     int result = bytes_to_int32_LE(buffer);
     return (result != 0);
 }
+
+// Bit scanning
+
+unsigned int lowest_set_bit64(uint64_t word)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return (unsigned int)__builtin_ctzll(word);
+#else
+    unsigned int index = 0;
+    while ((word & 1) == 0)
+    {
+        word >>= 1;
+        index++;
+    }
+    return index;
+#endif
+}
+
+unsigned int highest_set_bit64(uint64_t word)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return 63u - (unsigned int)__builtin_clzll(word);
+#else
+    unsigned int index = 0;
+    while (word >>= 1)
+    {
+        index++;
+    }
+    return index;
+#endif
+}
@@ -0,0 +1,200 @@
+#include "canvas.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Columns between tab stops, as in curses
+#define TAB_SIZE 8
+
+// Longest formatted line drawn with canvas_printf
+#define MAX_LINE_LEN 256
+
+#define REPLACEMENT_CHARACTER 0xFFFD
+
+bool generate_canvas(struct Canvas *canvas, int height, int width)
+{
+    canvas->height = 0;
+    canvas->width = 0;
+    canvas->cells = NULL;
+    canvas->color_pair = 0;
+    return resize_canvas(canvas, height, width);
+}
+
+bool resize_canvas(struct Canvas *canvas, int height, int width)
+{
+    free(canvas->cells);
+    canvas->cells = NULL;
+    canvas->height = 0;
+    canvas->width = 0;
+
+    size_t num_cells = (size_t)(height > 0 ? height : 0) * (size_t)(width > 0 ? width : 0);
+    if (num_cells > 0)
+    {
+        canvas->cells = calloc(num_cells, sizeof(struct Cell));
+        if (canvas->cells == NULL)
+        {
+            printf("Allocation of memory for canvas failed\n");
+            return false;
+        }
+        canvas->height = height;
+        canvas->width = width;
+    }
+
+    return true;
+}
+
+void free_canvas(struct Canvas *canvas)
+{
+    free(canvas->cells);
+    canvas->cells = NULL;
+    canvas->height = 0;
+    canvas->width = 0;
+}
+
+void canvas_erase(struct Canvas *canvas)
+{
+    if (canvas->cells != NULL)
+    {
+        memset(canvas->cells, 0, (size_t)canvas->height * canvas->width * sizeof(struct Cell));
+    }
+    canvas->color_pair = 0;
+}
+
+void canvas_set_color(struct Canvas *canvas, int color_pair)
+{
+    canvas->color_pair = color_pair;
+}
+
+static void put_code_point(struct Canvas *canvas, int y, int x, uint32_t code_point)
+{
+    if (y < 0 || y >= canvas->height || x < 0 || x >= canvas->width)
+    {
+        return;
+    }
+
+    struct Cell *cell = &canvas->cells[(size_t)y * canvas->width + x];
+    cell->ch = code_point;
+    cell->color_pair = (uint16_t)canvas->color_pair;
+}
+
+void canvas_put_char(struct Canvas *canvas, int y, int x, char ch)
+{
+    put_code_point(canvas, y, x, (unsigned char)ch);
+}
+
+void canvas_put_str(struct Canvas *canvas, int y, int x, const char *str)
+{
+    if (y < 0 || y >= canvas->height)
+    {
+        return;
+    }
+
+    while (*str != '\0' && x < canvas->width)
+    {
+        uint32_t code_point = utf8_decode(&str);
+        if (code_point == '\t')
+        {
+            x = (x / TAB_SIZE + 1) * TAB_SIZE;
+            continue;
+        }
+
+        put_code_point(canvas, y, x, code_point);
+        x++;
+    }
+}
+
+void canvas_printf(struct Canvas *canvas, int y, int x, const char *format, ...)
+{
+    char line[MAX_LINE_LEN];
+
+    va_list args;
+    va_start(args, format);
+    vsnprintf(line, sizeof(line), format, args);
+    va_end(args);
+
+    canvas_put_str(canvas, y, x, line);
+}
+
+uint32_t utf8_decode(const char **str)
+{
+    const unsigned char *bytes = (const unsigned char *)*str;
+
+    // Number of continuation bytes and the bits of the lead byte
+    int length;
+    uint32_t code_point;
+    if (bytes[0] < 0x80)
+    {
+        length = 0;
+        code_point = bytes[0];
+    }
+    else if ((bytes[0] & 0xE0) == 0xC0)
+    {
+        length = 1;
+        code_point = bytes[0] & 0x1F;
+    }
+    else if ((bytes[0] & 0xF0) == 0xE0)
+    {
+        length = 2;
+        code_point = bytes[0] & 0x0F;
+    }
+    else if ((bytes[0] & 0xF8) == 0xF0)
+    {
+        length = 3;
+        code_point = bytes[0] & 0x07;
+    }
+    else
+    {
+        *str += 1;
+        return REPLACEMENT_CHARACTER;
+    }
+
+    for (int i = 1; i <= length; ++i)
+    {
+        // Also stops at the NUL terminator
+        if ((bytes[i] & 0xC0) != 0x80)
+        {
+            *str += 1;
+            return REPLACEMENT_CHARACTER;
+        }
+        code_point = (code_point << 6) | (bytes[i] & 0x3F);
+    }
+
+    *str += length + 1;
+    return code_point;
+}
+
+int utf8_encode(uint32_t code_point, char *out)
+{
+    int length;
+    if (code_point < 0x80)
+    {
+        out[0] = (char)code_point;
+        length = 1;
+    }
+    else if (code_point < 0x800)
+    {
+        out[0] = (char)(0xC0 | (code_point >> 6));
+        out[1] = (char)(0x80 | (code_point & 0x3F));
+        length = 2;
+    }
+    else if (code_point < 0x10000)
+    {
+        out[0] = (char)(0xE0 | (code_point >> 12));
+        out[1] = (char)(0x80 | ((code_point >> 6) & 0x3F));
+        out[2] = (char)(0x80 | (code_point & 0x3F));
+        length = 3;
+    }
+    else
+    {
+        out[0] = (char)(0xF0 | (code_point >> 18));
+        out[1] = (char)(0x80 | ((code_point >> 12) & 0x3F));
+        out[2] = (char)(0x80 | ((code_point >> 6) & 0x3F));
+        out[3] = (char)(0x80 | (code_point & 0x3F));
+        length = 4;
+    }
+
+    out[length] = '\0';
+    return length;
+}
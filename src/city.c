@@ -1,205 +1,407 @@
 #include "city.h"
-#include "cities.h"
-#include "macros.h"
+#include "city_index.h"
 
 #include <ctype.h>
-#include <stdint.h>
+#include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
-#define MAX_LINE_LENGTH 1024
+// Columns of data/cities.csv
+enum CsvField
+{
+    CSV_NAME,
+    CSV_POPULATION,
+    CSV_COUNTRY,
+    CSV_TIMEZONE,
+    CSV_LATITUDE,
+    CSV_LONGITUDE,
+    NUM_CSV_FIELDS,
+};
+
+// Columns of a GeoNames dump that cities are read from, out of 19
+enum GeonamesField
+{
+    GEONAMES_NAME = 1,
+    GEONAMES_LATITUDE = 4,
+    GEONAMES_LONGITUDE = 5,
+    GEONAMES_COUNTRY = 8,
+    GEONAMES_POPULATION = 14,
+    NUM_GEONAMES_FIELDS = 15, // Only the columns up to population are needed
+};
+
+#define MAX_FIELDS NUM_GEONAMES_FIELDS
+
+// Part of a line, not terminated
+struct Span
+{
+    const char *start;
+    size_t length;
+};
+
+static const struct CityTable builtin_table = {
+    .records = city_records,
+    .num_records = CITY_RECORDS_LEN,
+    .data = NULL,
+};
 
-// Function to normalize a city name: trim spaces and convert to lowercase.
-// Since this is used in a binary search of data/cities.csv, it must be sorted accordingly.
-char *normalize_city_name(const char *input)
+const struct CityTable *builtin_city_table(void)
 {
-    if (input == NULL)
+    return &builtin_table;
+}
+
+/* Normalize `length` bytes of a name into `key`. It must match
+ * scripts/city_index.py, which sorts the built-in index by it
+ */
+static bool normalize_span(const char *name, size_t length, char *key, size_t key_size)
+{
+    while (length > 0 && isspace((unsigned char)*name))
     {
-        return NULL;
+        name++;
+        length--;
+    }
+    while (length > 0 && isspace((unsigned char)name[length - 1]))
+    {
+        length--;
     }
 
-    // Create a mutable copy of the input string
-    char *normalized = strdup(input);
-    if (normalized == NULL)
+    if (length >= key_size)
     {
-        perror("Memory allocation failed");
-        return NULL;
+        return false;
     }
 
-    // Trim leading spaces
-    char *start = normalized;
-    while (isspace((unsigned char)*start))
+    for (size_t i = 0; i < length; ++i)
     {
-        start++;
+        char c = name[i];
+        key[i] = c >= 'A' && c <= 'Z' ? (char)(c - 'A' + 'a') : c;
     }
+    key[length] = '\0';
+    return true;
+}
 
-    // Trim trailing spaces
-    char *end = start + strlen(start) - 1;
-    while (end >= start && isspace((unsigned char)*end))
+bool normalize_city_key(const char *name, char *key, size_t key_size)
+{
+    return normalize_span(name, strlen(name), key, key_size);
+}
+
+const struct CityRecord *city_table_find(const struct CityTable *table, const char *name)
+{
+    char key[CITY_KEY_MAX];
+    if (name == NULL || !normalize_city_key(name, key, sizeof(key)))
     {
-        *end = '\0';
-        end--;
+        return NULL;
+    }
+
+    // First record not below the key, which is the most populous of its name
+    size_t low = 0;
+    size_t high = table->num_records;
+    while (low < high)
+    {
+        size_t mid = low + (high - low) / 2;
+        if (strcmp(table->records[mid].key, key) < 0)
+        {
+            low = mid + 1;
+        }
+        else
+        {
+            high = mid;
+        }
     }
 
-    // Convert to lowercase
-    for (char *p = start; *p; p++)
+    if (low == table->num_records || strcmp(table->records[low].key, key) != 0)
     {
-        *p = tolower((unsigned char)*p);
+        return NULL;
     }
+    return &table->records[low];
+}
 
-    // Create a new string containing the normalized result
-    char *result = strdup(start);
-    free(normalized);
-    return result;
+const struct CityRecord *find_city(const char *name)
+{
+    return city_table_find(&builtin_table, name);
 }
 
-// Function to compare two city names for binary search
-static int compare_city(const void *key, const void *element)
+/* Split a line into fields at `separator`. CSV fields may be quoted, with
+ * doubled quotes inside, in which case the span excludes the outer quotes.
+ * Returns the number of fields found, at most `max_fields`
+ */
+static unsigned int split_fields(const char *line, size_t length, char separator, bool quoted, struct Span *fields,
+                                 unsigned int max_fields)
 {
-    const char *city_name = (const char *)key;
-    const char *line = *(const char **)element; // Dereference the element pointer (line array)
+    unsigned int num_fields = 0;
+    size_t i = 0;
+    while (num_fields < max_fields)
+    {
+        struct Span *field = &fields[num_fields++];
+        if (quoted && i < length && line[i] == '"')
+        {
+            size_t end = i + 1;
+            while (end < length && (line[end] != '"' || (end + 1 < length && line[end + 1] == '"')))
+            {
+                end += line[end] == '"' ? 2 : 1;
+            }
+            field->start = &line[i + 1];
+            field->length = end - (i + 1);
+            i = end + 1;
+        }
+        else
+        {
+            size_t end = i;
+            while (end < length && line[end] != separator)
+            {
+                end++;
+            }
+            field->start = &line[i];
+            field->length = end - i;
+            i = end;
+        }
 
-    // Extract city name from the line
-    char temp_line[MAX_LINE_LENGTH];
-    strncpy(temp_line, line, MAX_LINE_LENGTH);
-    temp_line[MAX_LINE_LENGTH - 1] = '\0'; // Ensure null termination
+        if (i >= length || line[i] != separator)
+        {
+            break;
+        }
+        i++; // Move past the separator
+    }
+    return num_fields;
+}
 
-    const char *token = strtok(temp_line, ","); // Extract the first token (city name)
-    if (token == NULL)
+/* Parse a number filling a whole field
+ */
+static bool parse_number(struct Span field, double *value)
+{
+    char *end;
+    *value = strtod(field.start, &end);
+    return field.length > 0 && end == field.start + field.length;
+}
+
+// A city parsed from a line, its strings still pointing into the file
+struct CityLine
+{
+    struct Span name;
+    struct Span country_code;
+    double latitude;
+    double longitude;
+    double population;
+};
+
+/* Whether a field holds more than spaces
+ */
+static bool has_text(struct Span span)
+{
+    for (size_t i = 0; i < span.length; ++i)
     {
-        return -1;
+        if (!isspace((unsigned char)span.start[i]))
+        {
+            return true;
+        }
     }
+    return false;
+}
 
-    // Normalize both the input key and the extracted city name for comparison
-    char *normalized_city_name = normalize_city_name(city_name);
-    char *normalized_token = normalize_city_name(token);
+static bool parse_city_line(const char *line, size_t length, bool csv, struct CityLine *city)
+{
+    // Files written on Windows end lines with CRLF
+    if (length > 0 && line[length - 1] == '\r')
+    {
+        length--;
+    }
 
-    if (normalized_city_name == NULL || normalized_token == NULL)
+    struct Span fields[MAX_FIELDS];
+    unsigned int num_fields = split_fields(line, length, csv ? ',' : '\t', csv, fields, MAX_FIELDS);
+    if (num_fields < (csv ? NUM_CSV_FIELDS : NUM_GEONAMES_FIELDS))
     {
-        free(normalized_city_name);
-        free(normalized_token);
-        return -1;
+        return false;
     }
 
-    int result = strcmp(normalized_city_name, normalized_token);
+    city->name = fields[csv ? CSV_NAME : GEONAMES_NAME];
+    city->country_code = fields[csv ? CSV_COUNTRY : GEONAMES_COUNTRY];
+    return has_text(city->name) && city->name.length < CITY_KEY_MAX &&
+           parse_number(fields[csv ? CSV_LATITUDE : GEONAMES_LATITUDE], &city->latitude) &&
+           parse_number(fields[csv ? CSV_LONGITUDE : GEONAMES_LONGITUDE], &city->longitude) &&
+           parse_number(fields[csv ? CSV_POPULATION : GEONAMES_POPULATION], &city->population);
+}
+
+/* Copy a field into the pool, undoing doubled quotes. Returns the copy
+ */
+static char *copy_span(struct Span span, char **pool)
+{
+    char *copy = *pool;
+    size_t length = 0;
+    for (size_t i = 0; i < span.length; ++i)
+    {
+        copy[length++] = span.start[i];
+        if (span.start[i] == '"' && i + 1 < span.length && span.start[i + 1] == '"')
+        {
+            i++;
+        }
+    }
+    copy[length] = '\0';
+    *pool += length + 1;
+    return copy;
+}
 
-    // Free allocated memory for normalized strings
-    free(normalized_city_name);
-    free(normalized_token);
+static int city_record_comparator(const void *v1, const void *v2)
+{
+    const struct CityRecord *c1 = (const struct CityRecord *)v1;
+    const struct CityRecord *c2 = (const struct CityRecord *)v2;
 
-    return result;
+    int order = strcmp(c1->key, c2->key);
+    if (order != 0)
+    {
+        return order;
+    }
+    return (c1->population < c2->population) - (c1->population > c2->population);
 }
 
-CityData *get_city(const char *name)
+/* Read a whole file, terminated by a NUL. Returns NULL upon error
+ */
+static char *read_file(const char *path, size_t *length)
 {
-    if (name == NULL || cities_len == 0)
+    FILE *file = fopen(path, "rb");
+    if (file == NULL)
     {
         return NULL;
     }
 
-    // Normalize the input city name
-    char *normalized_name = normalize_city_name(name);
-    if (normalized_name == NULL)
+    char *text = NULL;
+    long size = fseek(file, 0, SEEK_END) == 0 ? ftell(file) : -1;
+    if (size >= 0 && fseek(file, 0, SEEK_SET) == 0)
     {
-        return NULL;
+        text = malloc((size_t)size + 1);
+    }
+    if (text != NULL && fread(text, 1, (size_t)size, file) != (size_t)size)
+    {
+        free(text);
+        text = NULL;
     }
+    fclose(file);
 
-    // Convert the byte array into an array of lines
-    char **lines = NULL;
-    size_t line_count = 0;
+    if (text != NULL)
+    {
+        text[size] = '\0';
+        *length = (size_t)size;
+    }
+    return text;
+}
 
-    char *data = malloc(cities_len + 1);
-    if (data == NULL)
+bool generate_city_table(struct CityTable *table, const char *path)
+{
+    *table = (struct CityTable){.records = NULL, .num_records = 0, .data = NULL};
+
+    size_t length;
+    char *text = read_file(path, &length);
+    if (text == NULL)
     {
-        free(normalized_name);
-        return NULL;
+        printf("Could not read city file %s\n", path);
+        return false;
     }
 
-    memcpy(data, cities, cities_len);
-    data[cities_len] = '\0';
+    // Files in the format of data/cities.csv start with its header
+    const char *csv_header = "city_name,";
+    bool csv = strncmp(text, csv_header, strlen(csv_header)) == 0;
 
-    const char *line = strtok(data, "\n");
-    while (line != NULL)
+    // First pass: size the records and the string pool
+    unsigned int num_records = 0;
+    size_t pool_size = 0;
+    for (size_t offset = 0; offset < length;)
     {
-        char *line_copy = strdup(line);
-        if (line_copy == NULL)
-        {
-            perror("Memory allocation failed");
-            free(normalized_name);
-            free(data);
-            return NULL;
-        }
+        const char *newline = memchr(&text[offset], '\n', length - offset);
+        size_t line_len = newline != NULL ? (size_t)(newline - &text[offset]) : length - offset;
 
-        char **temp = realloc(lines, (line_count + 1) * sizeof(char *));
-        if (temp == NULL)
+        struct CityLine city;
+        if (parse_city_line(&text[offset], line_len, csv, &city))
         {
-            perror("Memory allocation failed");
-            free(normalized_name);
-            free(data);
-            for (size_t i = 0; i < line_count; i++)
-            {
-                free(lines[i]);
-            }
-            free(lines);
-            return NULL;
+            num_records++;
+            pool_size += 2 * (city.name.length + 1) + city.country_code.length + 1;
         }
-        lines = temp;
-
-        lines[line_count++] = line_copy;
-        line = strtok(NULL, "\n");
+        offset += line_len + 1; // Move past the newline character
     }
 
-    // Perform binary search with the normalized name
-    char **result = bsearch(normalized_name, lines, line_count, sizeof(char *), compare_city);
+    if (num_records == 0)
+    {
+        printf("City file %s holds no city\n", path);
+        free(text);
+        return false;
+    }
 
-    CityData *city = NULL;
-    if (result != NULL)
+    // Records and pool share a single allocation
+    size_t records_size = num_records * sizeof(struct CityRecord);
+    struct CityRecord *records = malloc(records_size + pool_size);
+    if (records == NULL)
     {
-        // Parse the line for city data
-        char *matched_line = *result;
-        const char *city_name, *latitude_str, *longitude_str;
+        printf("Allocation of memory for city table failed\n");
+        free(text);
+        return false;
+    }
+    char *pool = (char *)records + records_size;
 
-        city_name = strtok(matched_line, ",");
-        strtok(NULL, ","); // Skip population
-        strtok(NULL, ","); // Skip country code
-        strtok(NULL, ","); // Skip timezone
-        latitude_str = strtok(NULL, ",");
-        longitude_str = strtok(NULL, ",");
+    // Second pass: copy cities into the pool
+    unsigned int record_count = 0;
+    for (size_t offset = 0; offset < length;)
+    {
+        const char *newline = memchr(&text[offset], '\n', length - offset);
+        size_t line_len = newline != NULL ? (size_t)(newline - &text[offset]) : length - offset;
 
-        if (city_name && latitude_str && longitude_str)
+        struct CityLine city;
+        if (parse_city_line(&text[offset], line_len, csv, &city))
         {
-            city = malloc(sizeof(CityData));
-            if (city == NULL)
-            {
-                perror("Memory allocation failed");
-            }
-            else
-            {
-                city->city_name = strdup(city_name);
-                city->latitude = atof(latitude_str);
-                city->longitude = atof(longitude_str);
-            }
+            struct CityRecord *record = &records[record_count++];
+            record->name = copy_span(city.name, &pool);
+            record->country_code = copy_span(city.country_code, &pool);
+            record->latitude = (float)city.latitude;
+            record->longitude = (float)city.longitude;
+            record->population = (unsigned long)city.population;
+
+            // The key is never longer than the name
+            char *key = pool;
+            normalize_city_key(record->name, key, CITY_KEY_MAX);
+            record->key = key;
+            pool += strlen(key) + 1;
         }
+        offset += line_len + 1;
     }
+    free(text);
+
+    qsort(records, num_records, sizeof(struct CityRecord), city_record_comparator);
+
+    table->records = records;
+    table->num_records = num_records;
+    table->data = records;
+
+    return true;
+}
 
-    // Clean up lines and data
-    for (size_t i = 0; i < line_count; i++)
+void free_city_table(struct CityTable *table)
+{
+    // Strings live in the same allocation as the records
+    free(table->data);
+    table->records = NULL;
+    table->num_records = 0;
+    table->data = NULL;
+}
+
+CityData *get_city(const char *name)
+{
+    const struct CityRecord *record = find_city(name);
+    if (record == NULL)
     {
-        free(lines[i]);
+        return NULL;
     }
-    free(lines);
-    free(data);
-    free(normalized_name);
 
+    CityData *city = malloc(sizeof(CityData));
+    if (city == NULL)
+    {
+        perror("Memory allocation failed");
+        return NULL;
+    }
+
+    // Names live in the index for the whole program
+    city->city_name = record->name;
+    city->latitude = record->latitude;
+    city->longitude = record->longitude;
     return city;
 }
 
 void free_city(CityData *city)
 {
-    if (city != NULL)
-    {
-        free((void *)city->city_name);
-        free(city);
-    }
+    free(city);
 }
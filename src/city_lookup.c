@@ -0,0 +1,79 @@
+#include "city_lookup.h"
+
+#include "city_trie.h"
+
+#include <stdio.h>
+#include <string.h>
+
+// Cities suggested when a name is not found
+#define MAX_CITY_SUGGESTIONS 5
+
+bool load_city_table(const char *city_file, struct CityTable *cities)
+{
+    if (city_file == NULL)
+    {
+        *cities = *builtin_city_table();
+        return true;
+    }
+    return generate_city_table(cities, city_file);
+}
+
+void print_city_suggestions(const struct CityTable *cities, const char *name)
+{
+    struct CityTrie trie;
+    if (!generate_city_trie(&trie, cities))
+    {
+        return;
+    }
+
+    // Allow about one typo per four letters
+    size_t name_len = strlen(name);
+    unsigned int max_distance = name_len <= 4 ? 1 : name_len <= 8 ? 2 : 3;
+
+    struct CityMatch matches[MAX_CITY_SUGGESTIONS];
+    unsigned int num_matches = city_trie_search(&trie, name, max_distance, matches, MAX_CITY_SUGGESTIONS);
+    if (num_matches > 0)
+    {
+        fprintf(stderr, "Did you mean:\n");
+        for (unsigned int i = 0; i < num_matches; ++i)
+        {
+            fprintf(stderr, "    %s, %s\n", matches[i].city->name, matches[i].city->country_code);
+        }
+    }
+
+    free_city_trie(&trie);
+}
+
+bool list_cities(const char *city_file, const char *prefix)
+{
+    struct CityTable cities;
+    if (!load_city_table(city_file, &cities))
+    {
+        return false;
+    }
+
+    struct CityTrie trie;
+    if (!generate_city_trie(&trie, &cities))
+    {
+        free_city_table(&cities);
+        return false;
+    }
+
+    const struct CityRecord *first = NULL;
+    unsigned int num_cities = city_trie_complete(&trie, prefix, &first);
+    for (unsigned int i = 0; i < num_cities; ++i)
+    {
+        printf("%s, %s (%.4f, %.4f)\n", first[i].name, first[i].country_code, first[i].latitude,
+               first[i].longitude);
+    }
+
+    free_city_trie(&trie);
+    if (num_cities == 0)
+    {
+        fprintf(stderr, "ERROR: No city starts with \"%s\"\n", prefix);
+        print_city_suggestions(&cities, prefix);
+    }
+
+    free_city_table(&cities);
+    return num_cities > 0;
+}
@@ -0,0 +1,215 @@
+#include "city_tree.h"
+
+#include "macros.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// State of a nearest city search
+struct Nearest
+{
+    const struct CityTreeNode *nodes;
+    double target[3];
+    double best_chord2; // Squared chord to the nearest city so far
+    const struct CityTreeNode *best;
+};
+
+static void to_unit_vector(double latitude, double longitude, double vector[3])
+{
+    vector[0] = cos(latitude) * cos(longitude);
+    vector[1] = cos(latitude) * sin(longitude);
+    vector[2] = sin(latitude);
+}
+
+/* Reorder nodes so the one at `k` has the k-th smallest coordinate along
+ * `axis`, with none larger before it and none smaller after it
+ */
+static void select_node(struct CityTreeNode *nodes, long count, long k, unsigned int axis)
+{
+    long lo = 0;
+    long hi = count - 1;
+    while (lo < hi)
+    {
+        float pivot = nodes[lo + (hi - lo) / 2].position[axis];
+        long i = lo;
+        long j = hi;
+        while (i <= j)
+        {
+            while (nodes[i].position[axis] < pivot)
+            {
+                i++;
+            }
+            while (nodes[j].position[axis] > pivot)
+            {
+                j--;
+            }
+            if (i <= j)
+            {
+                struct CityTreeNode swap = nodes[i];
+                nodes[i++] = nodes[j];
+                nodes[j--] = swap;
+            }
+        }
+
+        // Nodes strictly between j and i equal the pivot
+        if (k <= j)
+        {
+            hi = j;
+        }
+        else if (k >= i)
+        {
+            lo = i;
+        }
+        else
+        {
+            return;
+        }
+    }
+}
+
+static void build_range(struct CityTreeNode *nodes, unsigned int count)
+{
+    if (count <= 1)
+    {
+        if (count == 1)
+        {
+            nodes[0].axis = 0;
+        }
+        return;
+    }
+
+    // Split along the coordinate the cities spread the most on
+    float low[3] = {nodes[0].position[0], nodes[0].position[1], nodes[0].position[2]};
+    float high[3] = {low[0], low[1], low[2]};
+    for (unsigned int i = 1; i < count; ++i)
+    {
+        for (unsigned int a = 0; a < 3; ++a)
+        {
+            low[a] = MIN(low[a], nodes[i].position[a]);
+            high[a] = MAX(high[a], nodes[i].position[a]);
+        }
+    }
+    unsigned int axis = 0;
+    for (unsigned int a = 1; a < 3; ++a)
+    {
+        if (high[a] - low[a] > high[axis] - low[axis])
+        {
+            axis = a;
+        }
+    }
+
+    unsigned int mid = count / 2;
+    select_node(nodes, count, mid, axis);
+    nodes[mid].axis = axis;
+
+    build_range(nodes, mid);
+    build_range(&nodes[mid + 1], count - mid - 1);
+}
+
+bool generate_city_tree(struct CityTree *tree, const struct CityTable *table)
+{
+    tree->table = table;
+    tree->nodes = NULL;
+    tree->num_nodes = 0;
+    if (table->num_records == 0)
+    {
+        return true;
+    }
+
+    tree->nodes = malloc(table->num_records * sizeof(struct CityTreeNode));
+    if (tree->nodes == NULL)
+    {
+        printf("Allocation of memory for city tree failed\n");
+        return false;
+    }
+
+    for (unsigned int i = 0; i < table->num_records; ++i)
+    {
+        const struct CityRecord *city = &table->records[i];
+        double position[3];
+        to_unit_vector(city->latitude * M_PI / 180.0, city->longitude * M_PI / 180.0, position);
+
+        struct CityTreeNode *node = &tree->nodes[i];
+        node->position[0] = (float)position[0];
+        node->position[1] = (float)position[1];
+        node->position[2] = (float)position[2];
+        node->record = i;
+    }
+    tree->num_nodes = table->num_records;
+
+    build_range(tree->nodes, tree->num_nodes);
+    return true;
+}
+
+void free_city_tree(struct CityTree *tree)
+{
+    free(tree->nodes);
+    tree->nodes = NULL;
+    tree->num_nodes = 0;
+}
+
+/* Search the nodes in [first, first + count), the side of each split the target
+ * is on first
+ */
+static void search_range(struct Nearest *nearest, unsigned int first, unsigned int count)
+{
+    while (count > 0)
+    {
+        unsigned int mid = first + count / 2;
+        const struct CityTreeNode *node = &nearest->nodes[mid];
+
+        double chord2 = 0.0;
+        for (unsigned int a = 0; a < 3; ++a)
+        {
+            double delta = nearest->target[a] - node->position[a];
+            chord2 += delta * delta;
+        }
+        if (chord2 < nearest->best_chord2)
+        {
+            nearest->best_chord2 = chord2;
+            nearest->best = node;
+        }
+
+        unsigned int below_count = count / 2;
+        unsigned int above_count = count - below_count - 1;
+        double offset = nearest->target[node->axis] - node->position[node->axis];
+        if (offset < 0.0)
+        {
+            search_range(nearest, first, below_count);
+            first = mid + 1;
+            count = above_count;
+        }
+        else
+        {
+            search_range(nearest, mid + 1, above_count);
+            count = below_count;
+        }
+
+        // Cities across the split are at least as far as the split
+        if (offset * offset >= nearest->best_chord2)
+        {
+            return;
+        }
+    }
+}
+
+const struct CityRecord *city_tree_nearest(const struct CityTree *tree, double latitude, double longitude,
+                                           double *distance)
+{
+    if (tree->num_nodes == 0)
+    {
+        return NULL;
+    }
+
+    struct Nearest nearest = {.nodes = tree->nodes, .best_chord2 = INFINITY, .best = NULL};
+    to_unit_vector(latitude, longitude, nearest.target);
+    search_range(&nearest, 0, tree->num_nodes);
+
+    if (distance != NULL)
+    {
+        // Angle subtending the chord
+        *distance = 2.0 * asin(MIN(1.0, sqrt(nearest.best_chord2) / 2.0));
+    }
+    return &tree->table->records[nearest.best->record];
+}
@@ -0,0 +1,257 @@
+#include "city_trie.h"
+
+#include "macros.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// State of a fuzzy search, with one row of edit distances per byte of prefix
+struct Search
+{
+    const struct CityTrie *trie;
+    char query[CITY_FUZZY_MAX + 1]; // Normalized
+    unsigned int query_len;
+    unsigned int max_distance;
+    struct CityMatch *matches; // Closest first, then most populous first
+    unsigned int max_matches;
+    unsigned int num_matches;
+    uint8_t rows[CITY_KEY_MAX][CITY_FUZZY_MAX + 1];
+};
+
+bool generate_city_trie(struct CityTrie *trie, const struct CityTable *table)
+{
+    const struct CityRecord *records = table->records;
+    trie->table = table;
+    trie->num_nodes = 0;
+
+    // Every node but the root either ends a name or branches, so there are
+    // fewer than two nodes per city
+    size_t max_nodes = 2 * (size_t)table->num_records + 1;
+    trie->nodes = malloc(max_nodes * sizeof(struct CityTrieNode));
+    if (trie->nodes == NULL)
+    {
+        printf("Allocation of memory for city trie failed\n");
+        return false;
+    }
+
+    trie->nodes[0] = (struct CityTrieNode){.first_record = 0, .num_records = table->num_records, .depth = 0};
+    trie->num_nodes = 1;
+
+    // Nodes are expanded in breadth-first order, which lays each node's
+    // children out next to each other
+    for (unsigned int i = 0; i < trie->num_nodes; ++i)
+    {
+        struct CityTrieNode *node = &trie->nodes[i];
+        unsigned int depth = node->depth;
+        unsigned int end = node->first_record + node->num_records;
+
+        // Shorter names sort first
+        unsigned int next = node->first_record;
+        while (next < end && records[next].key[depth] == '\0')
+        {
+            next++;
+        }
+        node->num_terminal = next - node->first_record;
+        node->first_child = trie->num_nodes;
+        node->num_children = 0;
+
+        while (next < end)
+        {
+            // Cities continuing with the same byte
+            char byte = records[next].key[depth];
+            unsigned int run_end = next + 1;
+            while (run_end < end && records[run_end].key[depth] == byte)
+            {
+                run_end++;
+            }
+
+            // The child's label runs as far as the first and last of its
+            // cities agree, and so all of them
+            const char *first = records[next].key;
+            const char *last = records[run_end - 1].key;
+            unsigned int child_depth = depth + 1;
+            while (first[child_depth] != '\0' && first[child_depth] == last[child_depth])
+            {
+                child_depth++;
+            }
+
+            trie->nodes[trie->num_nodes++] = (struct CityTrieNode){
+                .first_record = next,
+                .num_records = run_end - next,
+                .depth = (uint16_t)child_depth,
+            };
+            node->num_children++;
+            next = run_end;
+        }
+    }
+
+    // Give back what the bound overestimated
+    struct CityTrieNode *nodes = realloc(trie->nodes, trie->num_nodes * sizeof(struct CityTrieNode));
+    if (nodes != NULL)
+    {
+        trie->nodes = nodes;
+    }
+
+    return true;
+}
+
+void free_city_trie(struct CityTrie *trie)
+{
+    free(trie->nodes);
+    trie->nodes = NULL;
+    trie->num_nodes = 0;
+}
+
+/* The child of a node whose label starts with `byte`, or NULL
+ */
+static const struct CityTrieNode *find_child(const struct CityTrie *trie, const struct CityTrieNode *node, char byte)
+{
+    const struct CityRecord *records = trie->table->records;
+    for (unsigned int c = 0; c < node->num_children; ++c)
+    {
+        const struct CityTrieNode *child = &trie->nodes[node->first_child + c];
+        if (records[child->first_record].key[node->depth] == byte)
+        {
+            return child;
+        }
+    }
+    return NULL;
+}
+
+unsigned int city_trie_complete(const struct CityTrie *trie, const char *prefix, const struct CityRecord **first)
+{
+    char key[CITY_KEY_MAX];
+    if (trie->num_nodes == 0 || prefix == NULL || !normalize_city_key(prefix, key, sizeof(key)))
+    {
+        return 0;
+    }
+
+    unsigned int key_len = (unsigned int)strlen(key);
+    const struct CityTrieNode *node = &trie->nodes[0];
+    while (node->depth < key_len)
+    {
+        const struct CityTrieNode *child = find_child(trie, node, key[node->depth]);
+        if (child == NULL)
+        {
+            return 0;
+        }
+
+        // The prefix may end partway through the child's label
+        const char *label = trie->table->records[child->first_record].key;
+        unsigned int compared = MIN((unsigned int)child->depth, key_len);
+        if (memcmp(&label[node->depth], &key[node->depth], compared - node->depth) != 0)
+        {
+            return 0;
+        }
+        node = child;
+    }
+
+    *first = &trie->table->records[node->first_record];
+    return node->num_records;
+}
+
+/* Largest distance still worth matching: once the matches are full, only
+ * cities at most as far as the last one can take its place
+ */
+static unsigned int distance_bound(const struct Search *search)
+{
+    if (search->num_matches < search->max_matches)
+    {
+        return search->max_distance;
+    }
+    return MIN(search->max_distance, search->matches[search->num_matches - 1].distance);
+}
+
+static void add_match(struct Search *search, const struct CityRecord *city, unsigned int distance)
+{
+    // Find where the city ranks, from the back
+    unsigned int rank = search->num_matches;
+    while (rank > 0 && (search->matches[rank - 1].distance > distance ||
+                        (search->matches[rank - 1].distance == distance &&
+                         search->matches[rank - 1].city->population < city->population)))
+    {
+        rank--;
+    }
+    if (rank == search->max_matches)
+    {
+        return;
+    }
+
+    unsigned int num_moved = MIN(search->num_matches, search->max_matches - 1) - rank;
+    memmove(&search->matches[rank + 1], &search->matches[rank], num_moved * sizeof(struct CityMatch));
+    search->matches[rank] = (struct CityMatch){.city = city, .distance = distance};
+    search->num_matches = MIN(search->num_matches + 1, search->max_matches);
+}
+
+/* Extend the edit distances of the prefix ending at `parent_depth` along a
+ * node's label, then search its children
+ */
+static void search_node(struct Search *search, const struct CityTrieNode *node, unsigned int parent_depth)
+{
+    const struct CityRecord *records = search->trie->table->records;
+    const char *label = records[node->first_record].key;
+    unsigned int query_len = search->query_len;
+
+    for (unsigned int depth = parent_depth; depth < node->depth; ++depth)
+    {
+        const uint8_t *above = search->rows[depth];
+        uint8_t *row = search->rows[depth + 1];
+
+        // Entry j holds the edits between the prefix and the first j bytes of
+        // the query
+        row[0] = (uint8_t)(depth + 1);
+        unsigned int row_min = row[0];
+        for (unsigned int j = 1; j <= query_len; ++j)
+        {
+            unsigned int replace = above[j - 1] + (label[depth] != search->query[j - 1]);
+            unsigned int insert = row[j - 1] + 1u;
+            unsigned int delete = above[j] + 1u;
+            row[j] = (uint8_t)MIN(replace, MIN(insert, delete));
+            row_min = MIN(row_min, row[j]);
+        }
+
+        // Longer prefixes only get further away
+        if (row_min > distance_bound(search))
+        {
+            return;
+        }
+    }
+
+    unsigned int distance = search->rows[node->depth][query_len];
+    if (node->num_terminal > 0 && distance <= distance_bound(search))
+    {
+        add_match(search, &records[node->first_record], distance);
+    }
+
+    for (unsigned int c = 0; c < node->num_children; ++c)
+    {
+        search_node(search, &search->trie->nodes[node->first_child + c], node->depth);
+    }
+}
+
+unsigned int city_trie_search(const struct CityTrie *trie, const char *query, unsigned int max_distance,
+                              struct CityMatch *matches, unsigned int max_matches)
+{
+    struct Search search;
+    if (trie->num_nodes == 0 || query == NULL || max_matches == 0 ||
+        !normalize_city_key(query, search.query, sizeof(search.query)))
+    {
+        return 0;
+    }
+
+    search.trie = trie;
+    search.query_len = (unsigned int)strlen(search.query);
+    search.max_distance = max_distance;
+    search.matches = matches;
+    search.max_matches = max_matches;
+    search.num_matches = 0;
+
+    for (unsigned int j = 0; j <= search.query_len; ++j)
+    {
+        search.rows[0][j] = (uint8_t)j;
+    }
+    search_node(&search, &trie->nodes[0], 0);
+
+    return search.num_matches;
+}
@@ -2,6 +2,7 @@
 #include "macros.h"
 
 #include <math.h>
+#include <string.h>
 
 // Conversions
 
@@ -46,12 +47,89 @@ void equatorial_to_horizontal(double right_ascension, double declination, double
     return;
 }
 
+void equatorial_to_horizontal_unit(double right_ascension, double declination, double gmst, double latitude,
+                                   double longitude, double *east, double *north, double *up)
+{
+    // The same rotation as equatorial_to_horizontal, applied to the unit vector
+    // of the hour angle and declination, so no inverse trig is needed
+    double hour_angle = gmst + longitude - right_ascension;
+    double sin_hour_angle = sin(hour_angle);
+    double cos_hour_angle = cos(hour_angle);
+    double sin_declination = sin(declination);
+    double cos_declination = cos(declination);
+    double sin_latitude = sin(latitude);
+    double cos_latitude = cos(latitude);
+
+    *east = -cos_declination * sin_hour_angle;
+    *north = sin_declination * cos_latitude - cos_declination * cos_hour_angle * sin_latitude;
+    *up = sin_declination * sin_latitude + cos_declination * cos_hour_angle * cos_latitude;
+}
+
+void horizontal_to_equatorial(double azimuth, double altitude, double gmst, double latitude, double longitude,
+                              double *right_ascension, double *declination)
+{
+    // Astronomical Algorithms, Jean Meeus, eq. 13.5 & 13.6 solved for the hour
+    // angle, with Azimuth 0 at North as in equatorial_to_horizontal
+    double sin_declination = sin(latitude) * sin(altitude) + cos(latitude) * cos(altitude) * cos(azimuth);
+    *declination = asin(fmax(-1.0, fmin(1.0, sin_declination)));
+
+    double hour_angle = atan2(-sin(azimuth) * cos(altitude),
+                              sin(altitude) * cos(latitude) - cos(altitude) * cos(azimuth) * sin(latitude));
+
+    *right_ascension = fmod(gmst + longitude - hour_angle, 2.0 * M_PI);
+    if (*right_ascension < 0.0)
+    {
+        *right_ascension += 2.0 * M_PI;
+    }
+}
+
+void horizontal_rates(double hour_angle, double declination, double latitude, double *azimuth_rate,
+                      double *altitude_rate)
+{
+    // Differentiate sin(alt) = sin(lat)sin(dec) + cos(lat)cos(dec)cos(H)
+    double sin_altitude = sin(latitude) * sin(declination) + cos(latitude) * cos(declination) * cos(hour_angle);
+    double cos_altitude = sqrt(fmax(0.0, 1.0 - sin_altitude * sin_altitude));
+
+    // Differentiate tan(az) = sin(H) / (cos(H)sin(lat) - tan(dec)cos(lat))
+    double num = sin(hour_angle);
+    double den = cos(hour_angle) * sin(latitude) - tan(declination) * cos(latitude);
+    double norm = num * num + den * den;
+
+    if (cos_altitude < 1.0E-12 || norm < 1.0E-24)
+    {
+        *azimuth_rate = 0.0;
+        *altitude_rate = 0.0;
+        return;
+    }
+
+    *azimuth_rate = (sin(latitude) - cos(hour_angle) * tan(declination) * cos(latitude)) / norm;
+    *altitude_rate = -cos(latitude) * cos(declination) * sin(hour_angle) / cos_altitude;
+}
+
 void horizontal_to_spherical(double azimuth, double altitude, double *point_theta, double *point_phi)
 {
     *point_theta = M_PI / 2 - azimuth;
     *point_phi = M_PI / 2 - altitude;
 }
 
+void horizontal_to_unit(double azimuth, double altitude, double *east, double *north, double *up)
+{
+    double cos_altitude = cos(altitude);
+    *east = cos_altitude * sin(azimuth);
+    *north = cos_altitude * cos(azimuth);
+    *up = sin(altitude);
+}
+
+void unit_to_horizontal(double east, double north, double up, double *azimuth, double *altitude)
+{
+    *altitude = asin(fmax(-1.0, fmin(1.0, up)));
+    *azimuth = atan2(east, north);
+    if (*azimuth < 0.0)
+    {
+        *azimuth += 2.0 * M_PI;
+    }
+}
+
 // Projections
 
 void project_stereographic(double sphere_radius, double point_theta, double point_phi, double center_theta, double center_phi,
@@ -95,6 +173,107 @@ void project_stereographic_south(double sphere_radius, double point_theta, doubl
                                                   //             horizon is at the "top" of the projection
 }
 
+bool projection_from_name(const char *name, enum Projection *projection)
+{
+    static const char *names[] = {
+        [PROJECTION_STEREOGRAPHIC] = "stereographic",
+        [PROJECTION_ORTHOGRAPHIC] = "orthographic",
+        [PROJECTION_LAMBERT] = "lambert",
+        [PROJECTION_EQUIDISTANT] = "equidistant",
+    };
+
+    for (unsigned int i = 0; i < sizeof(names) / sizeof(names[0]); ++i)
+    {
+        if (strcmp(name, names[i]) == 0)
+        {
+            *projection = (enum Projection)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Every projection here moves a point at zenith distance z along its azimuth to
+ * radius r(z) on the disk. In terms of the unit vector (e, n, u) the point lands
+ * at k * (e, n), where k = r(z) / sin(z) only depends on u = cos(z). Azimuth is
+ * measured East of North and East is on the left, as when looking up at the sky
+ */
+static inline void place_scaled(double scale, double east, double north, double rad_y, double rad_x, int *row,
+                                int *col)
+{
+    // Every cell lies in [0, 2 * rad], so adding a half truncates to the nearest
+    *row = (int)(rad_y * (1.0 - scale * north) + 0.5);
+    *col = (int)(rad_x * (1.0 - scale * east) + 0.5);
+}
+
+// Coefficients of acos(x) ~ sqrt(1 - x) * P(x) for 0 <= x <= 1 with an error
+// below 2e-8, Handbook of Mathematical Functions, Abramowitz & Stegun, 4.4.46
+static const double acos_poly[8] = {1.5707963050, -0.2145988016, 0.0889789874, -0.0501743046,
+                                    0.0308918810, -0.0170881256, 0.0066700901, -0.0012624911};
+
+void project_unit_vectors(enum Projection projection, const double *restrict east, const double *restrict north,
+                          const double *restrict up, unsigned int count, int win_height, int win_width,
+                          int *restrict rows, int *restrict cols)
+{
+    double rad_y = (win_height - 1) / 2.0;
+    double rad_x = (win_width - 1) / 2.0;
+
+    // Below the horizon only `up` is clamped to zero, keeping every scale finite
+    switch (projection)
+    {
+    case PROJECTION_ORTHOGRAPHIC:
+        // r = sin(z)
+        for (unsigned int i = 0; i < count; ++i)
+        {
+            place_scaled(1.0, east[i], north[i], rad_y, rad_x, &rows[i], &cols[i]);
+        }
+        break;
+
+    case PROJECTION_LAMBERT:
+        // r = sqrt(2) * sin(z / 2), which is sqrt(1 - u)
+        for (unsigned int i = 0; i < count; ++i)
+        {
+            double u = 0.5 * (up[i] + fabs(up[i]));
+            double scale = 1.0 / sqrt(1.0 + u);
+            place_scaled(scale, east[i], north[i], rad_y, rad_x, &rows[i], &cols[i]);
+        }
+        break;
+
+    case PROJECTION_EQUIDISTANT:
+        // r = z / (π / 2), where z = sqrt(1 - u) * P(u) and sin(z) = sqrt(1 - u^2)
+        for (unsigned int i = 0; i < count; ++i)
+        {
+            double u = 0.5 * (up[i] + fabs(up[i]));
+            double poly = acos_poly[7];
+            for (int j = 6; j >= 0; --j)
+            {
+                poly = poly * u + acos_poly[j];
+            }
+            double scale = (2.0 / M_PI) * poly / sqrt(1.0 + u);
+            place_scaled(scale, east[i], north[i], rad_y, rad_x, &rows[i], &cols[i]);
+        }
+        break;
+
+    case PROJECTION_STEREOGRAPHIC:
+    default:
+        // r = tan(z / 2), which is sin(z) / (1 + u)
+        for (unsigned int i = 0; i < count; ++i)
+        {
+            double u = 0.5 * (up[i] + fabs(up[i]));
+            double scale = 1.0 / (1.0 + u);
+            place_scaled(scale, east[i], north[i], rad_y, rad_x, &rows[i], &cols[i]);
+        }
+        break;
+    }
+}
+
+bool project_unit_vector(enum Projection projection, double east, double north, double up, int win_height,
+                         int win_width, int *row, int *col)
+{
+    project_unit_vectors(projection, &east, &north, &up, 1, win_height, win_width, row, col);
+    return up >= 0.0;
+}
+
 // Screen space mapping
 
 void polar_to_win(double r, double theta, int win_height, int win_width, int *row, int *col)
@@ -1,10 +1,12 @@
 #include "core.h"
 
 #include "astro.h"
+#include "macros.h"
 #include "parse_BSC5.h"
 #include "strptime.h"
 
 #include <math.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -12,7 +14,34 @@
 
 // Data generation
 
-bool generate_star_table(struct Star **star_table_out, struct Entry *entries, const struct StarName *name_table,
+void set_star_symbol(struct ObjectBase *base, float magnitude)
+{
+    // Star magnitude mapping
+    // FIXME: some of these characters render on WSL while not on macOS
+    // (system wide, not just this project). I haven't gotten to the bottom
+    // of this yet...
+    // TODO: add CLI option to choose between these
+    const char *mag_map_unicode_round[10] = {"⬤", "●", "⦁", "•", "•", "∙", "⋅", "⋅", "⋅", "⋅"};
+    // const char *mag_map_unicode_diamond[10] = {"⯁", "◇", "⬥", "⬦", "⬩",
+    // "🞘", "🞗", "🞗", "🞗", "🞗"}; const char *mag_map_unicode_open[10]    =
+    // {"✩", "✧", "⋄", "⭒", "🞝", "🞝", "🞝", "🞝", "🞝", "🞝"}; const char
+    // *mag_map_unicode_filled[10]  = {"★", "✦", "⬩", "⭑", "🞝", "🞝", "🞝",
+    // "🞝", "🞝", "🞝"};
+    const char mag_map_round_ASCII[10] = {'0', '0', 'O', 'O', 'o', 'o', '.', '.', '.', '.'};
+
+    const float min_magnitude = -1.46f;
+    const float max_magnitude = 7.96f;
+
+    int symbol_index = map_float_to_int_range(min_magnitude, max_magnitude, 0, 9, magnitude);
+
+    // Catalogs deeper than the BSC5 share the faintest symbol
+    symbol_index = MAX(0, MIN(symbol_index, 9));
+
+    base->symbol_ASCII = mag_map_round_ASCII[symbol_index];
+    base->symbol_unicode = mag_map_unicode_round[symbol_index];
+}
+
+bool generate_star_table(struct Star **star_table_out, struct Entry *entries, const struct StarNameTable *name_table,
                          unsigned int num_stars)
 {
     *star_table_out = malloc(num_stars * sizeof(struct Star));
@@ -33,30 +62,11 @@ bool generate_star_table(struct Star **star_table_out, struct Entry *entries, co
         temp_star.dec_motion = (double)entries[i].XDPM;
         temp_star.magnitude = entries[i].MAG / 100.0f;
 
-        // Star magnitude mapping
-        // FIXME: some of these characters render on WSL while not on macOS
-        // (system wide, not just this project). I haven't gotten to the bottom
-        // of this yet...
-        // TODO: add CLI option to choose between these
-        const char *mag_map_unicode_round[10] = {"⬤", "●", "⦁", "•", "•", "∙", "⋅", "⋅", "⋅", "⋅"};
-        // const char *mag_map_unicode_diamond[10] = {"⯁", "◇", "⬥", "⬦", "⬩",
-        // "🞘", "🞗", "🞗", "🞗", "🞗"}; const char *mag_map_unicode_open[10]    =
-        // {"✩", "✧", "⋄", "⭒", "🞝", "🞝", "🞝", "🞝", "🞝", "🞝"}; const char
-        // *mag_map_unicode_filled[10]  = {"★", "✦", "⬩", "⭑", "🞝", "🞝", "🞝",
-        // "🞝", "🞝", "🞝"};
-        const char mag_map_round_ASCII[10] = {'0', '0', 'O', 'O', 'o', 'o', '.', '.', '.', '.'};
-
-        const float min_magnitude = -1.46f;
-        const float max_magnitude = 7.96f;
-
-        int symbol_index = map_float_to_int_range(min_magnitude, max_magnitude, 0, 9, temp_star.magnitude);
-
         temp_star.base = (struct ObjectBase){
             .color_pair = 0,
-            .symbol_ASCII = (char)mag_map_round_ASCII[symbol_index],
-            .symbol_unicode = mag_map_unicode_round[symbol_index],
-            .label = name_table[i].name,
+            .label = star_name_lookup(name_table, temp_star.catalog_number),
         };
+        set_star_symbol(&temp_star.base, temp_star.magnitude);
 
         // Copy temp struct to table index
         (*star_table_out)[i] = temp_star;
@@ -65,6 +75,17 @@ bool generate_star_table(struct Star **star_table_out, struct Entry *entries, co
     return true;
 }
 
+void drop_faint_labels(struct Star *star_table, unsigned int num_stars, float label_thresh)
+{
+    for (unsigned int i = 0; i < num_stars; ++i)
+    {
+        if (star_table[i].magnitude > label_thresh)
+        {
+            star_table[i].base.label = NULL;
+        }
+    }
+}
+
 bool generate_planet_table(struct Planet **planet_table, const struct KepElems *planet_elements,
                            const struct KepRates *planet_rates, const struct KepExtra *planet_extras)
 {
@@ -144,253 +165,340 @@ bool generate_moon_object(struct Moon *moon_data, const struct KepElems *moon_el
     return true;
 }
 
-// Line buffer (more than enough to store any of the names)
-#define BUF_SIZE 32
-
-// TODO: verify this catches the first and last entries
-bool generate_name_table(const uint8_t *data, size_t data_len, struct StarName **name_table_out, int num_stars)
+/* Find the bounds of the name in a line of the form "catalog_number,name".
+ * Returns false if the line is empty or malformed
+ */
+static bool find_name_bounds(const uint8_t *line, size_t line_len, int *catalog_number, size_t *name_start,
+                             size_t *name_len)
 {
-    *name_table_out = malloc(num_stars * sizeof(struct StarName));
-    if (*name_table_out == NULL)
+    size_t comma = 0;
+    while (comma < line_len && line[comma] != ',')
+    {
+        comma++;
+    }
+    if (comma == 0 || comma >= line_len)
     {
-        printf("Allocation of memory for name table failed\n");
         return false;
     }
 
-    char buffer[BUF_SIZE];
-    size_t offset = 0;
+    int number = 0;
+    for (size_t i = 0; i < comma; ++i)
+    {
+        if (line[i] < '0' || line[i] > '9')
+        {
+            return false;
+        }
+        number = number * 10 + (line[i] - '0');
+    }
 
-    // Fill array with NULL pointers to start
-    for (int i = 0; i < num_stars; ++i)
+    // The name runs until the next delimiter or carriage return
+    size_t end = comma + 1;
+    while (end < line_len && line[end] != ',' && line[end] != '\r')
     {
-        (*name_table_out)[i].name = NULL;
+        end++;
+    }
+    if (end == comma + 1)
+    {
+        return false;
     }
 
-    // Set desired indices with names
+    *catalog_number = number;
+    *name_start = comma + 1;
+    *name_len = end - (comma + 1);
+    return true;
+}
+
+static int star_name_comparator(const void *v1, const void *v2)
+{
+    const struct StarName *n1 = (const struct StarName *)v1;
+    const struct StarName *n2 = (const struct StarName *)v2;
+
+    return (n1->catalog_number > n2->catalog_number) - (n1->catalog_number < n2->catalog_number);
+}
+
+bool generate_name_table(const uint8_t *data, size_t data_len, struct StarNameTable *name_table_out)
+{
+    *name_table_out = (struct StarNameTable){.index = NULL, .pool = NULL, .num_names = 0};
+
+    // First pass: size the index and the string pool
+    unsigned int num_names = 0;
+    size_t pool_size = 0;
+    size_t offset = 0;
     while (offset < data_len)
     {
-        // Find the next line in the embedded data (similar to fgets)
-        size_t i = 0;
-        while (offset + i < data_len && data[offset + i] != '\n' && i < BUF_SIZE - 1)
+        size_t line_len = 0;
+        while (offset + line_len < data_len && data[offset + line_len] != '\n')
         {
-            buffer[i] = data[offset + i];
-            i++;
+            line_len++;
         }
-        buffer[i] = '\0'; // Null terminate the string
 
-        // If we haven't reached the end of the buffer, move to the next line
-        offset += i + 1; // Move past the newline character
-
-        if (buffer[0] == '\0')
+        int catalog_number;
+        size_t name_start, name_len;
+        if (find_name_bounds(&data[offset], line_len, &catalog_number, &name_start, &name_len))
         {
-            continue; // Skip empty lines
+            num_names++;
+            pool_size += name_len + 1;
         }
 
-        // Split by delimiter (expecting the format "catalog_number,name")
-        int catalog_number = atoi(strtok(buffer, ","));
-        const char *name = strtok(NULL, ",\n");
+        offset += line_len + 1; // Move past the newline character
+    }
 
-        int table_index = catalog_number - 1;
+    // Index and pool share a single allocation
+    size_t index_size = num_names * sizeof(struct StarName);
+    struct StarName *index = malloc(index_size + pool_size + 1);
+    if (index == NULL)
+    {
+        printf("Allocation of memory for name table failed\n");
+        return false;
+    }
+    char *pool = (char *)index + index_size;
 
-        struct StarName temp_name;
-        temp_name.name = malloc(strlen(name) + 1);
-        if (temp_name.name == NULL)
+    // Second pass: copy names into the pool
+    unsigned int name_count = 0;
+    size_t pool_offset = 0;
+    offset = 0;
+    while (offset < data_len)
+    {
+        size_t line_len = 0;
+        while (offset + line_len < data_len && data[offset + line_len] != '\n')
         {
-            return false;
+            line_len++;
         }
-        strcpy(temp_name.name, name);
 
-        (*name_table_out)[table_index] = temp_name;
+        int catalog_number;
+        size_t name_start, name_len;
+        if (find_name_bounds(&data[offset], line_len, &catalog_number, &name_start, &name_len))
+        {
+            memcpy(&pool[pool_offset], &data[offset + name_start], name_len);
+            pool[pool_offset + name_len] = '\0';
+
+            index[name_count].catalog_number = catalog_number;
+            index[name_count].offset = (unsigned int)pool_offset;
+
+            name_count++;
+            pool_offset += name_len + 1;
+        }
+
+        offset += line_len + 1;
     }
 
+    // bsc5_names.txt is sorted alphabetically; sort by catalog number for lookup
+    qsort(index, num_names, sizeof(struct StarName), star_name_comparator);
+
+    name_table_out->index = index;
+    name_table_out->pool = pool;
+    name_table_out->num_names = num_names;
+
     return true;
 }
 
-/* Parse a single constellation entry, e.g.:
- *
- * CVn 1 4915 4785
- *
- * Adds the entry *constell_table_out[line_number]:
- *
- * struct Constell
- * {
- * num_segments=1
- * int *star_numbers=[4915, 4785]
- * };
- *
- * NOTE: line numbers are 0-indexed
- */
-#define MAX_BUF_SIZE 2048
-bool parse_line(const uint8_t *data, struct Constell **constell_table_out, int line_start, int line_end, int line_number)
+const char *star_name_lookup(const struct StarNameTable *name_table, int catalog_number)
 {
-    // Validate the input range
-    if (line_end <= line_start || data == NULL || constell_table_out == NULL)
+    if (name_table == NULL || name_table->index == NULL)
     {
-        return false;
+        return NULL;
     }
 
-    // Create a temporary buffer for the line data
-    size_t line_length = line_end - line_start + 1;
-    char buffer[MAX_BUF_SIZE];
-
-    // Copy the relevant data into the buffer (ensure null-termination)
-    memcpy(buffer, &data[line_start], line_length);
-    buffer[line_length] = '\0';
-
-    // Parse the line:
-    const char *name = strtok(buffer, " "); // First token is the constellation name
-    if (name == NULL)
+    struct StarName key = {.catalog_number = catalog_number};
+    const struct StarName *match =
+        bsearch(&key, name_table->index, name_table->num_names, sizeof(struct StarName), star_name_comparator);
+    if (match == NULL)
     {
-        return false; // Malformed line, no name found
+        return NULL;
     }
 
-    // The next token is the number of segments
-    const char *num_segments_str = strtok(NULL, " ");
-    if (num_segments_str == NULL)
-    {
-        return false; // Malformed line, no number of segments
-    }
+    return &name_table->pool[match->offset];
+}
 
-    unsigned int num_segments = atoi(num_segments_str);
-    if (num_segments == 0)
+/* Return the next whitespace delimited token in [*cursor, line_end), advancing
+ * the cursor past it. Returns NULL once the line is exhausted
+ */
+static const uint8_t *next_token(const uint8_t **cursor, const uint8_t *line_end, size_t *token_len)
+{
+    const uint8_t *p = *cursor;
+    while (p < line_end && (*p == ' ' || *p == '\t' || *p == '\r'))
     {
-        return false; // Invalid number of segments
+        p++;
     }
-
-    // Allocate memory for the star numbers
-    int *star_numbers = malloc(num_segments * 2 * sizeof(int)); // Each segment has two star numbers
-    if (star_numbers == NULL)
+    if (p >= line_end)
     {
-        return false; // Memory allocation failed
+        *cursor = p;
+        return NULL;
     }
 
-    // Parse the star numbers (expecting num_segments * 2 star numbers)
-    unsigned int i = 0;
-    const char *token;
-    while ((token = strtok(NULL, " ")) != NULL && i < num_segments * 2)
+    const uint8_t *token = p;
+    while (p < line_end && *p != ' ' && *p != '\t' && *p != '\r')
     {
-        star_numbers[i] = atoi(token);
-        ++i;
+        p++;
     }
 
-    // If we didn't get enough star numbers, it's an error
-    if (i != num_segments * 2)
-    {
-        free(star_numbers);
-        return false; // Malformed line, not enough star numbers
-    }
+    *token_len = (size_t)(p - token);
+    *cursor = p;
+    return token;
+}
 
-    // Allocate memory for the constellations table if necessary
-    if (*constell_table_out == NULL)
+/* Parse an unsigned decimal token. Returns false if the token is not a number
+ */
+static bool token_to_uint(const uint8_t *token, size_t token_len, unsigned int *value)
+{
+    unsigned int result = 0;
+    for (size_t i = 0; i < token_len; ++i)
     {
-        *constell_table_out = malloc(sizeof(struct Constell) * (line_number + 1));
-        if (*constell_table_out == NULL)
+        if (token[i] < '0' || token[i] > '9')
         {
-            free(star_numbers);
-            return false; // Memory allocation failed for the table
+            return false;
         }
+        result = result * 10 + (unsigned int)(token[i] - '0');
     }
-    else
+
+    *value = result;
+    return token_len > 0;
+}
+
+/* Parse the header of a single constellation entry, e.g.:
+ *
+ * CVn 1 4785 4915
+ *
+ * yields num_segments = 1 and leaves the cursor at the first star number.
+ */
+static bool parse_constell_header(const uint8_t **cursor, const uint8_t *line_end, unsigned int *num_segments)
+{
+    size_t token_len;
+
+    // First token is the constellation name
+    if (next_token(cursor, line_end, &token_len) == NULL)
     {
-        // Reallocate memory to accommodate new constellations
-        *constell_table_out = realloc(*constell_table_out, sizeof(struct Constell) * (line_number + 1));
-        if (*constell_table_out == NULL)
-        {
-            free(star_numbers);
-            return false; // Memory allocation failed for the table
-        }
+        return false; // Malformed line, no name found
     }
 
-    // Store the parsed constellation in the correct table location
-    struct Constell temp_constell = {.num_segments = num_segments, .star_numbers = star_numbers};
-
-    (*constell_table_out)[line_number] = temp_constell;
+    // The next token is the number of segments
+    const uint8_t *token = next_token(cursor, line_end, &token_len);
+    if (token == NULL || !token_to_uint(token, token_len, num_segments) || *num_segments == 0)
+    {
+        return false; // Malformed line, missing or invalid number of segments
+    }
 
     return true;
 }
 
-bool generate_constell_table(const uint8_t *data, size_t data_len, struct Constell **constell_table_out,
-                             unsigned int *num_constell_out)
+bool generate_constell_table(const uint8_t *data, size_t data_len, unsigned int num_stars,
+                             struct ConstellTable *constell_table_out)
 {
     // Validate input
-    if (data == NULL || constell_table_out == NULL || num_constell_out == NULL || data_len == 0)
+    if (data == NULL || constell_table_out == NULL || data_len == 0)
     {
         return false;
     }
 
-    unsigned int num_constells = 0;
-    size_t line_start = 0;
-    size_t line_end;
+    *constell_table_out = (struct ConstellTable){.num_constells = 0, .offsets = NULL, .endpoints = NULL};
 
-    // Count the number of lines in the data
-    for (size_t i = 0; i < data_len; ++i)
+    // First pass: count constellations and segments so the table is sized once
+    unsigned int num_constells = 0;
+    unsigned int num_segments_total = 0;
+    const uint8_t *data_end = data + data_len;
+    const uint8_t *line_start = data;
+    while (line_start < data_end)
     {
-        if (data[i] == '\n')
+        const uint8_t *line_end = memchr(line_start, '\n', (size_t)(data_end - line_start));
+        if (line_end == NULL)
+        {
+            line_end = data_end;
+        }
+
+        const uint8_t *cursor = line_start;
+        size_t token_len;
+        if (next_token(&cursor, line_end, &token_len) != NULL)
         {
+            cursor = line_start;
+            unsigned int num_segments;
+            if (!parse_constell_header(&cursor, line_end, &num_segments))
+            {
+                printf("Failed to parse line %u\n", num_constells);
+                return false;
+            }
+
             num_constells++;
+            num_segments_total += num_segments;
         }
+
+        line_start = line_end + 1;
     }
 
-    // Allocate memory for the constellation table
-    *constell_table_out = malloc(num_constells * sizeof(struct Constell));
-    if (*constell_table_out == NULL)
+    // Offsets and endpoints share a single allocation
+    size_t num_offsets = (size_t)num_constells + 1;
+    size_t num_endpoints = (size_t)num_segments_total * 2;
+    unsigned int *offsets = malloc((num_offsets + num_endpoints) * sizeof(unsigned int));
+    if (offsets == NULL)
     {
         printf("Allocation of memory for constellation table failed\n");
         return false;
     }
+    unsigned int *endpoints = offsets + num_offsets;
 
-    // Parse each line of data
-    int line_number = 0;
-    for (size_t i = 0; i < data_len; ++i)
+    // Second pass: fill offsets and resolve star numbers to table indices
+    unsigned int constell = 0;
+    unsigned int segment = 0;
+    line_start = data;
+    while (line_start < data_end)
     {
-        // Find the start of the current line
-        if (i == 0 || data[i - 1] == '\n')
+        const uint8_t *line_end = memchr(line_start, '\n', (size_t)(data_end - line_start));
+        if (line_end == NULL)
         {
-            line_start = i;
+            line_end = data_end;
         }
 
-        // Find the end of the current line
-        if (i == data_len - 1 || data[i] == '\n')
+        const uint8_t *cursor = line_start;
+        size_t token_len;
+        if (next_token(&cursor, line_end, &token_len) != NULL)
         {
-            line_end = i;
+            cursor = line_start;
+            unsigned int num_segments;
+            parse_constell_header(&cursor, line_end, &num_segments);
+
+            offsets[constell] = segment;
 
-            // Parse the line and store the parsed constellation in the table
-            if (!parse_line(data, constell_table_out, line_start, line_end, line_number))
+            // Expect exactly num_segments * 2 star numbers
+            unsigned int num_read = 0;
+            const uint8_t *token;
+            while ((token = next_token(&cursor, line_end, &token_len)) != NULL)
             {
-                printf("Failed to parse line %d\n", line_number);
-                return false;
+                unsigned int catalog_num;
+                if (num_read == num_segments * 2 || !token_to_uint(token, token_len, &catalog_num) || catalog_num == 0 ||
+                    catalog_num > num_stars)
+                {
+                    printf("Failed to parse line %u\n", constell);
+                    free(offsets);
+                    return false; // Too many or invalid star numbers
+                }
+
+                endpoints[segment * 2 + num_read] = catalog_num - 1;
+                num_read++;
             }
 
-            line_number++; // Increment line number
+            if (num_read != num_segments * 2)
+            {
+                printf("Failed to parse line %u\n", constell);
+                free(offsets);
+                return false; // Malformed line, not enough star numbers
+            }
+
+            segment += num_segments;
+            constell++;
         }
+
+        line_start = line_end + 1;
     }
+    offsets[num_constells] = segment;
 
-    // Set the number of constellations in the output parameter
-    *num_constell_out = num_constells;
+    constell_table_out->num_constells = num_constells;
+    constell_table_out->offsets = offsets;
+    constell_table_out->endpoints = endpoints;
 
     return true;
 }
 
 // Memory freeing
 
-void free_constell_members(struct Constell constell_data)
-{
-    if (constell_data.star_numbers != NULL)
-    {
-        free(constell_data.star_numbers);
-    }
-    return;
-}
-
-void free_star_name_members(struct StarName name_data)
-{
-    if (name_data.name != NULL)
-    {
-        free(name_data.name);
-    }
-    return;
-}
-
 void free_stars(struct Star *star_table, unsigned int size)
 {
     (void)size;
@@ -412,70 +520,129 @@ void free_moon_object(struct Moon moon_data)
     return;
 }
 
-void free_constells(struct Constell *constell_table, unsigned int size)
+void free_constells(struct ConstellTable *constell_table)
 {
-    for (unsigned int i = 0; i < size; i++)
-    {
-        free_constell_members(constell_table[i]);
-    }
-    free(constell_table);
+    // Endpoints live in the same allocation as the offsets
+    free(constell_table->offsets);
+    constell_table->offsets = NULL;
+    constell_table->endpoints = NULL;
+    constell_table->num_constells = 0;
     return;
 }
 
-void free_star_names(struct StarName *name_table, unsigned int size)
+void free_star_names(struct StarNameTable *name_table)
 {
-    for (unsigned int i = 0; i < size; ++i)
-    {
-        free_star_name_members(name_table[i]);
-    }
-    free(name_table);
+    // The pool lives in the same allocation as the index
+    free(name_table->index);
+    name_table->index = NULL;
+    name_table->pool = NULL;
+    name_table->num_names = 0;
     return;
 }
 
 // Miscellaneous
 
-int star_magnitude_comparator(const void *v1, const void *v2)
+/* Map a magnitude to a 16 bit radix key. Magnitudes are quantized to
+ * centimagnitudes (the precision of BSC5) and inverted so that ascending keys
+ * correspond to decreasing magnitude, i.e. dimmest stars first
+ */
+static uint16_t magnitude_radix_key(float magnitude)
 {
-    const struct Star *p1 = (struct Star *)v1;
-    const struct Star *p2 = (struct Star *)v2;
-
-    // Lower magnitudes are brighter
-    if (p1->magnitude < p2->magnitude)
-        return +1;
-    else if (p1->magnitude > p2->magnitude)
-        return -1;
-    else
-        return 0;
+    long centimag = lroundf(magnitude * 100.0f);
+    if (centimag < INT16_MIN)
+    {
+        centimag = INT16_MIN;
+    }
+    else if (centimag > INT16_MAX)
+    {
+        centimag = INT16_MAX;
+    }
+
+    return (uint16_t)(INT16_MAX - centimag);
 }
 
-bool star_numbers_by_magnitude(int **num_by_mag, const struct Star *star_table, unsigned int num_stars)
+bool star_indices_by_magnitude(unsigned int **idx_by_mag, const struct Star *star_table, unsigned int num_stars)
 {
-    // Create and sort a copy of the star table
-    struct Star *table_copy = malloc(num_stars * sizeof(struct Star));
-    if (table_copy == NULL)
+    *idx_by_mag = malloc(num_stars * sizeof(unsigned int));
+    if (*idx_by_mag == NULL)
     {
-        printf("Allocation of memory for star table copy failed\n");
+        printf("Allocation of memory for idx by mag array failed\n");
         return false;
     }
 
-    memcpy(table_copy, star_table, num_stars * sizeof(*table_copy));
-    qsort(table_copy, num_stars, sizeof(struct Star), star_magnitude_comparator);
-
-    // Create and fill array of indices in table copy
-    *num_by_mag = malloc(num_stars * sizeof(int));
-    if (*num_by_mag == NULL)
+    // Keys and a scratch buffer for ping-ponging (key, index) pairs between
+    // passes. Everything is much smaller than a copy of the star table
+    uint16_t *keys = malloc(num_stars * 2 * sizeof(uint16_t));
+    unsigned int *scratch_indices = malloc(num_stars * sizeof(unsigned int));
+    if (keys == NULL || scratch_indices == NULL)
     {
-        printf("Allocation of memory for num by mag array failed\n");
-        free(table_copy);
+        printf("Allocation of memory for magnitude sort keys failed\n");
+        free(keys);
+        free(scratch_indices);
+        free(*idx_by_mag);
+        *idx_by_mag = NULL;
         return false;
     }
+    uint16_t *scratch_keys = keys + num_stars;
 
     for (unsigned int i = 0; i < num_stars; ++i)
     {
-        (*num_by_mag)[i] = table_copy[i].catalog_number;
+        keys[i] = magnitude_radix_key(star_table[i].magnitude);
+        (*idx_by_mag)[i] = i;
+    }
+
+    // Stable LSD radix sort over two 8 bit digits. Ties keep catalog order
+    uint16_t *src_keys = keys;
+    uint16_t *dst_keys = scratch_keys;
+    unsigned int *src_indices = *idx_by_mag;
+    unsigned int *dst_indices = scratch_indices;
+
+    for (unsigned int shift = 0; shift < 16; shift += 8)
+    {
+        unsigned int counts[256] = {0};
+        for (unsigned int i = 0; i < num_stars; ++i)
+        {
+            counts[(src_keys[i] >> shift) & 0xFF]++;
+        }
+
+        // Skip the pass if every key shares this digit
+        if (num_stars == 0 || counts[(src_keys[0] >> shift) & 0xFF] == num_stars)
+        {
+            continue;
+        }
+
+        unsigned int position = 0;
+        for (unsigned int digit = 0; digit < 256; ++digit)
+        {
+            unsigned int count = counts[digit];
+            counts[digit] = position;
+            position += count;
+        }
+
+        for (unsigned int i = 0; i < num_stars; ++i)
+        {
+            unsigned int dst = counts[(src_keys[i] >> shift) & 0xFF]++;
+            dst_keys[dst] = src_keys[i];
+            dst_indices[dst] = src_indices[i];
+        }
+
+        uint16_t *temp_keys = src_keys;
+        src_keys = dst_keys;
+        dst_keys = temp_keys;
+
+        unsigned int *temp_indices = src_indices;
+        src_indices = dst_indices;
+        dst_indices = temp_indices;
+    }
+
+    // An odd number of passes leaves the result in the scratch buffer
+    if (src_indices != *idx_by_mag)
+    {
+        memcpy(*idx_by_mag, src_indices, num_stars * sizeof(unsigned int));
     }
 
-    free(table_copy);
+    free(keys);
+    free(scratch_indices);
 
     return true;
 }
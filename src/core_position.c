@@ -3,8 +3,46 @@
 #include "astro.h"
 #include "coord.h"
 #include "core.h"
+#include "macros.h"
+#include "sky_index.h"
+#include "visibility.h"
 
 #include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Extra slack when culling cells against the horizon (radians)
+#define CULL_EPSILON 1.0E-3
+
+// How many stars ahead to prefetch when walking the members of a cell
+#define PREFETCH_DISTANCE 8
+#if defined(__GNUC__) || defined(__clang__)
+#define PREFETCH(addr) __builtin_prefetch(addr)
+#else
+#define PREFETCH(addr) ((void)(addr))
+#endif
+
+// Bound on the screen error, in projection radii, of stepping a unit vector
+// along its tangent and renormalizing, per (radian of hour angle)^2. The step
+// is off by sin(2 * declination) / 4 radians, largest at declinations of ±45°,
+// and no projection stretches angles above the horizon by more than a radius
+// per radian. This is the bound of 1/4 with a margin
+#define EXTRAPOLATION_ERROR_FACTOR 0.3
+
+// Longest round-robin period, so every star is still recomputed every few
+// seconds
+#define MAX_UPDATE_PERIOD 64
+
+static void update_star_position(struct ObjectBase *base, double catalog_ra, double ra_motion, double catalog_dec,
+                                 double dec_motion, double julian_date, double gmst, double latitude, double longitude)
+{
+    double right_ascension, declination;
+    calc_star_position(catalog_ra, ra_motion, catalog_dec, dec_motion, julian_date, &right_ascension, &declination);
+
+    equatorial_to_horizontal_unit(right_ascension, declination, gmst, latitude, longitude, &base->east, &base->north,
+                                  &base->up);
+}
 
 void update_star_positions(struct Star *star_table, int num_stars, double julian_date, double latitude, double longitude)
 {
@@ -14,22 +52,325 @@ void update_star_positions(struct Star *star_table, int num_stars, double julian
     for (i = 0; i < num_stars; ++i)
     {
         struct Star *star = &star_table[i];
+        update_star_position(&star->base, star->right_ascension, star->ra_motion, star->declination, star->dec_motion,
+                             julian_date, gmst, latitude, longitude);
+    }
 
-        double right_ascension, declination;
-        calc_star_position(star->right_ascension, star->ra_motion, star->declination, star->dec_motion, julian_date,
-                           &right_ascension, &declination);
+    return;
+}
 
-        // Convert to horizontal coordinates
-        double azimuth, altitude;
-        equatorial_to_horizontal(right_ascension, declination, gmst, latitude, longitude, &azimuth, &altitude);
+void update_star_positions_indexed(struct Star *star_table, struct SkyIndex *index, double julian_date, double latitude,
+                                   double longitude)
+{
+    double gmst = greenwich_mean_sidereal_time_rad(julian_date);
+    double local_sidereal_time = fmod(gmst + longitude, 2.0 * M_PI);
+
+    // Proper motion may carry a star out of its cell over time
+    const double J2000 = 2451545.0;
+    double years_from_epoch = fabs(julian_date - J2000) / 365.2425;
+
+    // Stars that never rise at this latitude are skipped entirely
+    if (sky_index_needs_classify(index, latitude, julian_date))
+    {
+        sky_index_classify(index, star_table, latitude, julian_date);
+    }
+
+    for (unsigned int c = 0; c < index->num_cells; ++c)
+    {
+        unsigned int first = index->cell_offsets[c];
+        unsigned int last = index->cell_active_end[c];
+        if (first == last)
+        {
+            // Every member is already parked
+            continue;
+        }
+
+        const struct SkyCell *cell = &index->cells[c];
+        double margin = cell->max_motion * years_from_epoch + CULL_EPSILON;
+        bool visible = !sky_cell_below_horizon(cell, local_sidereal_time, latitude, margin);
+
+        if (visible)
+        {
+            for (unsigned int i = first; i < last; ++i)
+            {
+                // Coordinates are read in cell order, but results are scattered
+                // back into the star table, so fetch the destination ahead
+                if (i + PREFETCH_DISTANCE < last)
+                {
+                    PREFETCH(&star_table[index->star_indices[i + PREFETCH_DISTANCE]].base);
+                }
+
+                const struct SkyEntry *entry = &index->entries[i];
+                update_star_position(&star_table[index->star_indices[i]].base, entry->right_ascension, entry->ra_motion,
+                                     entry->declination, entry->dec_motion, julian_date, gmst, latitude, longitude);
+            }
+        }
+        else if (index->cell_visible[c])
+        {
+            // Just set: park the stars at the nadir so they are not rendered
+            for (unsigned int i = first; i < last; ++i)
+            {
+                struct ObjectBase *base = &star_table[index->star_indices[i]].base;
+                base->east = 0.0;
+                base->north = 0.0;
+                base->up = -1.0;
+            }
+        }
+
+        index->cell_visible[c] = visible;
+    }
+
+    for (unsigned int i = 0; i < index->num_pinned; ++i)
+    {
+        struct Star *star = &star_table[index->pinned[i]];
+        update_star_position(&star->base, star->right_ascension, star->ra_motion, star->declination, star->dec_motion,
+                             julian_date, gmst, latitude, longitude);
+    }
 
-        star->base.azimuth = azimuth;
-        star->base.altitude = altitude;
+    return;
+}
+
+void update_star_positions_in_cap(struct Star *star_table, struct SkyIndex *index, double julian_date, double latitude,
+                                  double longitude, double right_ascension, double declination, double radius)
+{
+    double gmst = greenwich_mean_sidereal_time_rad(julian_date);
+    double local_sidereal_time = fmod(gmst + longitude, 2.0 * M_PI);
+
+    const double J2000 = 2451545.0;
+    double years_from_epoch = fabs(julian_date - J2000) / 365.2425;
+
+    if (sky_index_needs_classify(index, latitude, julian_date))
+    {
+        sky_index_classify(index, star_table, latitude, julian_date);
+    }
+
+    // Cells are selected with the largest motion of any star, then culled
+    // against the horizon with their own
+    double max_margin = index->max_motion * years_from_epoch + CULL_EPSILON;
+    sky_index_select_cap(index, right_ascension, declination, radius, max_margin);
+
+    unsigned int num_updated = 0;
+    for (unsigned int k = 0; k < index->num_selected; ++k)
+    {
+        unsigned int c = index->selected_cells[k];
+        unsigned int first = index->cell_offsets[c];
+        unsigned int last = index->cell_active_end[c];
+
+        const struct SkyCell *cell = &index->cells[c];
+        double margin = cell->max_motion * years_from_epoch + CULL_EPSILON;
+        if (first == last || sky_cell_below_horizon(cell, local_sidereal_time, latitude, margin))
+        {
+            continue;
+        }
+
+        for (unsigned int i = first; i < last; ++i)
+        {
+            if (i + PREFETCH_DISTANCE < last)
+            {
+                PREFETCH(&star_table[index->star_indices[i + PREFETCH_DISTANCE]].base);
+            }
+
+            const struct SkyEntry *entry = &index->entries[i];
+            update_star_position(&star_table[index->star_indices[i]].base, entry->right_ascension, entry->ra_motion,
+                                 entry->declination, entry->dec_motion, julian_date, gmst, latitude, longitude);
+        }
+
+        // Members now hold positions that may be above the horizon, so the
+        // next full update must either refresh or park them
+        index->cell_visible[c] = true;
+        index->selected_cells[num_updated++] = c;
+    }
+    index->num_selected = num_updated;
+
+    for (unsigned int i = 0; i < index->num_pinned; ++i)
+    {
+        struct Star *star = &star_table[index->pinned[i]];
+        update_star_position(&star->base, star->right_ascension, star->ra_motion, star->declination, star->dec_motion,
+                             julian_date, gmst, latitude, longitude);
+    }
+
+    return;
+}
+
+void update_tile_star_positions(struct TileCatalog *catalog, double julian_date, double latitude, double longitude)
+{
+    double gmst = greenwich_mean_sidereal_time_rad(julian_date);
+
+    for (unsigned int k = 0; k < catalog->num_frame; ++k)
+    {
+        const struct TileSnapshot *snapshot = &catalog->frame[k];
+        for (unsigned int i = 0; i < snapshot->count; ++i)
+        {
+            struct Star *star = &snapshot->stars[i];
+            update_star_position(&star->base, star->right_ascension, star->ra_motion, star->declination,
+                                 star->dec_motion, julian_date, gmst, latitude, longitude);
+        }
     }
 
     return;
 }
 
+void update_star_positions_scheduled(struct Star *star_table, struct VisibilityScheduler *scheduler, double julian_date,
+                                     double latitude, double longitude)
+{
+    visibility_scheduler_advance(scheduler, star_table, julian_date, latitude, longitude);
+
+    double gmst = greenwich_mean_sidereal_time_rad(julian_date);
+
+    unsigned int rank = visibility_scheduler_next(scheduler, 0);
+    while (rank < scheduler->num_stars)
+    {
+        struct Star *star = &star_table[scheduler->idx_by_mag[rank]];
+        update_star_position(&star->base, star->right_ascension, star->ra_motion, star->declination, star->dec_motion,
+                             julian_date, gmst, latitude, longitude);
+
+        rank = visibility_scheduler_next(scheduler, rank + 1);
+    }
+
+    return;
+}
+
+void update_pinned_star_positions(struct Star *star_table, const struct VisibilityScheduler *scheduler,
+                                  double julian_date, double latitude, double longitude)
+{
+    double gmst = greenwich_mean_sidereal_time_rad(julian_date);
+
+    unsigned int rank = visibility_scheduler_next_pinned(scheduler, 0);
+    while (rank < scheduler->num_stars)
+    {
+        struct Star *star = &star_table[scheduler->idx_by_mag[rank]];
+        update_star_position(&star->base, star->right_ascension, star->ra_motion, star->declination, star->dec_motion,
+                             julian_date, gmst, latitude, longitude);
+
+        rank = visibility_scheduler_next_pinned(scheduler, rank + 1);
+    }
+
+    return;
+}
+
+bool generate_star_extrapolation(struct StarExtrapolation *extrapolation, unsigned int num_stars)
+{
+    memset(extrapolation, 0, sizeof(struct StarExtrapolation));
+    extrapolation->motions = malloc(num_stars * sizeof(struct StarMotion));
+    if (extrapolation->motions == NULL && num_stars > 0)
+    {
+        printf("Allocation of memory for star extrapolation failed\n");
+        return false;
+    }
+
+    extrapolation->num_stars = num_stars;
+    extrapolation->period = 1;
+    extrapolation->julian_date = -INFINITY;
+    for (unsigned int i = 0; i < num_stars; ++i)
+    {
+        extrapolation->motions[i].julian_date = -INFINITY;
+    }
+
+    return true;
+}
+
+unsigned int amortized_update_period(double frame_step, double radius_cells)
+{
+    // Extrapolating over t days misplaces a star by at most
+    // EXTRAPOLATION_ERROR_FACTOR * (ωt)^2 * radius_cells cells. Allow one
+    // extra frame of age since stars are recomputed after, not at, `period`
+    double angular_step = 2.0 * M_PI * SIDEREAL_RATE * fabs(frame_step);
+    double max_angle = sqrt(0.5 / (EXTRAPOLATION_ERROR_FACTOR * fmax(radius_cells, 1.0)));
+    double period = angular_step > 0.0 ? floor(max_angle / angular_step) - 1.0 : MAX_UPDATE_PERIOD;
+
+    return (unsigned int)fmax(1.0, fmin(period, MAX_UPDATE_PERIOD));
+}
+
+/* Recompute a star exactly and record its position for later extrapolation
+ */
+static void compute_star_motion(struct Star *star, struct StarMotion *motion, double julian_date, double gmst,
+                                double latitude, double longitude)
+{
+    update_star_position(&star->base, star->right_ascension, star->ra_motion, star->declination, star->dec_motion,
+                         julian_date, gmst, latitude, longitude);
+
+    *motion = (struct StarMotion){
+        .julian_date = julian_date,
+        .east = star->base.east,
+        .north = star->base.north,
+        .up = star->base.up,
+    };
+}
+
+void update_star_positions_amortized(struct Star *star_table, struct VisibilityScheduler *scheduler,
+                                     struct StarExtrapolation *extrapolation, double julian_date, double latitude,
+                                     double longitude, double radius_cells)
+{
+    visibility_scheduler_advance(scheduler, star_table, julian_date, latitude, longitude);
+
+    // Stored motions are only valid going forwards for the same observer
+    if (latitude != extrapolation->latitude || longitude != extrapolation->longitude ||
+        julian_date < extrapolation->julian_date)
+    {
+        for (unsigned int i = 0; i < extrapolation->num_stars; ++i)
+        {
+            extrapolation->motions[i].julian_date = -INFINITY;
+        }
+        extrapolation->latitude = latitude;
+        extrapolation->longitude = longitude;
+    }
+
+    double frame_step = julian_date - extrapolation->julian_date;
+    unsigned int period = amortized_update_period(frame_step, radius_cells);
+    double max_age = (period + 0.5) * frame_step;
+    unsigned int phase = (unsigned int)(extrapolation->frame % period);
+
+    double gmst = greenwich_mean_sidereal_time_rad(julian_date);
+
+    // The sky turns about the celestial pole, which points North at the
+    // altitude of the latitude, by one turn per sidereal day
+    double turn_rate = 2.0 * M_PI * SIDEREAL_RATE;
+    double pole_north = cos(latitude);
+    double pole_up = sin(latitude);
+
+    unsigned int rank = visibility_scheduler_next(scheduler, 0);
+    while (rank < scheduler->num_stars)
+    {
+        struct Star *star = &star_table[scheduler->idx_by_mag[rank]];
+        struct StarMotion *motion = &extrapolation->motions[rank];
+
+        // Stars that just rose or were skipped when the period changed are
+        // stale
+        double age = julian_date - motion->julian_date;
+        if (rank % period == phase || age > max_age)
+        {
+            compute_star_motion(star, motion, julian_date, gmst, latitude, longitude);
+        }
+        else
+        {
+            // Step along the velocity, the position crossed with the pole, and
+            // return to the unit sphere
+            double angle = turn_rate * age;
+            double east = motion->east + angle * (motion->north * pole_up - motion->up * pole_north);
+            double north = motion->north - angle * motion->east * pole_up;
+            double up = motion->up + angle * motion->east * pole_north;
+            double inv_norm = 1.0 / sqrt(east * east + north * north + up * up);
+            star->base.east = east * inv_norm;
+            star->base.north = north * inv_norm;
+            star->base.up = up * inv_norm;
+        }
+
+        rank = visibility_scheduler_next(scheduler, rank + 1);
+    }
+
+    extrapolation->period = period;
+    extrapolation->frame++;
+    extrapolation->julian_date = julian_date;
+
+    return;
+}
+
+void free_star_extrapolation(struct StarExtrapolation *extrapolation)
+{
+    free(extrapolation->motions);
+    memset(extrapolation, 0, sizeof(struct StarExtrapolation));
+}
+
 void update_planet_positions(struct Planet *planet_table, double julian_date, double latitude, double longitude)
 {
     double gmst = greenwich_mean_sidereal_time_rad(julian_date);
@@ -70,11 +411,9 @@ void update_planet_positions(struct Planet *planet_table, double julian_date, do
         double right_ascension, declination;
         equatorial_rectangular_to_spherical(xg, yg, zg, &right_ascension, &declination);
 
-        double azimuth, altitude;
-        equatorial_to_horizontal(right_ascension, declination, gmst, latitude, longitude, &azimuth, &altitude);
-
-        planet_table[i].base.azimuth = azimuth;
-        planet_table[i].base.altitude = altitude;
+        struct ObjectBase *base = &planet_table[i].base;
+        equatorial_to_horizontal_unit(right_ascension, declination, gmst, latitude, longitude, &base->east,
+                                      &base->north, &base->up);
     }
 }
 
@@ -89,11 +428,9 @@ void update_moon_position(struct Moon *moon_object, double julian_date, double l
     double right_ascension, declination;
     equatorial_rectangular_to_spherical(xg, yg, zg, &right_ascension, &declination);
 
-    double azimuth, altitude;
-    equatorial_to_horizontal(right_ascension, declination, gmst, latitude, longitude, &azimuth, &altitude);
-
-    moon_object->base.azimuth = azimuth;
-    moon_object->base.altitude = altitude;
+    struct ObjectBase *base = &moon_object->base;
+    equatorial_to_horizontal_unit(right_ascension, declination, gmst, latitude, longitude, &base->east, &base->north,
+                                  &base->up);
 
     return;
 }
@@ -1,163 +1,498 @@
 #include "core_render.h"
 #include "macros.h"
 
+#include "canvas.h"
 #include "coord.h"
 #include "core.h"
 #include "drawing.h"
-#include "term.h"
+#include "projection_cache.h"
+#include "view.h"
+#include "visibility.h"
 
-#include <curses.h>
 #include <math.h>
 #include <stdlib.h>
 
-void horizontal_to_polar(double azimuth, double altitude, double *radius, double *theta)
+/* Find the cell an object is drawn at, on the whole sky projection or in the
+ * zoomed view. Returns false if it lies outside the projection
+ */
+static bool object_to_win(const struct ObjectBase *object, const struct Conf *config, const struct View *view,
+                          int height, int width, int *y, int *x)
 {
-    double theta_sphere, phi_sphere;
-    horizontal_to_spherical(azimuth, altitude, &theta_sphere, &phi_sphere);
-
-    project_stereographic_north(1.0, theta_sphere, phi_sphere, radius, theta);
-
-    return;
-}
-
-void render_object_stereo(WINDOW *win, struct ObjectBase *object, const struct Conf *config)
-{
-    double radius_polar, theta_polar;
-    horizontal_to_polar(object->azimuth, object->altitude, &radius_polar, &theta_polar);
-
-    int y, x;
-    int height, width;
-    getmaxyx(win, height, width);
-    polar_to_win(radius_polar, theta_polar, height, width, &y, &x);
+    // Objects below the horizon always lie outside the projection
+    if (object->up < 0.0)
+    {
+        return false;
+    }
 
-    // If outside projection, ignore
-    if (fabs(radius_polar) > 1)
+    if (view->zoomed)
     {
-        return;
+        double plane_x, plane_y;
+        return view_project(view, object->east, object->north, object->up, &plane_x, &plane_y) &&
+               view_plane_to_win(plane_x, plane_y, height, width, y, x);
     }
+    return project_unit_vector(config->projection, object->east, object->north, object->up, height, width, y, x);
+}
 
+static void draw_object(struct Canvas *canvas, const struct ObjectBase *object, const struct Conf *config, int y, int x)
+{
     bool use_color = config->color && object->color_pair != 0;
 
     if (use_color)
     {
-        wattron(win, COLOR_PAIR(object->color_pair));
+        canvas_set_color(canvas, object->color_pair);
     }
 
     // Draw object
     if (config->unicode)
     {
-        mvwaddstr(win, y, x, object->symbol_unicode);
+        canvas_put_str(canvas, y, x, object->symbol_unicode);
     }
     else
     {
-        mvwaddch(win, y, x, object->symbol_ASCII);
+        canvas_put_char(canvas, y, x, object->symbol_ASCII);
     }
 
     // Draw label
     if (object->label != NULL)
     {
-        mvwaddstr_truncate(win, y - 1, x + 1, object->label);
+        canvas_put_str(canvas, y - 1, x + 1, object->label);
     }
 
     if (use_color)
     {
-        wattroff(win, COLOR_PAIR(object->color_pair));
+        canvas_set_color(canvas, 0);
     }
 
     return;
 }
 
-void render_stars_stereo(WINDOW *win, const struct Conf *config, struct Star *star_table, int num_stars, const int *num_by_mag)
+void render_object_stereo(struct Canvas *canvas, struct ObjectBase *object, const struct Conf *config,
+                          const struct View *view)
+{
+    int y, x;
+    int height = canvas->height;
+    int width = canvas->width;
+
+    if (object_to_win(object, config, view, height, width, &y, &x))
+    {
+        draw_object(canvas, object, config, y, x);
+    }
+
+    return;
+}
+
+// Stars are projected this many at a time so the projection kernel runs over
+// arrays
+#define STAR_BATCH_SIZE 256
+
+struct StarBatch
 {
+    unsigned int count;
+    unsigned int star_indices[STAR_BATCH_SIZE];
+    double east[STAR_BATCH_SIZE];
+    double north[STAR_BATCH_SIZE];
+    double up[STAR_BATCH_SIZE];
+    int rows[STAR_BATCH_SIZE];
+    int cols[STAR_BATCH_SIZE];
+};
+
+/* Project and draw the batched stars in the order they were added, recording
+ * them into the cache slot while `recording` is set
+ */
+static void flush_star_batch(struct Canvas *canvas, const struct Conf *config, struct Star *star_table,
+                             struct StarBatch *batch, int height, int width, struct ProjectionCache *cache,
+                             struct CacheSlot *slot, bool *recording)
+{
+    project_unit_vectors(config->projection, batch->east, batch->north, batch->up, batch->count, height, width,
+                         batch->rows, batch->cols);
+
+    for (unsigned int i = 0; i < batch->count; ++i)
+    {
+        unsigned int star_index = batch->star_indices[i];
+        draw_object(canvas, &star_table[star_index].base, config, batch->rows[i], batch->cols[i]);
+        *recording = *recording && projection_cache_append(cache, slot, star_index, batch->rows[i], batch->cols[i]);
+    }
+
+    batch->count = 0;
+}
+
+/* Add a star to the batch if it is bright enough and above the horizon,
+ * drawing the batch once it is full
+ */
+static void batch_star(struct Canvas *canvas, const struct Conf *config, struct Star *star_table,
+                       unsigned int star_index, struct StarBatch *batch, int height, int width,
+                       struct ProjectionCache *cache, struct CacheSlot *slot, bool *recording)
+{
+    struct Star *star = &star_table[star_index];
+
+    if (star->magnitude > config->threshold || star->base.up < 0.0)
+    {
+        return;
+    }
+
+    unsigned int i = batch->count++;
+    batch->star_indices[i] = star_index;
+    batch->east[i] = star->base.east;
+    batch->north[i] = star->base.north;
+    batch->up[i] = star->base.up;
+
+    if (batch->count == STAR_BATCH_SIZE)
+    {
+        flush_star_batch(canvas, config, star_table, batch, height, width, cache, slot, recording);
+    }
+}
+
+void render_stars_stereo(struct Canvas *canvas, const struct Conf *config, struct Star *star_table, int num_stars,
+                         const unsigned int *idx_by_mag)
+{
+    int height = canvas->height;
+    int width = canvas->width;
+
+    struct StarBatch batch;
+    batch.count = 0;
+    bool recording = false;
+
     int i;
     for (i = 0; i < num_stars; ++i)
     {
-        int catalog_num = num_by_mag[i];
-        int table_index = catalog_num - 1;
+        batch_star(canvas, config, star_table, idx_by_mag[i], &batch, height, width, NULL, NULL, &recording);
+    }
+    flush_star_batch(canvas, config, star_table, &batch, height, width, NULL, NULL, &recording);
 
-        struct Star *star = &star_table[table_index];
+    return;
+}
+
+void render_visible_stars_stereo(struct Canvas *canvas, const struct Conf *config, struct Star *star_table,
+                                 const struct VisibilityScheduler *scheduler, struct ProjectionCache *cache,
+                                 struct CacheSlot *slot)
+{
+    int height = canvas->height;
+    int width = canvas->width;
+
+    struct StarBatch batch;
+    batch.count = 0;
+    // Slots that did not fit once are drawn without recording from then on
+    bool record = cache != NULL && slot != NULL && !slot->uncacheable;
+    bool recording = record;
+
+    unsigned int rank = visibility_scheduler_next(scheduler, 0);
+    while (rank < scheduler->num_stars)
+    {
+        batch_star(canvas, config, star_table, scheduler->idx_by_mag[rank], &batch, height, width, cache, slot,
+                   &recording);
+        rank = visibility_scheduler_next(scheduler, rank + 1);
+    }
+    flush_star_batch(canvas, config, star_table, &batch, height, width, cache, slot, &recording);
+
+    if (record)
+    {
+        projection_cache_finish(cache, slot, recording);
+    }
+
+    return;
+}
+
+// A star found in a zoomed view
+struct ViewStar
+{
+    float magnitude;
+    int catalog_number;
+    struct Star *star;
+    int row;
+    int col;
+};
+
+static int compare_view_stars(const void *a, const void *b)
+{
+    const struct ViewStar *star_a = a;
+    const struct ViewStar *star_b = b;
+
+    // Dimmest first so brighter stars are drawn on top, as with idx_by_mag
+    if (star_a->magnitude != star_b->magnitude)
+    {
+        return star_a->magnitude < star_b->magnitude ? 1 : -1;
+    }
+    return (star_a->catalog_number > star_b->catalog_number) - (star_a->catalog_number < star_b->catalog_number);
+}
+
+/* Append a star to `found` if it is bright enough and lands in the window
+ */
+static void find_view_star(struct Star *star, const struct Conf *config, const struct View *view, int height,
+                           int width, struct ViewStar *found, unsigned int *num_found)
+{
+    if (star->magnitude > config->threshold)
+    {
+        return;
+    }
+
+    int y, x;
+    if (object_to_win(&star->base, config, view, height, width, &y, &x))
+    {
+        found[(*num_found)++] = (struct ViewStar){
+            .magnitude = star->magnitude,
+            .catalog_number = star->catalog_number,
+            .star = star,
+            .row = y,
+            .col = x,
+        };
+    }
+}
+
+/* Draw the stars found in a zoomed view in magnitude order
+ */
+static void draw_view_stars(struct Canvas *canvas, const struct Conf *config, struct ViewStar *found,
+                            unsigned int num_found)
+{
+    // Stars are found in sky order, so restore the magnitude order
+    qsort(found, num_found, sizeof(struct ViewStar), compare_view_stars);
 
-        if (star->magnitude > config->threshold)
+    for (unsigned int i = 0; i < num_found; ++i)
+    {
+        draw_object(canvas, &found[i].star->base, config, found[i].row, found[i].col);
+    }
+}
+
+void render_stars_in_view(struct Canvas *canvas, const struct Conf *config, const struct View *view,
+                          struct Star *star_table, const struct SkyIndex *index)
+{
+    int height = canvas->height;
+    int width = canvas->width;
+
+    unsigned int max_stars = 0;
+    for (unsigned int k = 0; k < index->num_selected; ++k)
+    {
+        unsigned int c = index->selected_cells[k];
+        max_stars += index->cell_active_end[c] - index->cell_offsets[c];
+    }
+    if (max_stars == 0)
+    {
+        return;
+    }
+
+    struct ViewStar *found = malloc(max_stars * sizeof(struct ViewStar));
+    if (found == NULL)
+    {
+        return;
+    }
+
+    unsigned int num_found = 0;
+    for (unsigned int k = 0; k < index->num_selected; ++k)
+    {
+        unsigned int c = index->selected_cells[k];
+        for (unsigned int i = index->cell_offsets[c]; i < index->cell_active_end[c]; ++i)
         {
-            continue;
+            find_view_star(&star_table[index->star_indices[i]], config, view, height, width, found, &num_found);
         }
+    }
+
+    draw_view_stars(canvas, config, found, num_found);
+    free(found);
+
+    return;
+}
+
+void render_tile_stars_in_view(struct Canvas *canvas, const struct Conf *config, const struct View *view,
+                               const struct TileCatalog *catalog)
+{
+    int height = canvas->height;
+    int width = canvas->width;
+
+    unsigned int max_stars = 0;
+    for (unsigned int k = 0; k < catalog->num_frame; ++k)
+    {
+        max_stars += catalog->frame[k].count;
+    }
+    if (max_stars == 0)
+    {
+        return;
+    }
+
+    struct ViewStar *found = malloc(max_stars * sizeof(struct ViewStar));
+    if (found == NULL)
+    {
+        return;
+    }
 
-        // FIXME: this is hacky
-        if (star->magnitude > config->label_thresh)
+    unsigned int num_found = 0;
+    for (unsigned int k = 0; k < catalog->num_frame; ++k)
+    {
+        const struct TileSnapshot *snapshot = &catalog->frame[k];
+        for (unsigned int i = 0; i < snapshot->count; ++i)
         {
-            star->base.label = NULL;
+            find_view_star(&snapshot->stars[i], config, view, height, width, found, &num_found);
         }
+    }
+
+    draw_view_stars(canvas, config, found, num_found);
+    free(found);
 
-        render_object_stereo(win, &star->base, config);
+    return;
+}
+
+void render_cached_stars(struct Canvas *canvas, const struct Conf *config, const struct Star *star_table,
+                         const struct ProjectionCache *cache, const struct CacheSlot *slot)
+{
+    for (unsigned int i = slot->offset; i < slot->offset + slot->count; ++i)
+    {
+        const struct CachedStar *cached = &cache->stars[i];
+        draw_object(canvas, &star_table[cached->star].base, config, cached->row, cached->col);
     }
 
     return;
 }
 
-void render_constellation(WINDOW *win, const struct Conf *config, struct Constell *constellation, const struct Star *star_table)
+/* Find the point on the horizon directly above an object below it. Returns
+ * false for an object at the nadir, which has no azimuth
+ */
+static bool horizon_below(const struct ObjectBase *object, struct ObjectBase *horizon)
+{
+    double horizontal = sqrt(object->east * object->east + object->north * object->north);
+    if (horizontal == 0.0)
+    {
+        return false;
+    }
+
+    horizon->east = object->east / horizontal;
+    horizon->north = object->north / horizontal;
+    horizon->up = 0.0;
+    return true;
+}
+
+/* Find the cells the ends of a constellation segment are drawn at on the whole
+ * sky projection, moving an end below the horizon onto it. Returns false if
+ * the segment lies entirely below the horizon
+ */
+static bool segment_to_win_sky(const struct Conf *config, const struct ObjectBase *a, const struct ObjectBase *b,
+                               int height, int width, int *ya, int *xa, int *yb, int *xb, bool *a_clipped,
+                               bool *b_clipped)
 {
-    unsigned int num_segments = constellation->num_segments;
+    // Clip to edge of screen
+    if (a->up < 0.0 && b->up < 0.0)
+    {
+        // Segment lies outside of screen
+        return false;
+    }
 
-    // Only render if all stars are visible
-    for (unsigned int i = 0; i < num_segments * 2; i += 1)
+    // Clip the segment by moving the endpoint below the horizon onto it, at
+    // the same azimuth
+    struct ObjectBase clipped;
+    if (a->up < 0.0)
     {
-        int catalog_num = constellation->star_numbers[i];
-        int table_index = catalog_num - 1;
-        struct Star star = star_table[table_index];
-        if (star.magnitude > config->threshold)
+        *a_clipped = true;
+        if (!horizon_below(a, &clipped))
         {
-            return;
+            return false;
         }
+        a = &clipped;
     }
-
-    for (unsigned int i = 0; i < num_segments * 2; i += 2)
+    else if (b->up < 0.0)
     {
-        int catalog_num_a = constellation->star_numbers[i];
-        int catalog_num_b = constellation->star_numbers[i + 1];
+        *b_clipped = true;
+        if (!horizon_below(b, &clipped))
+        {
+            return false;
+        }
+        b = &clipped;
+    }
 
-        int table_index_a = catalog_num_a - 1;
-        int table_index_b = catalog_num_b - 1;
+    project_unit_vector(config->projection, a->east, a->north, a->up, height, width, ya, xa);
+    project_unit_vector(config->projection, b->east, b->north, b->up, height, width, yb, xb);
+    return true;
+}
 
-        struct Star star_a = star_table[table_index_a];
-        struct Star star_b = star_table[table_index_b];
+/* Find the cells the ends of a constellation segment are drawn at in a zoomed
+ * view, clipping the segment to the window (Liang-Barsky). Returns false if no
+ * part of it is in the window or either end is below the horizon
+ */
+static bool segment_to_win_view(const struct View *view, const struct ObjectBase *a, const struct ObjectBase *b,
+                                int height, int width, int *ya, int *xa, int *yb, int *xb, bool *a_clipped,
+                                bool *b_clipped)
+{
+    if (a->up < 0.0 || b->up < 0.0)
+    {
+        return false;
+    }
 
-        // TODO: Same code as in render_object_stereo... perhaps refactor this
-        // or cache coordinates
-        double radius_a, theta_a;
-        double radius_b, theta_b;
-        horizontal_to_polar(star_a.base.azimuth, star_a.base.altitude, &radius_a, &theta_a);
-        horizontal_to_polar(star_b.base.azimuth, star_b.base.altitude, &radius_b, &theta_b);
+    double x0, y0, x1, y1;
+    bool projected = view_project(view, a->east, a->north, a->up, &x0, &y0);
+    projected = view_project(view, b->east, b->north, b->up, &x1, &y1) && projected;
+    if (!projected)
+    {
+        return false;
+    }
 
-        // Clip to edge of screen
-        if (fabs(radius_a) > 1 && fabs(radius_b) > 1)
+    // Shrink the parameter range [t0, t1] of the segment to the window
+    double dx = x1 - x0;
+    double dy = y1 - y0;
+    double p[4] = {-dx, dx, -dy, dy};
+    double q[4] = {x0 + 1.0, 1.0 - x0, y0 + 1.0, 1.0 - y0};
+    double t0 = 0.0;
+    double t1 = 1.0;
+    for (int i = 0; i < 4; ++i)
+    {
+        if (p[i] == 0.0)
         {
-            // Segment lies outside of screen
+            if (q[i] < 0.0)
+            {
+                return false;
+            }
             continue;
         }
 
-        bool a_clipped = false;
-        bool b_clipped = false;
-
-        // Clip the segment
-        if (fabs(radius_a) > 1)
+        double t = q[i] / p[i];
+        if (p[i] < 0.0)
         {
-            a_clipped = true;
-            radius_a = 1.0;
+            t0 = fmax(t0, t);
         }
-        else if (fabs(radius_b) > 1)
+        else
+        {
+            t1 = fmin(t1, t);
+        }
+    }
+    if (t0 > t1)
+    {
+        return false;
+    }
+
+    *a_clipped = t0 > 0.0;
+    *b_clipped = t1 < 1.0;
+    view_plane_to_win(x0 + t0 * dx, y0 + t0 * dy, height, width, ya, xa);
+    view_plane_to_win(x0 + t1 * dx, y0 + t1 * dy, height, width, yb, xb);
+    return true;
+}
+
+void render_constellation(struct Canvas *canvas, const struct Conf *config, const struct View *view,
+                          const unsigned int *endpoints, unsigned int num_segments, const struct Star *star_table)
+{
+    // Only render if all stars are visible
+    for (unsigned int i = 0; i < num_segments * 2; i += 1)
+    {
+        if (star_table[endpoints[i]].magnitude > config->threshold)
         {
-            b_clipped = true;
-            radius_b = 1.0;
+            return;
         }
+    }
 
-        int height, width;
-        getmaxyx(win, height, width);
+    int height = canvas->height;
+    int width = canvas->width;
+
+    for (unsigned int i = 0; i < num_segments * 2; i += 2)
+    {
+        const struct ObjectBase *star_a = &star_table[endpoints[i]].base;
+        const struct ObjectBase *star_b = &star_table[endpoints[i + 1]].base;
 
         int ya, xa;
         int yb, xb;
-        polar_to_win(radius_a, theta_a, height, width, &ya, &xa);
-
-        polar_to_win(radius_b, theta_b, height, width, &yb, &xb);
+        bool a_clipped = false;
+        bool b_clipped = false;
+        bool drawn = view->zoomed ? segment_to_win_view(view, star_a, star_b, height, width, &ya, &xa, &yb, &xb,
+                                                        &a_clipped, &b_clipped)
+                                  : segment_to_win_sky(config, star_a, star_b, height, width, &ya, &xa, &yb, &xb,
+                                                       &a_clipped, &b_clipped);
+        if (!drawn)
+        {
+            continue;
+        }
 
         // TODO: In old version, constrained line length for some reason... not
         // sure why?
@@ -165,42 +500,45 @@ void render_constellation(WINDOW *win, const struct Conf *config, struct Constel
         // FIXME: this clipping doesn't seem to work or no-unicode for some reason?
         if (config->unicode)
         {
-            draw_line_smooth(win, ya, xa, yb, xb);
+            draw_line_smooth(canvas, ya, xa, yb, xb);
             if (!a_clipped)
             {
-                mvwaddstr(win, ya, xa, "\u25CB"); // Unicode circle symbol
+                canvas_put_str(canvas, ya, xa, "\u25CB"); // Unicode circle symbol
             }
             if (!b_clipped)
             {
-                mvwaddstr(win, yb, xb, "\u25CB");
+                canvas_put_str(canvas, yb, xb, "\u25CB");
             }
         }
         else
         {
-            draw_line_ASCII(win, ya, xa, yb, xb);
+            draw_line_ASCII(canvas, ya, xa, yb, xb);
             if (!a_clipped)
             {
-                mvwaddch(win, ya, xa, '+');
+                canvas_put_char(canvas, ya, xa, '+');
             }
             if (!b_clipped)
             {
-                mvwaddch(win, yb, xb, '+');
+                canvas_put_char(canvas, yb, xb, '+');
             }
         }
     }
 }
 
-void render_constells(WINDOW *win, const struct Conf *config, struct Constell **constell_table, int num_const,
-                      const struct Star *star_table)
+void render_constells(struct Canvas *canvas, const struct Conf *config, const struct View *view,
+                      const struct ConstellTable *constell_table, const struct Star *star_table)
 {
-    for (int i = 0; i < num_const; ++i)
+    // Figures are contiguous in the endpoint array, so this is a linear scan
+    for (unsigned int i = 0; i < constell_table->num_constells; ++i)
     {
-        struct Constell *constellation = &((*constell_table)[i]);
-        render_constellation(win, config, constellation, star_table);
+        unsigned int first = constell_table->offsets[i];
+        unsigned int num_segments = constell_table->offsets[i + 1] - first;
+        render_constellation(canvas, config, view, &constell_table->endpoints[first * 2], num_segments, star_table);
     }
 }
 
-void render_planets_stereo(WINDOW *win, const struct Conf *config, const struct Planet *planet_table)
+void render_planets_stereo(struct Canvas *canvas, const struct Conf *config, const struct View *view,
+                           const struct Planet *planet_table)
 {
     // Render planets so that closest are drawn on top
     int i;
@@ -215,15 +553,16 @@ void render_planets_stereo(WINDOW *win, const struct Conf *config, const struct
         }
 
         struct Planet planet_data = planet_table[i];
-        render_object_stereo(win, &planet_data.base, config);
+        render_object_stereo(canvas, &planet_data.base, config, view);
     }
 
     return;
 }
 
-void render_moon_stereo(WINDOW *win, const struct Conf *config, struct Moon moon_object)
+void render_moon_stereo(struct Canvas *canvas, const struct Conf *config, const struct View *view,
+                        struct Moon moon_object)
 {
-    render_object_stereo(win, &moon_object.base, config);
+    render_object_stereo(canvas, &moon_object.base, config, view);
 
     return;
 }
@@ -247,12 +586,12 @@ int compare_angles(const void *a, const void *b)
     return (90 / gcd(x, 90)) < (90 / gcd(y, 90));
 }
 
-void render_azimuthal_grid(WINDOW *win, const struct Conf *config)
+void render_azimuthal_grid(struct Canvas *canvas, const struct Conf *config)
 {
     const double to_rad = M_PI / 180.0;
 
-    int height, width;
-    getmaxyx(win, height, width);
+    int height = canvas->height;
+    int width = canvas->width;
     int maxy = height - 1;
     int maxx = width - 1;
 
@@ -301,11 +640,11 @@ void render_azimuthal_grid(WINDOW *win, const struct Conf *config)
 
             if (config->unicode)
             {
-                draw_line_smooth(win, y, x, rad_vertical, rad_horizontal);
+                draw_line_smooth(canvas, y, x, rad_vertical, rad_horizontal);
             }
             else
             {
-                draw_line_ASCII(win, y, x, rad_vertical, rad_horizontal);
+                draw_line_ASCII(canvas, y, x, rad_vertical, rad_horizontal);
             }
 
             int str_len = snprintf(NULL, 0, "%d", angle);
@@ -316,7 +655,7 @@ void render_azimuthal_grid(WINDOW *win, const struct Conf *config)
             // Offset to avoid truncating string
             int x_off = (x < rad_horizontal) ? 0 : -(str_len - 1);
 
-            mvwaddstr(win, y, x + x_off, label);
+            canvas_put_str(canvas, y, x + x_off, label);
 
             free(label);
         }
@@ -326,35 +665,45 @@ void render_azimuthal_grid(WINDOW *win, const struct Conf *config)
     // {
     //     int rad_x = rad_horizontal * angle / 90.0;
     //     int rad_x = rad_vertical * angle / 90.0;
-    //     // draw_ellipse(win, win->_maxy/2, win->_maxx/2, 20, 20,
+    //     // draw_ellipse(canvas, win->_maxy/2, win->_maxx/2, 20, 20,
     //     ascii); angle += inc;
     // }
 }
 
-void render_cardinal_directions(WINDOW *win, const struct Conf *config)
+void render_cardinal_directions(struct Canvas *canvas, const struct Conf *config)
 {
     // Render horizon directions
 
     if (config->color)
     {
-        wattron(win, COLOR_PAIR(5));
+        canvas_set_color(canvas, 5);
     }
 
-    int height, width;
-    getmaxyx(win, height, width);
+    int height = canvas->height;
+    int width = canvas->width;
     int maxy = height - 1;
     int maxx = width - 1;
 
     int half_maxy = round(maxy / 2.0);
     int half_maxx = round(maxx / 2.0);
 
-    mvwaddch(win, 0, half_maxx, 'N');
-    mvwaddch(win, half_maxy, width - 1, 'W');
-    mvwaddch(win, height - 1, half_maxx, 'S');
-    mvwaddch(win, half_maxy, 0, 'E');
+    canvas_put_char(canvas, 0, half_maxx, 'N');
+    canvas_put_char(canvas, half_maxy, width - 1, 'W');
+    canvas_put_char(canvas, height - 1, half_maxx, 'S');
+    canvas_put_char(canvas, half_maxy, 0, 'E');
 
     if (config->color)
     {
-        wattroff(win, COLOR_PAIR(5));
+        canvas_set_color(canvas, 0);
     }
 }
+
+void render_view_status(struct Canvas *canvas, const struct Conf *config, const struct View *view)
+{
+    char status[96];
+    snprintf(status, sizeof(status), "Az %.1f%s Alt %.1f%s Field %.2f%s %s", view->azimuth / TO_RAD,
+             config->unicode ? "\u00B0" : "", view->altitude / TO_RAD, config->unicode ? "\u00B0" : "",
+             view->field / TO_RAD, config->unicode ? "\u00B0" : "", view->gnomonic ? "gnomonic" : "stereographic");
+
+    canvas_put_str(canvas, canvas->height - 1, 0, status);
+}
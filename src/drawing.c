@@ -1,13 +1,12 @@
 #include "drawing.h"
 
-#include <curses.h>
 #include <math.h>
 #include <stdlib.h>
 
 // The difference in logic between drawing an ASCII and unicode line differs
 // enough that having two different functions is warranted
 
-void draw_line_ASCII(WINDOW *win, int ya, int xa, int yb, int xb)
+void draw_line_ASCII(struct Canvas *canvas, int ya, int xa, int yb, int xb)
 {
     // The logic here is not particularly elegant or efficient
 
@@ -44,12 +43,12 @@ void draw_line_ASCII(WINDOW *win, int ya, int xa, int yb, int xb)
             int next_y = ya + y + sy;
             int next_x = xa + (int)round(x + sx);
 
-            mvwaddch(win, curr_y, curr_x, '|');
+            canvas_put_char(canvas, curr_y, curr_x, '|');
 
             // Draw slope if we jump a column
             if (next_x != curr_x)
             {
-                mvwaddch(win, curr_y, curr_x, slope);
+                canvas_put_char(canvas, curr_y, curr_x, slope);
             }
 
             y += sy;
@@ -76,7 +75,7 @@ void draw_line_ASCII(WINDOW *win, int ya, int xa, int yb, int xb)
             // Edge case where we draw a horizontal line
             char horizontal = ya == yb ? '-' : '_';
 
-            mvwaddch(win, curr_y, curr_x, horizontal);
+            canvas_put_char(canvas, curr_y, curr_x, horizontal);
 
             // This bit requires a little more logic: drawing '-' characters
             // isn't as smooth as '_' characters. Thus, to draw a good lookin'
@@ -93,7 +92,7 @@ void draw_line_ASCII(WINDOW *win, int ya, int xa, int yb, int xb)
                     // Make sure we're not on the last cell first
                     if (curr_y != yb)
                     {
-                        mvwaddch(win, next_y, next_x, slope);
+                        canvas_put_char(canvas, next_y, next_x, slope);
 
                         // Skip drawing the next position the next iteration
                         y += sy;
@@ -103,7 +102,7 @@ void draw_line_ASCII(WINDOW *win, int ya, int xa, int yb, int xb)
                 else
                 {
                     // We're moving "up": just add the slope to the current cell
-                    mvwaddch(win, curr_y, curr_x, slope);
+                    canvas_put_char(canvas, curr_y, curr_x, slope);
                 }
             }
 
@@ -114,11 +113,11 @@ void draw_line_ASCII(WINDOW *win, int ya, int xa, int yb, int xb)
 
     // Could add asterisks at beginning and end of segment to "prettify",
     // but not for this application
-    // mvwaddch(win, ya, xa, '*');
-    // mvwaddch(win, yb, xb, '*');
+    // canvas_put_char(canvas, ya, xa, '*');
+    // canvas_put_char(canvas, yb, xb, '*');
 }
 
-void draw_line_smooth(WINDOW *win, int ya, int xa, int yb, int xb)
+void draw_line_smooth(struct Canvas *canvas, int ya, int xa, int yb, int xb)
 {
     // The logic here is not particularly elegant or efficient
 
@@ -158,13 +157,13 @@ void draw_line_smooth(WINDOW *win, int ya, int xa, int yb, int xb)
             int next_y = ya + y + sy;
             int next_x = xa + (int)round(x + sx);
 
-            mvwaddstr(win, curr_y, curr_x, "│");
+            canvas_put_str(canvas, curr_y, curr_x, "│");
 
             // Draw joint if we jump a column && we're not on the last cell
             if (curr_x != next_x && curr_x != xb)
             {
-                mvwaddstr(win, curr_y, curr_x, joint_a);
-                mvwaddstr(win, curr_y, next_x, joint_b);
+                canvas_put_str(canvas, curr_y, curr_x, joint_a);
+                canvas_put_str(canvas, curr_y, next_x, joint_b);
             }
 
             y += sy;
@@ -200,13 +199,13 @@ void draw_line_smooth(WINDOW *win, int ya, int xa, int yb, int xb)
             int next_y = ya + (int)round(y + sy);
             int next_x = xa + x + sx;
 
-            mvwaddstr(win, curr_y, curr_x, "─");
+            canvas_put_str(canvas, curr_y, curr_x, "─");
 
             // Draw joint if we jump a row && we're not on the last cell
             if (curr_y != next_y && curr_y != yb)
             {
-                mvwaddstr(win, curr_y, curr_x, joint_a);
-                mvwaddstr(win, next_y, curr_x, joint_b);
+                canvas_put_str(canvas, curr_y, curr_x, joint_a);
+                canvas_put_str(canvas, next_y, curr_x, joint_b);
             }
 
             y += sy;
@@ -215,7 +214,7 @@ void draw_line_smooth(WINDOW *win, int ya, int xa, int yb, int xb)
     }
 }
 
-void draw_line_dotted(WINDOW *win, int ya, int xa, int yb, int xb)
+void draw_line_dotted(struct Canvas *canvas, int ya, int xa, int yb, int xb)
 {
     // The logic here is not particularly elegant or efficient
 
@@ -238,7 +237,7 @@ void draw_line_dotted(WINDOW *win, int ya, int xa, int yb, int xb)
             int curr_y = ya + y;
             int curr_x = xa + (int)round(x);
 
-            mvwaddstr(win, curr_y, curr_x, fill);
+            canvas_put_str(canvas, curr_y, curr_x, fill);
 
             y += sy;
             x += sx;
@@ -258,7 +257,7 @@ void draw_line_dotted(WINDOW *win, int ya, int xa, int yb, int xb)
             int curr_y = ya + (int)round(y);
             int curr_x = xa + x;
 
-            mvwaddstr(win, curr_y, curr_x, fill);
+            canvas_put_str(canvas, curr_y, curr_x, fill);
 
             y += sy;
             x += sx;
@@ -275,65 +274,65 @@ enum FillType
 
 // Reference: https://dai.fmph.uniba.sk/upload/0/01/Ellipse.pdf
 
-void print_chars_ellipse_ASCII(WINDOW *win, int center_y, int center_x, int y, int x, int fill)
+void print_chars_ellipse_ASCII(struct Canvas *canvas, int center_y, int center_x, int y, int x, int fill)
 {
     switch (fill)
     {
     case CORNER:
-        mvwaddch(win, center_y - y, center_x + x, '\\'); // Quad I
-        mvwaddch(win, center_y - y, center_x - x, '/');  // Quad II
-        mvwaddch(win, center_y + y, center_x - x, '\\'); // Quad III
-        mvwaddch(win, center_y + y, center_x + x, '/');  // Quad IV
+        canvas_put_char(canvas, center_y - y, center_x + x, '\\'); // Quad I
+        canvas_put_char(canvas, center_y - y, center_x - x, '/');  // Quad II
+        canvas_put_char(canvas, center_y + y, center_x - x, '\\'); // Quad III
+        canvas_put_char(canvas, center_y + y, center_x + x, '/');  // Quad IV
         break;
 
     case VERTICAL:
-        mvwaddch(win, center_y - y, center_x + x, '|');
-        mvwaddch(win, center_y - y, center_x - x, '|');
-        mvwaddch(win, center_y + y, center_x - x, '|');
-        mvwaddch(win, center_y + y, center_x + x, '|');
+        canvas_put_char(canvas, center_y - y, center_x + x, '|');
+        canvas_put_char(canvas, center_y - y, center_x - x, '|');
+        canvas_put_char(canvas, center_y + y, center_x - x, '|');
+        canvas_put_char(canvas, center_y + y, center_x + x, '|');
         break;
 
     case HORIZONTAL:
-        mvwaddch(win, center_y - y, center_x + x, '-');
-        mvwaddch(win, center_y - y, center_x - x, '-');
-        mvwaddch(win, center_y + y, center_x - x, '-');
-        mvwaddch(win, center_y + y, center_x + x, '-');
+        canvas_put_char(canvas, center_y - y, center_x + x, '-');
+        canvas_put_char(canvas, center_y - y, center_x - x, '-');
+        canvas_put_char(canvas, center_y + y, center_x - x, '-');
+        canvas_put_char(canvas, center_y + y, center_x + x, '-');
         break;
     }
 }
 
-void print_chars_ellipse_unicode(WINDOW *win, int center_y, int center_x, int y, int x, int fill)
+void print_chars_ellipse_unicode(struct Canvas *canvas, int center_y, int center_x, int y, int x, int fill)
 {
     // TODO: def not correct
     switch (fill)
     {
     case CORNER:
         // Quad I
-        mvwaddstr(win, center_y - y - 1, center_x + x, "╮");
-        mvwaddstr(win, center_y - y, center_x + x, "╰");
+        canvas_put_str(canvas, center_y - y - 1, center_x + x, "╮");
+        canvas_put_str(canvas, center_y - y, center_x + x, "╰");
         // Quad II
-        mvwaddstr(win, center_y - y - 1, center_x - x, "╭");
-        mvwaddstr(win, center_y - y, center_x - x, "╯");
+        canvas_put_str(canvas, center_y - y - 1, center_x - x, "╭");
+        canvas_put_str(canvas, center_y - y, center_x - x, "╯");
         // Quad III
-        mvwaddstr(win, center_y + y - 1, center_x - x, "╮");
-        mvwaddstr(win, center_y + y, center_x - x, "╰");
+        canvas_put_str(canvas, center_y + y - 1, center_x - x, "╮");
+        canvas_put_str(canvas, center_y + y, center_x - x, "╰");
         // Quad IV
-        mvwaddstr(win, center_y + y - 1, center_x + x, "╭");
-        mvwaddstr(win, center_y + y, center_x + x, "╯");
+        canvas_put_str(canvas, center_y + y - 1, center_x + x, "╭");
+        canvas_put_str(canvas, center_y + y, center_x + x, "╯");
         break;
 
     case VERTICAL:
-        mvwaddstr(win, center_y - y, center_x + x, "│");
-        mvwaddstr(win, center_y - y, center_x - x, "│");
-        mvwaddstr(win, center_y + y, center_x - x, "│");
-        mvwaddstr(win, center_y + y, center_x + x, "│");
+        canvas_put_str(canvas, center_y - y, center_x + x, "│");
+        canvas_put_str(canvas, center_y - y, center_x - x, "│");
+        canvas_put_str(canvas, center_y + y, center_x - x, "│");
+        canvas_put_str(canvas, center_y + y, center_x + x, "│");
         break;
 
     case HORIZONTAL:
-        mvwaddstr(win, center_y - y, center_x + x, "─");
-        mvwaddstr(win, center_y - y, center_x - x, "─");
-        mvwaddstr(win, center_y + y, center_x - x, "─");
-        mvwaddstr(win, center_y + y, center_x + x, "─");
+        canvas_put_str(canvas, center_y - y, center_x + x, "─");
+        canvas_put_str(canvas, center_y - y, center_x - x, "─");
+        canvas_put_str(canvas, center_y + y, center_x - x, "─");
+        canvas_put_str(canvas, center_y + y, center_x + x, "─");
         break;
     }
 
@@ -345,7 +344,7 @@ int ellipse_error(int y, int x, int rad_y, int rad_x)
     return (rad_x * rad_x + x * x) + (rad_y * rad_y + y * y) - (rad_x * rad_x * rad_y * rad_y);
 }
 
-void draw_ellipse(WINDOW *win, int center_y, int center_x, int rad_y, int rad_x, bool no_unicode)
+void draw_ellipse(struct Canvas *canvas, int center_y, int center_x, int rad_y, int rad_x, bool no_unicode)
 {
     int y = 0;
     int x = rad_x;
@@ -370,11 +369,11 @@ void draw_ellipse(WINDOW *win, int center_y, int center_x, int rad_y, int rad_x,
 
         if (no_unicode)
         {
-            print_chars_ellipse_ASCII(win, center_y, center_x, y, x, fill);
+            print_chars_ellipse_ASCII(canvas, center_y, center_x, y, x, fill);
         }
         else
         {
-            print_chars_ellipse_unicode(win, center_y, center_x, y, x, fill);
+            print_chars_ellipse_unicode(canvas, center_y, center_x, y, x, fill);
         }
 
         y = y_next;
@@ -395,11 +394,11 @@ void draw_ellipse(WINDOW *win, int center_y, int center_x, int rad_y, int rad_x,
 
         if (no_unicode)
         {
-            print_chars_ellipse_ASCII(win, center_y, center_x, y, x, fill);
+            print_chars_ellipse_ASCII(canvas, center_y, center_x, y, x, fill);
         }
         else
         {
-            print_chars_ellipse_unicode(win, center_y, center_x, y, x, fill);
+            print_chars_ellipse_unicode(canvas, center_y, center_x, y, x, fill);
         }
 
         y = y_next;
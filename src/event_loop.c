@@ -0,0 +1,153 @@
+#include "event_loop.h"
+
+#ifdef __linux__
+
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdint.h>
+#include <sys/signalfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+static void loop_signals(sigset_t *signals)
+{
+    sigemptyset(signals);
+    sigaddset(signals, SIGWINCH);
+    sigaddset(signals, SIGINT);
+    sigaddset(signals, SIGTERM);
+}
+
+bool event_loop_init(struct EventLoop *loop, int input_fd)
+{
+    sigset_t signals;
+    loop_signals(&signals);
+
+    // Signals are only ever read from the signalfd
+    if (pthread_sigmask(SIG_BLOCK, &signals, NULL) != 0)
+    {
+        return false;
+    }
+
+    loop->input_fd = input_fd;
+    loop->signal_fd = signalfd(-1, &signals, SFD_NONBLOCK | SFD_CLOEXEC);
+    loop->timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+
+    if (loop->signal_fd == -1 || loop->timer_fd == -1)
+    {
+        event_loop_destroy(loop);
+        return false;
+    }
+
+    return true;
+}
+
+bool event_loop_arm(struct EventLoop *loop, struct SwTimestamp deadline)
+{
+    if (deadline.val_member != TICK_SPEC)
+    {
+        return false;
+    }
+
+    // A zero time would disarm the timer instead
+    struct itimerspec spec = {.it_value = deadline.val.tick_spec};
+    if (spec.it_value.tv_sec == 0 && spec.it_value.tv_nsec == 0)
+    {
+        spec.it_value.tv_nsec = 1;
+    }
+
+    return timerfd_settime(loop->timer_fd, TFD_TIMER_ABSTIME, &spec, NULL) == 0;
+}
+
+enum LoopEvent event_loop_wait(struct EventLoop *loop)
+{
+    while (true)
+    {
+        struct pollfd fds[] = {
+            {.fd = loop->signal_fd, .events = POLLIN},
+            {.fd = loop->input_fd, .events = POLLIN},
+            {.fd = loop->timer_fd, .events = POLLIN},
+        };
+
+        if (poll(fds, sizeof(fds) / sizeof(fds[0]), -1) == -1)
+        {
+            if (errno == EINTR)
+            {
+                continue; // e.g. SIGCONT after being stopped
+            }
+            return LOOP_EVENT_QUIT;
+        }
+
+        if (fds[0].revents & POLLIN)
+        {
+            struct signalfd_siginfo info;
+            if (read(loop->signal_fd, &info, sizeof(info)) == (ssize_t)sizeof(info))
+            {
+                return info.ssi_signo == SIGWINCH ? LOOP_EVENT_RESIZE : LOOP_EVENT_QUIT;
+            }
+        }
+
+        if (fds[1].revents & POLLIN)
+        {
+            return LOOP_EVENT_INPUT;
+        }
+        if (fds[1].revents & (POLLHUP | POLLERR | POLLNVAL))
+        {
+            return LOOP_EVENT_QUIT;
+        }
+
+        if (fds[2].revents & POLLIN)
+        {
+            uint64_t expirations;
+            if (read(loop->timer_fd, &expirations, sizeof(expirations)) == (ssize_t)sizeof(expirations))
+            {
+                return LOOP_EVENT_TICK;
+            }
+        }
+    }
+}
+
+void event_loop_destroy(struct EventLoop *loop)
+{
+    if (loop->signal_fd != -1)
+    {
+        close(loop->signal_fd);
+    }
+    if (loop->timer_fd != -1)
+    {
+        close(loop->timer_fd);
+    }
+
+    sigset_t signals;
+    loop_signals(&signals);
+    pthread_sigmask(SIG_UNBLOCK, &signals, NULL);
+}
+
+#else
+
+bool event_loop_init(struct EventLoop *loop, int input_fd)
+{
+    (void)loop;
+    (void)input_fd;
+    return false;
+}
+
+bool event_loop_arm(struct EventLoop *loop, struct SwTimestamp deadline)
+{
+    (void)loop;
+    (void)deadline;
+    return false;
+}
+
+enum LoopEvent event_loop_wait(struct EventLoop *loop)
+{
+    (void)loop;
+    return LOOP_EVENT_QUIT;
+}
+
+void event_loop_destroy(struct EventLoop *loop)
+{
+    (void)loop;
+}
+
+#endif // __linux__
@@ -0,0 +1,71 @@
+#include "frame_pacer.h"
+
+#include "macros.h"
+
+void frame_pacer_init(struct FramePacer *pacer, unsigned long long period, unsigned long long spin)
+{
+    histogram_reset(&pacer->stats.times);
+    pacer->stats.num_missed = 0;
+    pacer->period = MAX(period, 1ULL);
+    pacer->spin = MIN(spin, pacer->period);
+    pacer->frame = 0;
+    sw_gettime(&pacer->start);
+    pacer->wake = pacer->start;
+}
+
+unsigned long long frame_pacer_wait(struct FramePacer *pacer)
+{
+    struct SwTimestamp wake;
+    unsigned long long skipped = frame_pacer_next(pacer, &wake);
+    sw_sleep_until(wake);
+    frame_pacer_begin(pacer);
+
+    return skipped;
+}
+
+unsigned long long frame_pacer_next(struct FramePacer *pacer, struct SwTimestamp *wake)
+{
+    struct SwTimestamp now;
+    sw_gettime(&now);
+
+    unsigned long long elapsed;
+    sw_timediff_usec(now, pacer->start, &elapsed);
+
+    unsigned long long next = pacer->frame + 1;
+    if (elapsed > next * pacer->period)
+    {
+        // Start the next frame right away, in the slot we are already in, so
+        // simulation time stays locked to the schedule
+        pacer->stats.num_missed++;
+        next = elapsed / pacer->period;
+    }
+
+    unsigned long long skipped = next - pacer->frame - 1;
+    pacer->frame = next;
+
+    *wake = pacer->start;
+    sw_timeadd_usec(wake, MAX(next * pacer->period, pacer->spin) - pacer->spin);
+
+    return skipped;
+}
+
+void frame_pacer_begin(struct FramePacer *pacer)
+{
+    struct SwTimestamp now;
+    sw_gettime(&now);
+
+    // Waking up from a sleep can take longer than the spin, which is only
+    // worth its CPU time at high frame rates
+    unsigned long long elapsed;
+    sw_timediff_usec(now, pacer->start, &elapsed);
+    while (pacer->spin > 0 && elapsed < pacer->frame * pacer->period)
+    {
+        sw_gettime(&now);
+        sw_timediff_usec(now, pacer->start, &elapsed);
+    }
+
+    unsigned long long frame_time;
+    sw_timediff_usec(now, pacer->wake, &frame_time);
+    histogram_record(&pacer->stats.times, frame_time);
+    pacer->wake = now;
+}
@@ -0,0 +1,109 @@
+#include "frame_ring.h"
+
+#include "macros.h"
+
+void frame_ring_init(struct FrameRing *ring, unsigned int num_slots)
+{
+    ring->num_slots = MAX(1u, MIN(num_slots, (unsigned int)FRAME_RING_MAX_SLOTS));
+    ring->read = 0;
+    ring->filled = 0;
+    ring->writing = false;
+    ring->reading = false;
+    ring->paused = false;
+    ring->closed = false;
+    mutex_init(&ring->lock);
+    condition_init(&ring->changed);
+}
+
+bool frame_ring_begin_write(struct FrameRing *ring, unsigned int *slot)
+{
+    mutex_lock(&ring->lock);
+    while (!ring->closed && (ring->paused || ring->filled == ring->num_slots))
+    {
+        condition_wait(&ring->changed, &ring->lock);
+    }
+
+    bool open = !ring->closed;
+    if (open)
+    {
+        ring->writing = true;
+        *slot = (ring->read + ring->filled) % ring->num_slots;
+    }
+    mutex_unlock(&ring->lock);
+
+    return open;
+}
+
+void frame_ring_end_write(struct FrameRing *ring)
+{
+    mutex_lock(&ring->lock);
+    ring->writing = false;
+    ring->filled++;
+    condition_broadcast(&ring->changed);
+    mutex_unlock(&ring->lock);
+}
+
+bool frame_ring_begin_read(struct FrameRing *ring, unsigned int *slot)
+{
+    mutex_lock(&ring->lock);
+    while (!ring->closed && ring->filled == 0)
+    {
+        condition_wait(&ring->changed, &ring->lock);
+    }
+
+    bool open = !ring->closed;
+    if (open)
+    {
+        ring->reading = true;
+        *slot = ring->read;
+    }
+    mutex_unlock(&ring->lock);
+
+    return open;
+}
+
+void frame_ring_end_read(struct FrameRing *ring)
+{
+    mutex_lock(&ring->lock);
+    ring->reading = false;
+    ring->read = (ring->read + 1) % ring->num_slots;
+    ring->filled--;
+    condition_broadcast(&ring->changed);
+    mutex_unlock(&ring->lock);
+}
+
+void frame_ring_pause(struct FrameRing *ring)
+{
+    mutex_lock(&ring->lock);
+    ring->paused = true;
+    while (ring->writing)
+    {
+        condition_wait(&ring->changed, &ring->lock);
+    }
+
+    // Frames drawn before the pause are stale
+    ring->filled = 0;
+    mutex_unlock(&ring->lock);
+}
+
+void frame_ring_resume(struct FrameRing *ring)
+{
+    mutex_lock(&ring->lock);
+    ring->paused = false;
+    condition_broadcast(&ring->changed);
+    mutex_unlock(&ring->lock);
+}
+
+void frame_ring_close(struct FrameRing *ring)
+{
+    mutex_lock(&ring->lock);
+    ring->closed = true;
+    condition_broadcast(&ring->changed);
+    mutex_unlock(&ring->lock);
+}
+
+void frame_ring_destroy(struct FrameRing *ring)
+{
+    mutex_destroy(&ring->lock);
+    condition_destroy(&ring->changed);
+}
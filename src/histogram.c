@@ -0,0 +1,77 @@
+#include "histogram.h"
+
+#include "bit.h"
+#include "macros.h"
+
+#include <string.h>
+
+/* Bucket counting a value, exact below 2^(HISTOGRAM_SUB_BITS + 1)
+ */
+static unsigned int histogram_bucket(unsigned long long value)
+{
+    value = MIN(value, (2ULL << HISTOGRAM_MAX_BIT) - 1);
+    if (value < (1ULL << HISTOGRAM_SUB_BITS))
+    {
+        return (unsigned int)value;
+    }
+
+    unsigned int shift = highest_set_bit64(value) - HISTOGRAM_SUB_BITS;
+    return ((shift + 1) << HISTOGRAM_SUB_BITS) + (unsigned int)(value >> shift) - (1u << HISTOGRAM_SUB_BITS);
+}
+
+/* Middle of the values counted by a bucket
+ */
+static unsigned long long histogram_bucket_value(unsigned int bucket)
+{
+    if (bucket < (1u << HISTOGRAM_SUB_BITS))
+    {
+        return bucket;
+    }
+
+    unsigned int shift = (bucket >> HISTOGRAM_SUB_BITS) - 1;
+    unsigned long long lowest =
+        (unsigned long long)((bucket & ((1u << HISTOGRAM_SUB_BITS) - 1)) + (1u << HISTOGRAM_SUB_BITS)) << shift;
+    return lowest + ((1ULL << shift) >> 1);
+}
+
+void histogram_reset(struct Histogram *histogram)
+{
+    memset(histogram, 0, sizeof(*histogram));
+}
+
+void histogram_record(struct Histogram *histogram, unsigned long long value)
+{
+    histogram->counts[histogram_bucket(value)]++;
+    histogram->count++;
+    histogram->sum += value;
+    histogram->max = MAX(histogram->max, value);
+}
+
+unsigned long long histogram_percentile(const struct Histogram *histogram, double fraction)
+{
+    if (histogram->count == 0)
+    {
+        return 0;
+    }
+
+    // Rank of the value within the sorted values, from 1
+    unsigned long long rank = (unsigned long long)(fraction * (double)histogram->count + 0.5);
+    rank = MAX(1ULL, MIN(rank, histogram->count));
+
+    unsigned long long seen = 0;
+    for (unsigned int bucket = 0; bucket < HISTOGRAM_BUCKETS; ++bucket)
+    {
+        seen += histogram->counts[bucket];
+        if (seen >= rank)
+        {
+            // Never above the exact maximum
+            return MIN(histogram_bucket_value(bucket), histogram->max);
+        }
+    }
+    return histogram->max;
+}
+
+double histogram_mean(const struct Histogram *histogram)
+{
+    return histogram->count > 0 ? (double)histogram->sum / (double)histogram->count : 0.0;
+}
@@ -1,18 +1,28 @@
+#include "canvas.h"
 #include "city.h"
+#include "city_lookup.h"
 #include "core.h"
 #include "core_position.h"
 #include "core_render.h"
-#include "data/keplerian_elements.h"
+#include "event_loop.h"
+#include "frame_pacer.h"
+#include "frame_ring.h"
 #include "macros.h"
 #include "parse_BSC5.h"
-#include "stopwatch.h"
+#include "perf_counters.h"
+#include "profiler.h"
+#include "projection_cache.h"
+#include "report.h"
+#include "sky.h"
+#include "sky_index.h"
 #include "term.h"
+#include "thread.h"
+#include "tile_catalog.h"
+#include "timer.h"
+#include "trace.h"
 #include "version.h"
-
-// Embedded data generated during build
-#include "bsc5.h"
-#include "bsc5_constellations.h"
-#include "bsc5_names.h"
+#include "view.h"
+#include "visibility.h"
 
 // Third party libraries
 #ifdef HAVE_ARGTABLE3
@@ -25,6 +35,7 @@
 #include <curses.h>
 
 #include <locale.h>
+#include <math.h>
 #include <signal.h>
 #include <stdbool.h>
 #include <stdlib.h>
@@ -37,7 +48,6 @@ static void resize_main(WINDOW *win, const struct Conf *config);
 static void parse_options(int argc, char *argv[], struct Conf *config);
 static void convert_options(struct Conf *config);
 static const char *get_timezone(const struct tm *local_time);
-static void render_metadata(WINDOW *win, const struct Conf *config);
 
 // Track if we need to resize the curses window
 static volatile bool perform_resize = false;
@@ -51,6 +61,28 @@ static COORD winsize;
 static double julian_date = 0.0;
 static double julian_date_start = 0.0; // Note of when we started
 
+// Deep catalogs are streamed so that there is about one star for this many
+// cells of the window, before the magnitude threshold is applied
+#define CELLS_PER_TILE_STAR 8
+
+// Off-screen terminal drawn by --bench: a typical full screen sky
+#define BENCH_ROWS 100
+#define BENCH_COLS 200
+
+// Mean radius of the Earth, for the distance to the nearest city
+#define EARTH_RADIUS_KM 6371.0
+
+static void produce_frame(struct Sky *sky, struct Canvas *main_canvas, struct Canvas *metadata_canvas);
+static void present_frame(struct Sky *sky, unsigned int slot);
+static void resize_windows(struct Sky *sky);
+static bool read_keys(struct Sky *sky);
+static void apply_key(struct Sky *sky, int key);
+static bool wait_for_tick(struct Sky *sky, struct EventLoop *events);
+static void render_metadata(struct Canvas *canvas, const struct Sky *sky, const struct PacingSummary *pacing);
+static void compute_main(void *arg);
+static void run_frames(struct Sky *sky, struct FramePacer *pacer, struct EventLoop *events, bool use_events);
+static unsigned long long run_bench(struct Sky *sky, unsigned long long num_frames);
+
 int main(int argc, char *argv[])
 {
     // Default config
@@ -63,84 +95,442 @@ int main(int argc, char *argv[])
         .fps = 24,
         .speed = 1.0f,
         .aspect_ratio = 0.0,
+        .sky_cache_mib = 0,
+        .projection = PROJECTION_STEREOGRAPHIC,
+        .tiles_path = NULL,
+        .profile_path = NULL,
+        .trace_path = NULL,
+        .city_name = NULL,
+        .city_file = NULL,
+        .list_cities = NULL,
+        .write_tiles_path = NULL,
+        .tile_cache_mib = 256,
+        .spin_usec = 0,
+        .bench_frames = 0,
         .quit_on_any = false,
         .unicode = false,
         .color = false,
         .grid = false,
         .constell = false,
         .metadata = false,
+        .coordinates_given = false,
+        .pipeline = true,
+        .perf_counters = false,
     };
 
     // Parse command line args and convert to internal representations
     parse_options(argc, argv, &config);
     convert_options(&config);
 
-    // Time for each frame in microseconds
-    unsigned long dt = (unsigned long)(1.0 / config.fps * 1.0E6);
-
-    // Initialize data structs
-    unsigned int num_stars, num_const;
-
-    struct Entry *BSC5_entries = NULL;
-    struct StarName *name_table = NULL;
-    struct Constell *constell_table = NULL;
-    struct Star *star_table = NULL;
-    struct Planet *planet_table = NULL;
-    struct Moon moon_object;
-    int *num_by_mag = NULL;
-
-    // Track success of functions
-    bool s = true;
-
-    // Generated BSC5 data during build in bsc5_xxx.h:
-    //
-    // uint8_t bsc5_xxx[];
-    // size_t bsc5_xxx_len;
+    if (config.list_cities != NULL)
+    {
+        exit(list_cities(config.city_file, config.list_cities) ? EXIT_SUCCESS : EXIT_FAILURE);
+    }
 
-    s = s && parse_entries(bsc5, bsc5_len, &BSC5_entries, &num_stars);
-    s = s && generate_name_table(bsc5_names, bsc5_names_len, &name_table, num_stars);
-    s = s && generate_constell_table(bsc5_constellations, bsc5_constellations_len, &constell_table, &num_const);
-    s = s && generate_star_table(&star_table, BSC5_entries, name_table, num_stars);
-    s = s && generate_planet_table(&planet_table, planet_elements, planet_rates, planet_extras);
-    s = s && generate_moon_object(&moon_object, &moon_elements, &moon_rates);
-    s = s && star_numbers_by_magnitude(&num_by_mag, star_table, num_stars);
+    struct Sky sky = {.config = &config};
 
-    if (!s)
+    // Time for each frame in microseconds
+    unsigned long dt = (unsigned long)(1.0 / config.fps * 1.0E6);
+    sky.dt = dt;
+
+    // The simulation speed is fixed for the session, so pick the cheaper way of
+    // culling stars below the horizon once
+    const double microsec_per_day = 24.0 * 60.0 * 60.0 * 1.0E6;
+    sky.use_scheduler = visibility_scheduler_suits((double)dt / microsec_per_day * config.speed);
+
+    // Keys, resizes and frame deadlines are waited on together where the
+    // platform allows. Signals are routed to the loop before any thread starts,
+    // since threads inherit which signals are blocked. Benchmarks read no keys
+    struct EventLoop events;
+    bool interactive = config.bench_frames == 0;
+    bool use_events = interactive && event_loop_init(&events, fileno(stdin));
+
+    // Loading and indexing the catalogs, as reported by benchmarks
+    static struct SwTimer startup_timer = SW_TIMER("startup");
+    struct SwTimerScope startup_scope = sw_timer_begin(&startup_timer);
+
+    // Slow clocks come back to the same sky every sidereal day, which makes
+    // caching where stars are drawn worthwhile
+    sky.use_cache = sky.use_scheduler && config.sky_cache_mib > 0;
+
+    // Deep catalogs are only ever read around the zoomed view
+    sky.use_tiles = config.tiles_path != NULL;
+
+    // Figures can be toggled on later, and are only parsed then
+    sky.constells_loaded = false;
+    sky.show_constells = config.constell;
+
+    struct Startup startup = {
+        .sky = &sky,
+        .config = &config,
+        .entries = NULL,
+        .name_table = {.index = NULL, .pool = NULL, .num_names = 0},
+    };
+    if (!load_sky(&startup))
     {
-        // At least one of the above functions failed, exit
+        // At least one of the loaders failed, exit
         exit(EXIT_FAILURE);
     }
 
+    if (config.write_tiles_path != NULL)
+    {
+        if (!write_tile_catalog(config.write_tiles_path, sky.star_table, sky.num_stars,
+                                sky_index_default_bands(sky.num_stars)))
+        {
+            fprintf(stderr, "ERROR: Could not write tile catalog %s\n", config.write_tiles_path);
+            exit(EXIT_FAILURE);
+        }
+        exit(EXIT_SUCCESS);
+    }
+
     // This memory is no longer needed
-    free(BSC5_entries);
+    free(startup.entries);
+    sw_timer_end(&startup_scope);
 
     // Terminal/System settings
     setlocale(LC_ALL, ""); // Required for unicode rendering
 #ifndef _WIN32
-    signal(SIGWINCH, catch_winch); // Capture window resizes
+    if (interactive && !use_events)
+    {
+        signal(SIGWINCH, catch_winch); // Capture window resizes
+    }
 #endif
     tzset(); // Initialize timezone information
 
-    // Ncurses initialization
-    ncurses_init(config.color);
+    // Stages of every frame are streamed to the trace in the background, with
+    // a track for each thread
+    static const char *const trace_threads[] = {"main", "compute"};
+    struct Tracer tracer;
+    if (config.trace_path != NULL)
+    {
+        if (!generate_tracer(&tracer, config.trace_path, trace_threads, config.pipeline ? 2 : 1))
+        {
+            fprintf(stderr, "ERROR: Could not write trace %s\n", config.trace_path);
+            exit(EXIT_FAILURE);
+        }
+        sky.presenter.trace = &tracer.buffers[0];
+        sky.producer.trace = &tracer.buffers[config.pipeline ? 1 : 0];
+    }
 
-    // Main (projection) window
-    WINDOW *main_win = newwin(0, 0, 0, 0);
-    resize_main(main_win, &config);
+    // Ncurses initialization. Benchmarks draw the same off-screen terminal
+    // whatever they are run from
+    if (interactive)
+    {
+        ncurses_init(config.color);
+    }
+    else if (!ncurses_init_headless(config.color, BENCH_ROWS, BENCH_COLS))
+    {
+        fprintf(stderr, "ERROR: Could not initialize curses off screen\n");
+        exit(EXIT_FAILURE);
+    }
 
-    // Metadata window
-    WINDOW *metadata_win = newwin(0, 0, 0, 0); // Position at top left
+    // Main (projection) and metadata windows, and canvases of the same size for
+    // each frame slot. The metadata window is positioned at the top left
+    sky.main_win = newwin(0, 0, 0, 0);
+    resize_main(sky.main_win, &config);
+    sky.metadata_win = newwin(0, 0, 0, 0);
     if (config.metadata)
     {
-        resize_meta(metadata_win);
+        resize_meta(sky.metadata_win);
     }
 
-    // Render loop
-    while (true)
+    sky.num_slots = config.pipeline ? PIPELINE_SLOTS : 1;
+    for (unsigned int i = 0; i < sky.num_slots; ++i)
+    {
+        if (!generate_canvas(&sky.main_canvases[i], getmaxy(sky.main_win), getmaxx(sky.main_win)) ||
+            !generate_canvas(&sky.metadata_canvases[i], getmaxy(sky.metadata_win), getmaxx(sky.metadata_win)))
+        {
+            ncurses_kill();
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    // Whole sky until zoomed in with the keyboard
+    view_init(&sky.view);
+    mutex_init(&sky.lock);
+
+    // Counters only count events of the thread that opened them, so the
+    // compute thread opens its own
+    struct PerfCounters main_counters;
+    struct PerfCounters compute_counters;
+    if (config.perf_counters)
     {
-        struct SwTimestamp frame_begin;
-        sw_gettime(&frame_begin);
+        perf_counters_open(&main_counters);
+        sky.presenter.counters = &main_counters;
+        sky.producer.counters = config.pipeline ? &compute_counters : &main_counters;
+    }
+
+    // While the main thread flushes a frame to the terminal, the compute thread
+    // already works on the next one
+    struct Thread compute_thread;
+    if (config.pipeline)
+    {
+        frame_ring_init(&sky.ring, sky.num_slots);
+        if (!thread_start(&compute_thread, compute_main, &sky))
+        {
+            ncurses_kill();
+            printf("Could not start the compute thread\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    // Headless benchmarks run flat out, and interactive sessions on a schedule
+    // that also drives simulation time
+    unsigned long long bench_usec = 0;
+    struct FramePacer pacer;
+    frame_pacer_init(&pacer, dt, (unsigned long long)config.spin_usec);
+    if (interactive)
+    {
+        run_frames(&sky, &pacer, &events, use_events);
+    }
+    else
+    {
+        bench_usec = run_bench(&sky, (unsigned long long)config.bench_frames);
+    }
 
+    // Clean up
+
+    if (config.pipeline)
+    {
+        frame_ring_close(&sky.ring);
+        thread_join(&compute_thread);
+        frame_ring_destroy(&sky.ring);
+    }
+    mutex_destroy(&sky.lock);
+    if (config.perf_counters)
+    {
+        perf_counters_close(sky.presenter.counters);
+        perf_counters_close(sky.producer.counters);
+    }
+
+    for (unsigned int i = 0; i < sky.num_slots; ++i)
+    {
+        free_canvas(&sky.main_canvases[i]);
+        free_canvas(&sky.metadata_canvases[i]);
+    }
+    ncurses_kill();
+    if (use_events)
+    {
+        event_loop_destroy(&events);
+    }
+    if (interactive)
+    {
+        print_frame_stats(&pacer.stats, config.fps);
+    }
+    else
+    {
+        print_bench_report(&sky.profiler, &startup_timer, (unsigned long long)config.bench_frames, bench_usec);
+        if (config.perf_counters)
+        {
+            print_bench_counters(&sky.profiler, sky.num_stars);
+        }
+    }
+    if (config.trace_path != NULL)
+    {
+        unsigned long long num_dropped = tracer_dropped(&tracer);
+        if (!free_tracer(&tracer))
+        {
+            fprintf(stderr, "ERROR: Could not write trace %s\n", config.trace_path);
+        }
+        else if (num_dropped > 0)
+        {
+            fprintf(stderr, "WARNING: %llu trace events were dropped while writing the trace\n", num_dropped);
+        }
+    }
+    if (config.profile_path != NULL && !profiler_write_csv(&sky.profiler, config.profile_path))
+    {
+        fprintf(stderr, "ERROR: Could not write profile %s\n", config.profile_path);
+    }
+
+    if (sky.constells_loaded)
+    {
+        free_constells(&sky.constell_table);
+    }
+    free_stars(sky.star_table, sky.num_stars);
+    free_planets(sky.planet_table, NUM_PLANETS);
+    free_moon_object(sky.moon_object);
+    free_star_names(&startup.name_table);
+    free(sky.idx_by_mag);
+    free_sky_index(&sky.sky_index);
+    free_visibility_scheduler(&sky.scheduler);
+    free_star_extrapolation(&sky.extrapolation);
+    free_projection_cache(&sky.projection_cache);
+    free_tile_catalog(&sky.tile_catalog);
+    free_profiler(&sky.profiler);
+    free_city_table(&sky.cities);
+
+    return EXIT_SUCCESS;
+}
+
+/* Compute and draw the frame due in slot `sky->frame` of the schedule off screen.
+ * Makes no curses calls, so it can run on any thread
+ */
+void produce_frame(struct Sky *sky, struct Canvas *main_canvas, struct Canvas *metadata_canvas)
+{
+    const struct Conf *config = sky->config;
+
+    struct ProfileMark mark;
+    profiler_mark(&mark, &sky->producer);
+
+    // Simulation time follows the pacing schedule rather than counting frames,
+    // so it keeps up with the wall clock when frames are late
+    const double microsec_per_day = 24.0 * 60.0 * 60.0 * 1.0E6;
+    julian_date = julian_date_start + (double)sky->frame * sky->dt / microsec_per_day * config->speed;
+
+    canvas_erase(metadata_canvas);
+    canvas_erase(main_canvas);
+    profiler_lap(&sky->profiler, STAGE_CLEAR, &mark);
+
+    // Look up where stars were drawn the last time the sky looked like this
+    struct CacheSlot *slot = NULL;
+    if (sky->use_cache && !sky->view.zoomed)
+    {
+        slot = projection_cache_slot(&sky->projection_cache, main_canvas->height, main_canvas->width,
+                                     config->latitude, config->longitude, config->threshold, julian_date);
+    }
+    bool cache_hit = slot != NULL && slot->filled;
+
+    // Update object positions
+    if (sky->view.zoomed)
+    {
+        // Only stars around the field of view are updated
+        double center_ra, center_dec;
+        view_center_equatorial(&sky->view, julian_date, config->latitude, config->longitude, &center_ra, &center_dec);
+        update_star_positions_in_cap(sky->star_table, &sky->sky_index, julian_date, config->latitude,
+                                     config->longitude, center_ra, center_dec, view_cap_radius(&sky->view));
+
+        if (sky->use_tiles)
+        {
+            // Draw whatever is resident and let the loader fetch the rest
+            unsigned int num_cells = (unsigned int)(main_canvas->height * main_canvas->width);
+            tile_catalog_request(&sky->tile_catalog, julian_date, center_ra, center_dec, view_cap_radius(&sky->view),
+                                 num_cells / CELLS_PER_TILE_STAR);
+            update_tile_star_positions(&sky->tile_catalog, julian_date, config->latitude, config->longitude);
+        }
+    }
+    else if (cache_hit)
+    {
+        // Constellation figures are still drawn from exact positions
+        update_pinned_star_positions(sky->star_table, &sky->scheduler, julian_date, config->latitude,
+                                     config->longitude);
+    }
+    else if (sky->use_scheduler)
+    {
+        // Slow clocks barely move stars between frames, so most of them
+        // are extrapolated within half a cell of their true position
+        double radius_cells = (MAX(main_canvas->height, main_canvas->width) - 1) / 2.0;
+        update_star_positions_amortized(sky->star_table, &sky->scheduler, &sky->extrapolation, julian_date,
+                                        config->latitude, config->longitude, radius_cells);
+    }
+    else
+    {
+        update_star_positions_indexed(sky->star_table, &sky->sky_index, julian_date, config->latitude,
+                                      config->longitude);
+    }
+    profiler_lap(&sky->profiler, STAGE_UPDATE_STARS, &mark);
+
+    update_planet_positions(sky->planet_table, julian_date, config->latitude, config->longitude);
+    profiler_lap(&sky->profiler, STAGE_UPDATE_PLANETS, &mark);
+
+    update_moon_position(&sky->moon_object, julian_date, config->latitude, config->longitude);
+    update_moon_phase(&sky->moon_object, julian_date, config->latitude);
+    profiler_lap(&sky->profiler, STAGE_UPDATE_MOON, &mark);
+
+    // Render objects
+    if (sky->view.zoomed && sky->use_tiles)
+    {
+        render_tile_stars_in_view(main_canvas, config, &sky->view, &sky->tile_catalog);
+        tile_catalog_release(&sky->tile_catalog);
+    }
+    else if (sky->view.zoomed)
+    {
+        render_stars_in_view(main_canvas, config, &sky->view, sky->star_table, &sky->sky_index);
+    }
+    else if (cache_hit)
+    {
+        render_cached_stars(main_canvas, config, sky->star_table, &sky->projection_cache, slot);
+    }
+    else if (sky->use_scheduler)
+    {
+        render_visible_stars_stereo(main_canvas, config, sky->star_table, &sky->scheduler,
+                                    sky->use_cache ? &sky->projection_cache : NULL, slot);
+    }
+    else
+    {
+        render_stars_stereo(main_canvas, config, sky->star_table, sky->num_stars, sky->idx_by_mag);
+    }
+    profiler_lap(&sky->profiler, STAGE_RENDER_STARS, &mark);
+
+    if (sky->show_constells)
+    {
+        render_constells(main_canvas, config, &sky->view, &sky->constell_table, sky->star_table);
+        profiler_lap(&sky->profiler, STAGE_RENDER_CONSTELLS, &mark);
+    }
+    render_planets_stereo(main_canvas, config, &sky->view, sky->planet_table);
+    profiler_lap(&sky->profiler, STAGE_RENDER_PLANETS, &mark);
+
+    render_moon_stereo(main_canvas, config, &sky->view, sky->moon_object);
+    profiler_lap(&sky->profiler, STAGE_RENDER_MOON, &mark);
+
+    if (sky->view.zoomed)
+    {
+        render_view_status(main_canvas, config, &sky->view);
+    }
+    else if (config->grid)
+    {
+        render_azimuthal_grid(main_canvas, config);
+    }
+    else
+    {
+        render_cardinal_directions(main_canvas, config);
+    }
+    profiler_lap(&sky->profiler, STAGE_RENDER_GRID, &mark);
+
+    // Render metadata
+    if (config->metadata)
+    {
+        mutex_lock(&sky->lock);
+        struct PacingSummary pacing = sky->pacing;
+        mutex_unlock(&sky->lock);
+
+        render_metadata(metadata_canvas, sky, &pacing);
+        profiler_lap(&sky->profiler, STAGE_RENDER_METADATA, &mark);
+    }
+}
+
+/* Copy the canvases of a slot to the windows and flush them to the terminal,
+ * on the main thread
+ */
+void present_frame(struct Sky *sky, unsigned int slot)
+{
+    struct Canvas *main_canvas = &sky->main_canvases[slot];
+    if (sky->show_profile)
+    {
+        struct StageSummary summary[NUM_PROFILE_STAGES];
+        profiler_summarize(&sky->profiler, summary);
+        render_profile(main_canvas, summary, sky->dt);
+    }
+
+    // Use double buffering to avoid flickering while updating
+    win_draw_canvas(sky->main_win, main_canvas);
+    wnoutrefresh(sky->main_win);
+    if (sky->config->metadata)
+    {
+        win_draw_canvas(sky->metadata_win, &sky->metadata_canvases[slot]);
+        wnoutrefresh(sky->metadata_win);
+    }
+    doupdate();
+}
+
+/* Show frames on the pacing schedule until the user quits. Every stage of each
+ * frame is timed from where the previous one ended
+ */
+void run_frames(struct Sky *sky, struct FramePacer *pacer, struct EventLoop *events, bool use_events)
+{
+    struct ProfileMark mark;
+    profiler_mark(&mark, &sky->presenter);
+    while (true)
+    {
 #ifdef _WIN32
         // Use this function to catch console resizes on Windows
         perform_resize = check_console_window_resize_event(&winsize);
@@ -148,99 +538,259 @@ int main(int argc, char *argv[])
 
         if (perform_resize)
         {
-            resize_ncurses();
-            resize_main(main_win, &config);
-            if (config.metadata)
-            {
-                resize_meta(metadata_win);
-            }
-            doupdate();
-
+            resize_windows(sky);
             perform_resize = false;
         }
+
+        unsigned int slot = 0;
+        if (sky->config->pipeline)
+        {
+            frame_ring_begin_read(&sky->ring, &slot);
+            profiler_lap(&sky->profiler, STAGE_FRAME_WAIT, &mark);
+        }
         else
         {
-            werase(metadata_win);
-            werase(main_win);
+            sky->frame = pacer->frame;
+            produce_frame(sky, &sky->main_canvases[0], &sky->metadata_canvases[0]);
+            profiler_mark(&mark, &sky->presenter);
         }
 
-        // Update object positions
-        update_star_positions(star_table, num_stars, julian_date, config.latitude, config.longitude);
-        update_planet_positions(planet_table, julian_date, config.latitude, config.longitude);
-        update_moon_position(&moon_object, julian_date, config.latitude, config.longitude);
-        update_moon_phase(&moon_object, julian_date, config.latitude);
+        present_frame(sky, slot);
 
-        // Render objects
-        render_stars_stereo(main_win, &config, star_table, num_stars, num_by_mag);
-        if (config.constell)
+        if (sky->config->pipeline)
         {
-            render_constells(main_win, &config, &constell_table, num_const, star_table);
+            frame_ring_end_read(&sky->ring);
         }
-        render_planets_stereo(main_win, &config, planet_table);
-        render_moon_stereo(main_win, &config, moon_object);
-        if (config.grid)
+        profiler_lap(&sky->profiler, STAGE_FLUSH, &mark);
+
+        // Wait for the next deadline, or skip the ones this frame missed
+        unsigned long long skipped;
+        if (use_events)
         {
-            render_azimuthal_grid(main_win, &config);
+            // Keys and resizes are handled as they arrive in the meantime
+            struct SwTimestamp wake;
+            skipped = frame_pacer_next(pacer, &wake);
+            if (!event_loop_arm(events, wake) || !wait_for_tick(sky, events))
+            {
+                break;
+            }
+            frame_pacer_begin(pacer);
         }
         else
         {
-            render_cardinal_directions(main_win, &config);
+            if (!read_keys(sky))
+            {
+                break;
+            }
+            skipped = frame_pacer_wait(pacer);
         }
+        profiler_lap(&sky->profiler, STAGE_SLEEP, &mark);
 
-        // Render metadata
-        if (config.metadata)
+        // Oversleeping shows in the trace as the gap between the deadline and
+        // the end of the sleep
+        if (sky->presenter.trace != NULL)
         {
-            render_metadata(metadata_win, &config);
+            struct SwTimestamp deadline = pacer->start;
+            sw_timeadd_usec(&deadline, pacer->frame * pacer->period);
+            trace_instant(sky->presenter.trace, "deadline", deadline);
         }
 
-        // Exit if ESC or q is pressed
-        int ch = getch();
-        if (ch != ERR && (ch == 27 || ch == 'q' || config.quit_on_any))
+        mutex_lock(&sky->lock);
+        sky->skipped_frames += skipped;
+        if (sky->config->metadata)
         {
-            break;
+            sky->pacing.p50_usec = histogram_percentile(&pacer->stats.times, 0.50);
+            sky->pacing.p99_usec = histogram_percentile(&pacer->stats.times, 0.99);
+            sky->pacing.max_usec = pacer->stats.times.max;
+            sky->pacing.num_missed = pacer->stats.num_missed;
+            sky->pacing.num_frames = pacer->stats.times.count;
         }
+        mutex_unlock(&sky->lock);
+    }
+}
+
+/* Draw `num_frames` frames off screen as fast as they can be computed and
+ * flushed, with simulation time advancing as if each was shown on schedule.
+ * Returns the time taken (microseconds)
+ */
+unsigned long long run_bench(struct Sky *sky, unsigned long long num_frames)
+{
+    struct ProfileMark mark;
+    profiler_mark(&mark, &sky->presenter);
+    struct SwTimestamp begin = mark.time;
 
-        // Use double buffering to avoid flickering while updating
-        wnoutrefresh(main_win);
-        if (config.metadata)
+    for (unsigned long long frame = 0; frame < num_frames; ++frame)
+    {
+        unsigned int slot = 0;
+        if (sky->config->pipeline)
         {
-            wnoutrefresh(metadata_win);
+            frame_ring_begin_read(&sky->ring, &slot);
+            profiler_lap(&sky->profiler, STAGE_FRAME_WAIT, &mark);
+        }
+        else
+        {
+            sky->frame = frame;
+            produce_frame(sky, &sky->main_canvases[0], &sky->metadata_canvases[0]);
+            profiler_mark(&mark, &sky->presenter);
         }
-        doupdate();
 
-        // TODO: this timing scheme *should* minimize any drift or divergence
-        // between simulation time and realtime. Check this to make sure.
+        // Curses still generates the output for a terminal, which is part of
+        // the cost of a frame
+        present_frame(sky, slot);
+
+        if (sky->config->pipeline)
+        {
+            frame_ring_end_read(&sky->ring);
+        }
+        profiler_lap(&sky->profiler, STAGE_FLUSH, &mark);
+    }
 
-        // Increment "simulation" time
-        const double microsec_per_day = 24.0 * 60.0 * 60.0 * 1.0E6;
-        julian_date += (double)dt / microsec_per_day * config.speed;
+    unsigned long long elapsed;
+    sw_timediff_usec(mark.time, begin, &elapsed);
+    return elapsed;
+}
 
-        // Determine time it took to update positions and render to screen
-        struct SwTimestamp frame_end;
-        sw_gettime(&frame_end);
+/* Produce frames into free slots of the ring until it is closed, applying key
+ * presses and skipped slots forwarded by the main thread first
+ */
+void compute_main(void *arg)
+{
+    struct Sky *sky = arg;
+    if (sky->producer.counters != NULL)
+    {
+        perf_counters_open(sky->producer.counters);
+    }
 
-        unsigned long long frame_time;
-        sw_timediff_usec(frame_end, frame_begin, &frame_time);
+    unsigned int slot;
+    while (frame_ring_begin_write(&sky->ring, &slot))
+    {
+        int keys[MAX_PENDING_KEYS];
+        mutex_lock(&sky->lock);
+        unsigned int num_keys = sky->num_pending_keys;
+        for (unsigned int i = 0; i < num_keys; ++i)
+        {
+            keys[i] = sky->pending_keys[i];
+        }
+        sky->num_pending_keys = 0;
+        sky->frame += sky->skipped_frames;
+        sky->skipped_frames = 0;
+        mutex_unlock(&sky->lock);
 
-        // If updating the frame took less time than the time between frames,
-        // wait the rest of the time
-        if (frame_time < dt)
+        for (unsigned int i = 0; i < num_keys; ++i)
         {
-            sw_sleep(dt - frame_time);
+            apply_key(sky, keys[i]);
         }
+
+        produce_frame(sky, &sky->main_canvases[slot], &sky->metadata_canvases[slot]);
+        frame_ring_end_write(&sky->ring);
+        sky->frame++;
     }
+}
 
-    // Clean up
+/* Resize the windows to the terminal and the canvases of every slot to the
+ * windows, between frames
+ */
+void resize_windows(struct Sky *sky)
+{
+    if (sky->config->pipeline)
+    {
+        frame_ring_pause(&sky->ring);
+    }
 
-    ncurses_kill();
+    resize_ncurses();
+    resize_main(sky->main_win, sky->config);
+    if (sky->config->metadata)
+    {
+        resize_meta(sky->metadata_win);
+    }
+    doupdate();
 
-    free_constells(constell_table, num_const);
-    free_stars(star_table, num_stars);
-    free_planets(planet_table, NUM_PLANETS);
-    free_moon_object(moon_object);
-    free_star_names(name_table, num_stars);
+    // A canvas that cannot be allocated is left empty, and its frames blank
+    for (unsigned int i = 0; i < sky->num_slots; ++i)
+    {
+        resize_canvas(&sky->main_canvases[i], getmaxy(sky->main_win), getmaxx(sky->main_win));
+        resize_canvas(&sky->metadata_canvases[i], getmaxy(sky->metadata_win), getmaxx(sky->metadata_win));
+    }
 
-    return EXIT_SUCCESS;
+    if (sky->config->pipeline)
+    {
+        frame_ring_resume(&sky->ring);
+    }
+}
+
+/* Pan or zoom with the keys waiting to be read. Returns false if ESC or q is
+ * pressed
+ */
+bool read_keys(struct Sky *sky)
+{
+    int ch;
+    while ((ch = getch()) != ERR)
+    {
+        if (ch == 27 || ch == 'q' || sky->config->quit_on_any)
+        {
+            return false;
+        }
+
+        // The profile is drawn over frames as they are presented
+        if (ch == 't')
+        {
+            sky->show_profile = !sky->show_profile;
+        }
+        else if (sky->config->pipeline)
+        {
+            mutex_lock(&sky->lock);
+            if (sky->num_pending_keys < MAX_PENDING_KEYS)
+            {
+                sky->pending_keys[sky->num_pending_keys++] = ch;
+            }
+            mutex_unlock(&sky->lock);
+        }
+        else
+        {
+            apply_key(sky, ch);
+        }
+    }
+    return true;
+}
+
+/* Toggle constellations, or pan and zoom, on the thread producing frames
+ */
+void apply_key(struct Sky *sky, int key)
+{
+    if (key == 'c')
+    {
+        // Figures stay hidden if they cannot be loaded, as there is nowhere to
+        // report the error while drawing
+        sky->show_constells = !sky->show_constells && (sky->constells_loaded || load_constellations(sky));
+        return;
+    }
+    view_handle_key(&sky->view, key);
+}
+
+/* Sleep until the armed deadline, handling keys and resizes as they arrive.
+ * Returns false to quit
+ */
+bool wait_for_tick(struct Sky *sky, struct EventLoop *events)
+{
+    while (true)
+    {
+        switch (event_loop_wait(events))
+        {
+        case LOOP_EVENT_TICK:
+            return true;
+        case LOOP_EVENT_INPUT:
+            if (!read_keys(sky))
+            {
+                return false;
+            }
+            break;
+        case LOOP_EVENT_RESIZE:
+            resize_windows(sky);
+            break;
+        case LOOP_EVENT_QUIT:
+            return false;
+        }
+    }
 }
 
 void parse_options(int argc, char *argv[], struct Conf *config)
@@ -269,14 +819,66 @@ void parse_options(int argc, char *argv[], struct Conf *config)
     struct arg_str *city_arg =
         arg_str0("i", "city", "<city_name>",
                  "Use the latitude and longitude of the provided city. If the name contains multiple words, "
-                 "enclose the name in single or double quotes. For a list of available cities, see: "
-                 "https://github.com/da-luce/astroterm/blob/v" PROJ_VERSION "/data/cities.csv");
+                 "enclose the name in single or double quotes. For a list of available cities, use --list-cities "
+                 "or see: https://github.com/da-luce/astroterm/blob/v" PROJ_VERSION "/data/cities.csv");
+    struct arg_str *city_file_arg =
+        arg_str0(NULL, "city-file", "<file>",
+                 "Use the cities in this file instead of the built-in ones, both to look up --city and to show the "
+                 "nearest city with --metadata: a CSV in the format of data/cities.csv, or a GeoNames dump such as "
+                 "cities500.txt");
+    struct arg_str *list_cities_arg =
+        arg_str0(NULL, "list-cities", "<prefix>",
+                 "List the cities whose name starts with <prefix>, with their coordinates, and exit. Use \"\" to "
+                 "list all of them");
+    struct arg_int *cache_arg =
+        arg_int0(NULL, "sky-cache", "<MiB>",
+                 "Remember where stars are drawn over each sidereal day, using at most this much memory. Speeds up "
+                 "long sessions at a fixed location and normal speed (default: 0, disabled)");
+    struct arg_str *projection_arg =
+        arg_str0("p", "projection", "<name>",
+                 "Map projection of the sky: stereographic, orthographic, lambert (equal-area) or equidistant "
+                 "(default: stereographic)");
+    struct arg_str *tiles_arg =
+        arg_str0(NULL, "tiles", "<file>",
+                 "Stream stars from a tiled deep catalog when zoomed in, loading the brightest stars around the "
+                 "view in the background");
+    struct arg_int *tile_cache_arg =
+        arg_int0(NULL, "tile-cache", "<MiB>", "Memory used for stars streamed with --tiles (default: 256)");
+    struct arg_str *write_tiles_arg =
+        arg_str0(NULL, "write-tiles", "<file>", "Write the built-in catalog as a tiled catalog and exit");
+    struct arg_lit *no_pipeline_arg =
+        arg_lit0(NULL, "no-pipeline",
+                 "Compute and draw each frame in turn instead of computing the next frame while the terminal draws "
+                 "the current one");
+    struct arg_str *profile_arg =
+        arg_str0(NULL, "profile-out", "<file>", "Write the time spent in each stage of a frame to this CSV file at exit");
+    struct arg_str *trace_arg =
+        arg_str0(NULL, "trace", "<file>",
+                 "Record the stages of every frame on each thread to this file, in the Chrome trace event format "
+                 "read by Perfetto and chrome://tracing");
+    struct arg_int *spin_arg =
+        arg_int0(NULL, "spin", "<usec>",
+                 "Busy-wait this long before each frame instead of sleeping, for steadier pacing at high frame rates "
+                 "(default: 0)");
+    struct arg_lit *bench_arg =
+        arg_lit0(NULL, "bench",
+                 "Draw frames off screen as fast as possible, then print frames per second and the time spent in "
+                 "each stage. Other options apply as usual");
+    struct arg_int *frames_arg = arg_int0(NULL, "frames", "<int>", "Frames drawn by --bench (default: 1000)");
+    struct arg_lit *perf_arg =
+        arg_lit0(NULL, "perf-counters",
+                 "With --bench, also count CPU cycles, instructions, cache and branch misses in each stage, per frame "
+                 "and per star (Linux only)");
     struct arg_lit *version_arg = arg_lit0("v", "version", "Display version info and exit");
     struct arg_end *end = arg_end(20);
 
-    void *argtable[] = {latitude_arg, longitude_arg, datetime_arg, threshold_arg, label_arg,   fps_arg,
-                        speed_arg,    color_arg,     constell_arg, grid_arg,      unicode_arg, quit_arg,
-                        meta_arg,     ratio_arg,     help_arg,     city_arg,      version_arg, end};
+    void *argtable[] = {latitude_arg, longitude_arg,  datetime_arg,    threshold_arg,   label_arg,
+                        fps_arg,      speed_arg,      color_arg,       constell_arg,    grid_arg,
+                        unicode_arg,  quit_arg,       meta_arg,        ratio_arg,       help_arg,
+                        city_arg,     city_file_arg,  list_cities_arg, cache_arg,       projection_arg,
+                        tiles_arg,    tile_cache_arg, write_tiles_arg, no_pipeline_arg, spin_arg,
+                        profile_arg,  trace_arg,      bench_arg,       frames_arg,      perf_arg,
+                        version_arg,  end};
 
     int nerrors = arg_parse(argc, argv, argtable);
 
@@ -301,6 +903,8 @@ void parse_options(int argc, char *argv[], struct Conf *config)
         exit(EXIT_SUCCESS);
     }
 
+    config->coordinates_given = latitude_arg->count > 0 || longitude_arg->count > 0;
+
     if (latitude_arg->count > 0)
     {
         config->latitude = latitude_arg->dval[0];
@@ -386,20 +990,105 @@ void parse_options(int argc, char *argv[], struct Conf *config)
         config->aspect_ratio = ratio_arg->dval[0];
     }
 
-    if (city_arg->count > 0)
+    if (cache_arg->count > 0)
     {
-        const char *city_name = city_arg->sval[0];
-        CityData *city = get_city(city_name);
+        config->sky_cache_mib = cache_arg->ival[0];
+        if (config->sky_cache_mib < 0)
+        {
+            fprintf(stderr, "ERROR: Sky cache size must be non-negative\n");
+            exit(EXIT_FAILURE);
+        }
+    }
 
-        if (!city)
+    if (projection_arg->count > 0)
+    {
+        if (!projection_from_name(projection_arg->sval[0], &config->projection))
         {
-            fprintf(stderr, "ERROR: Could not find city \"%s\"\n", city_name);
+            fprintf(stderr, "ERROR: Unknown projection \"%s\"\n", projection_arg->sval[0]);
             exit(EXIT_FAILURE);
         }
+    }
+
+    if (tiles_arg->count > 0)
+    {
+        config->tiles_path = tiles_arg->sval[0];
+    }
+
+    if (tile_cache_arg->count > 0)
+    {
+        config->tile_cache_mib = tile_cache_arg->ival[0];
+        if (config->tile_cache_mib < 1)
+        {
+            fprintf(stderr, "ERROR: Tile cache size must be at least 1 MiB\n");
+            exit(EXIT_FAILURE);
+        }
+    }
 
-        config->latitude = city->latitude;
-        config->longitude = city->longitude;
-        free_city(city);
+    if (write_tiles_arg->count > 0)
+    {
+        config->write_tiles_path = write_tiles_arg->sval[0];
+    }
+
+    if (no_pipeline_arg->count > 0)
+    {
+        config->pipeline = false;
+    }
+
+    if (profile_arg->count > 0)
+    {
+        config->profile_path = profile_arg->sval[0];
+    }
+
+    if (trace_arg->count > 0)
+    {
+        config->trace_path = trace_arg->sval[0];
+    }
+
+    if (spin_arg->count > 0)
+    {
+        config->spin_usec = spin_arg->ival[0];
+        if (config->spin_usec < 0)
+        {
+            fprintf(stderr, "ERROR: Spin time must be non-negative\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    if ((frames_arg->count > 0 || perf_arg->count > 0) && bench_arg->count == 0)
+    {
+        fprintf(stderr, "ERROR: --frames and --perf-counters only apply to --bench\n");
+        exit(EXIT_FAILURE);
+    }
+
+    if (bench_arg->count > 0)
+    {
+        config->bench_frames = frames_arg->count > 0 ? frames_arg->ival[0] : 1000;
+        if (config->bench_frames < 1)
+        {
+            fprintf(stderr, "ERROR: Number of frames must be at least 1\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    if (perf_arg->count > 0)
+    {
+        config->perf_counters = true;
+    }
+
+    if (city_arg->count > 0)
+    {
+        // Looked up while the catalogs load
+        config->city_name = city_arg->sval[0];
+    }
+
+    if (city_file_arg->count > 0)
+    {
+        config->city_file = city_file_arg->sval[0];
+    }
+
+    if (list_cities_arg->count > 0)
+    {
+        config->list_cities = list_cities_arg->sval[0];
     }
 
     // Free Argtable resources
@@ -492,7 +1181,7 @@ void resize_meta(WINDOW *win)
     wnoutrefresh(win);
 #endif
 
-    const int meta_lines = 6; // Allows for 6 rows
+    const int meta_lines = 9; // Allows for 9 rows
     const int meta_cols = 45; // Set to allow enough room for longest line (elapsed time)
 
     wresize(win, MIN(LINES, meta_lines), MIN(COLS, meta_cols));
@@ -521,8 +1210,10 @@ const char *get_timezone(const struct tm *local_time)
 #endif
 }
 
-void render_metadata(WINDOW *win, const struct Conf *config)
+void render_metadata(struct Canvas *canvas, const struct Sky *sky, const struct PacingSummary *pacing)
 {
+    const struct Conf *config = sky->config;
+
     // Gregorian Date (local time)
 
     // Convert sim julian date (UTC) to local time
@@ -542,35 +1233,35 @@ void render_metadata(WINDOW *win, const struct Conf *config)
     int minute = local_time->tm_min;       // Minute (0-59)
 
     const char *timezone = get_timezone(local_time);
-    mvwprintw(win, 0, 0, "Date (%s): \t%02d-%02d-%04d %02d:%02d", timezone, day, month, year, hour, minute);
+    canvas_printf(canvas, 0, 0, "Date (%s): \t%02d-%02d-%04d %02d:%02d", timezone, day, month, year, hour, minute);
 
     // Zodiac
     const char *zodiac_name = get_zodiac_sign(month, day);
     const char *zodiac_symbol = get_zodiac_symbol(month, day);
     if (config->unicode)
     {
-        mvwprintw(win, 1, 0, "Zodiac: \t%s %s", zodiac_name, zodiac_symbol);
+        canvas_printf(canvas, 1, 0, "Zodiac: \t%s %s", zodiac_name, zodiac_symbol);
     }
     else
     {
-        mvwprintw(win, 1, 0, "Zodiac: \t%s", zodiac_name);
+        canvas_printf(canvas, 1, 0, "Zodiac: \t%s", zodiac_name);
     }
 
     // Lunar phase
     double age = calc_moon_age(julian_date);
     enum MoonPhase phase = moon_age_to_phase(age);
     const char *lunar_phase = get_moon_phase_name(phase);
-    mvwprintw(win, 2, 0, "Lunar Phase: \t%s", lunar_phase);
+    canvas_printf(canvas, 2, 0, "Lunar Phase: \t%s", lunar_phase);
 
     // Lat and Lon (convert back to degrees)
     int deg, min;
     double sec;
     decimal_to_dms(config->latitude * 180 / M_PI, &deg, &min, &sec);
-    mvwprintw(win, 3, 0, "Latitude: \t%d° %d' %.2f\"", deg, min, sec);
+    canvas_printf(canvas, 3, 0, "Latitude: \t%d° %d' %.2f\"", deg, min, sec);
 
     // Longitude
     decimal_to_dms(config->longitude * 180 / M_PI, &deg, &min, &sec);
-    mvwprintw(win, 4, 0, "Longitude: \t%d° %d' %.2f\"", deg, min, sec);
+    canvas_printf(canvas, 4, 0, "Longitude: \t%d° %d' %.2f\"", deg, min, sec);
 
     // Elapsed time
     int eyears, edays, ehours, emins, esecs;
@@ -579,8 +1270,19 @@ void render_metadata(WINDOW *win, const struct Conf *config)
     const char *day_label = (edays == 1) ? " day" : "days";
 
     // Display elapsed time with proper labels
-    mvwprintw(win, 5, 0, "Elapsed Time: \t%03d %s, %03d %s, %02d:%02d:%02d", eyears, year_label, edays, day_label, ehours,
-              emins, esecs);
+    canvas_printf(canvas, 5, 0, "Elapsed Time: \t%03d %s, %03d %s, %02d:%02d:%02d", eyears, year_label, edays, day_label,
+                  ehours, emins, esecs);
+
+    // Time between frames and frames that missed their deadline
+    canvas_printf(canvas, 6, 0, "Frame Time: \tp50 %.1f p99 %.1f max %.1f ms", pacing->p50_usec / 1.0E3,
+                  pacing->p99_usec / 1.0E3, pacing->max_usec / 1.0E3);
+    canvas_printf(canvas, 7, 0, "Missed Frames: \t%llu of %llu", pacing->num_missed, pacing->num_frames);
+
+    if (sky->nearest_city != NULL)
+    {
+        canvas_printf(canvas, 8, 0, "Nearest City: \t%s, %s (%.0f km)", sky->nearest_city->name,
+                      sky->nearest_city->country_code, sky->nearest_city_distance * EARTH_RADIUS_KM);
+    }
 
     return;
 }
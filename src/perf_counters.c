@@ -0,0 +1,144 @@
+#include "perf_counters.h"
+
+static const char *counter_names[NUM_PERF_COUNTERS] = {
+    [COUNTER_CYCLES] = "cycles",
+    [COUNTER_INSTRUCTIONS] = "instructions",
+    [COUNTER_L1D_MISSES] = "L1D misses",
+    [COUNTER_LLC_MISSES] = "LLC misses",
+    [COUNTER_BRANCH_MISSES] = "branch misses",
+};
+
+const char *perf_counter_name(enum PerfCounter counter)
+{
+    return counter_names[counter];
+}
+
+#ifdef __linux__
+
+#include <linux/perf_event.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#define CACHE_READ_MISS(cache) ((cache) | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16))
+
+static const struct
+{
+    uint32_t type;
+    uint64_t config;
+} counter_events[NUM_PERF_COUNTERS] = {
+    [COUNTER_CYCLES] = {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    [COUNTER_INSTRUCTIONS] = {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    [COUNTER_L1D_MISSES] = {PERF_TYPE_HW_CACHE, CACHE_READ_MISS(PERF_COUNT_HW_CACHE_L1D)},
+    [COUNTER_LLC_MISSES] = {PERF_TYPE_HW_CACHE, CACHE_READ_MISS(PERF_COUNT_HW_CACHE_LL)},
+    [COUNTER_BRANCH_MISSES] = {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+};
+
+bool perf_counters_open(struct PerfCounters *counters)
+{
+    counters->group_fd = -1;
+    counters->num_open = 0;
+
+    for (int counter = 0; counter < NUM_PERF_COUNTERS; ++counter)
+    {
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = counter_events[counter].type;
+        attr.config = counter_events[counter].config;
+        attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        attr.exclude_kernel = 1; // Allowed with the default perf_event_paranoid
+        attr.exclude_hv = 1;
+
+        // This thread, on whichever CPU it runs
+        long fd = syscall(SYS_perf_event_open, &attr, 0, -1, counters->group_fd, PERF_FLAG_FD_CLOEXEC);
+        counters->fds[counter] = (int)fd;
+        if (fd == -1)
+        {
+            continue;
+        }
+
+        if (counters->group_fd == -1)
+        {
+            counters->group_fd = (int)fd;
+        }
+        counters->num_open++;
+    }
+
+    return counters->num_open > 0;
+}
+
+bool perf_counters_read(const struct PerfCounters *counters, struct PerfSample *sample)
+{
+    sample->valid = 0;
+    if (counters->num_open == 0)
+    {
+        return false;
+    }
+
+    // Number of counters, time enabled and running, then each counter in the
+    // order they joined the group
+    uint64_t data[3 + NUM_PERF_COUNTERS];
+    ssize_t size = (ssize_t)((3 + counters->num_open) * sizeof(uint64_t));
+    if (read(counters->group_fd, data, (size_t)size) != size || data[0] != counters->num_open || data[2] == 0)
+    {
+        return false;
+    }
+
+    double scale = (double)data[1] / (double)data[2];
+    unsigned int next = 3;
+    for (int counter = 0; counter < NUM_PERF_COUNTERS; ++counter)
+    {
+        if (counters->fds[counter] == -1)
+        {
+            continue;
+        }
+
+        sample->values[counter] = (unsigned long long)((double)data[next++] * scale);
+        sample->valid |= 1u << counter;
+    }
+
+    return true;
+}
+
+void perf_counters_close(struct PerfCounters *counters)
+{
+    for (int counter = 0; counter < NUM_PERF_COUNTERS; ++counter)
+    {
+        if (counters->fds[counter] != -1)
+        {
+            close(counters->fds[counter]);
+            counters->fds[counter] = -1;
+        }
+    }
+    counters->group_fd = -1;
+    counters->num_open = 0;
+}
+
+#else
+
+bool perf_counters_open(struct PerfCounters *counters)
+{
+    for (int counter = 0; counter < NUM_PERF_COUNTERS; ++counter)
+    {
+        counters->fds[counter] = -1;
+    }
+    counters->group_fd = -1;
+    counters->num_open = 0;
+    return false;
+}
+
+bool perf_counters_read(const struct PerfCounters *counters, struct PerfSample *sample)
+{
+    (void)counters;
+    sample->valid = 0;
+    return false;
+}
+
+void perf_counters_close(struct PerfCounters *counters)
+{
+    (void)counters;
+}
+
+#endif // __linux__
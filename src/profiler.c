@@ -0,0 +1,156 @@
+#include "profiler.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char *stage_names[NUM_PROFILE_STAGES] = {
+    [STAGE_CLEAR] = "clear",
+    [STAGE_UPDATE_STARS] = "update stars",
+    [STAGE_UPDATE_PLANETS] = "update planets",
+    [STAGE_UPDATE_MOON] = "update moon",
+    [STAGE_RENDER_STARS] = "render stars",
+    [STAGE_RENDER_CONSTELLS] = "render constellations",
+    [STAGE_RENDER_PLANETS] = "render planets",
+    [STAGE_RENDER_MOON] = "render moon",
+    [STAGE_RENDER_GRID] = "render grid",
+    [STAGE_RENDER_METADATA] = "render metadata",
+    [STAGE_FRAME_WAIT] = "frame wait",
+    [STAGE_FLUSH] = "flush",
+    [STAGE_SLEEP] = "sleep",
+};
+
+bool generate_profiler(struct Profiler *profiler)
+{
+    // Too large for the stack on some platforms
+    profiler->stages = malloc(NUM_PROFILE_STAGES * sizeof(struct Histogram));
+    if (profiler->stages == NULL)
+    {
+        printf("Allocation of memory for profiler failed\n");
+        return false;
+    }
+
+    for (int stage = 0; stage < NUM_PROFILE_STAGES; ++stage)
+    {
+        histogram_reset(&profiler->stages[stage]);
+    }
+    memset(profiler->counts, 0, sizeof(profiler->counts));
+    mutex_init(&profiler->lock);
+
+    return true;
+}
+
+void free_profiler(struct Profiler *profiler)
+{
+    if (profiler->stages == NULL)
+    {
+        return;
+    }
+
+    mutex_destroy(&profiler->lock);
+    free(profiler->stages);
+    profiler->stages = NULL;
+}
+
+const char *profile_stage_name(enum ProfileStage stage)
+{
+    return stage_names[stage];
+}
+
+void profiler_mark(struct ProfileMark *mark, const struct ProfileThread *thread)
+{
+    sw_gettime(&mark->time);
+    mark->thread.counters = thread != NULL ? thread->counters : NULL;
+    mark->thread.trace = thread != NULL ? thread->trace : NULL;
+    mark->sample.valid = 0;
+    if (mark->thread.counters != NULL)
+    {
+        perf_counters_read(mark->thread.counters, &mark->sample);
+    }
+}
+
+void profiler_lap(struct Profiler *profiler, enum ProfileStage stage, struct ProfileMark *mark)
+{
+    struct SwTimestamp now;
+    sw_gettime(&now);
+
+    struct PerfSample sample = {.valid = 0};
+    if (mark->thread.counters != NULL)
+    {
+        perf_counters_read(mark->thread.counters, &sample);
+    }
+
+    unsigned long long elapsed;
+    sw_timediff_usec(now, mark->time, &elapsed);
+
+    // Only counters read at both ends of the lap count
+    unsigned int valid = sample.valid & mark->sample.valid;
+
+    mutex_lock(&profiler->lock);
+    histogram_record(&profiler->stages[stage], elapsed);
+    if (valid != 0)
+    {
+        struct StageCounts *counts = &profiler->counts[stage];
+        counts->valid = counts->laps == 0 ? valid : counts->valid & valid;
+        counts->laps++;
+        for (int counter = 0; counter < NUM_PERF_COUNTERS; ++counter)
+        {
+            if (valid & (1u << counter))
+            {
+                counts->events[counter] += sample.values[counter] - mark->sample.values[counter];
+            }
+        }
+    }
+    mutex_unlock(&profiler->lock);
+
+    if (mark->thread.trace != NULL)
+    {
+        trace_span(mark->thread.trace, stage_names[stage], mark->time, now);
+    }
+
+    mark->time = now;
+    mark->sample = sample;
+}
+
+void profiler_summarize(struct Profiler *profiler, struct StageSummary summary[NUM_PROFILE_STAGES])
+{
+    mutex_lock(&profiler->lock);
+    for (int stage = 0; stage < NUM_PROFILE_STAGES; ++stage)
+    {
+        const struct Histogram *histogram = &profiler->stages[stage];
+        summary[stage].count = histogram->count;
+        summary[stage].p50 = histogram_percentile(histogram, 0.50);
+        summary[stage].p99 = histogram_percentile(histogram, 0.99);
+        summary[stage].max = histogram->max;
+        summary[stage].mean = histogram_mean(histogram);
+    }
+    mutex_unlock(&profiler->lock);
+}
+
+void profiler_counts(struct Profiler *profiler, struct StageCounts counts[NUM_PROFILE_STAGES])
+{
+    mutex_lock(&profiler->lock);
+    memcpy(counts, profiler->counts, sizeof(profiler->counts));
+    mutex_unlock(&profiler->lock);
+}
+
+bool profiler_write_csv(struct Profiler *profiler, const char *path)
+{
+    FILE *file = fopen(path, "w");
+    if (file == NULL)
+    {
+        return false;
+    }
+
+    struct StageSummary summary[NUM_PROFILE_STAGES];
+    profiler_summarize(profiler, summary);
+
+    fprintf(file, "stage,count,mean_us,p50_us,p99_us,max_us\n");
+    for (int stage = 0; stage < NUM_PROFILE_STAGES; ++stage)
+    {
+        fprintf(file, "%s,%llu,%.1f,%llu,%llu,%llu\n", stage_names[stage], summary[stage].count, summary[stage].mean,
+                summary[stage].p50, summary[stage].p99, summary[stage].max);
+    }
+
+    return fclose(file) == 0;
+}
@@ -0,0 +1,147 @@
+#include "projection_cache.h"
+
+#include "astro.h"
+#include "macros.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Proper motion eventually moves stars out of their cached cells, so cached
+// positions are dropped after this long (days)
+#define CACHE_MAX_AGE 365.2425
+
+static void clear_cache(struct ProjectionCache *cache)
+{
+    cache->num_stars = 0;
+    for (unsigned int i = 0; i < cache->num_slots; ++i)
+    {
+        cache->slots[i] = (struct CacheSlot){0};
+    }
+}
+
+/* Number of slots per sidereal day so stars move at most half a cell per slot.
+ * The projection maps the hemisphere onto a disk of `radius` cells and is never
+ * stretched by more than one cell per radian of radius, so a turn of the sky
+ * moves a star by no more than 2π * radius cells
+ */
+static unsigned int slots_per_day(int height, int width)
+{
+    double radius = (MAX(height, width) - 1) / 2.0;
+    return (unsigned int)ceil(4.0 * M_PI * fmax(radius, 1.0));
+}
+
+bool generate_projection_cache(struct ProjectionCache *cache, size_t budget)
+{
+    memset(cache, 0, sizeof(struct ProjectionCache));
+    cache->budget = budget;
+    return true;
+}
+
+struct CacheSlot *projection_cache_slot(struct ProjectionCache *cache, int height, int width, double latitude,
+                                        double longitude, float threshold, double julian_date)
+{
+    bool key_changed = cache->slots == NULL || height != cache->height || width != cache->width ||
+                       latitude != cache->latitude || longitude != cache->longitude ||
+                       threshold != cache->threshold;
+    if (key_changed)
+    {
+        unsigned int num_slots = slots_per_day(height, width);
+        struct CacheSlot *slots = realloc(cache->slots, num_slots * sizeof(struct CacheSlot));
+        if (slots == NULL)
+        {
+            printf("Allocation of memory for projection cache failed\n");
+            return NULL;
+        }
+
+        cache->slots = slots;
+        cache->num_slots = num_slots;
+        cache->height = height;
+        cache->width = width;
+        cache->latitude = latitude;
+        cache->longitude = longitude;
+        cache->threshold = threshold;
+        clear_cache(cache);
+        cache->created_julian_date = julian_date;
+    }
+    else if (fabs(julian_date - cache->created_julian_date) > CACHE_MAX_AGE)
+    {
+        clear_cache(cache);
+        cache->created_julian_date = julian_date;
+    }
+
+    double gmst = greenwich_mean_sidereal_time_rad(julian_date);
+    double local_sidereal_time = fmod(gmst + longitude, 2.0 * M_PI);
+    local_sidereal_time += local_sidereal_time < 0.0 ? 2.0 * M_PI : 0.0;
+
+    unsigned int slot = (unsigned int)(local_sidereal_time / (2.0 * M_PI) * cache->num_slots);
+    return &cache->slots[MIN(slot, cache->num_slots - 1)];
+}
+
+bool projection_cache_append(struct ProjectionCache *cache, struct CacheSlot *slot, unsigned int star, int row,
+                             int col)
+{
+    if (slot->uncacheable || row < 0 || col < 0 || row > UINT16_MAX || col > UINT16_MAX)
+    {
+        return false;
+    }
+
+    if (slot->count == 0)
+    {
+        slot->offset = cache->num_stars;
+    }
+
+    if (cache->num_stars == cache->capacity)
+    {
+        // Grow geometrically, but never past the budget
+        size_t max_capacity = cache->budget / sizeof(struct CachedStar);
+        size_t capacity = MIN(MAX(2 * (size_t)cache->capacity, 1024), max_capacity);
+        if (capacity <= cache->num_stars)
+        {
+            return false;
+        }
+
+        struct CachedStar *stars = realloc(cache->stars, capacity * sizeof(struct CachedStar));
+        if (stars == NULL)
+        {
+            return false;
+        }
+        cache->stars = stars;
+        cache->capacity = (unsigned int)capacity;
+    }
+
+    cache->stars[cache->num_stars++] = (struct CachedStar){
+        .star = star,
+        .row = (uint16_t)row,
+        .col = (uint16_t)col,
+    };
+    slot->count++;
+
+    return true;
+}
+
+void projection_cache_finish(struct ProjectionCache *cache, struct CacheSlot *slot, bool keep)
+{
+    if (keep)
+    {
+        slot->filled = true;
+        return;
+    }
+
+    // Slots are filled one at a time, so the discarded stars are at the end
+    if (slot->count > 0)
+    {
+        cache->num_stars = slot->offset;
+    }
+
+    // The slot would overflow again every time it comes around
+    *slot = (struct CacheSlot){.uncacheable = true};
+}
+
+void free_projection_cache(struct ProjectionCache *cache)
+{
+    free(cache->stars);
+    free(cache->slots);
+    memset(cache, 0, sizeof(struct ProjectionCache));
+}
@@ -0,0 +1,161 @@
+#include "report.h"
+
+#include "macros.h"
+#include "perf_counters.h"
+#include "stopwatch.h"
+
+#include <stdio.h>
+
+void print_frame_stats(const struct FrameStats *stats, int fps)
+{
+    if (stats->times.count == 0)
+    {
+        return;
+    }
+
+    printf("%llu frames at %d fps, %llu missed deadlines. Time between frames: p50 %.1f ms, p99 %.1f ms, max %.1f ms\n",
+           stats->times.count, fps, stats->num_missed, histogram_percentile(&stats->times, 0.50) / 1.0E3,
+           histogram_percentile(&stats->times, 0.99) / 1.0E3, stats->times.max / 1.0E3);
+}
+
+void print_bench_report(struct Profiler *profiler, const struct SwTimer *startup, unsigned long long num_frames,
+                        unsigned long long usec)
+{
+    double seconds = usec / 1.0E6;
+    printf("%llu frames in %.3f s: %.1f frames/s, %.1f us/frame\n", num_frames, seconds,
+           seconds > 0.0 ? num_frames / seconds : 0.0, (double)usec / num_frames);
+    printf("Startup: %.2f ms\n", startup->times.sum / 1.0E6);
+
+    // CPU time of every thread, including startup, against the time frames took
+    struct SwUsage usage;
+    if (sw_process_usage(&usage) == 0)
+    {
+        printf("CPU time: user %.3f s, system %.3f s, max RSS %.1f MiB, %llu involuntary context switches\n",
+               usage.user_nsec / 1.0E9, usage.system_nsec / 1.0E9, usage.max_rss_kib / 1024.0, usage.involuntary_switches);
+    }
+    printf("\n");
+
+    // With the pipeline, stages on the compute thread overlap the flush, so
+    // their shares add up to more than the whole
+    struct StageSummary summary[NUM_PROFILE_STAGES];
+    profiler_summarize(profiler, summary);
+    printf("%-22s %10s %8s %8s %8s %7s\n", "Stage", "mean (us)", "p50", "p99", "max", "share");
+    for (int stage = 0; stage < NUM_PROFILE_STAGES; ++stage)
+    {
+        if (summary[stage].count == 0)
+        {
+            continue;
+        }
+
+        double share = usec > 0 ? 100.0 * summary[stage].mean * summary[stage].count / usec : 0.0;
+        printf("%-22s %10.1f %8llu %8llu %8llu %6.1f%%\n", profile_stage_name(stage), summary[stage].mean,
+               summary[stage].p50, summary[stage].p99, summary[stage].max, share);
+    }
+}
+
+void print_bench_counters(struct Profiler *profiler, unsigned int num_stars)
+{
+    struct StageCounts counts[NUM_PROFILE_STAGES];
+    profiler_counts(profiler, counts);
+
+    unsigned int valid = 0;
+    for (int stage = 0; stage < NUM_PROFILE_STAGES; ++stage)
+    {
+        valid |= counts[stage].valid;
+    }
+    if (valid == 0)
+    {
+        printf("\nHardware counters are unavailable: the CPU may not expose them, as in many virtual machines, or "
+               "/proc/sys/kernel/perf_event_paranoid restricts them\n");
+        return;
+    }
+
+    // Per star of the catalog, to compare the cost of the star loops across
+    // thresholds and catalogs
+    const char *titles[] = {"per frame", "per star"};
+    for (int table = 0; table < 2; ++table)
+    {
+        printf("\n%-22s", "Counters");
+        for (int counter = 0; counter < NUM_PERF_COUNTERS; ++counter)
+        {
+            if (valid & (1u << counter))
+            {
+                printf(" %14s", perf_counter_name(counter));
+            }
+        }
+        printf(" %6s  (%s)\n", "IPC", titles[table]);
+
+        for (int stage = 0; stage < NUM_PROFILE_STAGES; ++stage)
+        {
+            const struct StageCounts *stage_counts = &counts[stage];
+            if (stage_counts->laps == 0)
+            {
+                continue;
+            }
+
+            double divisor = (double)stage_counts->laps * (table == 0 ? 1.0 : (double)num_stars);
+            printf("%-22s", profile_stage_name(stage));
+            for (int counter = 0; counter < NUM_PERF_COUNTERS; ++counter)
+            {
+                if (!(valid & (1u << counter)))
+                {
+                    continue;
+                }
+                if (stage_counts->valid & (1u << counter))
+                {
+                    printf(table == 0 ? " %14.0f" : " %14.3f", stage_counts->events[counter] / divisor);
+                }
+                else
+                {
+                    printf(" %14s", "-");
+                }
+            }
+
+            unsigned int ipc_counters = (1u << COUNTER_CYCLES) | (1u << COUNTER_INSTRUCTIONS);
+            if ((stage_counts->valid & ipc_counters) == ipc_counters && stage_counts->events[COUNTER_CYCLES] > 0)
+            {
+                printf(" %6.2f\n", (double)stage_counts->events[COUNTER_INSTRUCTIONS] /
+                                       (double)stage_counts->events[COUNTER_CYCLES]);
+            }
+            else
+            {
+                printf(" %6s\n", "-");
+            }
+        }
+    }
+}
+
+void render_profile(struct Canvas *canvas, const struct StageSummary summary[NUM_PROFILE_STAGES],
+                    unsigned long long dt)
+{
+    // Bars show the median time of each stage against the time between frames
+    const int bar_width = 10;
+    const int profile_cols = 50;
+
+    int x = MAX(0, canvas->width - profile_cols);
+    int y = 0;
+
+    char line[96];
+    snprintf(line, sizeof(line), "%-22s %7s %7s  %-*s", "Stage (us)", "p50", "p99", bar_width, "of frame");
+    canvas_put_str(canvas, y++, x, line);
+
+    for (int stage = 0; stage < NUM_PROFILE_STAGES; ++stage)
+    {
+        if (summary[stage].count == 0)
+        {
+            continue;
+        }
+
+        char bar[16];
+        int filled = (int)MIN((double)bar_width, (double)summary[stage].p50 * bar_width / (double)dt + 0.5);
+        for (int i = 0; i < bar_width; ++i)
+        {
+            bar[i] = i < filled ? '#' : '.';
+        }
+        bar[bar_width] = '\0';
+
+        snprintf(line, sizeof(line), "%-22s %7llu %7llu  %s", profile_stage_name(stage), summary[stage].p50,
+                 summary[stage].p99, bar);
+        canvas_put_str(canvas, y++, x, line);
+    }
+}
@@ -0,0 +1,278 @@
+#include "sky.h"
+
+#include "city_lookup.h"
+#include "city_tree.h"
+#include "data/keplerian_elements.h"
+#include "macros.h"
+#include "task_graph.h"
+
+// Embedded data generated during build
+#include "bsc5.h"
+#include "bsc5_constellations.h"
+#include "bsc5_names.h"
+
+#include <math.h>
+#include <stdio.h>
+
+/* Keep the endpoints of the parsed constellations up to date. Frees the table
+ * upon memory allocation error
+ */
+static bool pin_constellations(struct Sky *sky)
+{
+    // Constellation endpoints need positions even below the horizon to clip
+    // their segments, so they are never culled once figures are drawn
+    unsigned int num_endpoints = sky->constell_table.offsets[sky->constell_table.num_constells] * 2;
+    if (!sky_index_pin_stars(&sky->sky_index, sky->constell_table.endpoints, num_endpoints))
+    {
+        free_constells(&sky->constell_table);
+        return false;
+    }
+    if (sky->use_scheduler)
+    {
+        visibility_scheduler_pin_stars(&sky->scheduler, sky->constell_table.endpoints, num_endpoints);
+    }
+
+    sky->constells_loaded = true;
+    return true;
+}
+
+bool load_constellations(struct Sky *sky)
+{
+    return generate_constell_table(bsc5_constellations, bsc5_constellations_len, sky->num_stars,
+                                   &sky->constell_table) &&
+           pin_constellations(sky);
+}
+
+/* Whether any star is bright enough to be both drawn and labeled, which the
+ * thresholds fix for the session
+ */
+static bool any_label_drawn(const struct Entry *entries, unsigned int num_entries, const struct Conf *config)
+{
+    float magnitude = MIN(config->label_thresh, config->threshold);
+    for (unsigned int i = 0; i < num_entries; ++i)
+    {
+        if (entries[i].MAG / 100.0f <= magnitude)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Startup tasks, each taking the startup state
+
+static bool load_entries(void *arg)
+{
+    struct Startup *startup = arg;
+
+    // Generated BSC5 data during build in bsc5_xxx.h:
+    //
+    // uint8_t bsc5_xxx[];
+    // size_t bsc5_xxx_len;
+    return parse_entries(bsc5, bsc5_len, &startup->entries, &startup->sky->num_stars);
+}
+
+static bool load_names(void *arg)
+{
+    struct Startup *startup = arg;
+
+    // Names are only ever read for labels, and tile catalogs store none
+    if (startup->config->write_tiles_path != NULL ||
+        !any_label_drawn(startup->entries, startup->sky->num_stars, startup->config))
+    {
+        return true;
+    }
+    return generate_name_table(bsc5_names, bsc5_names_len, &startup->name_table);
+}
+
+static bool load_star_table(void *arg)
+{
+    struct Startup *startup = arg;
+    struct Sky *sky = startup->sky;
+    if (!generate_star_table(&sky->star_table, startup->entries, &startup->name_table, sky->num_stars))
+    {
+        return false;
+    }
+
+    drop_faint_labels(sky->star_table, sky->num_stars, startup->config->label_thresh);
+    return true;
+}
+
+static bool load_profiler(void *arg)
+{
+    struct Startup *startup = arg;
+    return generate_profiler(&startup->sky->profiler);
+}
+
+static bool load_planets(void *arg)
+{
+    struct Startup *startup = arg;
+    return generate_planet_table(&startup->sky->planet_table, planet_elements, planet_rates, planet_extras);
+}
+
+static bool load_moon(void *arg)
+{
+    struct Startup *startup = arg;
+    return generate_moon_object(&startup->sky->moon_object, &moon_elements, &moon_rates);
+}
+
+static bool load_magnitude_order(void *arg)
+{
+    struct Sky *sky = ((struct Startup *)arg)->sky;
+    return star_indices_by_magnitude(&sky->idx_by_mag, sky->star_table, sky->num_stars);
+}
+
+static bool load_sky_index(void *arg)
+{
+    struct Sky *sky = ((struct Startup *)arg)->sky;
+    return generate_sky_index(&sky->sky_index, sky->star_table, sky->num_stars, sky_index_default_bands(sky->num_stars));
+}
+
+static bool load_scheduler(void *arg)
+{
+    struct Sky *sky = ((struct Startup *)arg)->sky;
+    return generate_visibility_scheduler(&sky->scheduler, sky->idx_by_mag, sky->num_stars);
+}
+
+static bool load_extrapolation(void *arg)
+{
+    struct Sky *sky = ((struct Startup *)arg)->sky;
+    return generate_star_extrapolation(&sky->extrapolation, sky->num_stars);
+}
+
+static bool load_projection_cache(void *arg)
+{
+    struct Startup *startup = arg;
+    return generate_projection_cache(&startup->sky->projection_cache, (size_t)startup->config->sky_cache_mib << 20);
+}
+
+static bool load_tile_catalog(void *arg)
+{
+    struct Startup *startup = arg;
+    return generate_tile_catalog(&startup->sky->tile_catalog, startup->config->tiles_path,
+                                 (size_t)startup->config->tile_cache_mib << 20);
+}
+
+static bool load_constell_table(void *arg)
+{
+    struct Sky *sky = ((struct Startup *)arg)->sky;
+    return generate_constell_table(bsc5_constellations, bsc5_constellations_len, sky->num_stars, &sky->constell_table);
+}
+
+static bool load_constell_pins(void *arg)
+{
+    struct Startup *startup = arg;
+    return pin_constellations(startup->sky);
+}
+
+static bool load_city(void *arg)
+{
+    struct Conf *config = ((struct Startup *)arg)->config;
+
+    struct CityTable cities;
+    if (!load_city_table(config->city_file, &cities))
+    {
+        return false;
+    }
+
+    const struct CityRecord *city = city_table_find(&cities, config->city_name);
+    if (city == NULL)
+    {
+        fprintf(stderr, "ERROR: Could not find city \"%s\"\n", config->city_name);
+        print_city_suggestions(&cities, config->city_name);
+        free_city_table(&cities);
+        return false;
+    }
+
+    // Options were already converted to radians
+    config->latitude = city->latitude * M_PI / 180.0;
+    config->longitude = city->longitude * M_PI / 180.0;
+
+    free_city_table(&cities);
+    return true;
+}
+
+/* Find the city nearest to the observer, for the metadata window
+ */
+static bool load_nearest_city(void *arg)
+{
+    struct Sky *sky = ((struct Startup *)arg)->sky;
+    const struct Conf *config = sky->config;
+
+    if (!load_city_table(config->city_file, &sky->cities))
+    {
+        return false;
+    }
+
+    // The observer stays put, so the tree is only searched once
+    struct CityTree tree;
+    if (!generate_city_tree(&tree, &sky->cities))
+    {
+        return false;
+    }
+    sky->nearest_city = city_tree_nearest(&tree, config->latitude, config->longitude, &sky->nearest_city_distance);
+    free_city_tree(&tree);
+
+    return true;
+}
+
+bool load_sky(struct Startup *startup)
+{
+    const struct Conf *config = startup->config;
+    const struct Sky *sky = startup->sky;
+
+    struct TaskGraph graph;
+    task_graph_init(&graph);
+
+    unsigned int entries = task_graph_add(&graph, "entries", load_entries, startup, NULL, 0);
+    unsigned int names = task_graph_add(&graph, "names", load_names, startup, (unsigned int[]){entries}, 1);
+    unsigned int stars =
+        task_graph_add(&graph, "star table", load_star_table, startup, (unsigned int[]){entries, names}, 2);
+
+    if (config->write_tiles_path == NULL)
+    {
+        task_graph_add(&graph, "profiler", load_profiler, startup, NULL, 0);
+        task_graph_add(&graph, "planets", load_planets, startup, NULL, 0);
+        task_graph_add(&graph, "moon", load_moon, startup, NULL, 0);
+        if (config->city_name != NULL)
+        {
+            task_graph_add(&graph, "city", load_city, startup, NULL, 0);
+        }
+        else if (config->metadata && config->coordinates_given)
+        {
+            task_graph_add(&graph, "nearest city", load_nearest_city, startup, NULL, 0);
+        }
+
+        unsigned int by_magnitude =
+            task_graph_add(&graph, "magnitude order", load_magnitude_order, startup, (unsigned int[]){stars}, 1);
+        // The sky index also culls stars outside of the zoomed view
+        unsigned int sky_index =
+            task_graph_add(&graph, "sky index", load_sky_index, startup, (unsigned int[]){stars}, 1);
+
+        // Constellation endpoints are pinned in the scheduler too, if any
+        unsigned int pin_deps[3] = {sky_index};
+        unsigned int num_pin_deps = 1;
+        if (sky->use_scheduler)
+        {
+            pin_deps[num_pin_deps++] = task_graph_add(&graph, "visibility scheduler", load_scheduler, startup,
+                                                      (unsigned int[]){by_magnitude}, 1);
+            task_graph_add(&graph, "star extrapolation", load_extrapolation, startup, (unsigned int[]){entries}, 1);
+        }
+        if (sky->use_cache)
+        {
+            task_graph_add(&graph, "projection cache", load_projection_cache, startup, NULL, 0);
+        }
+        if (sky->use_tiles)
+        {
+            task_graph_add(&graph, "tile catalog", load_tile_catalog, startup, NULL, 0);
+        }
+        if (config->constell)
+        {
+            pin_deps[num_pin_deps++] =
+                task_graph_add(&graph, "constellations", load_constell_table, startup, (unsigned int[]){entries}, 1);
+            task_graph_add(&graph, "constellation pins", load_constell_pins, startup, pin_deps, num_pin_deps);
+        }
+    }
+
+    return task_graph_run(&graph, task_graph_default_threads(graph.num_tasks));
+}
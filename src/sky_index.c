@@ -0,0 +1,397 @@
+#include "sky_index.h"
+
+#include "astro.h"
+#include "core.h"
+#include "macros.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Number of points sampled along each cell edge when computing bounding caps
+#define EDGE_SAMPLES 8
+
+// Target average number of stars per cell
+#define STARS_PER_CELL 24
+
+// Bounds on the number of declination bands
+#define MIN_BANDS 6
+#define MAX_BANDS 512
+
+// Stars are classified for proper motion over this many years either side of
+// the date of classification, after which they are classified again
+#define CLASSIFY_WINDOW_YEARS 100.0
+
+#define DAYS_PER_YEAR 365.2425
+#define J2000 2451545.0
+
+/* Normalize a radian angle to [0, 2π)
+ */
+static double norm_ra(double ra)
+{
+    double rem = fmod(ra, 2.0 * M_PI);
+    rem += rem < 0 ? 2.0 * M_PI : 0;
+    return rem;
+}
+
+/* Angular distance between two points given in equatorial coordinates
+ */
+static double angular_distance(double ra_a, double dec_a, double ra_b, double dec_b)
+{
+    double cos_dist = sin(dec_a) * sin(dec_b) + cos(dec_a) * cos(dec_b) * cos(ra_a - ra_b);
+    return acos(fmax(-1.0, fmin(1.0, cos_dist)));
+}
+
+/* Compute a cap centered on the middle of the cell containing the whole cell.
+ * The distance to the center is 1-Lipschitz along the boundary, so the largest
+ * sampled distance plus half the largest sample spacing is a true bound
+ */
+static void compute_bounding_cap(struct SkyCell *cell)
+{
+    cell->center_ra = (cell->ra_min + cell->ra_max) / 2.0;
+    cell->center_dec = (cell->dec_min + cell->dec_max) / 2.0;
+
+    double max_dist = 0.0;
+    for (int i = 0; i <= EDGE_SAMPLES; ++i)
+    {
+        double t = (double)i / EDGE_SAMPLES;
+        double ra = cell->ra_min + t * (cell->ra_max - cell->ra_min);
+        double dec = cell->dec_min + t * (cell->dec_max - cell->dec_min);
+
+        // Parallels (bottom and top) and meridians (left and right)
+        max_dist = fmax(max_dist, angular_distance(cell->center_ra, cell->center_dec, ra, cell->dec_min));
+        max_dist = fmax(max_dist, angular_distance(cell->center_ra, cell->center_dec, ra, cell->dec_max));
+        max_dist = fmax(max_dist, angular_distance(cell->center_ra, cell->center_dec, cell->ra_min, dec));
+        max_dist = fmax(max_dist, angular_distance(cell->center_ra, cell->center_dec, cell->ra_max, dec));
+    }
+
+    double ra_spacing = (cell->ra_max - cell->ra_min) / EDGE_SAMPLES;
+    double dec_spacing = (cell->dec_max - cell->dec_min) / EDGE_SAMPLES;
+    cell->radius = max_dist + fmax(ra_spacing, dec_spacing) / 2.0;
+}
+
+/* Largest angular displacement per year caused by a proper motion
+ */
+static double motion_per_year(double declination, double ra_motion, double dec_motion)
+{
+    return fabs(ra_motion) * cos(declination) + fabs(dec_motion);
+}
+
+/* Number of right ascension divisions for a band so cells have roughly equal
+ * area
+ */
+static unsigned int band_divisions(double dec_min, double dec_max, unsigned int num_bands)
+{
+    double widest = fmax(cos(dec_min), cos(dec_max));
+    if (dec_min < 0.0 && dec_max > 0.0)
+    {
+        widest = 1.0;
+    }
+
+    unsigned int divisions = (unsigned int)ceil(2.0 * num_bands * widest);
+    return MAX(divisions, 1u);
+}
+
+unsigned int sky_index_default_bands(unsigned int num_stars)
+{
+    // There are roughly 4 * num_bands^2 / π cells
+    double bands = sqrt(M_PI * num_stars / (4.0 * STARS_PER_CELL));
+    return (unsigned int)MAX(MIN_BANDS, MIN(MAX_BANDS, (int)ceil(bands)));
+}
+
+unsigned int sky_index_find_cell(const struct SkyIndex *index, double right_ascension, double declination)
+{
+    double band_height = M_PI / index->num_bands;
+    int band = (int)floor((declination + M_PI / 2.0) / band_height);
+    band = MAX(0, MIN(band, (int)index->num_bands - 1));
+
+    unsigned int first = index->band_offsets[band];
+    unsigned int divisions = index->band_offsets[band + 1] - first;
+
+    unsigned int column = (unsigned int)(norm_ra(right_ascension) / (2.0 * M_PI) * divisions);
+    column = MIN(column, divisions - 1);
+
+    return first + column;
+}
+
+bool generate_sky_index(struct SkyIndex *index, const struct Star *star_table, unsigned int num_stars,
+                        unsigned int num_bands)
+{
+    memset(index, 0, sizeof(struct SkyIndex));
+    if (num_bands == 0)
+    {
+        return false;
+    }
+
+    index->num_bands = num_bands;
+    index->band_offsets = malloc((num_bands + 1) * sizeof(unsigned int));
+    if (index->band_offsets == NULL)
+    {
+        printf("Allocation of memory for sky index failed\n");
+        return false;
+    }
+
+    // Lay out the bands
+    double band_height = M_PI / num_bands;
+    unsigned int num_cells = 0;
+    for (unsigned int band = 0; band < num_bands; ++band)
+    {
+        double dec_min = -M_PI / 2.0 + band * band_height;
+        index->band_offsets[band] = num_cells;
+        num_cells += band_divisions(dec_min, dec_min + band_height, num_bands);
+    }
+    index->band_offsets[num_bands] = num_cells;
+    index->num_cells = num_cells;
+
+    index->cells = malloc(num_cells * sizeof(struct SkyCell));
+    index->cell_offsets = calloc(num_cells + 1, sizeof(unsigned int));
+    index->cell_visible = malloc(num_cells * sizeof(bool));
+    index->cell_active_end = malloc(num_cells * sizeof(unsigned int));
+    index->selected_cells = malloc(num_cells * sizeof(unsigned int));
+    index->star_indices = malloc(num_stars * sizeof(unsigned int));
+    index->entries = malloc(num_stars * sizeof(struct SkyEntry));
+    if (index->cells == NULL || index->cell_offsets == NULL || index->cell_visible == NULL ||
+        index->cell_active_end == NULL || index->selected_cells == NULL ||
+        ((index->star_indices == NULL || index->entries == NULL) && num_stars > 0))
+    {
+        printf("Allocation of memory for sky index failed\n");
+        free_sky_index(index);
+        return false;
+    }
+
+    // Lay out the cells within each band
+    for (unsigned int band = 0; band < num_bands; ++band)
+    {
+        unsigned int first = index->band_offsets[band];
+        unsigned int divisions = index->band_offsets[band + 1] - first;
+        double ra_width = 2.0 * M_PI / divisions;
+        for (unsigned int column = 0; column < divisions; ++column)
+        {
+            struct SkyCell *cell = &index->cells[first + column];
+            cell->ra_min = column * ra_width;
+            cell->ra_max = (column + 1) * ra_width;
+            cell->dec_min = -M_PI / 2.0 + band * band_height;
+            cell->dec_max = cell->dec_min + band_height;
+            cell->max_motion = 0.0;
+            compute_bounding_cap(cell);
+
+            // Force every cell to be re-evaluated on the first update
+            index->cell_visible[first + column] = true;
+        }
+    }
+
+    // Counting sort of stars into cells
+    for (unsigned int i = 0; i < num_stars; ++i)
+    {
+        const struct Star *star = &star_table[i];
+        unsigned int cell = sky_index_find_cell(index, star->right_ascension, star->declination);
+        index->cell_offsets[cell + 1]++;
+
+        double motion = motion_per_year(star->declination, star->ra_motion, star->dec_motion);
+        index->cells[cell].max_motion = fmax(index->cells[cell].max_motion, motion);
+        index->max_motion = fmax(index->max_motion, motion);
+    }
+    for (unsigned int cell = 0; cell < num_cells; ++cell)
+    {
+        index->cell_offsets[cell + 1] += index->cell_offsets[cell];
+    }
+
+    unsigned int *cursor = malloc(num_cells * sizeof(unsigned int));
+    if (cursor == NULL)
+    {
+        printf("Allocation of memory for sky index failed\n");
+        free_sky_index(index);
+        return false;
+    }
+    memcpy(cursor, index->cell_offsets, num_cells * sizeof(unsigned int));
+
+    for (unsigned int i = 0; i < num_stars; ++i)
+    {
+        const struct Star *star = &star_table[i];
+        unsigned int cell = sky_index_find_cell(index, star->right_ascension, star->declination);
+        unsigned int slot = cursor[cell]++;
+
+        index->star_indices[slot] = i;
+        index->entries[slot] = (struct SkyEntry){
+            .right_ascension = star->right_ascension,
+            .declination = star->declination,
+            .ra_motion = star->ra_motion,
+            .dec_motion = star->dec_motion,
+        };
+    }
+    free(cursor);
+
+    // Every star is active until the index is classified for a latitude
+    memcpy(index->cell_active_end, index->cell_offsets + 1, num_cells * sizeof(unsigned int));
+    index->classified_latitude = NAN;
+
+    return true;
+}
+
+bool sky_index_needs_classify(const struct SkyIndex *index, double latitude, double julian_date)
+{
+    // NAN never compares equal, so an unclassified index always qualifies
+    return !(index->classified_latitude == latitude) ||
+           fabs(julian_date - index->classified_julian_date) > CLASSIFY_WINDOW_YEARS * DAYS_PER_YEAR;
+}
+
+void sky_index_classify(struct SkyIndex *index, struct Star *star_table, double latitude, double julian_date)
+{
+    double years = fabs(julian_date - J2000) / DAYS_PER_YEAR + CLASSIFY_WINDOW_YEARS;
+
+    index->num_circumpolar = 0;
+    index->num_never_rises = 0;
+    for (unsigned int c = 0; c < index->num_cells; ++c)
+    {
+        // Partition in place, moving never rising stars to the end of the cell
+        unsigned int active = index->cell_offsets[c];
+        unsigned int end = index->cell_offsets[c + 1];
+        while (active < end)
+        {
+            const struct SkyEntry *entry = &index->entries[active];
+            double margin = motion_per_year(entry->declination, entry->ra_motion, entry->dec_motion) * years;
+            enum DiurnalMotion motion = classify_diurnal_motion(entry->declination, latitude, margin);
+
+            if (motion != NEVER_RISES)
+            {
+                index->num_circumpolar += motion == CIRCUMPOLAR;
+                active++;
+                continue;
+            }
+
+            end--;
+            unsigned int star_index = index->star_indices[active];
+            index->star_indices[active] = index->star_indices[end];
+            index->star_indices[end] = star_index;
+
+            struct SkyEntry tmp = index->entries[active];
+            index->entries[active] = index->entries[end];
+            index->entries[end] = tmp;
+
+            struct ObjectBase *base = &star_table[star_index].base;
+            base->east = 0.0;
+            base->north = 0.0;
+            base->up = -1.0;
+            index->num_never_rises++;
+        }
+        index->cell_active_end[c] = active;
+    }
+
+    index->classified_latitude = latitude;
+    index->classified_julian_date = julian_date;
+}
+
+static int uint_comparator(const void *v1, const void *v2)
+{
+    unsigned int a = *(const unsigned int *)v1;
+    unsigned int b = *(const unsigned int *)v2;
+    return (a > b) - (a < b);
+}
+
+bool sky_index_pin_stars(struct SkyIndex *index, const unsigned int *star_indices, unsigned int count)
+{
+    unsigned int *pinned = NULL;
+    if (count > 0)
+    {
+        pinned = malloc(count * sizeof(unsigned int));
+        if (pinned == NULL)
+        {
+            printf("Allocation of memory for pinned stars failed\n");
+            return false;
+        }
+        memcpy(pinned, star_indices, count * sizeof(unsigned int));
+        qsort(pinned, count, sizeof(unsigned int), uint_comparator);
+    }
+
+    // Remove duplicates
+    unsigned int num_unique = 0;
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        if (num_unique == 0 || pinned[num_unique - 1] != pinned[i])
+        {
+            pinned[num_unique++] = pinned[i];
+        }
+    }
+
+    free(index->pinned);
+    index->pinned = pinned;
+    index->num_pinned = num_unique;
+
+    return true;
+}
+
+bool sky_cell_below_horizon(const struct SkyCell *cell, double local_sidereal_time, double latitude, double margin)
+{
+    double hour_angle = local_sidereal_time - cell->center_ra;
+    double sin_altitude =
+        sin(latitude) * sin(cell->center_dec) + cos(latitude) * cos(cell->center_dec) * cos(hour_angle);
+    double center_altitude = asin(fmax(-1.0, fmin(1.0, sin_altitude)));
+
+    // The highest point of the cap is its center raised by the cap radius
+    return center_altitude + cell->radius + margin < 0.0;
+}
+
+void sky_index_select_cap(struct SkyIndex *index, double right_ascension, double declination, double radius,
+                          double margin)
+{
+    index->num_selected = 0;
+
+    // Bands outside the declination range of the cap cannot intersect it
+    double band_height = M_PI / index->num_bands;
+    double reach = radius + margin;
+    int first_band = (int)floor((declination - reach + M_PI / 2.0) / band_height);
+    int last_band = (int)floor((declination + reach + M_PI / 2.0) / band_height);
+    first_band = MAX(0, first_band);
+    last_band = MIN(last_band, (int)index->num_bands - 1);
+
+    // Half the span in right ascension of the cap, or all of it around a pole
+    double ra_reach = M_PI;
+    if (fabs(declination) + reach < M_PI / 2.0)
+    {
+        ra_reach = asin(fmin(1.0, sin(reach) / cos(declination)));
+    }
+
+    for (int band = first_band; band <= last_band; ++band)
+    {
+        unsigned int first = index->band_offsets[band];
+        unsigned int divisions = index->band_offsets[band + 1] - first;
+
+        // Only the columns overlapping the span in right ascension are tested
+        unsigned int num_columns = divisions;
+        unsigned int first_column = 0;
+        if (ra_reach < M_PI)
+        {
+            double column_width = 2.0 * M_PI / divisions;
+            double start = floor((right_ascension - ra_reach) / column_width);
+            double end = floor((right_ascension + ra_reach) / column_width);
+            num_columns = (unsigned int)MIN(end - start + 1.0, (double)divisions);
+            first_column = (unsigned int)fmod(fmod(start, divisions) + divisions, divisions);
+        }
+
+        for (unsigned int k = 0; k < num_columns; ++k)
+        {
+            unsigned int c = first + (first_column + k) % divisions;
+            const struct SkyCell *cell = &index->cells[c];
+            double dist = angular_distance(cell->center_ra, cell->center_dec, right_ascension, declination);
+            if (dist <= cell->radius + reach)
+            {
+                index->selected_cells[index->num_selected++] = c;
+            }
+        }
+    }
+}
+
+void free_sky_index(struct SkyIndex *index)
+{
+    free(index->band_offsets);
+    free(index->cells);
+    free(index->cell_offsets);
+    free(index->cell_visible);
+    free(index->cell_active_end);
+    free(index->selected_cells);
+    free(index->star_indices);
+    free(index->entries);
+    free(index->pinned);
+    memset(index, 0, sizeof(struct SkyIndex));
+}
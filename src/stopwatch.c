@@ -1,10 +1,12 @@
 #include "stopwatch.h"
 
+#include <errno.h>
 #include <string.h>
 #include <time.h>
 
 // UNIX headers
 #if defined(__unix__) || (defined(__APPLE__) && defined(__MACH__))
+#include <sys/resource.h>
 #include <sys/time.h>
 #include <unistd.h> // Needed for _POSIX_TIMERS definition & usleep()
 #endif
@@ -44,10 +46,12 @@ int sw_gettime(struct SwTimestamp *stamp)
     stamp->val_member = TICK_APPLE;
 
 #elif defined(_POSIX_TIMERS) && _POSIX_TIMERS > 0
-    // Available on some POSIX systems (preferable to gettimeofday() below)
+    // Available on some POSIX systems (preferable to gettimeofday() below).
+    // Not CLOCK_MONOTONIC_RAW, so timestamps can be slept until with
+    // clock_nanosleep()
 
     struct timespec tick;
-    int check = clock_gettime(CLOCK_MONOTONIC_RAW, &tick);
+    int check = clock_gettime(CLOCK_MONOTONIC, &tick);
     if (check == -1)
     {
         return -1;
@@ -149,6 +153,182 @@ int sw_timediff_usec(struct SwTimestamp end, struct SwTimestamp begin, unsigned
     return 0;
 }
 
+int sw_timediff_nsec(struct SwTimestamp end, struct SwTimestamp begin, unsigned long long *diff)
+{
+    *diff = 0;
+
+    if (end.val_member != begin.val_member)
+    {
+        return -1;
+    }
+
+    switch (end.val_member)
+    {
+    case TICK_WIN: {
+#if defined(_WIN32)
+        LARGE_INTEGER frequency; // ticks per second
+        if (QueryPerformanceFrequency(&frequency) == 0)
+        {
+            return -1;
+        }
+        unsigned long long ticks = (unsigned long long)(end.val.tick_win.QuadPart - begin.val.tick_win.QuadPart);
+        unsigned long long rate = (unsigned long long)frequency.QuadPart;
+
+        // Split to avoid overflowing for long intervals
+        *diff = ticks / rate * 1000000000ULL + ticks % rate * 1000000000ULL / rate;
+#else
+        return -1;
+#endif
+        break;
+    }
+
+    case TICK_APPLE:
+        *diff = end.val.tick_apple - begin.val.tick_apple;
+        break;
+
+    case TICK_SPEC: {
+        long long sec_diff = (long long)(end.val.tick_spec.tv_sec - begin.val.tick_spec.tv_sec);
+        long long nsec_diff = (long long)(end.val.tick_spec.tv_nsec - begin.val.tick_spec.tv_nsec);
+        *diff = (unsigned long long)(sec_diff * 1000000000LL + nsec_diff);
+        break;
+    }
+
+    case TICK_VAL: {
+        long long sec_diff = (long long)(end.val.tick_val.tv_sec - begin.val.tick_val.tv_sec);
+        long long usec_diff = (long long)(end.val.tick_val.tv_usec - begin.val.tick_val.tv_usec);
+        *diff = (unsigned long long)(sec_diff * 1000000LL + usec_diff) * 1000ULL;
+        break;
+    }
+
+    default:
+        return -1;
+    }
+
+    return 0;
+}
+
+unsigned long long sw_now_nsec(void)
+{
+    struct SwTimestamp now;
+    if (sw_gettime(&now) != 0)
+    {
+        return 0;
+    }
+
+    switch (now.val_member)
+    {
+    case TICK_WIN: {
+#if defined(_WIN32)
+        LARGE_INTEGER frequency; // ticks per second
+        if (QueryPerformanceFrequency(&frequency) == 0)
+        {
+            return 0;
+        }
+        unsigned long long ticks = (unsigned long long)now.val.tick_win.QuadPart;
+        unsigned long long rate = (unsigned long long)frequency.QuadPart;
+
+        // Split to avoid overflowing after a few hours of uptime
+        return ticks / rate * 1000000000ULL + ticks % rate * 1000000000ULL / rate;
+#else
+        return 0;
+#endif
+    }
+
+    case TICK_APPLE:
+        return now.val.tick_apple;
+
+    case TICK_SPEC:
+        return (unsigned long long)now.val.tick_spec.tv_sec * 1000000000ULL + (unsigned long long)now.val.tick_spec.tv_nsec;
+
+    case TICK_VAL:
+        return (unsigned long long)now.val.tick_val.tv_sec * 1000000000ULL +
+               (unsigned long long)now.val.tick_val.tv_usec * 1000ULL;
+
+    default:
+        return 0;
+    }
+}
+
+unsigned long long sw_thread_cpu_nsec(void)
+{
+#if defined(_WIN32)
+
+    FILETIME creation, exit, kernel, user;
+    if (GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user) == 0)
+    {
+        return 0;
+    }
+
+    // 100 nanosecond units
+    ULARGE_INTEGER kernel_time = {.LowPart = kernel.dwLowDateTime, .HighPart = kernel.dwHighDateTime};
+    ULARGE_INTEGER user_time = {.LowPart = user.dwLowDateTime, .HighPart = user.dwHighDateTime};
+    return (kernel_time.QuadPart + user_time.QuadPart) * 100ULL;
+
+#elif defined(CLOCK_THREAD_CPUTIME_ID)
+
+    struct timespec cpu;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpu) == -1)
+    {
+        return 0;
+    }
+    return (unsigned long long)cpu.tv_sec * 1000000000ULL + (unsigned long long)cpu.tv_nsec;
+
+#else
+
+    return 0;
+
+#endif
+}
+
+int sw_process_usage(struct SwUsage *usage)
+{
+    memset(usage, 0, sizeof(struct SwUsage));
+
+#if defined(_WIN32)
+
+    FILETIME creation, exit, kernel, user;
+    if (GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user) == 0)
+    {
+        return -1;
+    }
+
+    // 100 nanosecond units
+    ULARGE_INTEGER kernel_time = {.LowPart = kernel.dwLowDateTime, .HighPart = kernel.dwHighDateTime};
+    ULARGE_INTEGER user_time = {.LowPart = user.dwLowDateTime, .HighPart = user.dwHighDateTime};
+    usage->user_nsec = user_time.QuadPart * 100ULL;
+    usage->system_nsec = kernel_time.QuadPart * 100ULL;
+
+#elif defined(__unix__) || (defined(__APPLE__) && defined(__MACH__))
+
+    struct rusage resources;
+    if (getrusage(RUSAGE_SELF, &resources) != 0)
+    {
+        return -1;
+    }
+
+    usage->user_nsec = (unsigned long long)resources.ru_utime.tv_sec * 1000000000ULL +
+                       (unsigned long long)resources.ru_utime.tv_usec * 1000ULL;
+    usage->system_nsec = (unsigned long long)resources.ru_stime.tv_sec * 1000000000ULL +
+                         (unsigned long long)resources.ru_stime.tv_usec * 1000ULL;
+#if defined(__APPLE__)
+    usage->max_rss_kib = (unsigned long long)resources.ru_maxrss / 1024ULL; // Bytes on macOS
+#else
+    usage->max_rss_kib = (unsigned long long)resources.ru_maxrss;
+#endif
+    usage->minor_faults = (unsigned long long)resources.ru_minflt;
+    usage->major_faults = (unsigned long long)resources.ru_majflt;
+    usage->voluntary_switches = (unsigned long long)resources.ru_nvcsw;
+    usage->involuntary_switches = (unsigned long long)resources.ru_nivcsw;
+
+#else
+
+    return -1;
+
+#endif
+
+    return 0;
+}
+
 int sw_sleep(unsigned long long microseconds)
 {
 #if defined(_WIN32)
@@ -170,3 +350,120 @@ int sw_sleep(unsigned long long microseconds)
 
     return 0;
 }
+
+int sw_timeadd_usec(struct SwTimestamp *stamp, unsigned long long microseconds)
+{
+    switch (stamp->val_member)
+    {
+    case TICK_WIN: {
+#if defined(_WIN32)
+        LARGE_INTEGER frequency; // ticks per second
+        int check = QueryPerformanceFrequency(&frequency);
+        if (check == 0)
+        {
+            return -1; // QueryPerformanceFrequency failed
+        }
+        stamp->val.tick_win.QuadPart += (LONGLONG)(microseconds / 1000000ULL) * frequency.QuadPart +
+                                        (LONGLONG)(microseconds % 1000000ULL) * frequency.QuadPart / 1000000LL;
+#else
+        return -1; // Unsupported on this platform
+#endif
+        break;
+    }
+
+    case TICK_APPLE: {
+        stamp->val.tick_apple += microseconds * 1000ULL; // us to ns
+        break;
+    }
+
+    case TICK_SPEC: {
+        stamp->val.tick_spec.tv_sec += (time_t)(microseconds / 1000000ULL);
+        stamp->val.tick_spec.tv_nsec += (long)(microseconds % 1000000ULL) * 1000L;
+        if (stamp->val.tick_spec.tv_nsec >= 1000000000L)
+        {
+            stamp->val.tick_spec.tv_sec += 1;
+            stamp->val.tick_spec.tv_nsec -= 1000000000L; // Adjust for nanosecond overflow
+        }
+        break;
+    }
+
+    case TICK_VAL: {
+        stamp->val.tick_val.tv_sec += (time_t)(microseconds / 1000000ULL);
+        stamp->val.tick_val.tv_usec += (long)(microseconds % 1000000ULL);
+        if (stamp->val.tick_val.tv_usec >= 1000000L)
+        {
+            stamp->val.tick_val.tv_sec += 1;
+            stamp->val.tick_val.tv_usec -= 1000000L; // Adjust for microsecond overflow
+        }
+        break;
+    }
+
+    default:
+        return -1; // Unsupported timestamp type
+    }
+
+    return 0;
+}
+
+/* Whether timestamp `a` is earlier than `b`
+ */
+static int sw_earlier(const struct SwTimestamp *a, const struct SwTimestamp *b)
+{
+    switch (a->val_member)
+    {
+#if defined(_WIN32)
+    case TICK_WIN:
+        return a->val.tick_win.QuadPart < b->val.tick_win.QuadPart;
+#endif
+    case TICK_APPLE:
+        return a->val.tick_apple < b->val.tick_apple;
+    case TICK_SPEC:
+        return a->val.tick_spec.tv_sec < b->val.tick_spec.tv_sec ||
+               (a->val.tick_spec.tv_sec == b->val.tick_spec.tv_sec &&
+                a->val.tick_spec.tv_nsec < b->val.tick_spec.tv_nsec);
+    case TICK_VAL:
+        return a->val.tick_val.tv_sec < b->val.tick_val.tv_sec ||
+               (a->val.tick_val.tv_sec == b->val.tick_val.tv_sec && a->val.tick_val.tv_usec < b->val.tick_val.tv_usec);
+    default:
+        return 0;
+    }
+}
+
+int sw_sleep_until(struct SwTimestamp deadline)
+{
+#if defined(__linux__) && defined(_POSIX_TIMERS) && _POSIX_TIMERS > 0
+    // Linux can sleep until an absolute time of the clock read by sw_gettime()
+
+    if (deadline.val_member == TICK_SPEC)
+    {
+        int check;
+        do
+        {
+            check = clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline.val.tick_spec, NULL);
+        } while (check == EINTR); // Woken by a signal, e.g. a window resize
+
+        return check == 0 ? 0 : -1; // clock_nanosleep() returns an error number on failure
+    }
+#endif
+
+    // Everything else sleeps for the time left
+
+    struct SwTimestamp now;
+    if (sw_gettime(&now) != 0 || now.val_member != deadline.val_member)
+    {
+        return -1;
+    }
+
+    if (!sw_earlier(&now, &deadline))
+    {
+        return 0;
+    }
+
+    unsigned long long remaining;
+    if (sw_timediff_usec(deadline, now, &remaining) != 0)
+    {
+        return -1;
+    }
+
+    return sw_sleep(remaining);
+}
@@ -0,0 +1,173 @@
+#include "task_graph.h"
+
+#include "macros.h"
+
+#include <stdio.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+static void worker_main(void *arg);
+static void finish_task(struct TaskGraph *graph, unsigned int index, enum TaskState state);
+
+void task_graph_init(struct TaskGraph *graph)
+{
+    graph->num_tasks = 0;
+    graph->num_finished = 0;
+    graph->malformed = false;
+}
+
+unsigned int task_graph_add(struct TaskGraph *graph, const char *name, TaskFunction function, void *arg,
+                            const unsigned int *deps, unsigned int num_deps)
+{
+    if (graph->num_tasks >= TASK_GRAPH_MAX_TASKS || num_deps > TASK_GRAPH_MAX_DEPS)
+    {
+        fprintf(stderr, "ERROR: Too many tasks, or dependencies of task \"%s\"\n", name);
+        graph->malformed = true;
+        return TASK_GRAPH_MAX_TASKS;
+    }
+    for (unsigned int i = 0; i < num_deps; ++i)
+    {
+        // Also catches dependencies on tasks that could not be added
+        if (deps[i] >= graph->num_tasks)
+        {
+            fprintf(stderr, "ERROR: Task \"%s\" depends on a task added after it\n", name);
+            graph->malformed = true;
+            return TASK_GRAPH_MAX_TASKS;
+        }
+    }
+
+    unsigned int index = graph->num_tasks++;
+    struct Task *task = &graph->tasks[index];
+    task->name = name;
+    task->function = function;
+    task->arg = arg;
+    task->num_deps = num_deps;
+    task->num_pending = num_deps;
+    task->state = TASK_WAITING;
+    for (unsigned int i = 0; i < num_deps; ++i)
+    {
+        task->deps[i] = deps[i];
+    }
+
+    return index;
+}
+
+bool task_graph_run(struct TaskGraph *graph, unsigned int num_threads)
+{
+    if (graph->malformed)
+    {
+        return false;
+    }
+
+    mutex_init(&graph->lock);
+    condition_init(&graph->changed);
+
+    // The calling thread works too, and finishes the graph alone if no other
+    // thread could be started
+    struct Thread workers[TASK_GRAPH_MAX_THREADS];
+    unsigned int num_workers = 0;
+    num_threads = MAX(1u, MIN(num_threads, (unsigned int)TASK_GRAPH_MAX_THREADS));
+    while (num_workers + 1 < num_threads && thread_start(&workers[num_workers], worker_main, graph))
+    {
+        num_workers++;
+    }
+
+    worker_main(graph);
+    for (unsigned int i = 0; i < num_workers; ++i)
+    {
+        thread_join(&workers[i]);
+    }
+
+    mutex_destroy(&graph->lock);
+    condition_destroy(&graph->changed);
+
+    bool success = true;
+    for (unsigned int i = 0; i < graph->num_tasks; ++i)
+    {
+        success = success && graph->tasks[i].state == TASK_DONE;
+    }
+    return success;
+}
+
+unsigned int task_graph_default_threads(unsigned int num_tasks)
+{
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    long num_processors = (long)info.dwNumberOfProcessors;
+#else
+    long num_processors = sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+    unsigned int num_threads = num_processors > 0 ? (unsigned int)num_processors : 1;
+
+    return MAX(1u, MIN(num_threads, MIN(num_tasks, (unsigned int)TASK_GRAPH_MAX_THREADS)));
+}
+
+/* Run tasks as they become ready until every task has finished
+ */
+void worker_main(void *arg)
+{
+    struct TaskGraph *graph = arg;
+
+    mutex_lock(&graph->lock);
+    while (graph->num_finished < graph->num_tasks)
+    {
+        // Tasks are few, so finding a ready one by scanning is cheap
+        unsigned int index = 0;
+        while (index < graph->num_tasks &&
+               (graph->tasks[index].state != TASK_WAITING || graph->tasks[index].num_pending > 0))
+        {
+            index++;
+        }
+        if (index == graph->num_tasks)
+        {
+            condition_wait(&graph->changed, &graph->lock);
+            continue;
+        }
+
+        struct Task *task = &graph->tasks[index];
+        task->state = TASK_RUNNING;
+        mutex_unlock(&graph->lock);
+
+        bool success = task->function(task->arg);
+
+        mutex_lock(&graph->lock);
+        finish_task(graph, index, success ? TASK_DONE : TASK_FAILED);
+        condition_broadcast(&graph->changed);
+    }
+    mutex_unlock(&graph->lock);
+}
+
+/* Record how a task ended, and release or skip the tasks depending on it
+ */
+void finish_task(struct TaskGraph *graph, unsigned int index, enum TaskState state)
+{
+    graph->tasks[index].state = state;
+    graph->num_finished++;
+
+    // Dependents were added after the task
+    for (unsigned int i = index + 1; i < graph->num_tasks; ++i)
+    {
+        struct Task *task = &graph->tasks[i];
+        for (unsigned int d = 0; d < task->num_deps; ++d)
+        {
+            if (task->deps[d] != index || task->state != TASK_WAITING)
+            {
+                continue;
+            }
+
+            if (state == TASK_DONE)
+            {
+                task->num_pending--;
+            }
+            else
+            {
+                finish_task(graph, i, TASK_SKIPPED);
+            }
+        }
+    }
+}
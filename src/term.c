@@ -1,13 +1,16 @@
 #include "term.h"
 
+#include "canvas.h"
+#include "macros.h"
+
 #include <curses.h>
 #include <math.h>
 #include <stdbool.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
 #ifdef _WIN32
-#include <stdio.h>
 #include <windows.h>
 extern BOOL WINAPI GetCurrentConsoleFont(HANDLE hConsoleOutput, BOOL bMaximumWindow, PCONSOLE_FONT_INFO lpConsoleCurrentFont);
 #else
@@ -15,14 +18,57 @@ extern BOOL WINAPI GetCurrentConsoleFont(HANDLE hConsoleOutput, BOOL bMaximumWin
 #include <unistd.h>
 #endif
 
+#ifdef _WIN32
+#define NULL_DEVICE "NUL"
+#else
+#define NULL_DEVICE "/dev/null"
+#endif
+
+static void ncurses_setup(bool color);
+
 void ncurses_init(bool color)
 {
     initscr();
+    ncurses_setup(color);
+}
+
+bool ncurses_init_headless(bool color, int rows, int cols)
+{
+    // Nothing is read, and everything written is thrown away. The terminal
+    // type only decides which escape sequences are generated
+    FILE *null_out = fopen(NULL_DEVICE, "w");
+    FILE *null_in = fopen(NULL_DEVICE, "r");
+    const char *term = getenv("TERM");
+    if (term == NULL || term[0] == '\0')
+    {
+        term = "xterm";
+    }
+    if (null_out == NULL || null_in == NULL || newterm(term, null_out, null_in) == NULL)
+    {
+        if (null_out != NULL)
+        {
+            fclose(null_out);
+        }
+        if (null_in != NULL)
+        {
+            fclose(null_in);
+        }
+        return false;
+    }
+
+    resize_term(rows, cols);
+    ncurses_setup(color);
+    return true;
+}
+
+void ncurses_setup(bool color)
+{
     clear();
-    noecho();    // Input characters aren't echoed
-    cbreak();    // Disable line buffering
-    curs_set(0); // Make cursor invisible
-    timeout(0);  // Non-blocking read for getch
+    noecho();             // Input characters aren't echoed
+    cbreak();             // Disable line buffering
+    curs_set(0);          // Make cursor invisible
+    timeout(0);           // Non-blocking read for getch
+    keypad(stdscr, TRUE); // Decode arrow keys, which pan the zoomed view
 
     // Set the console output code page to UTF-8 on Windows
 #ifdef _WIN32
@@ -175,22 +221,47 @@ float get_cell_aspect_ratio(void)
     return default_height;
 }
 
-#define MAX_STR_LEN 2048
-void mvwaddstr_truncate(WINDOW *win, int y, int x, const char *str)
+void win_draw_canvas(WINDOW *win, const struct Canvas *canvas)
 {
-    // Remaining space on the current line
-    int max_x = getmaxx(win);
-    int space_left = max_x - x;
+    werase(win);
 
-    // Don't write beyond the line
-    if (space_left > 0)
+    int height, width;
+    getmaxyx(win, height, width);
+    height = MIN(height, canvas->height);
+    width = MIN(width, canvas->width);
+
+    int color_pair = 0;
+    wattrset(win, A_NORMAL);
+    for (int y = 0; y < height; ++y)
     {
-        // Truncate if necessary
-        char truncated[MAX_STR_LEN];
-        strncpy(truncated, str, space_left);
-        truncated[space_left] = '\0';
-        mvwaddstr(win, y, x, truncated);
+        const struct Cell *row = &canvas->cells[(size_t)y * canvas->width];
+        for (int x = 0; x < width; ++x)
+        {
+            const struct Cell *cell = &row[x];
+            if (cell->ch == 0)
+            {
+                continue;
+            }
+
+            if (cell->color_pair != color_pair)
+            {
+                color_pair = cell->color_pair;
+                wattrset(win, COLOR_PAIR(color_pair));
+            }
+
+            if (cell->ch < 0x80)
+            {
+                mvwaddch(win, y, x, (chtype)cell->ch);
+            }
+            else
+            {
+                char encoded[5];
+                utf8_encode(cell->ch, encoded);
+                mvwaddstr(win, y, x, encoded);
+            }
+        }
     }
+    wattrset(win, A_NORMAL);
 }
 
 #ifdef _WIN32
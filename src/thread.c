@@ -0,0 +1,137 @@
+#include "thread.h"
+
+#ifdef _WIN32
+
+static DWORD WINAPI thread_entry(LPVOID param)
+{
+    struct Thread *thread = param;
+    thread->function(thread->arg);
+    return 0;
+}
+
+bool thread_start(struct Thread *thread, ThreadFunction function, void *arg)
+{
+    thread->function = function;
+    thread->arg = arg;
+    thread->handle = CreateThread(NULL, 0, thread_entry, thread, 0, NULL);
+    return thread->handle != NULL;
+}
+
+void thread_join(struct Thread *thread)
+{
+    WaitForSingleObject(thread->handle, INFINITE);
+    CloseHandle(thread->handle);
+}
+
+void mutex_init(struct Mutex *mutex)
+{
+    InitializeSRWLock(&mutex->lock);
+}
+
+void mutex_lock(struct Mutex *mutex)
+{
+    AcquireSRWLockExclusive(&mutex->lock);
+}
+
+void mutex_unlock(struct Mutex *mutex)
+{
+    ReleaseSRWLockExclusive(&mutex->lock);
+}
+
+void mutex_destroy(struct Mutex *mutex)
+{
+    (void)mutex; // SRW locks need no cleanup
+}
+
+void condition_init(struct Condition *condition)
+{
+    InitializeConditionVariable(&condition->cond);
+}
+
+void condition_wait(struct Condition *condition, struct Mutex *mutex)
+{
+    SleepConditionVariableSRW(&condition->cond, &mutex->lock, INFINITE, 0);
+}
+
+void condition_signal(struct Condition *condition)
+{
+    WakeConditionVariable(&condition->cond);
+}
+
+void condition_broadcast(struct Condition *condition)
+{
+    WakeAllConditionVariable(&condition->cond);
+}
+
+void condition_destroy(struct Condition *condition)
+{
+    (void)condition; // Condition variables need no cleanup
+}
+
+#else
+
+static void *thread_entry(void *param)
+{
+    struct Thread *thread = param;
+    thread->function(thread->arg);
+    return NULL;
+}
+
+bool thread_start(struct Thread *thread, ThreadFunction function, void *arg)
+{
+    thread->function = function;
+    thread->arg = arg;
+    return pthread_create(&thread->handle, NULL, thread_entry, thread) == 0;
+}
+
+void thread_join(struct Thread *thread)
+{
+    pthread_join(thread->handle, NULL);
+}
+
+void mutex_init(struct Mutex *mutex)
+{
+    pthread_mutex_init(&mutex->lock, NULL);
+}
+
+void mutex_lock(struct Mutex *mutex)
+{
+    pthread_mutex_lock(&mutex->lock);
+}
+
+void mutex_unlock(struct Mutex *mutex)
+{
+    pthread_mutex_unlock(&mutex->lock);
+}
+
+void mutex_destroy(struct Mutex *mutex)
+{
+    pthread_mutex_destroy(&mutex->lock);
+}
+
+void condition_init(struct Condition *condition)
+{
+    pthread_cond_init(&condition->cond, NULL);
+}
+
+void condition_wait(struct Condition *condition, struct Mutex *mutex)
+{
+    pthread_cond_wait(&condition->cond, &mutex->lock);
+}
+
+void condition_signal(struct Condition *condition)
+{
+    pthread_cond_signal(&condition->cond);
+}
+
+void condition_broadcast(struct Condition *condition)
+{
+    pthread_cond_broadcast(&condition->cond);
+}
+
+void condition_destroy(struct Condition *condition)
+{
+    pthread_cond_destroy(&condition->cond);
+}
+
+#endif
@@ -0,0 +1,695 @@
+#include "tile_catalog.h"
+
+#include "macros.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TILE_MAGIC "ASTTILE1"
+
+// Sizes of the records in the file (bytes)
+#define HEADER_SIZE 32
+#define DIRECTORY_ENTRY_SIZE 16
+#define STAR_RECORD_SIZE 32
+
+// Fewest stars wanted from any tile, however wide the field
+#define MIN_STARS_PER_TILE 8
+
+// Tiles within this many times the radius of the view are prefetched so
+// panning finds them resident
+#define PREFETCH_SCALE 1.5
+
+#define J2000 2451545.0
+#define DAYS_PER_YEAR 365.2425
+
+// Little-endian serialization
+
+static void put_u32(uint8_t *buffer, uint32_t value)
+{
+    for (int i = 0; i < 4; ++i)
+    {
+        buffer[i] = (uint8_t)(value >> (8 * i));
+    }
+}
+
+static void put_u64(uint8_t *buffer, uint64_t value)
+{
+    for (int i = 0; i < 8; ++i)
+    {
+        buffer[i] = (uint8_t)(value >> (8 * i));
+    }
+}
+
+static void put_f32(uint8_t *buffer, float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    put_u32(buffer, bits);
+}
+
+static void put_f64(uint8_t *buffer, double value)
+{
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    put_u64(buffer, bits);
+}
+
+static uint32_t get_u32(const uint8_t *buffer)
+{
+    uint32_t value = 0;
+    for (int i = 0; i < 4; ++i)
+    {
+        value |= (uint32_t)buffer[i] << (8 * i);
+    }
+    return value;
+}
+
+static uint64_t get_u64(const uint8_t *buffer)
+{
+    uint64_t value = 0;
+    for (int i = 0; i < 8; ++i)
+    {
+        value |= (uint64_t)buffer[i] << (8 * i);
+    }
+    return value;
+}
+
+static float get_f32(const uint8_t *buffer)
+{
+    uint32_t bits = get_u32(buffer);
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+static double get_f64(const uint8_t *buffer)
+{
+    uint64_t bits = get_u64(buffer);
+    double value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+static int seek_to(FILE *file, uint64_t offset)
+{
+#ifdef _WIN32
+    return _fseeki64(file, (__int64)offset, SEEK_SET);
+#else
+    return fseeko(file, (off_t)offset, SEEK_SET);
+#endif
+}
+
+// Writing
+
+struct TileMember
+{
+    float magnitude;
+    unsigned int star;
+};
+
+static int compare_members(const void *a, const void *b)
+{
+    const struct TileMember *member_a = a;
+    const struct TileMember *member_b = b;
+
+    // Brightest first
+    if (member_a->magnitude != member_b->magnitude)
+    {
+        return member_a->magnitude < member_b->magnitude ? -1 : 1;
+    }
+    return (member_a->star > member_b->star) - (member_a->star < member_b->star);
+}
+
+static void encode_star(uint8_t *record, const struct Star *star)
+{
+    put_f64(record, star->right_ascension);
+    put_f64(record + 8, star->declination);
+    put_f32(record + 16, (float)star->ra_motion);
+    put_f32(record + 20, (float)star->dec_motion);
+    put_f32(record + 24, star->magnitude);
+    put_u32(record + 28, (uint32_t)star->catalog_number);
+}
+
+bool write_tile_catalog(const char *path, const struct Star *star_table, unsigned int num_stars,
+                        unsigned int num_bands)
+{
+    struct SkyIndex index;
+    if (!generate_sky_index(&index, star_table, num_stars, num_bands))
+    {
+        return false;
+    }
+
+    unsigned int num_tiles = index.num_cells;
+    struct TileMember *members = malloc(MAX(num_stars, 1u) * sizeof(struct TileMember));
+    uint8_t *directory = malloc(num_tiles * DIRECTORY_ENTRY_SIZE);
+    if (members == NULL || directory == NULL)
+    {
+        printf("Allocation of memory for tile catalog failed\n");
+        free(members);
+        free(directory);
+        free_sky_index(&index);
+        return false;
+    }
+
+    // Sort the members of each tile brightest first
+    for (unsigned int i = 0; i < num_stars; ++i)
+    {
+        unsigned int star = index.star_indices[i];
+        members[i] = (struct TileMember){.magnitude = star_table[star].magnitude, .star = star};
+    }
+
+    uint64_t stars_start = HEADER_SIZE + (uint64_t)num_tiles * DIRECTORY_ENTRY_SIZE;
+    for (unsigned int t = 0; t < num_tiles; ++t)
+    {
+        unsigned int first = index.cell_offsets[t];
+        unsigned int count = index.cell_offsets[t + 1] - first;
+        qsort(&members[first], count, sizeof(struct TileMember), compare_members);
+
+        uint8_t *entry = &directory[t * DIRECTORY_ENTRY_SIZE];
+        put_u64(entry, stars_start + (uint64_t)first * STAR_RECORD_SIZE);
+        put_u32(entry + 8, count);
+        put_f32(entry + 12, count > 0 ? members[first].magnitude : INFINITY);
+    }
+
+    uint8_t header[HEADER_SIZE];
+    memcpy(header, TILE_MAGIC, 8);
+    put_u32(header + 8, num_bands);
+    put_u32(header + 12, num_tiles);
+    put_u64(header + 16, num_stars);
+    put_f64(header + 24, index.max_motion);
+
+    bool success = false;
+    FILE *file = fopen(path, "wb");
+    if (file != NULL)
+    {
+        success = fwrite(header, HEADER_SIZE, 1, file) == 1;
+        success = success && fwrite(directory, DIRECTORY_ENTRY_SIZE, num_tiles, file) == num_tiles;
+        for (unsigned int i = 0; success && i < num_stars; ++i)
+        {
+            uint8_t record[STAR_RECORD_SIZE];
+            encode_star(record, &star_table[members[i].star]);
+            success = fwrite(record, STAR_RECORD_SIZE, 1, file) == 1;
+        }
+        success = fclose(file) == 0 && success;
+    }
+
+    free(members);
+    free(directory);
+    free_sky_index(&index);
+    return success;
+}
+
+// LRU list of resident tiles
+
+static void lru_remove(struct TileCatalog *catalog, int t)
+{
+    struct Tile *tile = &catalog->tiles[t];
+    if (tile->lru_prev >= 0)
+    {
+        catalog->tiles[tile->lru_prev].lru_next = tile->lru_next;
+    }
+    else
+    {
+        catalog->lru_head = tile->lru_next;
+    }
+
+    if (tile->lru_next >= 0)
+    {
+        catalog->tiles[tile->lru_next].lru_prev = tile->lru_prev;
+    }
+    else
+    {
+        catalog->lru_tail = tile->lru_prev;
+    }
+
+    tile->lru_prev = -1;
+    tile->lru_next = -1;
+}
+
+static void lru_push_front(struct TileCatalog *catalog, int t)
+{
+    struct Tile *tile = &catalog->tiles[t];
+    tile->lru_prev = -1;
+    tile->lru_next = catalog->lru_head;
+    if (catalog->lru_head >= 0)
+    {
+        catalog->tiles[catalog->lru_head].lru_prev = t;
+    }
+    catalog->lru_head = t;
+    if (catalog->lru_tail < 0)
+    {
+        catalog->lru_tail = t;
+    }
+}
+
+/* Mark a resident tile as the most recently used
+ */
+static void lru_touch(struct TileCatalog *catalog, int t)
+{
+    if (catalog->tiles[t].num_loaded > 0 && catalog->lru_head != t)
+    {
+        lru_remove(catalog, t);
+        lru_push_front(catalog, t);
+    }
+}
+
+/* Evict the least recently used tiles, other than `keep` and pinned tiles,
+ * until `needed` more bytes fit in the budget. Returns false if they cannot
+ */
+static bool make_room(struct TileCatalog *catalog, int keep, size_t needed)
+{
+    int t = catalog->lru_tail;
+    while (catalog->resident_bytes + needed > catalog->budget && t >= 0)
+    {
+        struct Tile *tile = &catalog->tiles[t];
+        int prev = tile->lru_prev;
+        if (t != keep && !tile->pinned)
+        {
+            lru_remove(catalog, t);
+            catalog->resident_bytes -= tile->num_loaded * sizeof(struct Star);
+            free(tile->stars);
+            tile->stars = NULL;
+            tile->num_loaded = 0;
+        }
+        t = prev;
+    }
+
+    return catalog->resident_bytes + needed <= catalog->budget;
+}
+
+// Loading
+
+/* Read the first `count` stars of a tile. Returns NULL upon a read or memory
+ * allocation error
+ */
+static struct Star *read_tile_stars(FILE *file, uint64_t offset, unsigned int count)
+{
+    uint8_t *records = malloc((size_t)count * STAR_RECORD_SIZE);
+    struct Star *stars = malloc(count * sizeof(struct Star));
+    if (records == NULL || stars == NULL || seek_to(file, offset) != 0 ||
+        fread(records, STAR_RECORD_SIZE, count, file) != count)
+    {
+        free(records);
+        free(stars);
+        return NULL;
+    }
+
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        const uint8_t *record = &records[(size_t)i * STAR_RECORD_SIZE];
+        struct Star *star = &stars[i];
+
+        star->right_ascension = get_f64(record);
+        star->declination = get_f64(record + 8);
+        star->ra_motion = get_f32(record + 16);
+        star->dec_motion = get_f32(record + 20);
+        star->magnitude = get_f32(record + 24);
+        star->catalog_number = (int)get_u32(record + 28);
+
+        // Parked at the nadir until its position is first updated
+        star->base = (struct ObjectBase){
+            .east = 0.0,
+            .north = 0.0,
+            .up = -1.0,
+            .color_pair = 0,
+            .label = NULL,
+        };
+        set_star_symbol(&star->base, star->magnitude);
+    }
+
+    free(records);
+    return stars;
+}
+
+static void loader_main(void *arg)
+{
+    struct TileCatalog *catalog = arg;
+
+    mutex_lock(&catalog->lock);
+    while (!catalog->stop)
+    {
+        if (catalog->queue_head == catalog->queue_length)
+        {
+            catalog->busy = false;
+            condition_broadcast(&catalog->idle);
+            condition_wait(&catalog->wake, &catalog->lock);
+            continue;
+        }
+        catalog->busy = true;
+
+        int t = (int)catalog->queue[catalog->queue_head++];
+        struct Tile *tile = &catalog->tiles[t];
+        tile->queued = false;
+
+        unsigned int count = MIN(tile->num_wanted, tile->count);
+        if (count <= tile->num_loaded)
+        {
+            continue;
+        }
+
+        // Reserve room for the new stars before reading them. The whole prefix
+        // is read again rather than appended to so buffers captured by the
+        // renderer are never written to
+        size_t needed = (count - tile->num_loaded) * sizeof(struct Star);
+        if (!make_room(catalog, t, needed))
+        {
+            continue;
+        }
+        catalog->resident_bytes += needed;
+
+        uint64_t offset = tile->offset;
+        mutex_unlock(&catalog->lock);
+        struct Star *stars = read_tile_stars(catalog->file, offset, count);
+        mutex_lock(&catalog->lock);
+
+        if (stars == NULL)
+        {
+            catalog->resident_bytes -= needed;
+            continue;
+        }
+
+        if (tile->pinned && tile->stars != NULL)
+        {
+            catalog->retired[catalog->num_retired++] = tile->stars;
+        }
+        else
+        {
+            free(tile->stars);
+        }
+
+        if (tile->num_loaded > 0)
+        {
+            lru_remove(catalog, t);
+        }
+        tile->stars = stars;
+        tile->num_loaded = count;
+        lru_push_front(catalog, t);
+        catalog->num_loads++;
+    }
+    mutex_unlock(&catalog->lock);
+}
+
+// Opening
+
+/* Read and validate the header and directory of a tiled catalog
+ */
+static bool read_directory(struct TileCatalog *catalog, unsigned int *num_bands)
+{
+    uint8_t header[HEADER_SIZE];
+    if (fread(header, HEADER_SIZE, 1, catalog->file) != 1 || memcmp(header, TILE_MAGIC, 8) != 0)
+    {
+        return false;
+    }
+
+    *num_bands = get_u32(header + 8);
+    catalog->num_tiles = get_u32(header + 12);
+    uint64_t num_stars = get_u64(header + 16);
+    catalog->max_motion = get_f64(header + 24);
+    if (*num_bands == 0 || catalog->num_tiles == 0 || num_stars > UINT32_MAX || !(catalog->max_motion >= 0.0))
+    {
+        return false;
+    }
+    catalog->num_stars = (unsigned int)num_stars;
+
+    catalog->tiles = calloc(catalog->num_tiles, sizeof(struct Tile));
+    uint8_t *directory = malloc((size_t)catalog->num_tiles * DIRECTORY_ENTRY_SIZE);
+    if (catalog->tiles == NULL || directory == NULL ||
+        fread(directory, DIRECTORY_ENTRY_SIZE, catalog->num_tiles, catalog->file) != catalog->num_tiles)
+    {
+        free(directory);
+        return false;
+    }
+
+    // Tiles must be stored back to back in order
+    uint64_t expected = HEADER_SIZE + (uint64_t)catalog->num_tiles * DIRECTORY_ENTRY_SIZE;
+    uint64_t total = 0;
+    bool valid = true;
+    for (unsigned int t = 0; t < catalog->num_tiles && valid; ++t)
+    {
+        const uint8_t *entry = &directory[(size_t)t * DIRECTORY_ENTRY_SIZE];
+        struct Tile *tile = &catalog->tiles[t];
+        tile->offset = get_u64(entry);
+        tile->count = get_u32(entry + 8);
+        tile->lru_prev = -1;
+        tile->lru_next = -1;
+
+        valid = tile->offset == expected;
+        expected += (uint64_t)tile->count * STAR_RECORD_SIZE;
+        total += tile->count;
+    }
+    free(directory);
+
+    return valid && total == num_stars;
+}
+
+bool generate_tile_catalog(struct TileCatalog *catalog, const char *path, size_t budget)
+{
+    memset(catalog, 0, sizeof(struct TileCatalog));
+    catalog->budget = budget;
+    catalog->lru_head = -1;
+    catalog->lru_tail = -1;
+
+    catalog->file = fopen(path, "rb");
+    if (catalog->file == NULL)
+    {
+        printf("Could not open tile catalog %s\n", path);
+        return false;
+    }
+
+    unsigned int num_bands = 0;
+    if (!read_directory(catalog, &num_bands))
+    {
+        printf("Tile catalog %s is malformed\n", path);
+        fclose(catalog->file);
+        free(catalog->tiles);
+        memset(catalog, 0, sizeof(struct TileCatalog));
+        return false;
+    }
+
+    if (!generate_sky_index(&catalog->layout, NULL, 0, num_bands))
+    {
+        fclose(catalog->file);
+        free(catalog->tiles);
+        memset(catalog, 0, sizeof(struct TileCatalog));
+        return false;
+    }
+    if (catalog->layout.num_cells != catalog->num_tiles)
+    {
+        printf("Tile catalog %s is malformed\n", path);
+        fclose(catalog->file);
+        free(catalog->tiles);
+        free_sky_index(&catalog->layout);
+        memset(catalog, 0, sizeof(struct TileCatalog));
+        return false;
+    }
+
+    catalog->queue = malloc(catalog->num_tiles * sizeof(unsigned int));
+    catalog->retired = malloc(catalog->num_tiles * sizeof(struct Star *));
+    catalog->frame = malloc(catalog->num_tiles * sizeof(struct TileSnapshot));
+    if (catalog->queue == NULL || catalog->retired == NULL || catalog->frame == NULL)
+    {
+        printf("Allocation of memory for tile catalog failed\n");
+        fclose(catalog->file);
+        free(catalog->tiles);
+        free(catalog->queue);
+        free(catalog->retired);
+        free(catalog->frame);
+        free_sky_index(&catalog->layout);
+        memset(catalog, 0, sizeof(struct TileCatalog));
+        return false;
+    }
+
+    mutex_init(&catalog->lock);
+    condition_init(&catalog->wake);
+    condition_init(&catalog->idle);
+    if (!thread_start(&catalog->loader, loader_main, catalog))
+    {
+        printf("Could not start the tile loader thread\n");
+        mutex_destroy(&catalog->lock);
+        condition_destroy(&catalog->wake);
+        condition_destroy(&catalog->idle);
+        fclose(catalog->file);
+        free(catalog->tiles);
+        free(catalog->queue);
+        free(catalog->retired);
+        free(catalog->frame);
+        free_sky_index(&catalog->layout);
+        memset(catalog, 0, sizeof(struct TileCatalog));
+        return false;
+    }
+
+    return true;
+}
+
+// Requests
+
+static double angular_distance(double ra_a, double dec_a, double ra_b, double dec_b)
+{
+    double cos_dist = sin(dec_a) * sin(dec_b) + cos(dec_a) * cos(dec_b) * cos(ra_a - ra_b);
+    return acos(fmax(-1.0, fmin(1.0, cos_dist)));
+}
+
+static void enqueue(struct TileCatalog *catalog, unsigned int t)
+{
+    struct Tile *tile = &catalog->tiles[t];
+    if (!tile->queued && MIN(tile->num_wanted, tile->count) > tile->num_loaded)
+    {
+        tile->queued = true;
+        catalog->queue[catalog->queue_length++] = t;
+    }
+}
+
+/* Unpin the captured tiles and free the buffers they replaced. Must be called
+ * with the lock held
+ */
+static void release_frame(struct TileCatalog *catalog)
+{
+    for (unsigned int k = 0; k < catalog->num_frame; ++k)
+    {
+        catalog->tiles[catalog->frame[k].tile].pinned = false;
+    }
+    catalog->num_frame = 0;
+
+    for (unsigned int i = 0; i < catalog->num_retired; ++i)
+    {
+        free(catalog->retired[i]);
+    }
+    catalog->num_retired = 0;
+}
+
+void tile_catalog_request(struct TileCatalog *catalog, double julian_date, double right_ascension, double declination,
+                          double radius, unsigned int stars_per_view)
+{
+    // Tiles hold J2000 positions, so allow for the largest proper motion
+    double years_from_epoch = fabs(julian_date - J2000) / DAYS_PER_YEAR;
+    double margin = catalog->max_motion * years_from_epoch;
+
+    // Select the tiles to prefetch, a superset of those in view, without the
+    // lock: the layout is never written after opening
+    struct SkyIndex *layout = &catalog->layout;
+    double band_height = M_PI / layout->num_bands;
+    sky_index_select_cap(layout, right_ascension, declination, radius * PREFETCH_SCALE + band_height, margin);
+
+    unsigned int num_in_view = 0;
+    for (unsigned int k = 0; k < layout->num_selected; ++k)
+    {
+        const struct SkyCell *cell = &layout->cells[layout->selected_cells[k]];
+        double dist = angular_distance(cell->center_ra, cell->center_dec, right_ascension, declination);
+        num_in_view += dist <= cell->radius + radius + margin;
+    }
+    unsigned int per_tile = MAX(MIN_STARS_PER_TILE, (stars_per_view + num_in_view - 1) / MAX(num_in_view, 1u));
+
+    mutex_lock(&catalog->lock);
+    release_frame(catalog);
+
+    // Drop requests for tiles that are no longer needed
+    for (unsigned int i = catalog->queue_head; i < catalog->queue_length; ++i)
+    {
+        catalog->tiles[catalog->queue[i]].queued = false;
+    }
+    catalog->queue_head = 0;
+    catalog->queue_length = 0;
+
+    // Tiles in view are captured and queued first, then the tiles around them.
+    // Touching the surrounding tiles first leaves those in view as the most
+    // recently used
+    for (int pass = 0; pass < 2; ++pass)
+    {
+        bool want_in_view = pass == 1;
+        for (unsigned int k = 0; k < layout->num_selected; ++k)
+        {
+            unsigned int t = layout->selected_cells[k];
+            const struct SkyCell *cell = &layout->cells[t];
+            double dist = angular_distance(cell->center_ra, cell->center_dec, right_ascension, declination);
+            if ((dist <= cell->radius + radius + margin) != want_in_view)
+            {
+                continue;
+            }
+
+            struct Tile *tile = &catalog->tiles[t];
+            tile->num_wanted = per_tile;
+            lru_touch(catalog, (int)t);
+
+            if (want_in_view && tile->num_loaded > 0)
+            {
+                tile->pinned = true;
+                catalog->frame[catalog->num_frame++] = (struct TileSnapshot){
+                    .tile = t,
+                    .stars = tile->stars,
+                    .count = MIN(tile->num_loaded, per_tile),
+                };
+            }
+        }
+    }
+
+    for (int pass = 0; pass < 2; ++pass)
+    {
+        bool want_in_view = pass == 0;
+        for (unsigned int k = 0; k < layout->num_selected; ++k)
+        {
+            unsigned int t = layout->selected_cells[k];
+            const struct SkyCell *cell = &layout->cells[t];
+            double dist = angular_distance(cell->center_ra, cell->center_dec, right_ascension, declination);
+            if ((dist <= cell->radius + radius + margin) == want_in_view)
+            {
+                enqueue(catalog, t);
+            }
+        }
+    }
+
+    if (catalog->queue_length > 0)
+    {
+        catalog->busy = true;
+        condition_signal(&catalog->wake);
+    }
+    mutex_unlock(&catalog->lock);
+}
+
+void tile_catalog_release(struct TileCatalog *catalog)
+{
+    mutex_lock(&catalog->lock);
+    release_frame(catalog);
+    mutex_unlock(&catalog->lock);
+}
+
+void tile_catalog_wait_idle(struct TileCatalog *catalog)
+{
+    mutex_lock(&catalog->lock);
+    while (catalog->busy)
+    {
+        condition_wait(&catalog->idle, &catalog->lock);
+    }
+    mutex_unlock(&catalog->lock);
+}
+
+void free_tile_catalog(struct TileCatalog *catalog)
+{
+    if (catalog->tiles == NULL)
+    {
+        return;
+    }
+
+    mutex_lock(&catalog->lock);
+    catalog->stop = true;
+    condition_signal(&catalog->wake);
+    mutex_unlock(&catalog->lock);
+    thread_join(&catalog->loader);
+
+    release_frame(catalog);
+    for (unsigned int t = 0; t < catalog->num_tiles; ++t)
+    {
+        free(catalog->tiles[t].stars);
+    }
+
+    mutex_destroy(&catalog->lock);
+    condition_destroy(&catalog->wake);
+    condition_destroy(&catalog->idle);
+    fclose(catalog->file);
+    free(catalog->tiles);
+    free(catalog->queue);
+    free(catalog->retired);
+    free(catalog->frame);
+    free_sky_index(&catalog->layout);
+    memset(catalog, 0, sizeof(struct TileCatalog));
+}
@@ -0,0 +1,60 @@
+#include "timer.h"
+
+#include "macros.h"
+#include "stopwatch.h"
+
+void sw_timer_reset(struct SwTimer *timer, const char *name)
+{
+    timer->name = name;
+    timer->min = ULLONG_MAX;
+    histogram_reset(&timer->times);
+}
+
+void sw_timer_record(struct SwTimer *timer, unsigned long long nsec)
+{
+    timer->min = MIN(timer->min, nsec);
+    histogram_record(&timer->times, nsec);
+}
+
+struct SwTimerScope sw_timer_begin(struct SwTimer *timer)
+{
+    struct SwTimerScope scope = {.timer = timer, .begin = sw_now_nsec(), .open = true};
+    return scope;
+}
+
+void sw_timer_end(struct SwTimerScope *scope)
+{
+    unsigned long long end = sw_now_nsec();
+    sw_timer_record(scope->timer, end > scope->begin ? end - scope->begin : 0);
+    scope->open = false;
+}
+
+void sw_timer_summarize(const struct SwTimer *timer, struct SwTimerSummary *summary)
+{
+    summary->name = timer->name;
+    summary->count = timer->times.count;
+    summary->total = timer->times.sum;
+    summary->min = timer->times.count > 0 ? timer->min : 0;
+    summary->max = timer->times.max;
+    summary->p50 = histogram_percentile(&timer->times, 0.50);
+    summary->p99 = histogram_percentile(&timer->times, 0.99);
+    summary->mean = histogram_mean(&timer->times);
+}
+
+void sw_timers_print(FILE *file, const struct SwTimer *const timers[], unsigned int num_timers)
+{
+    fprintf(file, "%-24s %10s %12s %10s %10s %10s %10s\n", "Timer", "count", "total (us)", "mean", "p50", "p99", "max");
+    for (unsigned int i = 0; i < num_timers; ++i)
+    {
+        struct SwTimerSummary summary;
+        sw_timer_summarize(timers[i], &summary);
+        if (summary.count == 0)
+        {
+            continue;
+        }
+
+        fprintf(file, "%-24s %10llu %12.1f %10.2f %10.2f %10.2f %10.2f\n", summary.name, summary.count,
+                summary.total / 1.0E3, summary.mean / 1.0E3, summary.p50 / 1.0E3, summary.p99 / 1.0E3,
+                summary.max / 1.0E3);
+    }
+}
@@ -0,0 +1,250 @@
+#include "trace.h"
+
+#include "macros.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// Events copied out of a buffer at a time, to format them without holding its
+// lock
+#define WRITE_BATCH 512
+
+// The writer is woken once a buffer is this full
+#define WAKE_THRESHOLD (TRACE_BUFFER_EVENTS / 4)
+
+// Every traced thread is a track of the same process
+#define TRACE_PID 1
+
+static void writer_main(void *arg);
+static unsigned int drain_buffer(struct Tracer *tracer, unsigned int index);
+static void write_event(struct Tracer *tracer, unsigned int index, const struct TraceEvent *event);
+static void record_event(struct TraceBuffer *buffer, const struct TraceEvent *event);
+
+bool generate_tracer(struct Tracer *tracer, const char *path, const char *const thread_names[], unsigned int num_threads)
+{
+    memset(tracer, 0, sizeof(struct Tracer));
+
+    tracer->file = fopen(path, "w");
+    if (tracer->file == NULL)
+    {
+        return false;
+    }
+    setvbuf(tracer->file, NULL, _IOFBF, 1 << 16);
+
+    tracer->num_buffers = num_threads;
+    tracer->buffers = calloc(num_threads, sizeof(struct TraceBuffer));
+    bool allocated = tracer->buffers != NULL;
+    for (unsigned int i = 0; allocated && i < num_threads; ++i)
+    {
+        struct TraceBuffer *buffer = &tracer->buffers[i];
+        buffer->tracer = tracer;
+        buffer->thread_name = thread_names[i];
+        buffer->events = malloc(TRACE_BUFFER_EVENTS * sizeof(struct TraceEvent));
+        allocated = buffer->events != NULL;
+    }
+    if (!allocated)
+    {
+        printf("Allocation of memory for tracer failed\n");
+        for (unsigned int i = 0; tracer->buffers != NULL && i < num_threads; ++i)
+        {
+            free(tracer->buffers[i].events);
+        }
+        free(tracer->buffers);
+        fclose(tracer->file);
+        memset(tracer, 0, sizeof(struct Tracer));
+        return false;
+    }
+
+    for (unsigned int i = 0; i < num_threads; ++i)
+    {
+        mutex_init(&tracer->buffers[i].lock);
+    }
+    mutex_init(&tracer->lock);
+    condition_init(&tracer->wake);
+    sw_gettime(&tracer->start);
+
+    // Name the track of each thread up front
+    fprintf(tracer->file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    for (unsigned int i = 0; i < num_threads; ++i)
+    {
+        fprintf(tracer->file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+                i > 0 ? ",\n" : "", TRACE_PID, i + 1, thread_names[i]);
+    }
+    tracer->any_written = num_threads > 0;
+
+    if (!thread_start(&tracer->writer, writer_main, tracer))
+    {
+        printf("Could not start the trace writer thread\n");
+        for (unsigned int i = 0; i < num_threads; ++i)
+        {
+            mutex_destroy(&tracer->buffers[i].lock);
+            free(tracer->buffers[i].events);
+        }
+        mutex_destroy(&tracer->lock);
+        condition_destroy(&tracer->wake);
+        free(tracer->buffers);
+        fclose(tracer->file);
+        memset(tracer, 0, sizeof(struct Tracer));
+        return false;
+    }
+
+    return true;
+}
+
+bool free_tracer(struct Tracer *tracer)
+{
+    if (tracer->file == NULL)
+    {
+        return true;
+    }
+
+    // The writer drains every buffer on its way out
+    mutex_lock(&tracer->lock);
+    tracer->stop = true;
+    condition_signal(&tracer->wake);
+    mutex_unlock(&tracer->lock);
+    thread_join(&tracer->writer);
+
+    fprintf(tracer->file, "\n]}\n");
+    bool written = ferror(tracer->file) == 0;
+    written = fclose(tracer->file) == 0 && written;
+
+    for (unsigned int i = 0; i < tracer->num_buffers; ++i)
+    {
+        mutex_destroy(&tracer->buffers[i].lock);
+        free(tracer->buffers[i].events);
+    }
+    mutex_destroy(&tracer->lock);
+    condition_destroy(&tracer->wake);
+    free(tracer->buffers);
+    memset(tracer, 0, sizeof(struct Tracer));
+
+    return written;
+}
+
+void trace_span(struct TraceBuffer *buffer, const char *name, struct SwTimestamp begin, struct SwTimestamp end)
+{
+    struct TraceEvent event = {.name = name, .begin = begin, .end = end, .instant = false};
+    record_event(buffer, &event);
+}
+
+void trace_instant(struct TraceBuffer *buffer, const char *name, struct SwTimestamp time)
+{
+    struct TraceEvent event = {.name = name, .begin = time, .end = time, .instant = true};
+    record_event(buffer, &event);
+}
+
+unsigned long long tracer_dropped(struct Tracer *tracer)
+{
+    unsigned long long num_dropped = 0;
+    for (unsigned int i = 0; i < tracer->num_buffers; ++i)
+    {
+        mutex_lock(&tracer->buffers[i].lock);
+        num_dropped += tracer->buffers[i].num_dropped;
+        mutex_unlock(&tracer->buffers[i].lock);
+    }
+    return num_dropped;
+}
+
+void record_event(struct TraceBuffer *buffer, const struct TraceEvent *event)
+{
+    mutex_lock(&buffer->lock);
+    if (buffer->count < TRACE_BUFFER_EVENTS)
+    {
+        buffer->events[(buffer->head + buffer->count) % TRACE_BUFFER_EVENTS] = *event;
+        buffer->count++;
+    }
+    else
+    {
+        buffer->num_dropped++;
+    }
+    bool wake = buffer->count == WAKE_THRESHOLD;
+    mutex_unlock(&buffer->lock);
+
+    if (wake)
+    {
+        struct Tracer *tracer = buffer->tracer;
+        mutex_lock(&tracer->lock);
+        tracer->pending = true;
+        condition_signal(&tracer->wake);
+        mutex_unlock(&tracer->lock);
+    }
+}
+
+/* Write events whenever a buffer fills up, then everything left once stopped
+ */
+void writer_main(void *arg)
+{
+    struct Tracer *tracer = arg;
+
+    bool stop = false;
+    while (!stop)
+    {
+        mutex_lock(&tracer->lock);
+        while (!tracer->pending && !tracer->stop)
+        {
+            condition_wait(&tracer->wake, &tracer->lock);
+        }
+        tracer->pending = false;
+        stop = tracer->stop;
+        mutex_unlock(&tracer->lock);
+
+        // Buffers keep filling while they are drained
+        bool drained = false;
+        while (!drained)
+        {
+            drained = true;
+            for (unsigned int i = 0; i < tracer->num_buffers; ++i)
+            {
+                drained = drain_buffer(tracer, i) == 0 && drained;
+            }
+        }
+        fflush(tracer->file);
+    }
+}
+
+/* Write the oldest events of a buffer. Returns how many were written
+ */
+unsigned int drain_buffer(struct Tracer *tracer, unsigned int index)
+{
+    struct TraceBuffer *buffer = &tracer->buffers[index];
+    struct TraceEvent batch[WRITE_BATCH];
+
+    mutex_lock(&buffer->lock);
+    unsigned int num_events = MIN(buffer->count, (unsigned int)WRITE_BATCH);
+    for (unsigned int i = 0; i < num_events; ++i)
+    {
+        batch[i] = buffer->events[(buffer->head + i) % TRACE_BUFFER_EVENTS];
+    }
+    buffer->head = (buffer->head + num_events) % TRACE_BUFFER_EVENTS;
+    buffer->count -= num_events;
+    mutex_unlock(&buffer->lock);
+
+    for (unsigned int i = 0; i < num_events; ++i)
+    {
+        write_event(tracer, index, &batch[i]);
+    }
+    return num_events;
+}
+
+void write_event(struct Tracer *tracer, unsigned int index, const struct TraceEvent *event)
+{
+    // Microseconds since the start of the trace
+    unsigned long long begin;
+    sw_timediff_usec(event->begin, tracer->start, &begin);
+
+    const char *separator = tracer->any_written ? ",\n" : "";
+    tracer->any_written = true;
+
+    if (event->instant)
+    {
+        fprintf(tracer->file, "%s{\"name\":\"%s\",\"ph\":\"i\",\"s\":\"t\",\"pid\":%d,\"tid\":%u,\"ts\":%llu}", separator,
+                event->name, TRACE_PID, index + 1, begin);
+        return;
+    }
+
+    unsigned long long duration;
+    sw_timediff_usec(event->end, event->begin, &duration);
+    fprintf(tracer->file, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":%d,\"tid\":%u,\"ts\":%llu,\"dur\":%llu}", separator,
+            event->name, TRACE_PID, index + 1, begin, duration);
+}
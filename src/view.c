@@ -0,0 +1,219 @@
+#include "view.h"
+
+#include "astro.h"
+#include "coord.h"
+#include "macros.h"
+
+#include <curses.h>
+#include <math.h>
+
+// Range of the field of view (radians). The gnomonic projection stretches
+// without bound towards 180°, so it stops well before
+#define MIN_FIELD (0.5 * TO_RAD)
+#define MAX_FIELD_GNOMONIC (120.0 * TO_RAD)
+#define MAX_FIELD_STEREOGRAPHIC (240.0 * TO_RAD)
+#define DEFAULT_FIELD (60.0 * TO_RAD)
+
+// Each zoom step scales the field by this factor
+#define ZOOM_FACTOR 1.25
+
+// Each pan step moves the center by this fraction of the field
+#define PAN_FRACTION 0.125
+
+// Points this close to perpendicular to the center, or beyond, are not
+// projected (cosine of the angle from the center)
+#define MIN_COS_GNOMONIC 0.02
+#define MIN_COS_STEREOGRAPHIC -0.9
+
+static double max_field(const struct View *view)
+{
+    return view->gnomonic ? MAX_FIELD_GNOMONIC : MAX_FIELD_STEREOGRAPHIC;
+}
+
+/* Recompute the frame of the field from its center and the extent of the
+ * window on the projection plane. The right of the window points along
+ * increasing azimuth, so at the zenith facing South the view matches the whole
+ * sky projection with North at the top and East on the left
+ */
+static void update_frame(struct View *view)
+{
+    // Edges of the window lie at tan(field / 2) on the tangent plane, or at
+    // 2 tan(field / 4) stereographically
+    view->half_extent = view->gnomonic ? tan(view->field / 2.0) : 2.0 * tan(view->field / 4.0);
+
+    double sin_az = sin(view->azimuth);
+    double cos_az = cos(view->azimuth);
+    double sin_alt = sin(view->altitude);
+    double cos_alt = cos(view->altitude);
+
+    view->center[0] = cos_alt * sin_az;
+    view->center[1] = cos_alt * cos_az;
+    view->center[2] = sin_alt;
+
+    view->right[0] = cos_az;
+    view->right[1] = -sin_az;
+    view->right[2] = 0.0;
+
+    // right × center
+    view->up[0] = -sin_az * sin_alt;
+    view->up[1] = -cos_az * sin_alt;
+    view->up[2] = cos_alt;
+}
+
+void view_init(struct View *view)
+{
+    view->zoomed = false;
+    view->gnomonic = true;
+    view->azimuth = M_PI;
+    view->altitude = M_PI / 2.0;
+    view->field = DEFAULT_FIELD;
+    update_frame(view);
+}
+
+void view_look_at(struct View *view, double azimuth, double altitude, double field)
+{
+    view->zoomed = true;
+    view->azimuth = azimuth;
+    view->altitude = fmax(-M_PI / 2.0, fmin(M_PI / 2.0, altitude));
+    view->field = fmax(MIN_FIELD, fmin(max_field(view), field));
+    update_frame(view);
+}
+
+static void pan(struct View *view, double d_azimuth, double d_altitude)
+{
+    double step = view->field * PAN_FRACTION;
+
+    // Keep the apparent speed constant away from the zenith
+    view->azimuth += d_azimuth * step / fmax(cos(view->altitude), 0.25);
+    view->azimuth = fmod(view->azimuth, 2.0 * M_PI);
+    view->azimuth += view->azimuth < 0.0 ? 2.0 * M_PI : 0.0;
+
+    view->altitude = fmax(-M_PI / 2.0, fmin(M_PI / 2.0, view->altitude + d_altitude * step));
+    update_frame(view);
+}
+
+bool view_handle_key(struct View *view, int key)
+{
+    switch (key)
+    {
+    case '+':
+    case '=':
+        if (view->zoomed)
+        {
+            view->field = fmax(MIN_FIELD, view->field / ZOOM_FACTOR);
+            update_frame(view);
+        }
+        view->zoomed = true;
+        return true;
+
+    case 'z':
+        view->zoomed = !view->zoomed;
+        return true;
+
+    default:
+        break;
+    }
+
+    // The remaining keys only apply to the zoomed view
+    if (!view->zoomed)
+    {
+        return false;
+    }
+
+    switch (key)
+    {
+    case '-':
+    case '_':
+        view->field = fmin(max_field(view), view->field * ZOOM_FACTOR);
+        update_frame(view);
+        return true;
+
+    case KEY_LEFT:
+    case 'h':
+        pan(view, -1.0, 0.0);
+        return true;
+
+    case KEY_RIGHT:
+    case 'l':
+        pan(view, 1.0, 0.0);
+        return true;
+
+    case KEY_UP:
+    case 'k':
+        pan(view, 0.0, 1.0);
+        return true;
+
+    case KEY_DOWN:
+    case 'j':
+        pan(view, 0.0, -1.0);
+        return true;
+
+    case 'p':
+        view->gnomonic = !view->gnomonic;
+        view->field = fmin(max_field(view), view->field);
+        update_frame(view);
+        return true;
+
+    default:
+        return false;
+    }
+}
+
+double view_cap_radius(const struct View *view)
+{
+    // The corners of the window are the farthest points from the center
+    if (view->gnomonic)
+    {
+        return atan(M_SQRT2 * tan(view->field / 2.0));
+    }
+    return 2.0 * atan(M_SQRT2 * tan(view->field / 4.0));
+}
+
+void view_center_equatorial(const struct View *view, double julian_date, double latitude, double longitude,
+                            double *right_ascension, double *declination)
+{
+    double gmst = greenwich_mean_sidereal_time_rad(julian_date);
+    horizontal_to_equatorial(view->azimuth, view->altitude, gmst, latitude, longitude, right_ascension, declination);
+}
+
+bool view_project(const struct View *view, double east, double north, double up, double *x, double *y)
+{
+    double along = east * view->center[0] + north * view->center[1] + up * view->center[2];
+    double across = east * view->right[0] + north * view->right[1] + up * view->right[2];
+    double above = east * view->up[0] + north * view->up[1] + up * view->up[2];
+
+    double scale;
+    if (view->gnomonic)
+    {
+        // Central projection onto the tangent plane
+        if (along < MIN_COS_GNOMONIC)
+        {
+            return false;
+        }
+        scale = 1.0 / (along * view->half_extent);
+    }
+    else
+    {
+        // Projection from the antipode of the center
+        if (along < MIN_COS_STEREOGRAPHIC)
+        {
+            return false;
+        }
+        scale = 2.0 / ((1.0 + along) * view->half_extent);
+    }
+
+    *x = across * scale;
+    *y = above * scale;
+    return true;
+}
+
+bool view_plane_to_win(double x, double y, int win_height, int win_width, int *row, int *col)
+{
+    double rad_y = (win_height - 1) / 2.0;
+    double rad_x = (win_width - 1) / 2.0;
+
+    *row = (int)round(rad_y * (1.0 - y));
+    *col = (int)round(rad_x * (1.0 + x));
+
+    return fabs(x) <= 1.0 && fabs(y) <= 1.0;
+}
@@ -0,0 +1,304 @@
+#include "visibility.h"
+
+#include "astro.h"
+#include "bit.h"
+#include "core.h"
+#include "macros.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Stars are considered visible slightly below the horizon so the visible set is
+// a superset of what is rendered despite the approximations made when
+// predicting crossings (radians)
+#define HORIZON_ALTITUDE (-0.5 * TO_RAD)
+
+// Smallest delay between events of the same star, one second (days)
+#define MIN_EVENT_DELAY (1.0 / 86400.0)
+
+// Events are recomputed when the date drifts this far from when they were
+// built, since proper motion slowly changes the crossing times (days)
+#define REBUILD_WINDOW (100.0 * 365.2425)
+
+// Largest simulated time per frame (days) for which tracking rise and set
+// events beats culling whole cells of the sky index. Faster clocks make most
+// stars cross the horizon every few frames
+#define MAX_FRAME_STEP 0.002
+
+#define WORD_BITS 64
+
+// Binary heap
+
+static void swap_events(struct VisibilityEvent *a, struct VisibilityEvent *b)
+{
+    struct VisibilityEvent tmp = *a;
+    *a = *b;
+    *b = tmp;
+}
+
+static void sift_down(struct VisibilityEvent *events, unsigned int num_events, unsigned int i)
+{
+    while (true)
+    {
+        unsigned int smallest = i;
+        unsigned int left = 2 * i + 1;
+        unsigned int right = 2 * i + 2;
+        if (left < num_events && events[left].julian_date < events[smallest].julian_date)
+        {
+            smallest = left;
+        }
+        if (right < num_events && events[right].julian_date < events[smallest].julian_date)
+        {
+            smallest = right;
+        }
+        if (smallest == i)
+        {
+            return;
+        }
+        swap_events(&events[i], &events[smallest]);
+        i = smallest;
+    }
+}
+
+static void sift_up(struct VisibilityEvent *events, unsigned int i)
+{
+    while (i > 0)
+    {
+        unsigned int parent = (i - 1) / 2;
+        if (events[parent].julian_date <= events[i].julian_date)
+        {
+            return;
+        }
+        swap_events(&events[i], &events[parent]);
+        i = parent;
+    }
+}
+
+static void pop_event(struct VisibilityScheduler *scheduler)
+{
+    scheduler->events[0] = scheduler->events[--scheduler->num_events];
+    sift_down(scheduler->events, scheduler->num_events, 0);
+}
+
+// Visible set
+
+static bool test_bit(const uint64_t *bits, unsigned int i)
+{
+    return (bits[i / WORD_BITS] >> (i % WORD_BITS)) & 1;
+}
+
+static void set_visible(struct VisibilityScheduler *scheduler, struct Star *star_table, unsigned int star,
+                        bool visible)
+{
+    unsigned int rank = scheduler->rank_of[star];
+    uint64_t mask = (uint64_t)1 << (rank % WORD_BITS);
+    uint64_t *word = &scheduler->visible[rank / WORD_BITS];
+
+    bool was_visible = (*word & mask) != 0;
+    if (visible && !was_visible)
+    {
+        *word |= mask;
+        scheduler->num_visible++;
+    }
+    else if (!visible && was_visible)
+    {
+        *word &= ~mask;
+        scheduler->num_visible--;
+    }
+
+    // Park the star at the nadir so it is not rendered
+    if (!visible && !test_bit(scheduler->pinned, rank))
+    {
+        struct ObjectBase *base = &star_table[star].base;
+        base->east = 0.0;
+        base->north = 0.0;
+        base->up = -1.0;
+    }
+}
+
+/* Determine whether a star is visible at `julian_date` and, if it rises and
+ * sets, append an event at its next horizon crossing
+ */
+static void schedule_star(struct VisibilityScheduler *scheduler, struct Star *star_table, unsigned int star,
+                          double julian_date, double local_sidereal_time)
+{
+    const struct Star *entry = &star_table[star];
+    double right_ascension, declination;
+    calc_star_position(entry->right_ascension, entry->ra_motion, entry->declination, entry->dec_motion, julian_date,
+                       &right_ascension, &declination);
+
+    double semi_arc = 0.0;
+    enum DiurnalMotion motion =
+        calc_semi_diurnal_arc(declination, scheduler->latitude, HORIZON_ALTITUDE, &semi_arc);
+
+    bool visible = motion == CIRCUMPOLAR;
+    if (motion == RISES_AND_SETS)
+    {
+        // Above the horizon while the hour angle is within the semi-diurnal arc
+        double hour_angle = remainder(local_sidereal_time - right_ascension, 2.0 * M_PI);
+        visible = fabs(hour_angle) < semi_arc;
+
+        double angle_to_crossing =
+            visible ? semi_arc - hour_angle : fmod(-semi_arc - hour_angle + 4.0 * M_PI, 2.0 * M_PI);
+        double delay = fmax(angle_to_crossing / (2.0 * M_PI * SIDEREAL_RATE), MIN_EVENT_DELAY);
+
+        scheduler->events[scheduler->num_events++] = (struct VisibilityEvent){
+            .julian_date = julian_date + delay,
+            .star = star,
+        };
+    }
+
+    set_visible(scheduler, star_table, star, visible);
+}
+
+static void rebuild(struct VisibilityScheduler *scheduler, struct Star *star_table, double julian_date,
+                    double local_sidereal_time)
+{
+    memset(scheduler->visible, 0, scheduler->num_words * sizeof(uint64_t));
+    scheduler->num_visible = 0;
+    scheduler->num_events = 0;
+
+    for (unsigned int i = 0; i < scheduler->num_stars; ++i)
+    {
+        schedule_star(scheduler, star_table, i, julian_date, local_sidereal_time);
+    }
+
+    // Heapify in linear time rather than pushing one event at a time
+    for (unsigned int i = scheduler->num_events / 2; i-- > 0;)
+    {
+        sift_down(scheduler->events, scheduler->num_events, i);
+    }
+
+    scheduler->built = true;
+    scheduler->built_julian_date = julian_date;
+}
+
+bool generate_visibility_scheduler(struct VisibilityScheduler *scheduler, const unsigned int *idx_by_mag,
+                                   unsigned int num_stars)
+{
+    memset(scheduler, 0, sizeof(struct VisibilityScheduler));
+    scheduler->num_stars = num_stars;
+    scheduler->idx_by_mag = idx_by_mag;
+    scheduler->num_words = (num_stars + WORD_BITS - 1) / WORD_BITS;
+
+    scheduler->rank_of = malloc(num_stars * sizeof(unsigned int));
+    scheduler->visible = calloc(scheduler->num_words, sizeof(uint64_t));
+    scheduler->pinned = calloc(scheduler->num_words, sizeof(uint64_t));
+    scheduler->events = malloc(num_stars * sizeof(struct VisibilityEvent));
+    if ((scheduler->rank_of == NULL || scheduler->visible == NULL || scheduler->pinned == NULL ||
+         scheduler->events == NULL) &&
+        num_stars > 0)
+    {
+        printf("Allocation of memory for visibility scheduler failed\n");
+        free_visibility_scheduler(scheduler);
+        return false;
+    }
+
+    for (unsigned int rank = 0; rank < num_stars; ++rank)
+    {
+        scheduler->rank_of[idx_by_mag[rank]] = rank;
+    }
+
+    return true;
+}
+
+void visibility_scheduler_pin_stars(struct VisibilityScheduler *scheduler, const unsigned int *star_indices,
+                                    unsigned int count)
+{
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        unsigned int rank = scheduler->rank_of[star_indices[i]];
+        scheduler->pinned[rank / WORD_BITS] |= (uint64_t)1 << (rank % WORD_BITS);
+    }
+}
+
+void visibility_scheduler_advance(struct VisibilityScheduler *scheduler, struct Star *star_table, double julian_date,
+                                  double latitude, double longitude)
+{
+    double gmst = greenwich_mean_sidereal_time_rad(julian_date);
+    double local_sidereal_time = fmod(gmst + longitude, 2.0 * M_PI);
+
+    // Events only move forwards in time for a fixed observer
+    bool rebuild_needed = !scheduler->built || latitude != scheduler->latitude ||
+                          longitude != scheduler->longitude || julian_date < scheduler->julian_date ||
+                          julian_date - scheduler->built_julian_date > REBUILD_WINDOW;
+
+    scheduler->latitude = latitude;
+    scheduler->longitude = longitude;
+    scheduler->julian_date = julian_date;
+
+    if (rebuild_needed)
+    {
+        rebuild(scheduler, star_table, julian_date, local_sidereal_time);
+        return;
+    }
+
+    // Each star has at most one event, so a star is processed at most once per
+    // advance no matter how far the clock jumps
+    while (scheduler->num_events > 0 && scheduler->events[0].julian_date <= julian_date)
+    {
+        unsigned int star = scheduler->events[0].star;
+        pop_event(scheduler);
+
+        unsigned int num_events = scheduler->num_events;
+        schedule_star(scheduler, star_table, star, julian_date, local_sidereal_time);
+        if (scheduler->num_events > num_events)
+        {
+            sift_up(scheduler->events, num_events);
+        }
+    }
+}
+
+/* First set bit at or after `i` in the union of two bitsets, or `num_bits` if
+ * there is none
+ */
+static unsigned int next_set_bit(const uint64_t *a, const uint64_t *b, unsigned int num_words, unsigned int num_bits,
+                                 unsigned int i)
+{
+    if (i >= num_bits)
+    {
+        return num_bits;
+    }
+
+    // Mask off the bits below `i` in the first word
+    unsigned int w = i / WORD_BITS;
+    uint64_t word = (a[w] | b[w]) & (~(uint64_t)0 << (i % WORD_BITS));
+    while (word == 0)
+    {
+        if (++w >= num_words)
+        {
+            return num_bits;
+        }
+        word = a[w] | b[w];
+    }
+
+    return w * WORD_BITS + lowest_set_bit64(word);
+}
+
+bool visibility_scheduler_suits(double frame_step)
+{
+    // Events only move forwards, so a clock running backwards would recompute
+    // every one of them each frame
+    return frame_step >= 0.0 && frame_step < MAX_FRAME_STEP;
+}
+
+unsigned int visibility_scheduler_next(const struct VisibilityScheduler *scheduler, unsigned int rank)
+{
+    return next_set_bit(scheduler->visible, scheduler->pinned, scheduler->num_words, scheduler->num_stars, rank);
+}
+
+unsigned int visibility_scheduler_next_pinned(const struct VisibilityScheduler *scheduler, unsigned int rank)
+{
+    return next_set_bit(scheduler->pinned, scheduler->pinned, scheduler->num_words, scheduler->num_stars, rank);
+}
+
+void free_visibility_scheduler(struct VisibilityScheduler *scheduler)
+{
+    free(scheduler->rank_of);
+    free(scheduler->visible);
+    free(scheduler->pinned);
+    free(scheduler->events);
+    memset(scheduler, 0, sizeof(struct VisibilityScheduler));
+}
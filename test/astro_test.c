@@ -313,6 +313,51 @@ void test_decimal_to_dms(void)
     TEST_ASSERT_FLOAT_WITHIN(0.001, 0.0, seconds);
 }
 
+void test_classify_diurnal_motion(void)
+{
+    double latitude = 40.0 * M_PI / 180;
+
+    // Polaris from mid-northern latitudes
+    TEST_ASSERT_EQUAL_INT(CIRCUMPOLAR, classify_diurnal_motion(89.26 * M_PI / 180, latitude, 0.0));
+    // Canopus from mid-northern latitudes
+    TEST_ASSERT_EQUAL_INT(NEVER_RISES, classify_diurnal_motion(-52.7 * M_PI / 180, latitude, 0.0));
+    // Sirius
+    TEST_ASSERT_EQUAL_INT(RISES_AND_SETS, classify_diurnal_motion(-16.7 * M_PI / 180, latitude, 0.0));
+
+    // The same stars from the southern hemisphere
+    TEST_ASSERT_EQUAL_INT(NEVER_RISES, classify_diurnal_motion(89.26 * M_PI / 180, -latitude, 0.0));
+    TEST_ASSERT_EQUAL_INT(CIRCUMPOLAR, classify_diurnal_motion(-52.7 * M_PI / 180, -latitude, 0.0));
+
+    // Everything rises and sets at the equator
+    TEST_ASSERT_EQUAL_INT(RISES_AND_SETS, classify_diurnal_motion(80.0 * M_PI / 180, 0.0, 0.0));
+    TEST_ASSERT_EQUAL_INT(RISES_AND_SETS, classify_diurnal_motion(-80.0 * M_PI / 180, 0.0, 0.0));
+
+    // Stars near the boundary are not classified when within the margin
+    TEST_ASSERT_EQUAL_INT(NEVER_RISES, classify_diurnal_motion(-50.5 * M_PI / 180, latitude, 0.0));
+    TEST_ASSERT_EQUAL_INT(RISES_AND_SETS, classify_diurnal_motion(-50.5 * M_PI / 180, latitude, 1.0 * M_PI / 180));
+}
+
+void test_calc_semi_diurnal_arc(void)
+{
+    double semi_arc = 0.0;
+
+    // Objects on the celestial equator are up for half a day everywhere
+    TEST_ASSERT_EQUAL_INT(RISES_AND_SETS, calc_semi_diurnal_arc(0.0, 0.7, 0.0, &semi_arc));
+    TEST_ASSERT_FLOAT_WITHIN(EPSILON, M_PI / 2, semi_arc);
+
+    // Northern objects are up for longer in the northern hemisphere
+    TEST_ASSERT_EQUAL_INT(RISES_AND_SETS, calc_semi_diurnal_arc(0.3, 0.7, 0.0, &semi_arc));
+    TEST_ASSERT_TRUE(semi_arc > M_PI / 2);
+    TEST_ASSERT_FLOAT_WITHIN(EPSILON, acos(-tan(0.3) * tan(0.7)), semi_arc);
+
+    TEST_ASSERT_EQUAL_INT(CIRCUMPOLAR, calc_semi_diurnal_arc(1.2, 0.7, 0.0, &semi_arc));
+    TEST_ASSERT_EQUAL_INT(NEVER_RISES, calc_semi_diurnal_arc(-1.2, 0.7, 0.0, &semi_arc));
+
+    // Altitude is constant at the poles
+    TEST_ASSERT_EQUAL_INT(CIRCUMPOLAR, calc_semi_diurnal_arc(0.1, M_PI / 2, 0.0, &semi_arc));
+    TEST_ASSERT_EQUAL_INT(NEVER_RISES, calc_semi_diurnal_arc(-0.1, M_PI / 2, 0.0, &semi_arc));
+}
+
 int main(void)
 {
     UNITY_BEGIN();
@@ -327,5 +372,7 @@ int main(void)
     RUN_TEST(test_get_moon_phase_name);
     RUN_TEST(test_get_moon_phase_image);
     RUN_TEST(test_decimal_to_dms);
+    RUN_TEST(test_classify_diurnal_motion);
+    RUN_TEST(test_calc_semi_diurnal_arc);
     return UNITY_END();
 }
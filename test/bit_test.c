@@ -103,6 +103,22 @@ void test_bytes_to_bool32_LE(void)
     TEST_ASSERT_FALSE(bytes_to_bool32_LE(buffer));
 }
 
+void test_lowest_set_bit64(void)
+{
+    TEST_ASSERT_EQUAL_UINT(0, lowest_set_bit64(0x1));
+    TEST_ASSERT_EQUAL_UINT(3, lowest_set_bit64(0x28));
+    TEST_ASSERT_EQUAL_UINT(32, lowest_set_bit64(0x100000000ULL));
+    TEST_ASSERT_EQUAL_UINT(63, lowest_set_bit64(0x8000000000000000ULL));
+}
+
+void test_highest_set_bit64(void)
+{
+    TEST_ASSERT_EQUAL_UINT(0, highest_set_bit64(0x1));
+    TEST_ASSERT_EQUAL_UINT(5, highest_set_bit64(0x28));
+    TEST_ASSERT_EQUAL_UINT(32, highest_set_bit64(0x1FFFFFFFFULL));
+    TEST_ASSERT_EQUAL_UINT(63, highest_set_bit64(0x8000000000000001ULL));
+}
+
 int main(void)
 {
     UNITY_BEGIN();
@@ -115,6 +131,8 @@ int main(void)
     RUN_TEST(test_bytes_to_float32_LE);
     RUN_TEST(test_bytes_to_double64_LE);
     RUN_TEST(test_bytes_to_bool32_LE);
+    RUN_TEST(test_lowest_set_bit64);
+    RUN_TEST(test_highest_set_bit64);
 
     return UNITY_END();
 }
@@ -0,0 +1,166 @@
+#include "canvas.h"
+#include "unity.h"
+
+#include <stdint.h>
+
+static struct Canvas canvas;
+
+void setUp(void)
+{
+    TEST_ASSERT_TRUE(generate_canvas(&canvas, 4, 10));
+}
+
+void tearDown(void)
+{
+    free_canvas(&canvas);
+}
+
+static uint32_t cell_ch(int y, int x)
+{
+    return canvas.cells[y * canvas.width + x].ch;
+}
+
+void test_generate_canvas_is_blank(void)
+{
+    TEST_ASSERT_EQUAL_INT(4, canvas.height);
+    TEST_ASSERT_EQUAL_INT(10, canvas.width);
+    for (int i = 0; i < canvas.height * canvas.width; ++i)
+    {
+        TEST_ASSERT_EQUAL_UINT32(0, canvas.cells[i].ch);
+        TEST_ASSERT_EQUAL_UINT16(0, canvas.cells[i].color_pair);
+    }
+}
+
+void test_utf8_round_trip(void)
+{
+    const uint32_t code_points[] = {'A', 0xB0, 0x2588, 0x28FF, 0x1F315};
+    const int lengths[] = {1, 2, 3, 3, 4};
+    for (unsigned int i = 0; i < sizeof(code_points) / sizeof(code_points[0]); ++i)
+    {
+        char encoded[5];
+        TEST_ASSERT_EQUAL_INT(lengths[i], utf8_encode(code_points[i], encoded));
+
+        const char *str = encoded;
+        TEST_ASSERT_EQUAL_UINT32(code_points[i], utf8_decode(&str));
+        TEST_ASSERT_EQUAL_PTR(encoded + lengths[i], str);
+        TEST_ASSERT_EQUAL_CHAR('\0', *str);
+    }
+}
+
+void test_utf8_decode_invalid_bytes(void)
+{
+    // Stray continuation byte, then a lead byte cut short by the terminator
+    const char *str = "\x80" "a\xE2\x96";
+    TEST_ASSERT_EQUAL_UINT32(0xFFFD, utf8_decode(&str));
+    TEST_ASSERT_EQUAL_UINT32('a', utf8_decode(&str));
+    TEST_ASSERT_EQUAL_UINT32(0xFFFD, utf8_decode(&str));
+    TEST_ASSERT_EQUAL_UINT32(0xFFFD, utf8_decode(&str));
+    TEST_ASSERT_EQUAL_CHAR('\0', *str);
+}
+
+void test_put_str_one_cell_per_code_point(void)
+{
+    canvas_put_str(&canvas, 1, 2, "\xE2\x96\x88x\xC2\xB0");
+    TEST_ASSERT_EQUAL_UINT32(0x2588, cell_ch(1, 2));
+    TEST_ASSERT_EQUAL_UINT32('x', cell_ch(1, 3));
+    TEST_ASSERT_EQUAL_UINT32(0xB0, cell_ch(1, 4));
+    TEST_ASSERT_EQUAL_UINT32(0, cell_ch(1, 5));
+}
+
+void test_put_str_clips_at_right_edge(void)
+{
+    canvas_put_str(&canvas, 0, 7, "abcdef");
+    TEST_ASSERT_EQUAL_UINT32('a', cell_ch(0, 7));
+    TEST_ASSERT_EQUAL_UINT32('c', cell_ch(0, 9));
+    // Nothing wraps onto the next row
+    TEST_ASSERT_EQUAL_UINT32(0, cell_ch(1, 0));
+}
+
+void test_drawing_out_of_bounds_is_dropped(void)
+{
+    canvas_put_char(&canvas, -1, 0, '*');
+    canvas_put_char(&canvas, 4, 0, '*');
+    canvas_put_char(&canvas, 0, -1, '*');
+    canvas_put_char(&canvas, 0, 10, '*');
+    canvas_put_str(&canvas, 4, 0, "below");
+
+    // Characters left of the canvas are dropped, the rest are drawn
+    canvas_put_str(&canvas, 2, -2, "abc");
+    TEST_ASSERT_EQUAL_UINT32('c', cell_ch(2, 0));
+
+    for (int i = 0; i < canvas.height * canvas.width; ++i)
+    {
+        if (i != 2 * canvas.width)
+        {
+            TEST_ASSERT_EQUAL_UINT32(0, canvas.cells[i].ch);
+        }
+    }
+}
+
+void test_put_str_tab_stops(void)
+{
+    canvas_put_str(&canvas, 0, 0, "ab\tc");
+    TEST_ASSERT_EQUAL_UINT32('b', cell_ch(0, 1));
+    TEST_ASSERT_EQUAL_UINT32(0, cell_ch(0, 2));
+    TEST_ASSERT_EQUAL_UINT32('c', cell_ch(0, 8));
+}
+
+void test_color_pairs(void)
+{
+    canvas_set_color(&canvas, 3);
+    canvas_put_char(&canvas, 0, 0, 'a');
+    canvas_set_color(&canvas, 0);
+    canvas_put_char(&canvas, 0, 1, 'b');
+
+    TEST_ASSERT_EQUAL_UINT16(3, canvas.cells[0].color_pair);
+    TEST_ASSERT_EQUAL_UINT16(0, canvas.cells[1].color_pair);
+
+    // Erasing also resets the color pair
+    canvas_set_color(&canvas, 2);
+    canvas_erase(&canvas);
+    canvas_put_char(&canvas, 0, 0, 'c');
+    TEST_ASSERT_EQUAL_UINT16(0, canvas.cells[0].color_pair);
+}
+
+void test_printf(void)
+{
+    canvas_printf(&canvas, 3, 0, "%d%s", 42, "!");
+    TEST_ASSERT_EQUAL_UINT32('4', cell_ch(3, 0));
+    TEST_ASSERT_EQUAL_UINT32('2', cell_ch(3, 1));
+    TEST_ASSERT_EQUAL_UINT32('!', cell_ch(3, 2));
+}
+
+void test_resize_leaves_canvas_blank(void)
+{
+    canvas_put_str(&canvas, 0, 0, "stars");
+    TEST_ASSERT_TRUE(resize_canvas(&canvas, 6, 3));
+    TEST_ASSERT_EQUAL_INT(6, canvas.height);
+    TEST_ASSERT_EQUAL_INT(3, canvas.width);
+    for (int i = 0; i < canvas.height * canvas.width; ++i)
+    {
+        TEST_ASSERT_EQUAL_UINT32(0, canvas.cells[i].ch);
+    }
+
+    // An empty canvas draws nothing
+    TEST_ASSERT_TRUE(resize_canvas(&canvas, 0, 0));
+    TEST_ASSERT_NULL(canvas.cells);
+    canvas_put_str(&canvas, 0, 0, "stars");
+    canvas_erase(&canvas);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_generate_canvas_is_blank);
+    RUN_TEST(test_utf8_round_trip);
+    RUN_TEST(test_utf8_decode_invalid_bytes);
+    RUN_TEST(test_put_str_one_cell_per_code_point);
+    RUN_TEST(test_put_str_clips_at_right_edge);
+    RUN_TEST(test_drawing_out_of_bounds_is_dropped);
+    RUN_TEST(test_put_str_tab_stops);
+    RUN_TEST(test_color_pairs);
+    RUN_TEST(test_printf);
+    RUN_TEST(test_resize_leaves_canvas_blank);
+
+    return UNITY_END();
+}
@@ -1,12 +1,26 @@
 #include "city.h"
 #include "unity.h"
 
+#include <stdio.h>
+#include <string.h>
+
+#define TEST_PATH "city_test.txt"
+
 void setUp(void)
 {
 }
 
 void tearDown(void)
 {
+    remove(TEST_PATH);
+}
+
+static void write_test_file(const char *contents)
+{
+    FILE *file = fopen(TEST_PATH, "wb");
+    TEST_ASSERT_NOT_NULL(file);
+    fputs(contents, file);
+    fclose(file);
 }
 
 void test_get_city(void)
@@ -74,11 +88,116 @@ void test_get_city(void)
     TEST_ASSERT_NULL(city);
 }
 
+void test_find_city_normalizes_names(void)
+{
+    const struct CityRecord *city = find_city("  bOSTON ");
+    TEST_ASSERT_NOT_NULL(city);
+    TEST_ASSERT_EQUAL_STRING("Boston", city->name);
+    TEST_ASSERT_EQUAL_STRING("US", city->country_code);
+
+    // Only ASCII letters change case
+    TEST_ASSERT_EQUAL_PTR(find_city("Zürich"), find_city("zürich"));
+    TEST_ASSERT_NOT_NULL(find_city("Zürich"));
+
+    TEST_ASSERT_NULL(find_city(""));
+    TEST_ASSERT_NULL(find_city("   "));
+    TEST_ASSERT_NULL(find_city("Bost"));
+    TEST_ASSERT_NULL(find_city("Bostonx"));
+}
+
+void test_find_city_prefers_most_populous(void)
+{
+    const struct CityRecord *city = find_city("London");
+    TEST_ASSERT_NOT_NULL(city);
+    TEST_ASSERT_EQUAL_STRING("GB", city->country_code);
+
+    // The smaller London directly follows in the index
+    const struct CityRecord *other = city + 1;
+    TEST_ASSERT_EQUAL_STRING("london", other->key);
+    TEST_ASSERT_EQUAL_STRING("CA", other->country_code);
+    TEST_ASSERT_TRUE(city->population > other->population);
+}
+
+void test_find_city_rejects_long_names(void)
+{
+    char name[512];
+    memset(name, 'a', sizeof(name) - 1);
+    name[sizeof(name) - 1] = '\0';
+    TEST_ASSERT_NULL(find_city(name));
+}
+
+void test_generate_city_table_from_csv(void)
+{
+    write_test_file("city_name,population,country_code,timezone,latitude,longitude\r\n"
+                    "Springfield,150000,US,America/Chicago,39.80172,-89.64371\r\n"
+                    "\"Mianzhu, Deyang\",510000,CN,Asia/Shanghai,31.33786,104.22057\r\n"
+                    "Springfield,170000,US,America/Chicago,37.21533,-93.29824\r\n"
+                    "Nowhere,not a number,XX,Etc/UTC,0,0\r\n"
+                    "Aachen,265208,DE,Europe/Berlin,50.77664,6.08342");
+
+    struct CityTable table;
+    TEST_ASSERT_TRUE(generate_city_table(&table, TEST_PATH));
+    TEST_ASSERT_EQUAL_UINT(4, table.num_records);
+
+    // Sorted by name, the most populous first
+    TEST_ASSERT_EQUAL_STRING("Aachen", table.records[0].name);
+    TEST_ASSERT_EQUAL_STRING("Mianzhu, Deyang", table.records[1].name);
+    TEST_ASSERT_EQUAL_STRING("mianzhu, deyang", table.records[1].key);
+    TEST_ASSERT_EQUAL_UINT(170000, table.records[2].population);
+
+    const struct CityRecord *city = city_table_find(&table, "SPRINGFIELD");
+    TEST_ASSERT_NOT_NULL(city);
+    TEST_ASSERT_EQUAL_FLOAT(37.21533, city->latitude);
+    TEST_ASSERT_EQUAL_FLOAT(-93.29824, city->longitude);
+    TEST_ASSERT_EQUAL_STRING("US", city->country_code);
+    TEST_ASSERT_NULL(city_table_find(&table, "Nowhere"));
+
+    free_city_table(&table);
+    TEST_ASSERT_EQUAL_UINT(0, table.num_records);
+}
+
+void test_generate_city_table_from_geonames(void)
+{
+    // Columns as in cities500.txt, trimmed after the population
+    write_test_file("2950159\tBerlin\tBerlin\tBerlin,Berlino\t52.52437\t13.41053\tP\tPPLC\tDE\t\t16\t00\t11000\t"
+                    "11000000\t3426354\t\t74\tEurope/Berlin\t2022-04-05\n"
+                    "2643743\tLondon\tLondon\t\t51.50853\t-0.12574\tP\tPPLC\tGB\t\tENG\tGLA\t\t\t8961989\n");
+
+    struct CityTable table;
+    TEST_ASSERT_TRUE(generate_city_table(&table, TEST_PATH));
+    TEST_ASSERT_EQUAL_UINT(2, table.num_records);
+
+    const struct CityRecord *city = city_table_find(&table, "berlin");
+    TEST_ASSERT_NOT_NULL(city);
+    TEST_ASSERT_EQUAL_STRING("DE", city->country_code);
+    TEST_ASSERT_EQUAL_FLOAT(52.52437, city->latitude);
+    TEST_ASSERT_EQUAL_UINT(3426354, city->population);
+    TEST_ASSERT_NOT_NULL(city_table_find(&table, "London"));
+
+    free_city_table(&table);
+}
+
+void test_generate_city_table_rejects_bad_files(void)
+{
+    struct CityTable table;
+    remove(TEST_PATH);
+    TEST_ASSERT_FALSE(generate_city_table(&table, TEST_PATH));
+
+    write_test_file("not,a,city\n");
+    TEST_ASSERT_FALSE(generate_city_table(&table, TEST_PATH));
+}
+
 int main(void)
 {
     UNITY_BEGIN();
 
     RUN_TEST(test_get_city);
+    RUN_TEST(test_find_city_normalizes_names);
+    RUN_TEST(test_find_city_prefers_most_populous);
+    RUN_TEST(test_find_city_rejects_long_names);
+    RUN_TEST(test_generate_city_table_from_csv);
+    RUN_TEST(test_generate_city_table_from_geonames);
+    RUN_TEST(test_generate_city_table_rejects_bad_files);
 
     return UNITY_END();
 }
@@ -0,0 +1,114 @@
+#include "city.h"
+#include "city_tree.h"
+#include "macros.h"
+#include "unity.h"
+
+#include <math.h>
+
+static struct CityTree tree;
+
+void setUp(void)
+{
+    TEST_ASSERT_TRUE(generate_city_tree(&tree, builtin_city_table()));
+}
+
+void tearDown(void)
+{
+    free_city_tree(&tree);
+}
+
+// Angle between two places by the haversine formula (radians)
+static double angle_between(double lat1, double lon1, double lat2, double lon2)
+{
+    double a = pow(sin((lat2 - lat1) / 2.0), 2.0) + cos(lat1) * cos(lat2) * pow(sin((lon2 - lon1) / 2.0), 2.0);
+    return 2.0 * asin(MIN(1.0, sqrt(a)));
+}
+
+static double angle_to_city(const struct CityRecord *city, double latitude, double longitude)
+{
+    return angle_between(latitude, longitude, city->latitude * M_PI / 180.0, city->longitude * M_PI / 180.0);
+}
+
+void test_nearest_matches_linear_search(void)
+{
+    const struct CityTable *table = builtin_city_table();
+
+    // Places all over the globe, poles included
+    for (int lat = -90; lat <= 90; lat += 5)
+    {
+        for (int lon = -180; lon < 180; lon += 7)
+        {
+            double latitude = lat * M_PI / 180.0;
+            double longitude = lon * M_PI / 180.0;
+
+            double closest = INFINITY;
+            for (unsigned int i = 0; i < table->num_records; ++i)
+            {
+                closest = MIN(closest, angle_to_city(&table->records[i], latitude, longitude));
+            }
+
+            double distance;
+            const struct CityRecord *city = city_tree_nearest(&tree, latitude, longitude, &distance);
+            TEST_ASSERT_NOT_NULL(city);
+            // Positions are stored as floats, good to within meters
+            TEST_ASSERT_DOUBLE_WITHIN(1.0E-6, closest, angle_to_city(city, latitude, longitude));
+            TEST_ASSERT_DOUBLE_WITHIN(1.0E-6, closest, distance);
+        }
+    }
+}
+
+void test_nearest_city_to_a_city_is_itself(void)
+{
+    const struct CityRecord *london = city_table_find(builtin_city_table(), "London");
+    double distance;
+    const struct CityRecord *city = city_tree_nearest(&tree, london->latitude * M_PI / 180.0,
+                                                      london->longitude * M_PI / 180.0, &distance);
+    TEST_ASSERT_EQUAL_PTR(london, city);
+    TEST_ASSERT_DOUBLE_WITHIN(1.0E-6, 0.0, distance);
+}
+
+void test_nearest_across_antimeridian_and_poles(void)
+{
+    // Sorted by key, as tables are
+    static const struct CityRecord records[] = {
+        {"east", "East", "XX", 0.0f, 179.9f, 1},
+        {"north", "North", "XX", 89.0f, 0.0f, 1},
+        {"polar", "Polar", "XX", 80.0f, 180.0f, 1},
+        {"west", "West", "XX", 0.0f, -170.0f, 1},
+    };
+    struct CityTable table = {.records = records, .num_records = 4, .data = NULL};
+    struct CityTree small;
+    TEST_ASSERT_TRUE(generate_city_tree(&small, &table));
+
+    // Closer across the antimeridian than by longitude
+    const struct CityRecord *city = city_tree_nearest(&small, 0.0, -179.95 * M_PI / 180.0, NULL);
+    TEST_ASSERT_EQUAL_STRING("East", city->name);
+
+    // Closer over the pole than along the meridian
+    double distance;
+    city = city_tree_nearest(&small, 89.5 * M_PI / 180.0, M_PI, &distance);
+    TEST_ASSERT_EQUAL_STRING("North", city->name);
+    TEST_ASSERT_DOUBLE_WITHIN(1.0E-5, 1.5 * M_PI / 180.0, distance);
+
+    free_city_tree(&small);
+}
+
+void test_empty_table_has_no_nearest_city(void)
+{
+    struct CityTable table = {.records = NULL, .num_records = 0, .data = NULL};
+    struct CityTree empty;
+    TEST_ASSERT_TRUE(generate_city_tree(&empty, &table));
+    TEST_ASSERT_NULL(city_tree_nearest(&empty, 0.0, 0.0, NULL));
+    free_city_tree(&empty);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_nearest_matches_linear_search);
+    RUN_TEST(test_nearest_city_to_a_city_is_itself);
+    RUN_TEST(test_nearest_across_antimeridian_and_poles);
+    RUN_TEST(test_empty_table_has_no_nearest_city);
+
+    return UNITY_END();
+}
@@ -0,0 +1,123 @@
+#include "city.h"
+#include "city_trie.h"
+#include "unity.h"
+
+#include <string.h>
+
+#define MAX_MATCHES 8
+
+static struct CityTrie trie;
+
+void setUp(void)
+{
+    TEST_ASSERT_TRUE(generate_city_trie(&trie, builtin_city_table()));
+}
+
+void tearDown(void)
+{
+    free_city_trie(&trie);
+}
+
+// Cities whose key starts with `prefix`, counted one by one
+static unsigned int count_with_prefix(const char *prefix)
+{
+    const struct CityTable *table = builtin_city_table();
+    unsigned int count = 0;
+    for (unsigned int i = 0; i < table->num_records; ++i)
+    {
+        count += strncmp(table->records[i].key, prefix, strlen(prefix)) == 0;
+    }
+    return count;
+}
+
+void test_trie_is_compact(void)
+{
+    const struct CityTable *table = builtin_city_table();
+    TEST_ASSERT_TRUE(trie.num_nodes <= 2 * table->num_records + 1);
+    TEST_ASSERT_EQUAL_UINT(table->num_records, trie.nodes[0].num_records);
+}
+
+void test_complete_prefixes(void)
+{
+    const char *prefixes[] = {"", "l", "lond", "london", "san j", "rio de janeiro", "thủ"};
+    for (unsigned int i = 0; i < sizeof(prefixes) / sizeof(prefixes[0]); ++i)
+    {
+        const struct CityRecord *first = NULL;
+        unsigned int count = city_trie_complete(&trie, prefixes[i], &first);
+        TEST_ASSERT_EQUAL_UINT_MESSAGE(count_with_prefix(prefixes[i]), count, prefixes[i]);
+        TEST_ASSERT_TRUE(count > 0);
+        for (unsigned int c = 0; c < count; ++c)
+        {
+            TEST_ASSERT_EQUAL_INT(0, strncmp(first[c].key, prefixes[i], strlen(prefixes[i])));
+        }
+    }
+
+    // Prefixes are normalized as names are
+    const struct CityRecord *first = NULL;
+    TEST_ASSERT_EQUAL_UINT(count_with_prefix("lond"), city_trie_complete(&trie, "  LOND", &first));
+    TEST_ASSERT_EQUAL_STRING("London", first[0].name);
+
+    TEST_ASSERT_EQUAL_UINT(0, city_trie_complete(&trie, "qqq", &first));
+    TEST_ASSERT_EQUAL_UINT(0, city_trie_complete(&trie, "londonx", &first));
+}
+
+void test_search_finds_typos(void)
+{
+    struct CityMatch matches[MAX_MATCHES];
+
+    unsigned int count = city_trie_search(&trie, "Lodnon", 2, matches, MAX_MATCHES);
+    TEST_ASSERT_TRUE(count > 0);
+    TEST_ASSERT_EQUAL_STRING("London", matches[0].city->name);
+    TEST_ASSERT_EQUAL_STRING("GB", matches[0].city->country_code);
+    TEST_ASSERT_EQUAL_UINT(2, matches[0].distance);
+
+    count = city_trie_search(&trie, "Bostn", 1, matches, MAX_MATCHES);
+    TEST_ASSERT_TRUE(count > 0);
+    TEST_ASSERT_EQUAL_STRING("Boston", matches[0].city->name);
+    TEST_ASSERT_EQUAL_UINT(1, matches[0].distance);
+
+    // An exact name comes first
+    count = city_trie_search(&trie, "paris", 2, matches, MAX_MATCHES);
+    TEST_ASSERT_TRUE(count > 0);
+    TEST_ASSERT_EQUAL_STRING("Paris", matches[0].city->name);
+    TEST_ASSERT_EQUAL_UINT(0, matches[0].distance);
+
+    TEST_ASSERT_EQUAL_UINT(0, city_trie_search(&trie, "qqqqqqqq", 2, matches, MAX_MATCHES));
+}
+
+void test_search_orders_and_limits_matches(void)
+{
+    struct CityMatch matches[MAX_MATCHES];
+    unsigned int count = city_trie_search(&trie, "san", 3, matches, MAX_MATCHES);
+    TEST_ASSERT_EQUAL_UINT(MAX_MATCHES, count);
+
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        TEST_ASSERT_TRUE(matches[i].distance <= 3);
+        if (i > 0)
+        {
+            TEST_ASSERT_TRUE(matches[i - 1].distance <= matches[i].distance);
+            TEST_ASSERT_TRUE(matches[i - 1].distance < matches[i].distance ||
+                             matches[i - 1].city->population >= matches[i].city->population);
+            // Names are distinct
+            TEST_ASSERT_TRUE(strcmp(matches[i - 1].city->key, matches[i].city->key) != 0);
+        }
+    }
+
+    // A single match is the best one
+    struct CityMatch best;
+    TEST_ASSERT_EQUAL_UINT(1, city_trie_search(&trie, "san", 3, &best, 1));
+    TEST_ASSERT_EQUAL_PTR(matches[0].city, best.city);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_trie_is_compact);
+    RUN_TEST(test_complete_prefixes);
+    RUN_TEST(test_search_finds_typos);
+    RUN_TEST(test_search_orders_and_limits_matches);
+
+    return UNITY_END();
+}
@@ -2,6 +2,8 @@
 #include "macros.h"
 #include "unity.h"
 
+#include <math.h>
+
 void setUp(void)
 {
 }
@@ -67,12 +69,182 @@ void test_polar_to_win(void)
     TEST_ASSERT_EQUAL_INT(50, col);
 }
 
+// horizontal_rates
+
+void test_horizontal_rates(void)
+{
+    double latitude = 0.6;
+    double declinations[] = {-0.4, 0.1, 0.9};
+    double hour_angles[] = {-2.0, -0.3, 0.5, 1.7};
+    double h = 1.0E-6;
+
+    for (int i = 0; i < 3; ++i)
+    {
+        for (int j = 0; j < 4; ++j)
+        {
+            // Hour angle grows as right ascension shrinks
+            double right_ascension = -hour_angles[j];
+            double az_before, alt_before, az_after, alt_after;
+            equatorial_to_horizontal(right_ascension, declinations[i], -h, latitude, 0.0, &az_before, &alt_before);
+            equatorial_to_horizontal(right_ascension, declinations[i], h, latitude, 0.0, &az_after, &alt_after);
+
+            double azimuth_rate, altitude_rate;
+            horizontal_rates(hour_angles[j], declinations[i], latitude, &azimuth_rate, &altitude_rate);
+
+            TEST_ASSERT_DOUBLE_WITHIN(1.0E-5, (alt_after - alt_before) / (2 * h), altitude_rate);
+            TEST_ASSERT_DOUBLE_WITHIN(1.0E-5, (az_after - az_before) / (2 * h), azimuth_rate);
+        }
+    }
+
+    // Azimuth is undefined at the zenith
+    double azimuth_rate, altitude_rate;
+    horizontal_rates(0.0, latitude, latitude, &azimuth_rate, &altitude_rate);
+    TEST_ASSERT_EQUAL_DOUBLE(0.0, azimuth_rate);
+}
+
+// horizontal_to_equatorial
+
+void test_horizontal_to_equatorial(void)
+{
+    double gmst = 1.234;
+    double latitude = 42.0 * TO_RAD;
+    double longitude = -71.0 * TO_RAD;
+    for (int dec_deg = -80; dec_deg <= 80; dec_deg += 20)
+    {
+        for (int ra_deg = 5; ra_deg < 360; ra_deg += 30)
+        {
+            double azimuth, altitude;
+            equatorial_to_horizontal(ra_deg * TO_RAD, dec_deg * TO_RAD, gmst, latitude, longitude, &azimuth, &altitude);
+
+            double right_ascension, declination;
+            horizontal_to_equatorial(azimuth, altitude, gmst, latitude, longitude, &right_ascension, &declination);
+            TEST_ASSERT_DOUBLE_WITHIN(1.0E-9, dec_deg * TO_RAD, declination);
+            TEST_ASSERT_DOUBLE_WITHIN(1.0E-9, ra_deg * TO_RAD, right_ascension);
+        }
+    }
+}
+
+// equatorial_to_horizontal_unit
+
+void test_equatorial_to_horizontal_unit(void)
+{
+    double gmst = 1.234;
+    double latitude = 42.0 * TO_RAD;
+    double longitude = -71.0 * TO_RAD;
+    for (int dec_deg = -80; dec_deg <= 80; dec_deg += 20)
+    {
+        for (int ra_deg = 5; ra_deg < 360; ra_deg += 30)
+        {
+            double azimuth, altitude;
+            equatorial_to_horizontal(ra_deg * TO_RAD, dec_deg * TO_RAD, gmst, latitude, longitude, &azimuth, &altitude);
+
+            double east, north, up;
+            equatorial_to_horizontal_unit(ra_deg * TO_RAD, dec_deg * TO_RAD, gmst, latitude, longitude, &east, &north,
+                                          &up);
+            double east_expected, north_expected, up_expected;
+            horizontal_to_unit(azimuth, altitude, &east_expected, &north_expected, &up_expected);
+            TEST_ASSERT_DOUBLE_WITHIN(1.0E-12, east_expected, east);
+            TEST_ASSERT_DOUBLE_WITHIN(1.0E-12, north_expected, north);
+            TEST_ASSERT_DOUBLE_WITHIN(1.0E-12, up_expected, up);
+
+            double azimuth_back, altitude_back;
+            unit_to_horizontal(east, north, up, &azimuth_back, &altitude_back);
+            TEST_ASSERT_DOUBLE_WITHIN(1.0E-9, azimuth, azimuth_back);
+            TEST_ASSERT_DOUBLE_WITHIN(1.0E-9, altitude, altitude_back);
+        }
+    }
+}
+
+// project_unit_vectors
+
+void test_project_unit_vectors_stereographic(void)
+{
+    // Must match the trigonometric path on a typical window
+    int height = 51;
+    int width = 101;
+    for (int alt_deg = 0; alt_deg <= 90; alt_deg += 5)
+    {
+        for (int az_deg = 0; az_deg < 360; az_deg += 7)
+        {
+            double azimuth = az_deg * TO_RAD;
+            double altitude = alt_deg * TO_RAD;
+
+            double theta_sphere, phi_sphere, radius_polar, theta_polar;
+            horizontal_to_spherical(azimuth, altitude, &theta_sphere, &phi_sphere);
+            project_stereographic_north(1.0, theta_sphere, phi_sphere, &radius_polar, &theta_polar);
+            int expected_row, expected_col;
+            polar_to_win(radius_polar, theta_polar, height, width, &expected_row, &expected_col);
+
+            double east, north, up;
+            horizontal_to_unit(azimuth, altitude, &east, &north, &up);
+            int row, col;
+            TEST_ASSERT_TRUE(project_unit_vector(PROJECTION_STEREOGRAPHIC, east, north, up, height, width, &row, &col));
+
+            // Cells may only differ where the exact position is halfway between two
+            TEST_ASSERT_INT_WITHIN(1, expected_row, row);
+            TEST_ASSERT_INT_WITHIN(1, expected_col, col);
+        }
+    }
+}
+
+void test_project_unit_vectors_radii(void)
+{
+    // Distance from the center at an altitude of 45° for each projection
+    const enum Projection projections[] = {PROJECTION_STEREOGRAPHIC, PROJECTION_ORTHOGRAPHIC, PROJECTION_LAMBERT,
+                                           PROJECTION_EQUIDISTANT};
+    const double radii[] = {tan(M_PI / 8.0), sin(M_PI / 4.0), sqrt(2.0) * sin(M_PI / 8.0), 0.5};
+
+    // A large window so one cell is a thousandth of the radius
+    int size = 2001;
+    double east[4], north[4], up[4];
+    horizontal_to_unit(0.0, M_PI / 2.0, &east[0], &north[0], &up[0]);  // Zenith
+    horizontal_to_unit(0.0, 0.0, &east[1], &north[1], &up[1]);         // North horizon
+    horizontal_to_unit(M_PI / 2.0, 0.0, &east[2], &north[2], &up[2]);  // East horizon
+    horizontal_to_unit(M_PI, M_PI / 4.0, &east[3], &north[3], &up[3]); // South at 45°
+
+    for (unsigned int i = 0; i < sizeof(projections) / sizeof(projections[0]); ++i)
+    {
+        int rows[4], cols[4];
+        project_unit_vectors(projections[i], east, north, up, 4, size, size, rows, cols);
+
+        TEST_ASSERT_EQUAL_INT(1000, rows[0]);
+        TEST_ASSERT_EQUAL_INT(1000, cols[0]);
+        TEST_ASSERT_EQUAL_INT(0, rows[1]);
+        TEST_ASSERT_EQUAL_INT(1000, cols[1]);
+        TEST_ASSERT_EQUAL_INT(1000, rows[2]);
+        TEST_ASSERT_EQUAL_INT(0, cols[2]);
+        TEST_ASSERT_INT_WITHIN(1, (int)round(1000.0 * (1.0 + radii[i])), rows[3]);
+        TEST_ASSERT_EQUAL_INT(1000, cols[3]);
+    }
+
+    // Below the horizon
+    int row, col;
+    TEST_ASSERT_FALSE(project_unit_vector(PROJECTION_LAMBERT, 0.0, 0.0, -1.0, size, size, &row, &col));
+}
+
+void test_projection_from_name(void)
+{
+    enum Projection projection = PROJECTION_STEREOGRAPHIC;
+    TEST_ASSERT_TRUE(projection_from_name("equidistant", &projection));
+    TEST_ASSERT_EQUAL_INT(PROJECTION_EQUIDISTANT, projection);
+    TEST_ASSERT_TRUE(projection_from_name("orthographic", &projection));
+    TEST_ASSERT_EQUAL_INT(PROJECTION_ORTHOGRAPHIC, projection);
+    TEST_ASSERT_FALSE(projection_from_name("mercator", &projection));
+    TEST_ASSERT_EQUAL_INT(PROJECTION_ORTHOGRAPHIC, projection);
+}
+
 int main(void)
 {
     UNITY_BEGIN();
 
     RUN_TEST(test_project_stereographic_top);
     RUN_TEST(test_polar_to_win);
+    RUN_TEST(test_horizontal_rates);
+    RUN_TEST(test_horizontal_to_equatorial);
+    RUN_TEST(test_equatorial_to_horizontal_unit);
+    RUN_TEST(test_project_unit_vectors_stereographic);
+    RUN_TEST(test_project_unit_vectors_radii);
+    RUN_TEST(test_projection_from_name);
 
     return UNITY_END();
 }
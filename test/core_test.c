@@ -4,6 +4,7 @@
 #include "bsc5.h"
 #include "bsc5_constellations.h"
 #include "bsc5_names.h"
+#include "coord.h"
 #include "core.h"
 #include "core_position.h"
 #include "data/keplerian_elements.h"
@@ -14,34 +15,34 @@
 #include <string.h>
 
 // Initialize data structs
-static unsigned int num_stars, num_const;
+static unsigned int num_stars;
 
 static struct Entry *BSC5_entries;
-static struct StarName *name_table;
+static struct StarNameTable name_table;
 static struct Star *star_table;
-struct Constell *constell_table;
-static int *num_by_mag;
+struct ConstellTable constell_table;
+static unsigned int *idx_by_mag;
 struct Planet *planet_table;
 struct Moon moon_object;
 
 void setUp(void)
 {
     parse_entries(bsc5, bsc5_len, &BSC5_entries, &num_stars);
-    generate_name_table(bsc5_names, bsc5_names_len, &name_table, num_stars);
-    generate_star_table(&star_table, BSC5_entries, name_table, num_stars);
-    star_numbers_by_magnitude(&num_by_mag, star_table, num_stars);
-    generate_constell_table(bsc5_constellations, bsc5_constellations_len, &constell_table, &num_const);
+    generate_name_table(bsc5_names, bsc5_names_len, &name_table);
+    generate_star_table(&star_table, BSC5_entries, &name_table, num_stars);
+    star_indices_by_magnitude(&idx_by_mag, star_table, num_stars);
+    generate_constell_table(bsc5_constellations, bsc5_constellations_len, num_stars, &constell_table);
     generate_planet_table(&planet_table, planet_elements, planet_rates, planet_extras);
     generate_moon_object(&moon_object, &moon_elements, &moon_rates);
 }
 
 void tearDown(void)
 {
-    free_constells(constell_table, num_const);
+    free_constells(&constell_table);
     free_stars(star_table, num_stars);
     free_planets(planet_table, NUM_PLANETS);
     free_moon_object(moon_object);
-    free_star_names(name_table, num_stars);
+    free_star_names(&name_table);
 }
 
 // Tolerance for positions in radians. Planets are slightly less accurate. The moon is even less inaccurate.
@@ -124,49 +125,115 @@ void test_generate_star_table(void)
     TEST_ASSERT_FLOAT_WITHIN(S_EPSILON, 5.8, star_table[last_index].magnitude);
 }
 
+void test_drop_faint_labels(void)
+{
+    drop_faint_labels(star_table, num_stars, 1.0f);
+
+    // Only bright stars keep their names
+    for (unsigned int i = 0; i < num_stars; ++i)
+    {
+        const char *name = star_name_lookup(&name_table, star_table[i].catalog_number);
+        const char *expected = star_table[i].magnitude <= 1.0f ? name : NULL;
+        TEST_ASSERT_EQUAL_PTR(expected, star_table[i].base.label);
+    }
+}
+
 void test_generate_name_table(void)
 {
     // Trim carriage returns so passed on windows
-    TEST_ASSERT_NOT_NULL(name_table);
-    TEST_ASSERT_EQUAL_STRING("Acamar", trim_string(name_table[896].name));
-    TEST_ASSERT_EQUAL_STRING("Vega", trim_string(name_table[7000].name));
-    TEST_ASSERT_EQUAL_STRING("Wezen", trim_string(name_table[2692].name));
-    TEST_ASSERT_EQUAL_STRING("Zubeneschamali", trim_string(name_table[5684].name));
+    TEST_ASSERT_NOT_NULL(name_table.index);
+    TEST_ASSERT_EQUAL_STRING("Acamar", trim_string(star_name_lookup(&name_table, 897)));
+    TEST_ASSERT_EQUAL_STRING("Vega", trim_string(star_name_lookup(&name_table, 7001)));
+    TEST_ASSERT_EQUAL_STRING("Wezen", trim_string(star_name_lookup(&name_table, 2693)));
+    TEST_ASSERT_EQUAL_STRING("Zubeneschamali", trim_string(star_name_lookup(&name_table, 5685)));
+
+    // Stars without a name are not stored
+    TEST_ASSERT_NULL(star_name_lookup(&name_table, 1));
+    TEST_ASSERT_NULL(star_name_lookup(&name_table, 0));
+
+    // Index must be sorted by catalog number
+    for (unsigned int i = 1; i < name_table.num_names; ++i)
+    {
+        TEST_ASSERT_TRUE(name_table.index[i - 1].catalog_number < name_table.index[i].catalog_number);
+    }
 }
 
 void test_generate_constell_table(void)
 {
     // As seen in bsc5_constellations.txt
     // FIXME: if the order of constellations in the text file changes, this will break.
-    TEST_ASSERT_NOT_NULL(constell_table);
+    TEST_ASSERT_NOT_NULL(constell_table.offsets);
+    TEST_ASSERT_EQUAL_UINT(88, constell_table.num_constells);
 
     // Aql constellation
-    TEST_ASSERT_EQUAL_INT(8, constell_table[0].num_segments);
+    TEST_ASSERT_EQUAL_UINT(0, constell_table.offsets[0]);
+    TEST_ASSERT_EQUAL_UINT(8, constell_table.offsets[1] - constell_table.offsets[0]);
+
+    // CVn constellation (endpoints are star table indices, i.e. catalog number - 1)
+    TEST_ASSERT_EQUAL_UINT(1, constell_table.offsets[20] - constell_table.offsets[19]);
+    unsigned int expected_endpoints[] = {4785 - 1, 4915 - 1};
+    TEST_ASSERT_EQUAL_UINT_ARRAY(expected_endpoints, &constell_table.endpoints[constell_table.offsets[19] * 2], 2);
+
+    // All endpoints must index into the star table
+    unsigned int num_endpoints = constell_table.offsets[constell_table.num_constells] * 2;
+    for (unsigned int i = 0; i < num_endpoints; ++i)
+    {
+        TEST_ASSERT_TRUE(constell_table.endpoints[i] < num_stars);
+    }
+}
+
+void test_generate_constell_table_malformed(void)
+{
+    struct ConstellTable table;
 
-    // CVn constellation
-    TEST_ASSERT_EQUAL_INT(1, constell_table[19].num_segments);
-    int expected_star_numbers[] = {4785, 4915};
-    TEST_ASSERT_EQUAL_INT_ARRAY(expected_star_numbers, constell_table[19].star_numbers, 2);
+    // Not enough star numbers
+    const char *short_line = "CVn 2 4785 4915\n";
+    TEST_ASSERT_FALSE(generate_constell_table((const uint8_t *)short_line, strlen(short_line), num_stars, &table));
+
+    // Star number outside of the catalog
+    const char *bad_star = "CVn 1 4785 99999\n";
+    TEST_ASSERT_FALSE(generate_constell_table((const uint8_t *)bad_star, strlen(bad_star), num_stars, &table));
+
+    // Missing trailing newline is accepted
+    const char *no_newline = "CVn 1 4785 4915";
+    TEST_ASSERT_TRUE(generate_constell_table((const uint8_t *)no_newline, strlen(no_newline), num_stars, &table));
+    TEST_ASSERT_EQUAL_UINT(1, table.num_constells);
+    free_constells(&table);
 }
 
-void test_star_numbers_by_magnitude(void)
+void test_star_indices_by_magnitude(void)
 {
-    TEST_ASSERT_NOT_NULL(num_by_mag);
+    TEST_ASSERT_NOT_NULL(idx_by_mag);
 
     // Least bright
-    TEST_ASSERT_EQUAL(1894, num_by_mag[0]);
-    TEST_ASSERT_EQUAL(365, num_by_mag[1]);
-    TEST_ASSERT_EQUAL(3313, num_by_mag[2]);
+    TEST_ASSERT_EQUAL(1894 - 1, idx_by_mag[0]);
+    TEST_ASSERT_EQUAL(365 - 1, idx_by_mag[1]);
+    TEST_ASSERT_EQUAL(3313 - 1, idx_by_mag[2]);
 
     // Brightest
     // Access the last elements (brightest stars)
     unsigned int last_index = num_stars - 1; // Assuming num_stars is defined elsewhere
 
-    TEST_ASSERT_EQUAL(2491, num_by_mag[last_index]);
-    TEST_ASSERT_EQUAL(2326, num_by_mag[last_index - 1]);
-    TEST_ASSERT_EQUAL(5340, num_by_mag[last_index - 2]);
+    TEST_ASSERT_EQUAL(2491 - 1, idx_by_mag[last_index]);
+    TEST_ASSERT_EQUAL(2326 - 1, idx_by_mag[last_index - 1]);
+    TEST_ASSERT_EQUAL(5340 - 1, idx_by_mag[last_index - 2]);
+
+    // Ordering is a permutation with non-increasing magnitude
+    bool *seen = calloc(num_stars, sizeof(bool));
+    TEST_ASSERT_NOT_NULL(seen);
+    for (unsigned int i = 0; i < num_stars; ++i)
+    {
+        TEST_ASSERT_TRUE(idx_by_mag[i] < num_stars);
+        TEST_ASSERT_FALSE(seen[idx_by_mag[i]]);
+        seen[idx_by_mag[i]] = true;
+        if (i > 0)
+        {
+            TEST_ASSERT_TRUE(star_table[idx_by_mag[i - 1]].magnitude >= star_table[idx_by_mag[i]].magnitude);
+        }
+    }
+    free(seen);
 
-    free(num_by_mag);
+    free(idx_by_mag);
 }
 
 void test_update_star_positions(void)
@@ -182,20 +249,23 @@ void test_update_star_positions(void)
     double longitude = -71.0589 * M_PI / 180;
 
     update_star_positions(star_table, num_stars, julian_date, latitude, longitude);
+    double azimuth, altitude;
 
     // Verify Vega's position is correct
     // https://stellarium-web.org/skysource/Vega?fov=120.00&date=2020-10-23T12:00:00Z&lat=42.36&lng=-71.06&elev=0
     TEST_ASSERT_EQUAL(7001, star_table[7000].catalog_number);
     TEST_ASSERT_EQUAL_STRING("Vega", trim_string(star_table[7000].base.label));
-    TEST_ASSERT_DOUBLE_WITHIN(S_EPSILON, 0.547246, star_table[7000].base.azimuth);
-    TEST_ASSERT_DOUBLE_WITHIN(S_EPSILON, 0.0, star_table[7000].base.altitude);
+    unit_to_horizontal(star_table[7000].base.east, star_table[7000].base.north, star_table[7000].base.up, &azimuth, &altitude);
+    TEST_ASSERT_DOUBLE_WITHIN(S_EPSILON, 0.547246, azimuth);
+    TEST_ASSERT_DOUBLE_WITHIN(S_EPSILON, 0.0, altitude);
 
     // Verify Arcturus's position is correct
     // https://stellarium-web.org/skysource/Arcturus?fov=120.00&date=2020-10-23T12:00:00Z&lat=42.36&lng=-71.06&elev=0
     TEST_ASSERT_EQUAL(5340, star_table[5339].catalog_number);
     TEST_ASSERT_EQUAL_STRING("Arcturus", trim_string(star_table[5339].base.label));
-    TEST_ASSERT_DOUBLE_WITHIN(S_EPSILON, 1.511414, star_table[5339].base.azimuth);
-    TEST_ASSERT_DOUBLE_WITHIN(S_EPSILON, 0.440355, star_table[5339].base.altitude);
+    unit_to_horizontal(star_table[5339].base.east, star_table[5339].base.north, star_table[5339].base.up, &azimuth, &altitude);
+    TEST_ASSERT_DOUBLE_WITHIN(S_EPSILON, 1.511414, azimuth);
+    TEST_ASSERT_DOUBLE_WITHIN(S_EPSILON, 0.440355, altitude);
 }
 
 void test_update_planet_positions(void)
@@ -206,22 +276,26 @@ void test_update_planet_positions(void)
     double longitude = -71.0589 * M_PI / 180;
 
     update_planet_positions(planet_table, julian_date, latitude, longitude);
+    double azimuth, altitude;
 
     // Verify Sun's position is correct
     // https://stellarium-web.org/skysource/Sun?fov=120.00&date=2020-10-23T12:00:00Z&lat=42.36&lng=-71.06&elev=0
-    TEST_ASSERT_DOUBLE_WITHIN(S_EPSILON, 1.993463, planet_table[SUN].base.azimuth);
-    TEST_ASSERT_DOUBLE_WITHIN(S_EPSILON, 0.145643, planet_table[SUN].base.altitude);
+    unit_to_horizontal(planet_table[SUN].base.east, planet_table[SUN].base.north, planet_table[SUN].base.up, &azimuth, &altitude);
+    TEST_ASSERT_DOUBLE_WITHIN(S_EPSILON, 1.993463, azimuth);
+    TEST_ASSERT_DOUBLE_WITHIN(S_EPSILON, 0.145643, altitude);
 
     // Verify Mars's position is correct
     // https://stellarium-web.org/skysource/Mars?fov=120.00&date=2020-10-23T12:00:00Z&lat=42.36&lng=-71.06&elev=0
-    TEST_ASSERT_DOUBLE_WITHIN(P_EPSILON, 5.1954878, planet_table[MARS].base.azimuth);
-    TEST_ASSERT_DOUBLE_WITHIN(P_EPSILON, -0.341956, planet_table[MARS].base.altitude);
+    unit_to_horizontal(planet_table[MARS].base.east, planet_table[MARS].base.north, planet_table[MARS].base.up, &azimuth, &altitude);
+    TEST_ASSERT_DOUBLE_WITHIN(P_EPSILON, 5.1954878, azimuth);
+    TEST_ASSERT_DOUBLE_WITHIN(P_EPSILON, -0.341956, altitude);
 
     // Verify Neptune's position is correct
     // Note that the outer planets have extra kep elements (position takes more calculation)
     // https://stellarium-web.org/skysource/Neptune?fov=120.00&date=2020-10-23T12:00:00Z&lat=42.36&lng=-71.06&elev=0
-    TEST_ASSERT_DOUBLE_WITHIN(P_EPSILON, 5.5390816, planet_table[NEPTUNE].base.azimuth);
-    TEST_ASSERT_DOUBLE_WITHIN(P_EPSILON, -0.779650, planet_table[NEPTUNE].base.altitude);
+    unit_to_horizontal(planet_table[NEPTUNE].base.east, planet_table[NEPTUNE].base.north, planet_table[NEPTUNE].base.up, &azimuth, &altitude);
+    TEST_ASSERT_DOUBLE_WITHIN(P_EPSILON, 5.5390816, azimuth);
+    TEST_ASSERT_DOUBLE_WITHIN(P_EPSILON, -0.779650, altitude);
 }
 
 void test_update_moon_position(void)
@@ -232,10 +306,12 @@ void test_update_moon_position(void)
     double longitude = -71.0589 * M_PI / 180;
 
     update_moon_position(&moon_object, julian_date, latitude, longitude);
+    double azimuth, altitude;
 
     // https://stellarium-web.org/skysource/Moon?fov=120.00&date=2020-10-23T12:00:00Z&lat=42.36&lng=-71.06&elev=0
-    TEST_ASSERT_DOUBLE_WITHIN(M_EPSILON, 0.7817126, moon_object.base.azimuth);
-    TEST_ASSERT_DOUBLE_WITHIN(M_EPSILON, -1.118899, moon_object.base.altitude);
+    unit_to_horizontal(moon_object.base.east, moon_object.base.north, moon_object.base.up, &azimuth, &altitude);
+    TEST_ASSERT_DOUBLE_WITHIN(M_EPSILON, 0.7817126, azimuth);
+    TEST_ASSERT_DOUBLE_WITHIN(M_EPSILON, -1.118899, altitude);
 }
 
 void test_map_float_to_int_range(void)
@@ -287,9 +363,11 @@ int main(void)
     UNITY_BEGIN();
 
     RUN_TEST(test_generate_star_table);
+    RUN_TEST(test_drop_faint_labels);
     RUN_TEST(test_generate_name_table);
     RUN_TEST(test_generate_constell_table);
-    RUN_TEST(test_star_numbers_by_magnitude);
+    RUN_TEST(test_generate_constell_table_malformed);
+    RUN_TEST(test_star_indices_by_magnitude);
     RUN_TEST(test_update_star_positions);
     RUN_TEST(test_update_planet_positions);
     RUN_TEST(test_update_moon_position);
@@ -1,8 +1,8 @@
 #include "bit.h"
+#include "canvas.h"
 #include "drawing.h"
 #include "unity.h"
 
-#include <curses.h>
 #include <locale.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -21,14 +21,16 @@
 // ASCII Tests
 // -----------------------------------------------------------------------------
 
-// Function to read an ncurses window into a 2D array
-void read_window_to_array(WINDOW *win, char array[MAX_WINDOW_HEIGHT][MAX_WINDOW_WIDTH], int height, int width)
+// Function to read a canvas into a 2D array
+void read_canvas_to_array(const struct Canvas *canvas, char array[MAX_WINDOW_HEIGHT][MAX_WINDOW_WIDTH], int height,
+                          int width)
 {
     for (int y = 0; y < height; y++)
     {
         for (int x = 0; x < width; x++)
         {
-            array[y][x] = mvwinch(win, y, x) & A_CHARTEXT; // Extract character
+            uint32_t ch = canvas->cells[y * canvas->width + x].ch;
+            array[y][x] = ch != 0 ? (char)ch : ' '; // Blank cells read as spaces
         }
         array[y][width] = '\0'; // Null-terminate the line
     }
@@ -70,21 +72,22 @@ const char diagonal_ascii_10x10[MAX_WINDOW_HEIGHT][MAX_WINDOW_WIDTH] = {
 
 void test_diagonal_ascii_10x10(void)
 {
-    WINDOW *win = newwin(10, 10, 0, 0);
+    struct Canvas canvas;
+    TEST_ASSERT_TRUE(generate_canvas(&canvas, 10, 10));
     char actual[MAX_WINDOW_HEIGHT][MAX_WINDOW_WIDTH];
 
     // Draw the line
-    draw_line_ASCII(win, 0, 0, 9, 9);
+    draw_line_ASCII(&canvas, 0, 0, 9, 9);
 
-    // Read window content into an array
-    read_window_to_array(win, actual, 10, 10);
+    // Read canvas content into an array
+    read_canvas_to_array(&canvas, actual, 10, 10);
 
     const char(*const_actual)[MAX_WINDOW_WIDTH] = (const char(*)[MAX_WINDOW_WIDTH])actual;
 
     // Compare actual and expected output
     TEST_ASSERT_TRUE(compare_arrays(const_actual, diagonal_ascii_10x10, 10, 10));
 
-    delwin(win);
+    free_canvas(&canvas);
 }
 
 // -----------------------------------------------------------------------------
@@ -108,21 +111,22 @@ const char diagonal_ascii_opposite_10x10[MAX_WINDOW_HEIGHT][MAX_WINDOW_WIDTH] =
 
 void test_diagonal_ascii_opposite_10x10(void)
 {
-    WINDOW *win = newwin(10, 10, 0, 0);
+    struct Canvas canvas;
+    TEST_ASSERT_TRUE(generate_canvas(&canvas, 10, 10));
     char actual[MAX_WINDOW_HEIGHT][MAX_WINDOW_WIDTH];
 
     // Draw the line (opposite diagonal)
-    draw_line_ASCII(win, 9, 0, 0, 9);
+    draw_line_ASCII(&canvas, 9, 0, 0, 9);
 
-    // Read window content into an ASCII array
-    read_window_to_array(win, actual, 10, 10);
+    // Read canvas content into an ASCII array
+    read_canvas_to_array(&canvas, actual, 10, 10);
 
     const char(*const_actual)[MAX_WINDOW_WIDTH] = (const char(*)[MAX_WINDOW_WIDTH])actual;
 
     // Compare actual and expected output
     TEST_ASSERT_TRUE(compare_arrays(const_actual, diagonal_ascii_opposite_10x10, 10, 10));
 
-    delwin(win);
+    free_canvas(&canvas);
 }
 
 // -----------------------------------------------------------------------------
@@ -147,21 +151,22 @@ const char vertical_ascii_11x11[MAX_WINDOW_HEIGHT][MAX_WINDOW_WIDTH] = {
 
 void test_vertical_ascii_11x11(void)
 {
-    WINDOW *win = newwin(11, 11, 0, 0);
+    struct Canvas canvas;
+    TEST_ASSERT_TRUE(generate_canvas(&canvas, 11, 11));
     char actual[MAX_WINDOW_HEIGHT][MAX_WINDOW_WIDTH];
 
     // Draw the line
-    draw_line_ASCII(win, 0, 5, 10, 5);
+    draw_line_ASCII(&canvas, 0, 5, 10, 5);
 
-    // Read window content into an ASCII array
-    read_window_to_array(win, actual, 11, 11);
+    // Read canvas content into an ASCII array
+    read_canvas_to_array(&canvas, actual, 11, 11);
 
     const char(*const_actual)[MAX_WINDOW_WIDTH] = (const char(*)[MAX_WINDOW_WIDTH])actual;
 
     // Compare actual and expected output
     TEST_ASSERT_TRUE(compare_arrays(const_actual, vertical_ascii_11x11, 11, 11));
 
-    delwin(win);
+    free_canvas(&canvas);
 }
 
 // -----------------------------------------------------------------------------
@@ -186,36 +191,37 @@ const char horizontal_ascii_11x11[MAX_WINDOW_HEIGHT][MAX_WINDOW_WIDTH] = {
 
 void test_horizontal_ascii_11x11(void)
 {
-    WINDOW *win = newwin(11, 11, 0, 0);
+    struct Canvas canvas;
+    TEST_ASSERT_TRUE(generate_canvas(&canvas, 11, 11));
     char actual[MAX_WINDOW_HEIGHT][MAX_WINDOW_WIDTH];
 
     // Draw the line
-    draw_line_ASCII(win, 5, 0, 5, 10);
+    draw_line_ASCII(&canvas, 5, 0, 5, 10);
 
-    // Read window content into an ASCII array
-    read_window_to_array(win, actual, 11, 11);
+    // Read canvas content into an ASCII array
+    read_canvas_to_array(&canvas, actual, 11, 11);
 
     const char(*const_actual)[MAX_WINDOW_WIDTH] = (const char(*)[MAX_WINDOW_WIDTH])actual;
 
     // Compare actual and expected output
     TEST_ASSERT_TRUE(compare_arrays(const_actual, horizontal_ascii_11x11, 11, 11));
 
-    delwin(win);
+    free_canvas(&canvas);
 }
 
 // -----------------------------------------------------------------------------
 // Unicode Tests
 // -----------------------------------------------------------------------------
 
-void read_window_to_wide_array(WINDOW *win, wchar_t array[MAX_WINDOW_HEIGHT][MAX_WINDOW_WIDTH], int height, int width)
+void read_canvas_to_wide_array(const struct Canvas *canvas, wchar_t array[MAX_WINDOW_HEIGHT][MAX_WINDOW_WIDTH],
+                               int height, int width)
 {
-    chtype wc;
-
     for (int y = 0; y < height; y++)
     {
         for (int x = 0; x < width; x++)
         {
-            array[y][x] = mvwinch(win, y, x);
+            uint32_t ch = canvas->cells[y * canvas->width + x].ch;
+            array[y][x] = ch != 0 ? (wchar_t)ch : L' ';
         }
         array[y][width] = L'\0'; // Null-terminate the line
     }
@@ -257,21 +263,22 @@ const wchar_t diagonal_smooth_10x10[MAX_WINDOW_HEIGHT][MAX_WINDOW_WIDTH] = {
 
 void test_diagonal_smooth_10x10(void)
 {
-    WINDOW *win = newwin(10, 10, 0, 0);
+    struct Canvas canvas;
+    TEST_ASSERT_TRUE(generate_canvas(&canvas, 10, 10));
     wchar_t actual[MAX_WINDOW_HEIGHT][MAX_WINDOW_WIDTH];
 
     // Draw the line
-    draw_line_smooth(win, 0, 0, 9, 9);
+    draw_line_smooth(&canvas, 0, 0, 9, 9);
 
-    // Read window content into a wide-character array
-    read_window_to_wide_array(win, actual, 10, 10);
+    // Read canvas content into a wide-character array
+    read_canvas_to_wide_array(&canvas, actual, 10, 10);
 
     const wchar_t(*const_actual)[MAX_WINDOW_WIDTH] = (const wchar_t(*)[MAX_WINDOW_WIDTH])actual;
 
     // Compare actual and expected output
     TEST_ASSERT_TRUE(compare_wide_arrays(const_actual, diagonal_smooth_10x10, 10, 10));
 
-    delwin(win);
+    free_canvas(&canvas);
 }
 
 // -----------------------------------------------------------------------------
@@ -295,21 +302,22 @@ const wchar_t diagonal_smooth_opposite_10x10[MAX_WINDOW_HEIGHT][MAX_WINDOW_WIDTH
 
 void test_diagonal_smooth_opposite_10x10(void)
 {
-    WINDOW *win = newwin(10, 10, 0, 0);
+    struct Canvas canvas;
+    TEST_ASSERT_TRUE(generate_canvas(&canvas, 10, 10));
     wchar_t actual[MAX_WINDOW_HEIGHT][MAX_WINDOW_WIDTH];
 
     // Draw the line (opposite diagonal)
-    draw_line_smooth(win, 9, 0, 0, 9);
+    draw_line_smooth(&canvas, 9, 0, 0, 9);
 
-    // Read window content into a wide-character array
-    read_window_to_wide_array(win, actual, 10, 10);
+    // Read canvas content into a wide-character array
+    read_canvas_to_wide_array(&canvas, actual, 10, 10);
 
     const wchar_t(*const_actual)[MAX_WINDOW_WIDTH] = (const wchar_t(*)[MAX_WINDOW_WIDTH])actual;
 
     // Compare actual and expected output
     TEST_ASSERT_TRUE(compare_wide_arrays(const_actual, diagonal_smooth_opposite_10x10, 10, 10));
 
-    delwin(win);
+    free_canvas(&canvas);
 }
 
 // -----------------------------------------------------------------------------
@@ -334,21 +342,22 @@ const wchar_t vertical_smooth_11x11[MAX_WINDOW_HEIGHT][MAX_WINDOW_WIDTH] = {
 
 void test_vertical_smooth_11x11(void)
 {
-    WINDOW *win = newwin(11, 11, 0, 0);
+    struct Canvas canvas;
+    TEST_ASSERT_TRUE(generate_canvas(&canvas, 11, 11));
     wchar_t actual[MAX_WINDOW_HEIGHT][MAX_WINDOW_WIDTH];
 
     // Draw the line
-    draw_line_smooth(win, 0, 5, 10, 5);
+    draw_line_smooth(&canvas, 0, 5, 10, 5);
 
-    // Read window content into a wide-character array
-    read_window_to_wide_array(win, actual, 11, 11);
+    // Read canvas content into a wide-character array
+    read_canvas_to_wide_array(&canvas, actual, 11, 11);
 
     const wchar_t(*const_actual)[MAX_WINDOW_WIDTH] = (const wchar_t(*)[MAX_WINDOW_WIDTH])actual;
 
     // Compare actual and expected output
     TEST_ASSERT_TRUE(compare_wide_arrays(const_actual, vertical_smooth_11x11, 11, 11));
 
-    delwin(win);
+    free_canvas(&canvas);
 }
 
 // -----------------------------------------------------------------------------
@@ -373,61 +382,36 @@ const wchar_t horizontal_smooth_11x11[MAX_WINDOW_HEIGHT][MAX_WINDOW_WIDTH] = {
 
 void test_horizontal_smooth_11x11(void)
 {
-    WINDOW *win = newwin(11, 11, 0, 0);
+    struct Canvas canvas;
+    TEST_ASSERT_TRUE(generate_canvas(&canvas, 11, 11));
     wchar_t actual[MAX_WINDOW_HEIGHT][MAX_WINDOW_WIDTH];
 
     // Draw the line
-    draw_line_smooth(win, 5, 0, 5, 10);
+    draw_line_smooth(&canvas, 5, 0, 5, 10);
 
-    // Read window content into a wide-character array
-    read_window_to_wide_array(win, actual, 11, 11);
+    // Read canvas content into a wide-character array
+    read_canvas_to_wide_array(&canvas, actual, 11, 11);
 
     const wchar_t(*const_actual)[MAX_WINDOW_WIDTH] = (const wchar_t(*)[MAX_WINDOW_WIDTH])actual;
 
     // Compare actual and expected output
     TEST_ASSERT_TRUE(compare_wide_arrays(const_actual, horizontal_smooth_11x11, 11, 11));
 
-    delwin(win);
+    free_canvas(&canvas);
 }
 
 // -----------------------------------------------------------------------------
 // Unity
 // -----------------------------------------------------------------------------
 
-FILE *output_file;
-SCREEN *fake_screen;
-
 void setUp(void)
 {
-    // Use a "fake" screen to bypass the need for a real terminal in CI/CD environments.
-    // This redirects ncurses output to a file or buffer for testing in non-interactive setups.
-
+    // Mismatches are printed as wide strings
     setlocale(LC_ALL, "");
-    output_file = fopen("fake_terminal.txt", "w");
-    if (!output_file)
-    {
-        perror("Failed to open file for fake terminal");
-        exit(EXIT_FAILURE);
-    }
-
-    fake_screen = newterm("xterm", output_file, stdin);
-    if (!fake_screen)
-    {
-        fprintf(stderr, "Failed to create fake terminal\n");
-        fclose(output_file);
-        exit(EXIT_FAILURE);
-    }
-
-    set_term(fake_screen);
-    noecho();
-    cbreak();
 }
 
 void tearDown(void)
 {
-    endwin();
-    delscreen(fake_screen);
-    fclose(output_file);
 }
 
 int main(void)
@@ -0,0 +1,116 @@
+#include "event_loop.h"
+#include "stopwatch.h"
+#include "unity.h"
+
+#ifdef __linux__
+#include <signal.h>
+#include <unistd.h>
+#endif
+
+static struct EventLoop loop;
+static bool loop_ready;
+
+#ifdef __linux__
+static int input[2]; // Read and write ends of a pipe standing in for the terminal
+#endif
+
+void setUp(void)
+{
+#ifdef __linux__
+    TEST_ASSERT_EQUAL_INT(0, pipe(input));
+    loop_ready = event_loop_init(&loop, input[0]);
+    TEST_ASSERT_TRUE(loop_ready);
+#else
+    loop_ready = false;
+#endif
+}
+
+void tearDown(void)
+{
+#ifdef __linux__
+    if (loop_ready)
+    {
+        event_loop_destroy(&loop);
+    }
+    close(input[0]);
+    close(input[1]);
+#endif
+}
+
+void test_deadline_ticks(void)
+{
+    if (!loop_ready)
+    {
+        TEST_IGNORE_MESSAGE("No event loop on this platform");
+    }
+
+    struct SwTimestamp begin, deadline;
+    sw_gettime(&begin);
+    deadline = begin;
+    sw_timeadd_usec(&deadline, 20000);
+    TEST_ASSERT_TRUE(event_loop_arm(&loop, deadline));
+    TEST_ASSERT_EQUAL_INT(LOOP_EVENT_TICK, event_loop_wait(&loop));
+
+    struct SwTimestamp end;
+    unsigned long long elapsed;
+    sw_gettime(&end);
+    sw_timediff_usec(end, begin, &elapsed);
+    TEST_ASSERT_TRUE(elapsed >= 20000);
+
+    // Deadlines in the past tick right away
+    TEST_ASSERT_TRUE(event_loop_arm(&loop, begin));
+    TEST_ASSERT_EQUAL_INT(LOOP_EVENT_TICK, event_loop_wait(&loop));
+}
+
+void test_input_and_signals_come_before_ticks(void)
+{
+    if (!loop_ready)
+    {
+        TEST_IGNORE_MESSAGE("No event loop on this platform");
+    }
+
+#ifdef __linux__
+    struct SwTimestamp now;
+    sw_gettime(&now);
+    TEST_ASSERT_TRUE(event_loop_arm(&loop, now));
+
+    TEST_ASSERT_EQUAL_INT(1, write(input[1], "q", 1));
+    raise(SIGWINCH);
+    TEST_ASSERT_EQUAL_INT(LOOP_EVENT_RESIZE, event_loop_wait(&loop));
+    TEST_ASSERT_EQUAL_INT(LOOP_EVENT_INPUT, event_loop_wait(&loop));
+
+    // Reported until the input is read
+    TEST_ASSERT_EQUAL_INT(LOOP_EVENT_INPUT, event_loop_wait(&loop));
+    char ch;
+    TEST_ASSERT_EQUAL_INT(1, read(input[0], &ch, 1));
+    TEST_ASSERT_EQUAL_INT(LOOP_EVENT_TICK, event_loop_wait(&loop));
+
+    raise(SIGTERM);
+    TEST_ASSERT_EQUAL_INT(LOOP_EVENT_QUIT, event_loop_wait(&loop));
+#endif
+}
+
+void test_closed_input_quits(void)
+{
+    if (!loop_ready)
+    {
+        TEST_IGNORE_MESSAGE("No event loop on this platform");
+    }
+
+#ifdef __linux__
+    close(input[1]);
+    input[1] = -1;
+    TEST_ASSERT_EQUAL_INT(LOOP_EVENT_QUIT, event_loop_wait(&loop));
+#endif
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_deadline_ticks);
+    RUN_TEST(test_input_and_signals_come_before_ticks);
+    RUN_TEST(test_closed_input_quits);
+
+    return UNITY_END();
+}
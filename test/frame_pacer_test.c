@@ -0,0 +1,79 @@
+#include "frame_pacer.h"
+#include "stopwatch.h"
+#include "unity.h"
+
+#define PERIOD_USEC 2000
+#define NUM_FRAMES 50
+
+static struct FramePacer pacer;
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+void test_deadlines_do_not_drift(void)
+{
+    frame_pacer_init(&pacer, PERIOD_USEC, 0);
+
+    unsigned long long skipped = 0;
+    for (int i = 0; i < NUM_FRAMES; ++i)
+    {
+        skipped += frame_pacer_wait(&pacer);
+    }
+
+    // Every frame started in its own slot, or slots were skipped and counted
+    TEST_ASSERT_EQUAL_UINT64(NUM_FRAMES + skipped, pacer.frame);
+    TEST_ASSERT_EQUAL_UINT64(NUM_FRAMES, pacer.stats.times.count);
+
+    // Never early: the last frame started after its deadline
+    struct SwTimestamp now;
+    unsigned long long elapsed;
+    sw_gettime(&now);
+    sw_timediff_usec(now, pacer.start, &elapsed);
+    TEST_ASSERT_TRUE(elapsed >= pacer.frame * PERIOD_USEC);
+}
+
+void test_late_frame_skips_to_current_slot(void)
+{
+    frame_pacer_init(&pacer, PERIOD_USEC, 0);
+
+    // A frame taking several periods misses its deadline
+    sw_sleep(5 * PERIOD_USEC);
+    unsigned long long skipped = frame_pacer_wait(&pacer);
+
+    TEST_ASSERT_EQUAL_UINT64(1, pacer.stats.num_missed);
+    TEST_ASSERT_TRUE(skipped >= 4);
+    TEST_ASSERT_EQUAL_UINT64(skipped + 1, pacer.frame);
+    TEST_ASSERT_TRUE(pacer.stats.times.max >= 5 * PERIOD_USEC);
+
+    // The next frame is on time again
+    frame_pacer_wait(&pacer);
+    TEST_ASSERT_EQUAL_UINT64(skipped + 2, pacer.frame);
+}
+
+void test_spin_reaches_deadline(void)
+{
+    frame_pacer_init(&pacer, PERIOD_USEC, PERIOD_USEC / 2);
+    frame_pacer_wait(&pacer);
+
+    struct SwTimestamp now;
+    unsigned long long elapsed;
+    sw_gettime(&now);
+    sw_timediff_usec(now, pacer.start, &elapsed);
+    TEST_ASSERT_TRUE(elapsed >= PERIOD_USEC);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_deadlines_do_not_drift);
+    RUN_TEST(test_late_frame_skips_to_current_slot);
+    RUN_TEST(test_spin_reaches_deadline);
+
+    return UNITY_END();
+}
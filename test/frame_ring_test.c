@@ -0,0 +1,105 @@
+#include "frame_ring.h"
+#include "thread.h"
+#include "unity.h"
+
+#define NUM_FRAMES 2000
+
+static struct FrameRing ring;
+
+// Frame number written into each slot by the producer
+static unsigned int slot_frames[FRAME_RING_MAX_SLOTS];
+
+void setUp(void)
+{
+    frame_ring_init(&ring, 2);
+}
+
+void tearDown(void)
+{
+    frame_ring_destroy(&ring);
+}
+
+static void produce(void *arg)
+{
+    (void)arg;
+
+    unsigned int slot;
+    for (unsigned int frame = 0; frame_ring_begin_write(&ring, &slot); ++frame)
+    {
+        slot_frames[slot] = frame;
+        frame_ring_end_write(&ring);
+    }
+}
+
+void test_frames_arrive_in_order(void)
+{
+    struct Thread producer;
+    TEST_ASSERT_TRUE(thread_start(&producer, produce, NULL));
+
+    for (unsigned int frame = 0; frame < NUM_FRAMES; ++frame)
+    {
+        unsigned int slot;
+        TEST_ASSERT_TRUE(frame_ring_begin_read(&ring, &slot));
+        TEST_ASSERT_EQUAL_UINT(frame, slot_frames[slot]);
+        frame_ring_end_read(&ring);
+    }
+
+    frame_ring_close(&ring);
+    thread_join(&producer);
+
+    unsigned int slot;
+    TEST_ASSERT_FALSE(frame_ring_begin_read(&ring, &slot));
+}
+
+void test_producer_waits_for_free_slot(void)
+{
+    unsigned int write_a, write_b, read;
+    TEST_ASSERT_TRUE(frame_ring_begin_write(&ring, &write_a));
+    frame_ring_end_write(&ring);
+    TEST_ASSERT_TRUE(frame_ring_begin_read(&ring, &read));
+    TEST_ASSERT_EQUAL_UINT(write_a, read);
+
+    // The slot being read is never handed to the producer
+    TEST_ASSERT_TRUE(frame_ring_begin_write(&ring, &write_b));
+    TEST_ASSERT_NOT_EQUAL(read, write_b);
+    frame_ring_end_write(&ring);
+    TEST_ASSERT_EQUAL_UINT(2, ring.filled);
+
+    frame_ring_end_read(&ring);
+    TEST_ASSERT_TRUE(frame_ring_begin_read(&ring, &read));
+    TEST_ASSERT_EQUAL_UINT(write_b, read);
+    frame_ring_end_read(&ring);
+    TEST_ASSERT_EQUAL_UINT(0, ring.filled);
+}
+
+void test_pause_discards_filled_slots(void)
+{
+    unsigned int slot;
+    TEST_ASSERT_TRUE(frame_ring_begin_write(&ring, &slot));
+    frame_ring_end_write(&ring);
+
+    frame_ring_pause(&ring);
+    TEST_ASSERT_EQUAL_UINT(0, ring.filled);
+    frame_ring_resume(&ring);
+
+    // Production picks up again after the pause
+    struct Thread producer;
+    TEST_ASSERT_TRUE(thread_start(&producer, produce, NULL));
+    TEST_ASSERT_TRUE(frame_ring_begin_read(&ring, &slot));
+    TEST_ASSERT_EQUAL_UINT(0, slot_frames[slot]);
+    frame_ring_end_read(&ring);
+
+    frame_ring_close(&ring);
+    thread_join(&producer);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_frames_arrive_in_order);
+    RUN_TEST(test_producer_waits_for_free_slot);
+    RUN_TEST(test_pause_discards_filled_slots);
+
+    return UNITY_END();
+}
@@ -0,0 +1,76 @@
+#include "histogram.h"
+#include "unity.h"
+
+static struct Histogram histogram;
+
+void setUp(void)
+{
+    histogram_reset(&histogram);
+}
+
+void tearDown(void)
+{
+}
+
+void test_empty_histogram(void)
+{
+    TEST_ASSERT_EQUAL_UINT64(0, histogram_percentile(&histogram, 0.5));
+    TEST_ASSERT_EQUAL_DOUBLE(0.0, histogram_mean(&histogram));
+}
+
+void test_percentiles_are_within_a_bucket(void)
+{
+    // 1 ms to 100 ms, in microseconds
+    for (unsigned long long usec = 1000; usec <= 100000; usec += 1000)
+    {
+        histogram_record(&histogram, usec);
+    }
+
+    TEST_ASSERT_EQUAL_UINT64(100, histogram.count);
+    TEST_ASSERT_EQUAL_UINT64(100000, histogram.max);
+    TEST_ASSERT_EQUAL_DOUBLE(50500.0, histogram_mean(&histogram));
+    TEST_ASSERT_UINT64_WITHIN(500, 50000, histogram_percentile(&histogram, 0.5));
+    TEST_ASSERT_UINT64_WITHIN(1000, 99000, histogram_percentile(&histogram, 0.99));
+    TEST_ASSERT_EQUAL_UINT64(100000, histogram_percentile(&histogram, 1.0));
+}
+
+void test_small_values_are_exact(void)
+{
+    for (unsigned long long value = 0; value < 256; ++value)
+    {
+        histogram_reset(&histogram);
+        histogram_record(&histogram, value);
+        TEST_ASSERT_EQUAL_UINT64(value, histogram_percentile(&histogram, 0.5));
+    }
+}
+
+void test_relative_error_is_bounded(void)
+{
+    // Nanoseconds to minutes
+    for (unsigned long long value = 300; value < (1ULL << 36); value = value * 3 + 7)
+    {
+        histogram_reset(&histogram);
+        histogram_record(&histogram, value);
+        histogram_record(&histogram, value + 1);
+        unsigned long long p50 = histogram_percentile(&histogram, 0.5);
+        TEST_ASSERT_UINT64_WITHIN(value / 128 + 1, value, p50);
+    }
+
+    // Huge values are clamped rather than lost
+    histogram_reset(&histogram);
+    histogram_record(&histogram, ~0ULL);
+    TEST_ASSERT_EQUAL_UINT64(1, histogram.count);
+    TEST_ASSERT_TRUE(histogram_percentile(&histogram, 0.5) >= (1ULL << 39));
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_empty_histogram);
+    RUN_TEST(test_percentiles_are_within_a_bucket);
+    RUN_TEST(test_small_values_are_exact);
+    RUN_TEST(test_relative_error_is_bounded);
+
+    return UNITY_END();
+}
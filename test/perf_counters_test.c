@@ -0,0 +1,87 @@
+#include "perf_counters.h"
+#include "unity.h"
+
+#include <string.h>
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+void test_unavailable_counters_are_left_out(void)
+{
+    struct PerfCounters counters;
+    bool open = perf_counters_open(&counters);
+
+    unsigned int num_open = 0;
+    for (int counter = 0; counter < NUM_PERF_COUNTERS; ++counter)
+    {
+        num_open += counters.fds[counter] != -1;
+    }
+    TEST_ASSERT_EQUAL_UINT(counters.num_open, num_open);
+    TEST_ASSERT_EQUAL(open, num_open > 0);
+
+    struct PerfSample sample;
+    TEST_ASSERT_EQUAL(open, perf_counters_read(&counters, &sample));
+    for (int counter = 0; counter < NUM_PERF_COUNTERS; ++counter)
+    {
+        bool valid = (sample.valid & (1u << counter)) != 0;
+        TEST_ASSERT_EQUAL(counters.fds[counter] != -1, valid);
+    }
+
+    perf_counters_close(&counters);
+    TEST_ASSERT_EQUAL_UINT(0, counters.num_open);
+    TEST_ASSERT_FALSE(perf_counters_read(&counters, &sample));
+    TEST_ASSERT_EQUAL_UINT(0, sample.valid);
+}
+
+void test_counters_only_grow(void)
+{
+    struct PerfCounters counters;
+    if (!perf_counters_open(&counters))
+    {
+        TEST_IGNORE_MESSAGE("Hardware counters are unavailable");
+    }
+
+    struct PerfSample before, after;
+    TEST_ASSERT_TRUE(perf_counters_read(&counters, &before));
+    volatile double sum = 0.0;
+    for (int i = 0; i < 100000; ++i)
+    {
+        sum += i * 0.5;
+    }
+    TEST_ASSERT_TRUE(perf_counters_read(&counters, &after));
+    perf_counters_close(&counters);
+
+    TEST_ASSERT_EQUAL_UINT(before.valid, after.valid);
+    for (int counter = 0; counter < NUM_PERF_COUNTERS; ++counter)
+    {
+        if (after.valid & (1u << counter))
+        {
+            TEST_ASSERT_TRUE(after.values[counter] >= before.values[counter]);
+        }
+    }
+}
+
+void test_every_counter_is_named(void)
+{
+    for (int counter = 0; counter < NUM_PERF_COUNTERS; ++counter)
+    {
+        TEST_ASSERT_NOT_NULL(perf_counter_name(counter));
+        TEST_ASSERT_TRUE(strlen(perf_counter_name(counter)) > 0);
+    }
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_unavailable_counters_are_left_out);
+    RUN_TEST(test_counters_only_grow);
+    RUN_TEST(test_every_counter_is_named);
+
+    return UNITY_END();
+}
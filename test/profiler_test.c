@@ -0,0 +1,131 @@
+#include "profiler.h"
+#include "stopwatch.h"
+#include "unity.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#define TEST_PATH "profiler_test.csv"
+
+static struct Profiler profiler;
+
+void setUp(void)
+{
+    TEST_ASSERT_TRUE(generate_profiler(&profiler));
+}
+
+void tearDown(void)
+{
+    free_profiler(&profiler);
+    remove(TEST_PATH);
+}
+
+void test_laps_are_counted_per_stage(void)
+{
+    struct ProfileMark mark;
+    profiler_mark(&mark, NULL);
+    for (int i = 0; i < 10; ++i)
+    {
+        sw_sleep(1000);
+        profiler_lap(&profiler, STAGE_SLEEP, &mark);
+        profiler_lap(&profiler, STAGE_FLUSH, &mark);
+    }
+
+    struct StageSummary summary[NUM_PROFILE_STAGES];
+    profiler_summarize(&profiler, summary);
+
+    TEST_ASSERT_EQUAL_UINT64(10, summary[STAGE_SLEEP].count);
+    TEST_ASSERT_EQUAL_UINT64(10, summary[STAGE_FLUSH].count);
+    TEST_ASSERT_EQUAL_UINT64(0, summary[STAGE_RENDER_STARS].count);
+
+    // Each lap starts where the previous one ended
+    TEST_ASSERT_TRUE(summary[STAGE_SLEEP].p50 >= 1000);
+    TEST_ASSERT_TRUE(summary[STAGE_FLUSH].p50 < summary[STAGE_SLEEP].p50);
+    TEST_ASSERT_TRUE(summary[STAGE_SLEEP].p99 <= summary[STAGE_SLEEP].max);
+}
+
+void test_csv_has_a_row_per_stage(void)
+{
+    struct ProfileMark mark;
+    profiler_mark(&mark, NULL);
+    profiler_lap(&profiler, STAGE_RENDER_STARS, &mark);
+    TEST_ASSERT_TRUE(profiler_write_csv(&profiler, TEST_PATH));
+
+    FILE *file = fopen(TEST_PATH, "r");
+    TEST_ASSERT_NOT_NULL(file);
+
+    char line[256];
+    TEST_ASSERT_NOT_NULL(fgets(line, sizeof(line), file));
+    TEST_ASSERT_EQUAL_STRING("stage,count,mean_us,p50_us,p99_us,max_us\n", line);
+
+    int rows = 0;
+    bool found = false;
+    while (fgets(line, sizeof(line), file) != NULL)
+    {
+        found = found || strncmp(line, "render stars,1,", 15) == 0;
+        rows++;
+    }
+    fclose(file);
+    TEST_ASSERT_EQUAL_INT(NUM_PROFILE_STAGES, rows);
+    TEST_ASSERT_TRUE(found);
+
+    TEST_ASSERT_FALSE(profiler_write_csv(&profiler, "missing_directory/profile.csv"));
+}
+
+void test_events_are_counted_per_stage(void)
+{
+    struct PerfCounters counters;
+    if (!perf_counters_open(&counters))
+    {
+        TEST_IGNORE_MESSAGE("Hardware counters are unavailable");
+    }
+
+    struct ProfileThread thread = {.counters = &counters, .trace = NULL};
+    struct ProfileMark mark;
+    profiler_mark(&mark, &thread);
+    volatile double sum = 0.0;
+    for (int i = 0; i < 100000; ++i)
+    {
+        sum += i * 0.5;
+    }
+    profiler_lap(&profiler, STAGE_UPDATE_STARS, &mark);
+    profiler_lap(&profiler, STAGE_RENDER_STARS, &mark);
+    perf_counters_close(&counters);
+
+    struct StageCounts counts[NUM_PROFILE_STAGES];
+    profiler_counts(&profiler, counts);
+
+    TEST_ASSERT_EQUAL_UINT64(1, counts[STAGE_UPDATE_STARS].laps);
+    TEST_ASSERT_EQUAL_UINT64(0, counts[STAGE_FLUSH].laps);
+    if (counts[STAGE_UPDATE_STARS].valid & (1u << COUNTER_INSTRUCTIONS))
+    {
+        TEST_ASSERT_TRUE(counts[STAGE_UPDATE_STARS].events[COUNTER_INSTRUCTIONS] > 100000);
+        TEST_ASSERT_TRUE(counts[STAGE_RENDER_STARS].events[COUNTER_INSTRUCTIONS] <
+                         counts[STAGE_UPDATE_STARS].events[COUNTER_INSTRUCTIONS]);
+    }
+}
+
+void test_laps_without_counters_count_no_events(void)
+{
+    struct ProfileMark mark;
+    profiler_mark(&mark, NULL);
+    profiler_lap(&profiler, STAGE_CLEAR, &mark);
+
+    struct StageCounts counts[NUM_PROFILE_STAGES];
+    profiler_counts(&profiler, counts);
+    TEST_ASSERT_EQUAL_UINT64(0, counts[STAGE_CLEAR].laps);
+    TEST_ASSERT_EQUAL_UINT(0, counts[STAGE_CLEAR].valid);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_laps_are_counted_per_stage);
+    RUN_TEST(test_csv_has_a_row_per_stage);
+    RUN_TEST(test_events_are_counted_per_stage);
+    RUN_TEST(test_laps_without_counters_count_no_events);
+
+    return UNITY_END();
+}
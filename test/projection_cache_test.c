@@ -0,0 +1,153 @@
+#include "astro.h"
+#include "projection_cache.h"
+#include "unity.h"
+
+#include <stdlib.h>
+
+static struct ProjectionCache cache;
+
+void setUp(void)
+{
+    generate_projection_cache(&cache, 1 << 20);
+}
+
+void tearDown(void)
+{
+    free_projection_cache(&cache);
+}
+
+static void fill_slot(struct CacheSlot *slot, unsigned int count)
+{
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        TEST_ASSERT_TRUE(projection_cache_append(&cache, slot, i, (int)i % 40, (int)i % 80));
+    }
+    projection_cache_finish(&cache, slot, true);
+}
+
+void test_slot_repeats_every_sidereal_day(void)
+{
+    double julian_date = 2459146.0;
+    double sidereal_day = 1.0 / SIDEREAL_RATE;
+
+    struct CacheSlot *slot = projection_cache_slot(&cache, 40, 80, 0.7, -1.2, 5.0f, julian_date);
+    TEST_ASSERT_NOT_NULL(slot);
+    TEST_ASSERT_FALSE(slot->filled);
+    fill_slot(slot, 100);
+
+    // The same sky a sidereal day later, and a month of sidereal days later
+    TEST_ASSERT_EQUAL_PTR(slot, projection_cache_slot(&cache, 40, 80, 0.7, -1.2, 5.0f, julian_date + sidereal_day));
+    TEST_ASSERT_EQUAL_PTR(slot,
+                          projection_cache_slot(&cache, 40, 80, 0.7, -1.2, 5.0f, julian_date + 30 * sidereal_day));
+    TEST_ASSERT_TRUE(slot->filled);
+    TEST_ASSERT_EQUAL_UINT(100, slot->count);
+
+    // A quarter of a day later the sky has turned
+    TEST_ASSERT_TRUE(slot != projection_cache_slot(&cache, 40, 80, 0.7, -1.2, 5.0f, julian_date + 0.25));
+}
+
+void test_slots_short_enough_for_half_a_cell(void)
+{
+    projection_cache_slot(&cache, 40, 80, 0.7, -1.2, 5.0f, 2459146.0);
+
+    // A star at most a projection radius from the center moves at most the
+    // radius times the angle the sky turns in one slot
+    double radius = (80 - 1) / 2.0;
+    TEST_ASSERT_TRUE(2.0 * 3.14159265358979 / cache.num_slots * radius <= 0.5);
+}
+
+void test_key_change_clears(void)
+{
+    double julian_date = 2459146.0;
+    struct CacheSlot *slot = projection_cache_slot(&cache, 40, 80, 0.7, -1.2, 5.0f, julian_date);
+    fill_slot(slot, 10);
+
+    // Resize, observer and threshold changes all clear the cache
+    slot = projection_cache_slot(&cache, 41, 80, 0.7, -1.2, 5.0f, julian_date);
+    TEST_ASSERT_FALSE(slot->filled);
+    fill_slot(slot, 10);
+    slot = projection_cache_slot(&cache, 41, 80, 0.6, -1.2, 5.0f, julian_date);
+    TEST_ASSERT_FALSE(slot->filled);
+    fill_slot(slot, 10);
+    slot = projection_cache_slot(&cache, 41, 80, 0.6, -1.2, 4.0f, julian_date);
+    TEST_ASSERT_FALSE(slot->filled);
+    TEST_ASSERT_EQUAL_UINT(0, cache.num_stars);
+
+    // Positions eventually go stale from proper motion
+    fill_slot(slot, 10);
+    slot = projection_cache_slot(&cache, 41, 80, 0.6, -1.2, 4.0f, julian_date + 1000.0);
+    TEST_ASSERT_EQUAL_UINT(0, cache.num_stars);
+}
+
+void test_budget_is_respected(void)
+{
+    free_projection_cache(&cache);
+    generate_projection_cache(&cache, 1000 * sizeof(struct CachedStar));
+
+    double julian_date = 2459146.0;
+    struct CacheSlot *first = projection_cache_slot(&cache, 40, 80, 0.7, -1.2, 5.0f, julian_date);
+    fill_slot(first, 600);
+
+    // A slot that does not fit is discarded without disturbing the others
+    struct CacheSlot *second = projection_cache_slot(&cache, 40, 80, 0.7, -1.2, 5.0f, julian_date + 0.5);
+    bool kept = true;
+    for (unsigned int i = 0; i < 600 && kept; ++i)
+    {
+        kept = projection_cache_append(&cache, second, i, 0, 0);
+    }
+    TEST_ASSERT_FALSE(kept);
+    projection_cache_finish(&cache, second, false);
+
+    TEST_ASSERT_FALSE(second->filled);
+    TEST_ASSERT_EQUAL_UINT(600, cache.num_stars);
+    TEST_ASSERT_TRUE(cache.capacity * sizeof(struct CachedStar) <= cache.budget);
+    TEST_ASSERT_TRUE(first->filled);
+    TEST_ASSERT_EQUAL_UINT(599, cache.stars[first->offset + 599].star);
+}
+
+void test_overflowing_slot_is_not_recorded_again(void)
+{
+    free_projection_cache(&cache);
+    generate_projection_cache(&cache, 1000 * sizeof(struct CachedStar));
+
+    double julian_date = 2459146.0;
+    double sidereal_day = 1.0 / SIDEREAL_RATE;
+    fill_slot(projection_cache_slot(&cache, 40, 80, 0.7, -1.2, 5.0f, julian_date), 600);
+
+    struct CacheSlot *slot = projection_cache_slot(&cache, 40, 80, 0.7, -1.2, 5.0f, julian_date + 0.5);
+    unsigned int appended = 0;
+    while (projection_cache_append(&cache, slot, appended, 0, 0))
+    {
+        appended++;
+    }
+    projection_cache_finish(&cache, slot, false);
+    TEST_ASSERT_TRUE(slot->uncacheable);
+
+    // Later frames in the slot, on later days too, append nothing
+    for (int day = 0; day < 3; ++day)
+    {
+        slot = projection_cache_slot(&cache, 40, 80, 0.7, -1.2, 5.0f, julian_date + 0.5 + day * sidereal_day);
+        TEST_ASSERT_TRUE(slot->uncacheable);
+        TEST_ASSERT_FALSE(projection_cache_append(&cache, slot, 0, 0, 0));
+        TEST_ASSERT_EQUAL_UINT(0, slot->count);
+        TEST_ASSERT_EQUAL_UINT(600, cache.num_stars);
+    }
+
+    // Clearing the cache gives the slot another chance
+    slot = projection_cache_slot(&cache, 41, 80, 0.7, -1.2, 5.0f, julian_date + 0.5);
+    TEST_ASSERT_FALSE(slot->uncacheable);
+    TEST_ASSERT_TRUE(projection_cache_append(&cache, slot, 0, 0, 0));
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_slot_repeats_every_sidereal_day);
+    RUN_TEST(test_slots_short_enough_for_half_a_cell);
+    RUN_TEST(test_key_change_clears);
+    RUN_TEST(test_budget_is_respected);
+    RUN_TEST(test_overflowing_slot_is_not_recorded_again);
+
+    return UNITY_END();
+}
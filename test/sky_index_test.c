@@ -0,0 +1,273 @@
+#include "astro.h"
+#include "coord.h"
+#include "core.h"
+#include "core_position.h"
+#include "macros.h"
+#include "sky_index.h"
+#include "test_stars.h"
+#include "unity.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define NUM_TEST_STARS 2000
+
+static struct Star *star_table;
+static struct SkyIndex sky_index;
+
+void setUp(void)
+{
+    star_table = generate_test_stars(NUM_TEST_STARS, 12345, 5.0f, 5.0f);
+
+    // Include the poles and the seam in right ascension
+    star_table[0].declination = M_PI / 2.0;
+    star_table[1].declination = -M_PI / 2.0;
+    star_table[2].right_ascension = 0.0;
+    star_table[3].right_ascension = 2.0 * M_PI - 1.0E-12;
+
+    generate_sky_index(&sky_index, star_table, NUM_TEST_STARS, 12);
+}
+
+void tearDown(void)
+{
+    free_sky_index(&sky_index);
+    free(star_table);
+}
+
+void test_every_star_in_exactly_one_cell(void)
+{
+    TEST_ASSERT_EQUAL_UINT(NUM_TEST_STARS, sky_index.cell_offsets[sky_index.num_cells]);
+
+    int *count = calloc(NUM_TEST_STARS, sizeof(int));
+    for (unsigned int c = 0; c < sky_index.num_cells; ++c)
+    {
+        const struct SkyCell *cell = &sky_index.cells[c];
+        for (unsigned int i = sky_index.cell_offsets[c]; i < sky_index.cell_offsets[c + 1]; ++i)
+        {
+            const struct Star *star = &star_table[sky_index.star_indices[i]];
+            count[sky_index.star_indices[i]]++;
+
+            // Member stars lie within the cell's bounding cap
+            double cos_dist = sin(star->declination) * sin(cell->center_dec) +
+                              cos(star->declination) * cos(cell->center_dec) * cos(star->right_ascension - cell->center_ra);
+            TEST_ASSERT_TRUE(acos(fmin(1.0, cos_dist)) <= cell->radius + 1.0E-9);
+        }
+    }
+
+    for (unsigned int i = 0; i < NUM_TEST_STARS; ++i)
+    {
+        TEST_ASSERT_EQUAL_INT(1, count[i]);
+    }
+    free(count);
+}
+
+void test_culled_cells_are_below_horizon(void)
+{
+    for (int trial = 0; trial < 50; ++trial)
+    {
+        double local_sidereal_time = test_random() * 2.0 * M_PI;
+        double latitude = (test_random() - 0.5) * M_PI;
+
+        for (unsigned int c = 0; c < sky_index.num_cells; ++c)
+        {
+            if (!sky_cell_below_horizon(&sky_index.cells[c], local_sidereal_time, latitude, 0.0))
+            {
+                continue;
+            }
+
+            for (unsigned int i = sky_index.cell_offsets[c]; i < sky_index.cell_offsets[c + 1]; ++i)
+            {
+                const struct Star *star = &star_table[sky_index.star_indices[i]];
+                double azimuth, altitude;
+                equatorial_to_horizontal(star->right_ascension, star->declination, local_sidereal_time, latitude, 0.0,
+                                         &azimuth, &altitude);
+                TEST_ASSERT_TRUE(altitude < 0.0);
+            }
+        }
+    }
+}
+
+void test_indexed_update_matches_full_update(void)
+{
+    struct Star *reference = malloc(NUM_TEST_STARS * sizeof(struct Star));
+    memcpy(reference, star_table, NUM_TEST_STARS * sizeof(struct Star));
+
+    double julian_date = 2459146.0;
+    double latitude = 42.3601 * M_PI / 180;
+    double longitude = -71.0589 * M_PI / 180;
+
+    // Pinned stars are updated even when culled
+    unsigned int pinned[] = {5, 6, 5};
+    TEST_ASSERT_TRUE(sky_index_pin_stars(&sky_index, pinned, 3));
+    TEST_ASSERT_EQUAL_UINT(2, sky_index.num_pinned);
+
+    // Advance over several hours so cells rise and set between updates
+    for (int step = 0; step < 8; ++step)
+    {
+        double jd = julian_date + step * 0.1;
+        update_star_positions(reference, NUM_TEST_STARS, jd, latitude, longitude);
+        update_star_positions_indexed(star_table, &sky_index, jd, latitude, longitude);
+
+        for (unsigned int i = 0; i < NUM_TEST_STARS; ++i)
+        {
+            if (reference[i].base.up >= 0.0 || i == 5 || i == 6)
+            {
+                // Visible stars must be exact
+                TEST_ASSERT_DOUBLE_WITHIN(1.0E-12, reference[i].base.east, star_table[i].base.east);
+                TEST_ASSERT_DOUBLE_WITHIN(1.0E-12, reference[i].base.north, star_table[i].base.north);
+                TEST_ASSERT_DOUBLE_WITHIN(1.0E-12, reference[i].base.up, star_table[i].base.up);
+            }
+            else
+            {
+                // Hidden stars must stay hidden
+                TEST_ASSERT_TRUE(star_table[i].base.up < 0.0);
+            }
+        }
+    }
+
+    free(reference);
+}
+
+void test_cap_update_covers_cap(void)
+{
+    struct Star *reference = malloc(NUM_TEST_STARS * sizeof(struct Star));
+    memcpy(reference, star_table, NUM_TEST_STARS * sizeof(struct Star));
+
+    double latitude = 42.3601 * M_PI / 180;
+    double longitude = -71.0589 * M_PI / 180;
+    double radii[] = {1.0 * TO_RAD, 10.0 * TO_RAD, 60.0 * TO_RAD};
+
+    for (int step = 0; step < 6; ++step)
+    {
+        double jd = 2459146.0 + step * 0.1;
+        double gmst = greenwich_mean_sidereal_time_rad(jd);
+        update_star_positions(reference, NUM_TEST_STARS, jd, latitude, longitude);
+
+        // Center the cap on a star above the horizon so it is never empty
+        unsigned int center_star = 0;
+        while (reference[center_star].base.up < sin(0.2))
+        {
+            center_star++;
+        }
+        const struct ObjectBase *center = &reference[center_star].base;
+        double azimuth, altitude;
+        unit_to_horizontal(center->east, center->north, center->up, &azimuth, &altitude);
+        double center_ra, center_dec;
+        horizontal_to_equatorial(azimuth, altitude, gmst, latitude, longitude, &center_ra, &center_dec);
+
+        double radius = radii[step % 3];
+        update_star_positions_in_cap(star_table, &sky_index, jd, latitude, longitude, center_ra, center_dec, radius);
+
+        for (unsigned int i = 0; i < NUM_TEST_STARS; ++i)
+        {
+            const struct Star *star = &reference[i];
+            double cos_dist = sin(star->declination) * sin(center_dec) +
+                              cos(star->declination) * cos(center_dec) * cos(star->right_ascension - center_ra);
+            if (star->base.up >= 0.0 && acos(fmin(1.0, cos_dist)) <= radius)
+            {
+                TEST_ASSERT_DOUBLE_WITHIN(1.0E-12, star->base.east, star_table[i].base.east);
+                TEST_ASSERT_DOUBLE_WITHIN(1.0E-12, star->base.north, star_table[i].base.north);
+                TEST_ASSERT_DOUBLE_WITHIN(1.0E-12, star->base.up, star_table[i].base.up);
+            }
+        }
+
+        // Narrow caps only touch a few cells
+        if (radius < 2.0 * TO_RAD)
+        {
+            TEST_ASSERT_TRUE(sky_index.num_selected <= sky_index.num_cells / 10);
+        }
+    }
+
+    // Going back to whole sky updates hides every star that set meanwhile
+    double jd = 2459146.0 + 0.9;
+    update_star_positions(reference, NUM_TEST_STARS, jd, latitude, longitude);
+    update_star_positions_indexed(star_table, &sky_index, jd, latitude, longitude);
+    for (unsigned int i = 0; i < NUM_TEST_STARS; ++i)
+    {
+        if (reference[i].base.up < 0.0)
+        {
+            TEST_ASSERT_TRUE(star_table[i].base.up < 0.0);
+        }
+    }
+
+    free(reference);
+}
+
+void test_classification_skips_never_rising_stars(void)
+{
+    double latitude = 42.3601 * M_PI / 180;
+    sky_index_classify(&sky_index, star_table, latitude, 2459146.0);
+    TEST_ASSERT_FALSE(sky_index_needs_classify(&sky_index, latitude, 2459146.0));
+    TEST_ASSERT_TRUE(sky_index_needs_classify(&sky_index, -latitude, 2459146.0));
+
+    // The south celestial pole never rises in the north, the north one never sets
+    TEST_ASSERT_TRUE(sky_index.num_never_rises > 0);
+    TEST_ASSERT_TRUE(sky_index.num_circumpolar > 0);
+
+    unsigned int num_never_rises = 0;
+    for (unsigned int c = 0; c < sky_index.num_cells; ++c)
+    {
+        for (unsigned int i = sky_index.cell_offsets[c]; i < sky_index.cell_offsets[c + 1]; ++i)
+        {
+            const struct Star *star = &star_table[sky_index.star_indices[i]];
+            bool active = i < sky_index.cell_active_end[c];
+            TEST_ASSERT_EQUAL(active, star->declination > latitude - M_PI / 2.0);
+            TEST_ASSERT_EQUAL_DOUBLE(star->declination, sky_index.entries[i].declination);
+            num_never_rises += !active;
+        }
+    }
+    TEST_ASSERT_EQUAL_UINT(sky_index.num_never_rises, num_never_rises);
+}
+
+void test_indexed_update_follows_latitude_change(void)
+{
+    struct Star *reference = malloc(NUM_TEST_STARS * sizeof(struct Star));
+    memcpy(reference, star_table, NUM_TEST_STARS * sizeof(struct Star));
+
+    double julian_date = 2459146.0;
+    double latitudes[] = {60.0 * M_PI / 180, -35.0 * M_PI / 180, 0.0, 60.0 * M_PI / 180};
+
+    for (int step = 0; step < 4; ++step)
+    {
+        update_star_positions(reference, NUM_TEST_STARS, julian_date, latitudes[step], 0.0);
+        update_star_positions_indexed(star_table, &sky_index, julian_date, latitudes[step], 0.0);
+
+        for (unsigned int i = 0; i < NUM_TEST_STARS; ++i)
+        {
+            if (reference[i].base.up >= 0.0)
+            {
+                TEST_ASSERT_DOUBLE_WITHIN(1.0E-12, reference[i].base.east, star_table[i].base.east);
+                TEST_ASSERT_DOUBLE_WITHIN(1.0E-12, reference[i].base.north, star_table[i].base.north);
+                TEST_ASSERT_DOUBLE_WITHIN(1.0E-12, reference[i].base.up, star_table[i].base.up);
+            }
+            else
+            {
+                TEST_ASSERT_TRUE(star_table[i].base.up < 0.0);
+            }
+        }
+    }
+
+    free(reference);
+}
+
+void test_default_bands(void)
+{
+    TEST_ASSERT_TRUE(sky_index_default_bands(0) >= 1);
+    TEST_ASSERT_TRUE(sky_index_default_bands(9110) < sky_index_default_bands(2000000));
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_every_star_in_exactly_one_cell);
+    RUN_TEST(test_culled_cells_are_below_horizon);
+    RUN_TEST(test_indexed_update_matches_full_update);
+    RUN_TEST(test_cap_update_covers_cap);
+    RUN_TEST(test_classification_skips_never_rising_stars);
+    RUN_TEST(test_indexed_update_follows_latitude_change);
+    RUN_TEST(test_default_bands);
+
+    return UNITY_END();
+}
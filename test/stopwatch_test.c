@@ -72,6 +72,73 @@ void test_sw_sleep_should_pause_execution(void)
     TEST_ASSERT_UINT_WITHIN(500000, 500000, diff);
 }
 
+void test_sw_timediff_nsec_should_match_usec(void)
+{
+    struct SwTimestamp start, end;
+    TEST_ASSERT_EQUAL(0, sw_gettime(&start));
+    sw_sleep(2000);
+    TEST_ASSERT_EQUAL(0, sw_gettime(&end));
+
+    unsigned long long usec, nsec;
+    TEST_ASSERT_EQUAL(0, sw_timediff_usec(end, start, &usec));
+    TEST_ASSERT_EQUAL(0, sw_timediff_nsec(end, start, &nsec));
+    TEST_ASSERT_TRUE(nsec >= 2000000ULL);
+    TEST_ASSERT_EQUAL_UINT64(usec, nsec / 1000ULL);
+}
+
+void test_sw_now_nsec_should_follow_sw_gettime(void)
+{
+    unsigned long long before = sw_now_nsec();
+    sw_sleep(2000);
+    unsigned long long after = sw_now_nsec();
+
+    TEST_ASSERT_NOT_EQUAL(0, before);
+    TEST_ASSERT_TRUE(after - before >= 2000000ULL);
+    TEST_ASSERT_TRUE(after - before < 2000000000ULL);
+}
+
+void test_sw_thread_cpu_nsec_should_leave_out_sleep(void)
+{
+    unsigned long long before = sw_thread_cpu_nsec();
+    if (before == 0)
+    {
+        TEST_IGNORE_MESSAGE("Thread CPU time is unsupported");
+    }
+
+    sw_sleep(50000);
+    unsigned long long slept = sw_thread_cpu_nsec() - before;
+
+    volatile double sum = 0.0;
+    unsigned long long busy_begin = sw_thread_cpu_nsec();
+    for (int i = 0; i < 10000000; ++i)
+    {
+        sum += i * 0.5;
+    }
+    unsigned long long busy = sw_thread_cpu_nsec() - busy_begin;
+
+    TEST_ASSERT_TRUE(slept < 50000000ULL);
+    TEST_ASSERT_TRUE(busy > 0);
+}
+
+void test_sw_process_usage_should_count_cpu_time(void)
+{
+    struct SwUsage before, after;
+    if (sw_process_usage(&before) != 0)
+    {
+        TEST_IGNORE_MESSAGE("Process usage is unsupported");
+    }
+
+    volatile double sum = 0.0;
+    for (int i = 0; i < 10000000; ++i)
+    {
+        sum += i * 0.5;
+    }
+    TEST_ASSERT_EQUAL(0, sw_process_usage(&after));
+
+    TEST_ASSERT_TRUE(after.user_nsec + after.system_nsec >= before.user_nsec + before.system_nsec);
+    TEST_ASSERT_TRUE(after.user_nsec > 0);
+}
+
 int main(void)
 {
     UNITY_BEGIN();
@@ -79,6 +146,10 @@ int main(void)
     RUN_TEST(test_sw_gettime_should_return_success);
     RUN_TEST(test_sw_timediff_usec_should_calculate_difference);
     RUN_TEST(test_sw_sleep_should_pause_execution);
+    RUN_TEST(test_sw_timediff_nsec_should_match_usec);
+    RUN_TEST(test_sw_now_nsec_should_follow_sw_gettime);
+    RUN_TEST(test_sw_thread_cpu_nsec_should_leave_out_sleep);
+    RUN_TEST(test_sw_process_usage_should_count_cpu_time);
 
     return UNITY_END();
 }
@@ -0,0 +1,173 @@
+#include "task_graph.h"
+#include "thread.h"
+#include "unity.h"
+
+#define NUM_CHAINS TASK_GRAPH_MAX_DEPS
+#define CHAIN_LENGTH 4
+
+static struct TaskGraph graph;
+
+// Order in which tasks finished, filled in as they run
+static struct Mutex order_lock;
+static unsigned int finish_order[TASK_GRAPH_MAX_TASKS];
+static unsigned int num_ran;
+
+struct Step
+{
+    unsigned int id;
+    bool success;
+};
+
+static struct Step steps[TASK_GRAPH_MAX_TASKS];
+
+void setUp(void)
+{
+    task_graph_init(&graph);
+    mutex_init(&order_lock);
+    num_ran = 0;
+}
+
+void tearDown(void)
+{
+    mutex_destroy(&order_lock);
+}
+
+static bool record_step(void *arg)
+{
+    struct Step *step = arg;
+
+    mutex_lock(&order_lock);
+    finish_order[num_ran++] = step->id;
+    mutex_unlock(&order_lock);
+
+    return step->success;
+}
+
+static unsigned int add_step(unsigned int id, bool success, const unsigned int *deps, unsigned int num_deps)
+{
+    steps[id] = (struct Step){.id = id, .success = success};
+    return task_graph_add(&graph, "step", record_step, &steps[id], deps, num_deps);
+}
+
+// Position of a task in the order tasks finished
+static unsigned int finish_position(unsigned int id)
+{
+    for (unsigned int i = 0; i < num_ran; ++i)
+    {
+        if (finish_order[i] == id)
+        {
+            return i;
+        }
+    }
+    return TASK_GRAPH_MAX_TASKS;
+}
+
+void test_tasks_run_after_their_dependencies(void)
+{
+    // Independent chains, joined by a last task depending on every chain
+    unsigned int ends[NUM_CHAINS];
+    for (unsigned int c = 0; c < NUM_CHAINS; ++c)
+    {
+        unsigned int previous = add_step(graph.num_tasks, true, NULL, 0);
+        for (unsigned int i = 1; i < CHAIN_LENGTH; ++i)
+        {
+            previous = add_step(graph.num_tasks, true, (unsigned int[]){previous}, 1);
+        }
+        ends[c] = previous;
+    }
+    unsigned int last = add_step(graph.num_tasks, true, ends, NUM_CHAINS);
+
+    TEST_ASSERT_TRUE(task_graph_run(&graph, TASK_GRAPH_MAX_THREADS));
+    TEST_ASSERT_EQUAL_UINT(graph.num_tasks, num_ran);
+
+    for (unsigned int t = 0; t < graph.num_tasks; ++t)
+    {
+        TEST_ASSERT_EQUAL(TASK_DONE, graph.tasks[t].state);
+        for (unsigned int d = 0; d < graph.tasks[t].num_deps; ++d)
+        {
+            TEST_ASSERT_LESS_THAN_UINT(finish_position(t), finish_position(graph.tasks[t].deps[d]));
+        }
+    }
+    TEST_ASSERT_EQUAL_UINT(last, finish_order[num_ran - 1]);
+}
+
+void test_failure_skips_dependents_only(void)
+{
+    unsigned int root = add_step(0, true, NULL, 0);
+    unsigned int failing = add_step(1, false, (unsigned int[]){root}, 1);
+    unsigned int dependent = add_step(2, true, (unsigned int[]){failing}, 1);
+    unsigned int indirect = add_step(3, true, (unsigned int[]){root, dependent}, 2);
+    unsigned int independent = add_step(4, true, (unsigned int[]){root}, 1);
+
+    TEST_ASSERT_FALSE(task_graph_run(&graph, TASK_GRAPH_MAX_THREADS));
+
+    TEST_ASSERT_EQUAL(TASK_DONE, graph.tasks[root].state);
+    TEST_ASSERT_EQUAL(TASK_FAILED, graph.tasks[failing].state);
+    TEST_ASSERT_EQUAL(TASK_SKIPPED, graph.tasks[dependent].state);
+    TEST_ASSERT_EQUAL(TASK_SKIPPED, graph.tasks[indirect].state);
+    TEST_ASSERT_EQUAL(TASK_DONE, graph.tasks[independent].state);
+    TEST_ASSERT_EQUAL_UINT(3, num_ran);
+}
+
+void test_single_thread_runs_in_order_added(void)
+{
+    unsigned int first = add_step(0, true, NULL, 0);
+    add_step(1, true, NULL, 0);
+    add_step(2, true, (unsigned int[]){first}, 1);
+
+    TEST_ASSERT_TRUE(task_graph_run(&graph, 1));
+    TEST_ASSERT_EQUAL_UINT(3, num_ran);
+    for (unsigned int i = 0; i < num_ran; ++i)
+    {
+        TEST_ASSERT_EQUAL_UINT(i, finish_order[i]);
+    }
+}
+
+void test_empty_graph_succeeds(void)
+{
+    TEST_ASSERT_TRUE(task_graph_run(&graph, TASK_GRAPH_MAX_THREADS));
+    TEST_ASSERT_EQUAL_UINT(0, num_ran);
+}
+
+void test_malformed_graph_does_not_run(void)
+{
+    unsigned int first = add_step(0, true, NULL, 0);
+
+    // Dependencies on the task itself, or on one that was not added
+    TEST_ASSERT_EQUAL_UINT(TASK_GRAPH_MAX_TASKS, add_step(1, true, (unsigned int[]){1}, 1));
+    TEST_ASSERT_EQUAL_UINT(TASK_GRAPH_MAX_TASKS, add_step(1, true, (unsigned int[]){TASK_GRAPH_MAX_TASKS}, 1));
+
+    // Too many dependencies
+    unsigned int deps[TASK_GRAPH_MAX_DEPS + 1] = {first};
+    TEST_ASSERT_EQUAL_UINT(TASK_GRAPH_MAX_TASKS, add_step(1, true, deps, TASK_GRAPH_MAX_DEPS + 1));
+    TEST_ASSERT_EQUAL_UINT(1, graph.num_tasks);
+
+    TEST_ASSERT_FALSE(task_graph_run(&graph, TASK_GRAPH_MAX_THREADS));
+    TEST_ASSERT_EQUAL_UINT(0, num_ran);
+}
+
+void test_too_many_tasks_are_not_added(void)
+{
+    for (unsigned int id = 0; id < TASK_GRAPH_MAX_TASKS; ++id)
+    {
+        TEST_ASSERT_EQUAL_UINT(id, add_step(id, true, NULL, 0));
+    }
+    TEST_ASSERT_EQUAL_UINT(TASK_GRAPH_MAX_TASKS, task_graph_add(&graph, "extra", record_step, &steps[0], NULL, 0));
+    TEST_ASSERT_EQUAL_UINT(TASK_GRAPH_MAX_TASKS, graph.num_tasks);
+
+    TEST_ASSERT_FALSE(task_graph_run(&graph, TASK_GRAPH_MAX_THREADS));
+    TEST_ASSERT_EQUAL_UINT(0, num_ran);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_tasks_run_after_their_dependencies);
+    RUN_TEST(test_failure_skips_dependents_only);
+    RUN_TEST(test_single_thread_runs_in_order_added);
+    RUN_TEST(test_empty_graph_succeeds);
+    RUN_TEST(test_malformed_graph_does_not_run);
+    RUN_TEST(test_too_many_tasks_are_not_added);
+
+    return UNITY_END();
+}
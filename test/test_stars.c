@@ -0,0 +1,32 @@
+#include "test_stars.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+static unsigned int rng_state = 12345;
+
+double test_random(void)
+{
+    rng_state = rng_state * 1103515245u + 12345u;
+    return (double)((rng_state >> 8) & 0xFFFFFF) / (double)0x1000000;
+}
+
+struct Star *generate_test_stars(unsigned int num_stars, unsigned int seed, float min_magnitude,
+                                 float max_magnitude)
+{
+    rng_state = seed;
+    struct Star *star_table = calloc(num_stars, sizeof(struct Star));
+    if (star_table == NULL)
+    {
+        return NULL;
+    }
+
+    for (unsigned int i = 0; i < num_stars; ++i)
+    {
+        star_table[i].catalog_number = (int)i + 1;
+        star_table[i].right_ascension = test_random() * 2.0 * M_PI;
+        star_table[i].declination = asin(test_random() * 2.0 - 1.0);
+        star_table[i].magnitude = min_magnitude + (float)test_random() * (max_magnitude - min_magnitude);
+    }
+    return star_table;
+}
@@ -0,0 +1,21 @@
+/* Random star tables shared by the tests of the star indexes and catalogs.
+ */
+
+#ifndef TEST_STARS_H
+#define TEST_STARS_H
+
+#include "core.h"
+
+/* Deterministic pseudo-random number in [0, 1), so failures are reproducible
+ */
+double test_random(void);
+
+/* Allocate `num_stars` stars spread uniformly over the sky, with magnitudes
+ * uniform in [min_magnitude, max_magnitude). The same seed always gives the same
+ * stars, and restarts the sequence of test_random. The table should be freed by
+ * the caller via free
+ */
+struct Star *generate_test_stars(unsigned int num_stars, unsigned int seed, float min_magnitude,
+                                 float max_magnitude);
+
+#endif // TEST_STARS_H
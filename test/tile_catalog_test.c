@@ -0,0 +1,186 @@
+#include "core.h"
+#include "macros.h"
+#include "sky_index.h"
+#include "tile_catalog.h"
+#include "test_stars.h"
+#include "unity.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define NUM_TEST_STARS 5000
+#define NUM_TEST_BANDS 12
+#define TEST_PATH "tile_catalog_test.bin"
+
+// Any date works, the test stars have no proper motion
+#define TEST_JULIAN_DATE 2451545.0
+
+static struct Star *star_table;
+
+void setUp(void)
+{
+    star_table = generate_test_stars(NUM_TEST_STARS, 12345, 0.0f, 15.0f);
+
+    TEST_ASSERT_TRUE(write_tile_catalog(TEST_PATH, star_table, NUM_TEST_STARS, NUM_TEST_BANDS));
+}
+
+void tearDown(void)
+{
+    remove(TEST_PATH);
+    free(star_table);
+}
+
+/* Request a view and wait for the loader, then request it again so the frame
+ * holds everything that was loaded
+ */
+static void request_loaded(struct TileCatalog *catalog, double ra, double dec, double radius, unsigned int stars)
+{
+    tile_catalog_request(catalog, TEST_JULIAN_DATE, ra, dec, radius, stars);
+    tile_catalog_wait_idle(catalog);
+    tile_catalog_request(catalog, TEST_JULIAN_DATE, ra, dec, radius, stars);
+}
+
+void test_view_is_covered_when_loaded(void)
+{
+    struct TileCatalog catalog;
+    TEST_ASSERT_TRUE(generate_tile_catalog(&catalog, TEST_PATH, 64 << 20));
+    TEST_ASSERT_EQUAL_UINT(NUM_TEST_STARS, catalog.num_stars);
+
+    double ra = 1.0;
+    double dec = 0.3;
+    double radius = 15.0 * TO_RAD;
+    request_loaded(&catalog, ra, dec, radius, NUM_TEST_STARS);
+
+    // Every star within the cap is captured, in the tile that contains it
+    bool *found = calloc(NUM_TEST_STARS, sizeof(bool));
+    for (unsigned int k = 0; k < catalog.num_frame; ++k)
+    {
+        const struct TileSnapshot *snapshot = &catalog.frame[k];
+        TEST_ASSERT_EQUAL_UINT(catalog.tiles[snapshot->tile].count, snapshot->count);
+        for (unsigned int i = 0; i < snapshot->count; ++i)
+        {
+            const struct Star *star = &snapshot->stars[i];
+            TEST_ASSERT_EQUAL_UINT(snapshot->tile,
+                                   sky_index_find_cell(&catalog.layout, star->right_ascension, star->declination));
+            found[star->catalog_number - 1] = true;
+        }
+    }
+
+    for (unsigned int i = 0; i < NUM_TEST_STARS; ++i)
+    {
+        const struct Star *star = &star_table[i];
+        double cos_dist = sin(dec) * sin(star->declination) +
+                          cos(dec) * cos(star->declination) * cos(ra - star->right_ascension);
+        if (acos(fmin(1.0, cos_dist)) < radius)
+        {
+            TEST_ASSERT_TRUE(found[i]);
+        }
+    }
+
+    free(found);
+    free_tile_catalog(&catalog);
+}
+
+void test_brightest_stars_load_first(void)
+{
+    struct TileCatalog catalog;
+    TEST_ASSERT_TRUE(generate_tile_catalog(&catalog, TEST_PATH, 64 << 20));
+
+    // Few stars over a wide cap leaves only the brightest few of each tile
+    request_loaded(&catalog, 4.0, -0.5, 30.0 * TO_RAD, 100);
+    TEST_ASSERT_TRUE(catalog.num_frame > 0);
+
+    for (unsigned int k = 0; k < catalog.num_frame; ++k)
+    {
+        const struct TileSnapshot *snapshot = &catalog.frame[k];
+        TEST_ASSERT_TRUE(snapshot->count < catalog.tiles[snapshot->tile].count);
+
+        for (unsigned int i = 1; i < snapshot->count; ++i)
+        {
+            TEST_ASSERT_TRUE(snapshot->stars[i - 1].magnitude <= snapshot->stars[i].magnitude);
+        }
+
+        // No star left on disk is brighter than the faintest one loaded
+        float faintest = snapshot->stars[snapshot->count - 1].magnitude;
+        unsigned int brighter = 0;
+        for (unsigned int i = 0; i < NUM_TEST_STARS; ++i)
+        {
+            const struct Star *star = &star_table[i];
+            if (sky_index_find_cell(&catalog.layout, star->right_ascension, star->declination) == snapshot->tile &&
+                star->magnitude <= faintest)
+            {
+                brighter++;
+            }
+        }
+        TEST_ASSERT_EQUAL_UINT(snapshot->count, brighter);
+    }
+
+    // Zooming in loads more stars of the same tiles
+    unsigned int first_tile = catalog.frame[0].tile;
+    unsigned int loaded = catalog.frame[0].count;
+    request_loaded(&catalog, 4.0, -0.5, 30.0 * TO_RAD, NUM_TEST_STARS);
+    TEST_ASSERT_TRUE(catalog.tiles[first_tile].num_loaded > loaded);
+
+    free_tile_catalog(&catalog);
+}
+
+void test_cache_stays_within_budget(void)
+{
+    // Room for only a small part of the catalog
+    size_t budget = NUM_TEST_STARS / 8 * sizeof(struct Star);
+    struct TileCatalog catalog;
+    TEST_ASSERT_TRUE(generate_tile_catalog(&catalog, TEST_PATH, budget));
+
+    for (int step = 0; step < 24; ++step)
+    {
+        double ra = step * 2.0 * M_PI / 24.0;
+        request_loaded(&catalog, ra, 0.2, 5.0 * TO_RAD, NUM_TEST_STARS);
+
+        size_t resident = 0;
+        for (unsigned int t = 0; t < catalog.num_tiles; ++t)
+        {
+            resident += catalog.tiles[t].num_loaded * sizeof(struct Star);
+        }
+        TEST_ASSERT_EQUAL_UINT64(resident, catalog.resident_bytes);
+        TEST_ASSERT_TRUE(catalog.resident_bytes <= budget);
+
+        // The current view always fits, so it is resident
+        TEST_ASSERT_TRUE(catalog.num_frame > 0);
+    }
+
+    // Panning all the way around the sky evicted the first tiles
+    unsigned int num_resident = 0;
+    for (unsigned int t = 0; t < catalog.num_tiles; ++t)
+    {
+        num_resident += catalog.tiles[t].num_loaded > 0;
+    }
+    TEST_ASSERT_TRUE(catalog.num_loads > num_resident);
+    tile_catalog_release(&catalog);
+
+    free_tile_catalog(&catalog);
+}
+
+void test_malformed_file_is_rejected(void)
+{
+    FILE *file = fopen(TEST_PATH, "r+b");
+    TEST_ASSERT_NOT_NULL(file);
+    fputc('X', file);
+    fclose(file);
+
+    struct TileCatalog catalog;
+    TEST_ASSERT_FALSE(generate_tile_catalog(&catalog, TEST_PATH, 64 << 20));
+    TEST_ASSERT_FALSE(generate_tile_catalog(&catalog, "missing_tile_catalog.bin", 64 << 20));
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_view_is_covered_when_loaded);
+    RUN_TEST(test_brightest_stars_load_first);
+    RUN_TEST(test_cache_stays_within_budget);
+    RUN_TEST(test_malformed_file_is_rejected);
+
+    return UNITY_END();
+}
@@ -0,0 +1,115 @@
+#include "stopwatch.h"
+#include "timer.h"
+#include "unity.h"
+
+#include <limits.h>
+#include <stdio.h>
+#include <string.h>
+
+#define TEST_PATH "timer_test.txt"
+
+static struct SwTimer timer = SW_TIMER("test");
+
+void setUp(void)
+{
+    sw_timer_reset(&timer, "test");
+}
+
+void tearDown(void)
+{
+    remove(TEST_PATH);
+}
+
+void test_static_timer_starts_empty(void)
+{
+    static struct SwTimer fresh = SW_TIMER("fresh");
+
+    struct SwTimerSummary summary;
+    sw_timer_summarize(&fresh, &summary);
+    TEST_ASSERT_EQUAL_STRING("fresh", summary.name);
+    TEST_ASSERT_EQUAL_UINT64(0, summary.count);
+    TEST_ASSERT_EQUAL_UINT64(0, summary.min);
+    TEST_ASSERT_EQUAL_UINT64(0, summary.max);
+    TEST_ASSERT_EQUAL_UINT64(ULLONG_MAX, fresh.min);
+}
+
+void test_records_accumulate(void)
+{
+    sw_timer_record(&timer, 300);
+    sw_timer_record(&timer, 100);
+    sw_timer_record(&timer, 200);
+
+    struct SwTimerSummary summary;
+    sw_timer_summarize(&timer, &summary);
+    TEST_ASSERT_EQUAL_UINT64(3, summary.count);
+    TEST_ASSERT_EQUAL_UINT64(600, summary.total);
+    TEST_ASSERT_EQUAL_UINT64(100, summary.min);
+    TEST_ASSERT_EQUAL_UINT64(300, summary.max);
+    TEST_ASSERT_EQUAL_DOUBLE(200.0, summary.mean);
+    TEST_ASSERT_UINT64_WITHIN(2, 200, summary.p50);
+}
+
+void test_timed_block_records_once(void)
+{
+    int runs = 0;
+    SW_TIMED(&timer)
+    {
+        sw_sleep(1000);
+        runs++;
+    }
+
+    // Nested blocks time with their own scope
+    SW_TIMED(&timer)
+    {
+        SW_TIMED(&timer)
+        {
+            runs++;
+        }
+    }
+
+    struct SwTimerSummary summary;
+    sw_timer_summarize(&timer, &summary);
+    TEST_ASSERT_EQUAL_INT(2, runs);
+    TEST_ASSERT_EQUAL_UINT64(3, summary.count);
+    TEST_ASSERT_TRUE(summary.max >= 1000000ULL);
+    TEST_ASSERT_TRUE(summary.min < summary.max);
+}
+
+void test_print_skips_unused_timers(void)
+{
+    static struct SwTimer unused = SW_TIMER("unused");
+    sw_timer_record(&timer, 1500);
+
+    const struct SwTimer *const timers[] = {&timer, &unused};
+    FILE *file = fopen(TEST_PATH, "w");
+    TEST_ASSERT_NOT_NULL(file);
+    sw_timers_print(file, timers, 2);
+    fclose(file);
+
+    file = fopen(TEST_PATH, "r");
+    TEST_ASSERT_NOT_NULL(file);
+    char line[256];
+    int rows = 0;
+    bool found = false;
+    while (fgets(line, sizeof(line), file) != NULL)
+    {
+        found = found || strncmp(line, "test ", 5) == 0;
+        rows++;
+    }
+    fclose(file);
+
+    TEST_ASSERT_EQUAL_INT(2, rows);
+    TEST_ASSERT_TRUE(found);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_static_timer_starts_empty);
+    RUN_TEST(test_records_accumulate);
+    RUN_TEST(test_timed_block_records_once);
+    RUN_TEST(test_print_skips_unused_timers);
+
+    return UNITY_END();
+}
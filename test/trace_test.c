@@ -0,0 +1,123 @@
+#include "thread.h"
+#include "trace.h"
+#include "unity.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TEST_PATH "trace_test.json"
+#define NUM_SPANS 5000
+
+static const char *const thread_names[] = {"main", "compute"};
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+    remove(TEST_PATH);
+}
+
+static char *read_trace(void)
+{
+    FILE *file = fopen(TEST_PATH, "rb");
+    TEST_ASSERT_NOT_NULL(file);
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    char *text = malloc((size_t)size + 1);
+    TEST_ASSERT_NOT_NULL(text);
+    TEST_ASSERT_EQUAL_size_t((size_t)size, fread(text, 1, (size_t)size, file));
+    text[size] = '\0';
+    fclose(file);
+    return text;
+}
+
+static unsigned int count_matches(const char *text, const char *pattern)
+{
+    unsigned int count = 0;
+    for (const char *match = strstr(text, pattern); match != NULL; match = strstr(match + 1, pattern))
+    {
+        count++;
+    }
+    return count;
+}
+
+static void record_spans(void *arg)
+{
+    struct TraceBuffer *buffer = arg;
+    for (int i = 0; i < NUM_SPANS; ++i)
+    {
+        struct SwTimestamp begin, end;
+        sw_gettime(&begin);
+        sw_gettime(&end);
+        trace_span(buffer, "render stars", begin, end);
+    }
+}
+
+void test_spans_of_each_thread_are_written(void)
+{
+    struct Tracer tracer;
+    TEST_ASSERT_TRUE(generate_tracer(&tracer, TEST_PATH, thread_names, 2));
+
+    // Each thread records into its own buffer while the writer drains both
+    struct Thread compute;
+    TEST_ASSERT_TRUE(thread_start(&compute, record_spans, &tracer.buffers[1]));
+    record_spans(&tracer.buffers[0]);
+    thread_join(&compute);
+
+    struct SwTimestamp now;
+    sw_gettime(&now);
+    trace_instant(&tracer.buffers[0], "deadline", now);
+
+    unsigned long long num_dropped = tracer_dropped(&tracer);
+    TEST_ASSERT_TRUE(free_tracer(&tracer));
+
+    char *text = read_trace();
+    TEST_ASSERT_EQUAL_INT(0, strncmp(text, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n", 40));
+    TEST_ASSERT_NOT_NULL(strstr(text, "\n]}\n"));
+    TEST_ASSERT_EQUAL_UINT(2, count_matches(text, "\"thread_name\""));
+    TEST_ASSERT_NOT_NULL(strstr(text, "\"args\":{\"name\":\"compute\"}"));
+    TEST_ASSERT_EQUAL_UINT(1, count_matches(text, "\"ph\":\"i\""));
+
+    // Every span is either written or counted as dropped
+    unsigned int num_spans = count_matches(text, "\"ph\":\"X\"");
+    TEST_ASSERT_EQUAL_UINT64(2 * NUM_SPANS, num_spans + num_dropped);
+    TEST_ASSERT_TRUE(count_matches(text, "\"tid\":2,") > 0);
+    free(text);
+}
+
+void test_empty_trace_is_valid(void)
+{
+    struct Tracer tracer;
+    TEST_ASSERT_TRUE(generate_tracer(&tracer, TEST_PATH, thread_names, 1));
+    TEST_ASSERT_TRUE(free_tracer(&tracer));
+
+    char *text = read_trace();
+    TEST_ASSERT_EQUAL_STRING("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n"
+                             "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"main\"}}"
+                             "\n]}\n",
+                             text);
+    free(text);
+}
+
+void test_unwritable_path_fails(void)
+{
+    struct Tracer tracer;
+    TEST_ASSERT_FALSE(generate_tracer(&tracer, "missing_directory/trace.json", thread_names, 1));
+    TEST_ASSERT_TRUE(free_tracer(&tracer));
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_spans_of_each_thread_are_written);
+    RUN_TEST(test_empty_trace_is_valid);
+    RUN_TEST(test_unwritable_path_fails);
+
+    return UNITY_END();
+}
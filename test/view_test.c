@@ -0,0 +1,144 @@
+#include "coord.h"
+#include "macros.h"
+#include "unity.h"
+#include "view.h"
+
+#include <curses.h>
+#include <math.h>
+
+static struct View view;
+
+void setUp(void)
+{
+    view_init(&view);
+}
+
+void tearDown(void)
+{
+}
+
+static void project_horizontal(double azimuth, double altitude, double *x, double *y)
+{
+    double east, north, up;
+    horizontal_to_unit(azimuth, altitude, &east, &north, &up);
+    TEST_ASSERT_TRUE(view_project(&view, east, north, up, x, y));
+}
+
+void test_zoom_keys(void)
+{
+    TEST_ASSERT_FALSE(view.zoomed);
+
+    // Panning does nothing until zoomed in
+    TEST_ASSERT_FALSE(view_handle_key(&view, KEY_LEFT));
+    TEST_ASSERT_FALSE(view_handle_key(&view, '-'));
+
+    double field = view.field;
+    TEST_ASSERT_TRUE(view_handle_key(&view, '+'));
+    TEST_ASSERT_TRUE(view.zoomed);
+    TEST_ASSERT_EQUAL_DOUBLE(field, view.field);
+
+    TEST_ASSERT_TRUE(view_handle_key(&view, '+'));
+    TEST_ASSERT_TRUE(view.field < field);
+    TEST_ASSERT_TRUE(view_handle_key(&view, '-'));
+    TEST_ASSERT_DOUBLE_WITHIN(1.0E-12, field, view.field);
+
+    // Never zooms out past where the gnomonic projection breaks down
+    for (int i = 0; i < 50; ++i)
+    {
+        view_handle_key(&view, '-');
+    }
+    TEST_ASSERT_TRUE(view.field < M_PI);
+
+    TEST_ASSERT_TRUE(view_handle_key(&view, KEY_DOWN));
+    TEST_ASSERT_TRUE(view.altitude < M_PI / 2.0);
+
+    TEST_ASSERT_TRUE(view_handle_key(&view, 'z'));
+    TEST_ASSERT_FALSE(view.zoomed);
+    TEST_ASSERT_FALSE(view_handle_key(&view, 'x'));
+}
+
+void test_zenith_matches_whole_sky_orientation(void)
+{
+    // Centered on the zenith, North is at the top and East on the left
+    double x, y;
+    project_horizontal(0.0, M_PI / 2.0, &x, &y);
+    TEST_ASSERT_DOUBLE_WITHIN(1.0E-12, 0.0, x);
+    TEST_ASSERT_DOUBLE_WITHIN(1.0E-12, 0.0, y);
+
+    project_horizontal(0.0, 80.0 * TO_RAD, &x, &y);
+    TEST_ASSERT_DOUBLE_WITHIN(1.0E-12, 0.0, x);
+    TEST_ASSERT_TRUE(y > 0.0);
+
+    project_horizontal(M_PI / 2.0, 80.0 * TO_RAD, &x, &y);
+    TEST_ASSERT_TRUE(x < 0.0);
+    TEST_ASSERT_DOUBLE_WITHIN(1.0E-12, 0.0, y);
+}
+
+void test_field_spans_window(void)
+{
+    for (int projections = 0; projections < 2; ++projections)
+    {
+        // Look at the southern horizon with a 20° field
+        view_look_at(&view, M_PI, 0.0, 20.0 * TO_RAD);
+
+        // Half the field away from the center lands on the edge of the window
+        double x, y;
+        project_horizontal(M_PI + 10.0 * TO_RAD, 0.0, &x, &y);
+        TEST_ASSERT_DOUBLE_WITHIN(1.0E-9, 1.0, x);
+        TEST_ASSERT_DOUBLE_WITHIN(1.0E-9, 0.0, y);
+
+        project_horizontal(M_PI, 10.0 * TO_RAD, &x, &y);
+        TEST_ASSERT_DOUBLE_WITHIN(1.0E-9, 0.0, x);
+        TEST_ASSERT_DOUBLE_WITHIN(1.0E-9, 1.0, y);
+
+        // Points behind the viewer are not projected
+        double east, north, up;
+        horizontal_to_unit(0.0, 0.0, &east, &north, &up);
+        TEST_ASSERT_FALSE(view_project(&view, east, north, up, &x, &y));
+
+        view_handle_key(&view, 'p');
+    }
+
+    int row, col;
+    TEST_ASSERT_TRUE(view_plane_to_win(1.0, 1.0, 41, 81, &row, &col));
+    TEST_ASSERT_EQUAL_INT(0, row);
+    TEST_ASSERT_EQUAL_INT(80, col);
+    TEST_ASSERT_FALSE(view_plane_to_win(1.01, 0.0, 41, 81, &row, &col));
+}
+
+void test_cap_contains_window(void)
+{
+    view_handle_key(&view, '+');
+    for (int projections = 0; projections < 2; ++projections)
+    {
+        double radius = view_cap_radius(&view);
+
+        // The corners of the window are exactly on the cap
+        double along;
+        if (view.gnomonic)
+        {
+            double rho = M_SQRT2 * view.half_extent;
+            along = 1.0 / sqrt(1.0 + rho * rho);
+        }
+        else
+        {
+            double rho = M_SQRT2 * view.half_extent;
+            along = cos(2.0 * atan(rho / 2.0));
+        }
+        TEST_ASSERT_DOUBLE_WITHIN(1.0E-9, radius, acos(along));
+
+        view_handle_key(&view, 'p');
+    }
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_zoom_keys);
+    RUN_TEST(test_zenith_matches_whole_sky_orientation);
+    RUN_TEST(test_field_spans_window);
+    RUN_TEST(test_cap_contains_window);
+
+    return UNITY_END();
+}
@@ -0,0 +1,245 @@
+#include "core.h"
+#include "core_position.h"
+#include "macros.h"
+#include "visibility.h"
+#include "test_stars.h"
+#include "unity.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define NUM_TEST_STARS 2000
+
+static struct Star *star_table;
+static unsigned int *idx_by_mag;
+static struct VisibilityScheduler scheduler;
+
+void setUp(void)
+{
+    star_table = generate_test_stars(NUM_TEST_STARS, 54321, -1.0f, 7.0f);
+
+    // Include the poles
+    star_table[0].declination = M_PI / 2.0;
+    star_table[1].declination = -M_PI / 2.0;
+
+    star_indices_by_magnitude(&idx_by_mag, star_table, NUM_TEST_STARS);
+    generate_visibility_scheduler(&scheduler, idx_by_mag, NUM_TEST_STARS);
+}
+
+void tearDown(void)
+{
+    free_visibility_scheduler(&scheduler);
+    free(idx_by_mag);
+    free(star_table);
+}
+
+static void assert_matches_reference(const struct Star *reference)
+{
+    for (unsigned int i = 0; i < NUM_TEST_STARS; ++i)
+    {
+        if (reference[i].base.up >= 0.0)
+        {
+            // Visible stars must be exact
+            TEST_ASSERT_DOUBLE_WITHIN(1.0E-12, reference[i].base.east, star_table[i].base.east);
+            TEST_ASSERT_DOUBLE_WITHIN(1.0E-12, reference[i].base.north, star_table[i].base.north);
+            TEST_ASSERT_DOUBLE_WITHIN(1.0E-12, reference[i].base.up, star_table[i].base.up);
+        }
+        else
+        {
+            // Hidden stars must stay hidden
+            TEST_ASSERT_TRUE(star_table[i].base.up < 0.0);
+        }
+    }
+}
+
+void test_scheduled_update_matches_full_update(void)
+{
+    struct Star *reference = malloc(NUM_TEST_STARS * sizeof(struct Star));
+    memcpy(reference, star_table, NUM_TEST_STARS * sizeof(struct Star));
+
+    double julian_date = 2459146.0;
+    double latitude = 42.3601 * M_PI / 180;
+    double longitude = -71.0589 * M_PI / 180;
+
+    // Small steps so stars rise and set between updates
+    for (int step = 0; step < 200; ++step)
+    {
+        double jd = julian_date + step * 0.01;
+        update_star_positions(reference, NUM_TEST_STARS, jd, latitude, longitude);
+        update_star_positions_scheduled(star_table, &scheduler, jd, latitude, longitude);
+        assert_matches_reference(reference);
+    }
+
+    // Jumps forwards and backwards in time
+    double jumps[] = {julian_date + 37.3, julian_date + 3650.7, julian_date - 12.9, julian_date + 0.5};
+    for (int step = 0; step < 4; ++step)
+    {
+        update_star_positions(reference, NUM_TEST_STARS, jumps[step], latitude, longitude);
+        update_star_positions_scheduled(star_table, &scheduler, jumps[step], latitude, longitude);
+        assert_matches_reference(reference);
+    }
+
+    // Change of observer
+    update_star_positions(reference, NUM_TEST_STARS, julian_date, -latitude, 0.0);
+    update_star_positions_scheduled(star_table, &scheduler, julian_date, -latitude, 0.0);
+    assert_matches_reference(reference);
+
+    free(reference);
+}
+
+void test_visible_set_is_sorted_and_counted(void)
+{
+    update_star_positions_scheduled(star_table, &scheduler, 2459146.0, 0.5, 0.0);
+
+    unsigned int count = 0;
+    unsigned int previous = 0;
+    for (unsigned int rank = visibility_scheduler_next(&scheduler, 0); rank < NUM_TEST_STARS;
+         rank = visibility_scheduler_next(&scheduler, rank + 1))
+    {
+        // Iteration follows magnitude order, up to the 0.01 resolution of the
+        // sort keys
+        if (count > 0)
+        {
+            TEST_ASSERT_TRUE(rank > previous);
+            TEST_ASSERT_TRUE(star_table[idx_by_mag[rank]].magnitude <=
+                             star_table[idx_by_mag[previous]].magnitude + 0.01f);
+        }
+        previous = rank;
+        count++;
+    }
+
+    // Roughly half the sky is up
+    TEST_ASSERT_EQUAL_UINT(scheduler.num_visible, count);
+    TEST_ASSERT_TRUE(count > NUM_TEST_STARS * 2 / 5 && count < NUM_TEST_STARS * 3 / 5);
+
+    // Only stars that rise and set are scheduled
+    TEST_ASSERT_TRUE(scheduler.num_events < NUM_TEST_STARS);
+}
+
+void test_pinned_stars_are_always_visible(void)
+{
+    // The south celestial pole never rises at this latitude
+    unsigned int pinned[] = {1};
+    visibility_scheduler_pin_stars(&scheduler, pinned, 1);
+    update_star_positions_scheduled(star_table, &scheduler, 2459146.0, 0.5, 0.0);
+
+    unsigned int rank = scheduler.rank_of[1];
+    TEST_ASSERT_EQUAL_UINT(rank, visibility_scheduler_next(&scheduler, rank));
+    TEST_ASSERT_DOUBLE_WITHIN(1.0E-9, sin(-0.5), star_table[1].base.up);
+}
+
+// Stereographic projection onto a disk of radius one at the horizon
+static void project(const struct ObjectBase *base, double *x, double *y)
+{
+    *x = base->east / (1.0 + base->up);
+    *y = base->north / (1.0 + base->up);
+}
+
+void test_amortized_update_stays_within_half_a_cell(void)
+{
+    struct StarExtrapolation extrapolation;
+    TEST_ASSERT_TRUE(generate_star_extrapolation(&extrapolation, NUM_TEST_STARS));
+
+    struct Star *reference = malloc(NUM_TEST_STARS * sizeof(struct Star));
+    memcpy(reference, star_table, NUM_TEST_STARS * sizeof(struct Star));
+
+    // One minute of sky per frame on a window 80 cells across
+    double frame_step = 1.0 / (24.0 * 60.0);
+    double radius_cells = 40.0;
+    double latitude = 42.3601 * M_PI / 180;
+
+    unsigned int recomputed = 0;
+    for (int frame = 0; frame < 400; ++frame)
+    {
+        double jd = 2459146.0 + frame * frame_step;
+        update_star_positions(reference, NUM_TEST_STARS, jd, latitude, 0.0);
+        update_star_positions_amortized(star_table, &scheduler, &extrapolation, jd, latitude, 0.0, radius_cells);
+
+        for (unsigned int i = 0; i < NUM_TEST_STARS; ++i)
+        {
+            if (reference[i].base.up < 0.0 || star_table[i].base.up < 0.0)
+            {
+                continue;
+            }
+
+            double x_exact, y_exact, x, y;
+            project(&reference[i].base, &x_exact, &y_exact);
+            project(&star_table[i].base, &x, &y);
+            TEST_ASSERT_TRUE(hypot(x - x_exact, y - y_exact) * radius_cells <= 0.5);
+        }
+
+        recomputed += extrapolation.motions[scheduler.rank_of[0]].julian_date == jd;
+    }
+
+    // Stars are recomputed only every few frames
+    TEST_ASSERT_TRUE(extrapolation.period > 1);
+    TEST_ASSERT_TRUE(recomputed < 400);
+
+    free(reference);
+    free_star_extrapolation(&extrapolation);
+}
+
+void test_amortized_update_period(void)
+{
+    // A paused clock never needs recomputing
+    TEST_ASSERT_TRUE(amortized_update_period(0.0, 40.0) > 1);
+
+    // Faster clocks and larger windows recompute more often
+    TEST_ASSERT_TRUE(amortized_update_period(1.0E-4, 40.0) >= amortized_update_period(1.0E-3, 40.0));
+    TEST_ASSERT_TRUE(amortized_update_period(1.0E-3, 20.0) >= amortized_update_period(1.0E-3, 200.0));
+    TEST_ASSERT_EQUAL_UINT(1, amortized_update_period(1.0, 40.0));
+}
+
+void test_scheduler_only_suits_slow_forward_clocks(void)
+{
+    // One second of sky per frame, a paused clock, and a day per frame
+    TEST_ASSERT_TRUE(visibility_scheduler_suits(1.0 / 86400.0));
+    TEST_ASSERT_TRUE(visibility_scheduler_suits(0.0));
+    TEST_ASSERT_FALSE(visibility_scheduler_suits(1.0));
+
+    // Events only move forwards, so reversed clocks are never scheduled
+    TEST_ASSERT_FALSE(visibility_scheduler_suits(-1.0 / 86400.0));
+}
+
+void test_update_backwards_in_time(void)
+{
+    struct StarExtrapolation extrapolation;
+    TEST_ASSERT_TRUE(generate_star_extrapolation(&extrapolation, NUM_TEST_STARS));
+
+    struct Star *reference = malloc(NUM_TEST_STARS * sizeof(struct Star));
+    memcpy(reference, star_table, NUM_TEST_STARS * sizeof(struct Star));
+
+    // One minute of sky per frame, backwards
+    double frame_step = -1.0 / (24.0 * 60.0);
+    double radius_cells = 40.0;
+    double latitude = 42.3601 * M_PI / 180;
+
+    for (int frame = 0; frame < 50; ++frame)
+    {
+        double jd = 2459146.0 + frame * frame_step;
+        update_star_positions(reference, NUM_TEST_STARS, jd, latitude, 0.0);
+        update_star_positions_amortized(star_table, &scheduler, &extrapolation, jd, latitude, 0.0, radius_cells);
+
+        // Still correct, if slow, as every event and motion is recomputed
+        assert_matches_reference(reference);
+    }
+
+    free(reference);
+    free_star_extrapolation(&extrapolation);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_scheduled_update_matches_full_update);
+    RUN_TEST(test_visible_set_is_sorted_and_counted);
+    RUN_TEST(test_pinned_stars_are_always_visible);
+    RUN_TEST(test_amortized_update_stays_within_half_a_cell);
+    RUN_TEST(test_amortized_update_period);
+    RUN_TEST(test_scheduler_only_suits_slow_forward_clocks);
+    RUN_TEST(test_update_backwards_in_time);
+
+    return UNITY_END();
+}